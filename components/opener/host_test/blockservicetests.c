@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* ReadBlock and WriteBlock of the Motoman data classes: a block written and
+ * read back, blocks outside the class or larger than a reply, truncated and
+ * surplus request data, and the cost against single requests. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hosttest.h"
+
+#define kReadBlock 0x4B
+#define kWriteBlock 0x4C
+#define kRegisterClass 0x79
+#define kVariableDClass 0x7C
+#define kPositionClass 0x75
+#define kVariables 1000
+/* PC_OPENER_ETHERNET_BUFFER_SIZE minus the reply overhead, in DINTs */
+#define kLargestDBlock ( (PC_OPENER_ETHERNET_BUFFER_SIZE - 50) / 4)
+
+static EipUint8 g_request[PC_OPENER_ETHERNET_BUFFER_SIZE];
+static CipMessageRouterResponse g_response;
+
+/* the count, then data_length bytes of data */
+static CipUsint SendBlockRequest(const CipUsint service,
+                                 const CipUint class_id,
+                                 const CipInstanceNum instance,
+                                 const CipUint count,
+                                 const EipUint8 *const data,
+                                 const size_t data_length) {
+  EipUint8 request_data[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  request_data[0] = (EipUint8)count;
+  request_data[1] = (EipUint8)(count >> 8);
+  if(0 != data_length) {
+    memcpy(request_data + 2, data, data_length);
+  }
+  HostTestSendRequest(g_request,
+                      HostTestEncodeRequest(g_request, service, class_id,
+                                            instance, -1, request_data,
+                                            2 + data_length),
+                      &g_response);
+  return g_response.general_status;
+}
+
+static EipInt32 GetVariableD(const CipInstanceNum instance) {
+  EipUint8 request[16];
+  CipMessageRouterResponse response;
+  HostTestSendRequest(request,
+                      HostTestEncodeRequest(request, kGetAttributeSingle,
+                                            kVariableDClass, instance, 1, NULL,
+                                            0),
+                      &response);
+  EipInt32 value;
+  memcpy(&value, response.message.message_buffer, sizeof(value) );
+  return value;
+}
+
+static void TestGoodBlocks(void) {
+  EipInt32 values[kLargestDBlock];
+  for(int i = 0; i < kLargestDBlock; i++) {
+    values[i] = -1000 * i - 7;
+  }
+  HOST_TEST_CHECK(kCipErrorSuccess ==
+                  SendBlockRequest(kWriteBlock, kVariableDClass, 11,
+                                   kLargestDBlock, (const EipUint8 *)values,
+                                   sizeof(values) ) );
+  HOST_TEST_CHECK(0 == g_response.message.used_message_length);
+  HOST_TEST_CHECK(values[0] == GetVariableD(11) );
+  HOST_TEST_CHECK(values[kLargestDBlock - 1] ==
+                  GetVariableD(11 + kLargestDBlock - 1) );
+  HOST_TEST_CHECK(0 == GetVariableD(11 + kLargestDBlock) );
+
+  HOST_TEST_CHECK(kCipErrorSuccess ==
+                  SendBlockRequest(kReadBlock, kVariableDClass, 11,
+                                   kLargestDBlock, NULL, 0) );
+  HOST_TEST_CHECK(sizeof(values) == g_response.message.used_message_length &&
+                  0 == memcmp(values, g_response.message.message_buffer,
+                              sizeof(values) ) );
+
+  /* registers 1 to 3 hold 100, 250 and 500, packed as UINTs */
+  static const EipUint8 registers[] = { 100, 0, 250, 0, 0xF4, 0x01 };
+  HOST_TEST_CHECK(kCipErrorSuccess ==
+                  SendBlockRequest(kReadBlock, kRegisterClass, 1, 3, NULL, 0) );
+  HOST_TEST_CHECK(sizeof(registers) == g_response.message.used_message_length &&
+                  0 == memcmp(registers, g_response.message.message_buffer,
+                              sizeof(registers) ) );
+
+  /* the last element of the class */
+  HOST_TEST_CHECK(kCipErrorSuccess ==
+                  SendBlockRequest(kReadBlock, kVariableDClass, kVariables, 1,
+                                   NULL, 0) );
+}
+
+static void TestBadBlocks(void) {
+  const EipUint8 data[8] = { 0 };
+
+  /* larger than a reply */
+  HOST_TEST_CHECK(kCipErrorReplyDataTooLarge ==
+                  SendBlockRequest(kReadBlock, kVariableDClass, 1,
+                                   kLargestDBlock + 1, NULL, 0) );
+  HOST_TEST_CHECK(0 == g_response.message.used_message_length);
+
+  /* outside the class, or empty */
+  HOST_TEST_CHECK(kCipErrorInvalidParameter ==
+                  SendBlockRequest(kReadBlock, kVariableDClass, kVariables, 2,
+                                   NULL, 0) );
+  HOST_TEST_CHECK(kCipErrorInvalidParameter ==
+                  SendBlockRequest(kReadBlock, kVariableDClass, 1, 0, NULL,
+                                   0) );
+  HOST_TEST_CHECK(kCipErrorInvalidParameter ==
+                  SendBlockRequest(kWriteBlock, kVariableDClass, kVariables, 2,
+                                   data, 8) );
+  HOST_TEST_CHECK(0 == GetVariableD(kVariables) );
+
+  /* truncated: no count, half a count, short write data */
+  HostTestSendRequest(g_request,
+                      HostTestEncodeRequest(g_request, kReadBlock,
+                                            kVariableDClass, 1, -1, NULL, 0),
+                      &g_response);
+  HOST_TEST_CHECK(kCipErrorNotEnoughData == g_response.general_status);
+  HostTestSendRequest(g_request,
+                      HostTestEncodeRequest(g_request, kWriteBlock,
+                                            kVariableDClass, 1, -1, data, 1),
+                      &g_response);
+  HOST_TEST_CHECK(kCipErrorNotEnoughData == g_response.general_status);
+  HOST_TEST_CHECK(kCipErrorNotEnoughData ==
+                  SendBlockRequest(kWriteBlock, kVariableDClass, 1, 2, data,
+                                   7) );
+
+  /* surplus data */
+  HOST_TEST_CHECK(kCipErrorTooMuchData ==
+                  SendBlockRequest(kWriteBlock, kVariableDClass, 1, 1, data,
+                                   5) );
+  HOST_TEST_CHECK(kCipErrorTooMuchData ==
+                  SendBlockRequest(kReadBlock, kVariableDClass, 1, 1, data,
+                                   1) );
+
+  /* a class without array backed instances has no block services */
+  HOST_TEST_CHECK(kCipErrorServiceNotSupported ==
+                  SendBlockRequest(kReadBlock, kPositionClass, 1, 1, NULL,
+                                   0) );
+}
+
+static void MeasureBlockRead(void) {
+  EipUint8 singles[100][16];
+  size_t single_lengths[100];
+  EipUint8 block[16];
+  const EipUint8 count[] = { 100, 0 };
+  CipMessageRouterResponse response;
+  const int repetitions = 2000;
+
+  for(int i = 0; i < 100; i++) {
+    single_lengths[i] = HostTestEncodeRequest(singles[i], kGetAttributeSingle,
+                                              kVariableDClass,
+                                              (CipInstanceNum)(i + 1), 1, NULL,
+                                              0);
+  }
+  const size_t block_length = HostTestEncodeRequest(block, kReadBlock,
+                                                    kVariableDClass, 1, -1,
+                                                    count, sizeof(count) );
+  double start = HostTestNanoSeconds();
+  for(int k = 0; k < repetitions; k++) {
+    for(int i = 0; i < 100; i++) {
+      HostTestSendRequest(singles[i], single_lengths[i], &response);
+    }
+  }
+  const double singles_cost = (HostTestNanoSeconds() - start) / repetitions;
+  const double block_cost = HostTestMeasureRequest(block, block_length,
+                                                   repetitions, 5);
+  HostTestSendRequest(block, block_length, &response);
+  printf("100 D variables, us: 100 x Get_Attribute_Single %.1f, "
+         "1 x ReadBlock %.1f (%zu byte reply)\n", singles_cost / 1e3,
+         block_cost / 1e3, response.message.used_message_length);
+  HOST_TEST_CHECK(400 == response.message.used_message_length);
+  HOST_TEST_CHECK(block_cost < singles_cost);
+}
+
+int main(void) {
+  HostTestInitializeStack();
+  TestGoodBlocks();
+  TestBadBlocks();
+  MeasureBlockRead();
+  return HostTestResult();
+}
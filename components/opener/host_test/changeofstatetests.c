@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* Change of state production of the input assembly: a class 1 connection to
+ * the connection points 151/150/100 while the client writes mapped io,
+ * unmapped io or the same value over and over, and the latency from a write
+ * to the first frame carrying it. The network handler and the I/O task run
+ * in threads of their own, the test is the client. Before, the production
+ * inhibit time of the Forward Open is checked against the RPI. */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+
+#include "cipconnectionobject.h"
+#include "cpf.h"
+#include "encap.h"
+#include "generic_networkhandler.h"
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+#include "generic_iohandler.h"
+#endif
+
+#define kIoClass 0x78
+#define kMappedIo 1 /* input signal 00010, in the default input map */
+#define kUnmappedIo 5001
+#define kInputSize 120
+#define kOutputSize 32
+#define kReceiverPort 23456
+#define kCyclicTrigger 0x01
+#define kChangeOfStateTrigger 0x11
+#define kApplicationTrigger 0x21
+#define kNoPitSegment 256
+/* CPF of a class 1 frame: item count, sequenced address item, data item
+ * header and sequence count */
+#define kFrameDataOffset 20
+#define kMappedIoOffset 72 /* of io 1 in the input assembly */
+
+EipUint16 ProcessProductionInhibitTime(
+  CipConnectionObject *io_connection_object);
+
+typedef enum {
+  kWritesNone,
+  kWritesMapped,
+  kWritesUnmapped,
+  kWritesSameValue
+} Writes;
+
+static atomic_bool g_stop_handler;
+static atomic_bool g_stop_feed;
+static int g_client = -1;
+static CipSessionHandle g_session;
+static CipUdint g_consumed_connection_id;
+static CipUdint g_rpi;
+static EipUint16 g_connection_serial_number = 1;
+
+static void *RunNetworkHandler(void *argument) {
+  (void)argument;
+  while(!g_stop_handler) {
+    NetworkHandlerProcessCyclic();
+  }
+  return NULL;
+}
+
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+static void *RunIoTask(void *argument) {
+  (void)argument;
+  while(!g_stop_handler) {
+    IoHandlerProcessCyclic();
+  }
+  return NULL;
+}
+#endif
+
+static void ReceiveExactly(EipUint8 *const buffer, const size_t length) {
+  size_t received = 0;
+  while(received < length) {
+    const long bytes = recv(g_client, buffer + received, length - received, 0);
+    if(bytes <= 0) {
+      perror("recv");
+      exit(EXIT_FAILURE);
+    }
+    received += bytes;
+  }
+}
+
+/* sends an encapsulation packet, returns the length of the reply */
+static size_t Exchange(const EipUint8 *const packet,
+                       const size_t length,
+                       EipUint8 *const reply) {
+  if(length != (size_t)send(g_client, packet, length, 0) ) {
+    perror("send");
+    exit(EXIT_FAILURE);
+  }
+  ReceiveExactly(reply, ENCAPSULATION_HEADER_LENGTH);
+  const size_t data_length = reply[2] | reply[3] << 8;
+  ReceiveExactly(reply + ENCAPSULATION_HEADER_LENGTH, data_length);
+  return ENCAPSULATION_HEADER_LENGTH + data_length;
+}
+
+/* general status of the explicit reply in a SendRRData reply */
+static const EipUint8 *ExplicitReply(const EipUint8 *const reply) {
+  return reply + ENCAPSULATION_HEADER_LENGTH + 16;
+}
+
+static CipUsint SendExplicit(const EipUint8 *const request,
+                             const size_t request_length) {
+  EipUint8 packet[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  EipUint8 reply[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  const size_t length = HostTestEncodeSendRRData(packet, g_session, request,
+                                                 request_length);
+  Exchange(packet, length, reply);
+  return ExplicitReply(reply)[2];
+}
+
+static CipUsint WriteIo(const CipInstanceNum instance, const EipUint8 value) {
+  EipUint8 request[16];
+  return SendExplicit(request,
+                      HostTestEncodeRequest(request, kSetAttributeSingle,
+                                            kIoClass, instance, 1, &value, 1) );
+}
+
+static void PutUint16(EipUint8 *const buffer, const EipUint16 value) {
+  buffer[0] = (EipUint8)value;
+  buffer[1] = (EipUint8)(value >> 8);
+}
+
+static void PutUint32(EipUint8 *const buffer, const EipUint32 value) {
+  PutUint16(buffer, (EipUint16)value);
+  PutUint16(buffer + 2, (EipUint16)(value >> 16) );
+}
+
+/* connection triple, shared by Forward Open and Forward Close */
+static size_t EncodeConnectionTriple(EipUint8 *const buffer) {
+  PutUint16(buffer, g_connection_serial_number);
+  PutUint16(buffer + 2, 0x1234); /* vendor */
+  PutUint32(buffer + 4, 0xABCD); /* originator serial number */
+  return 8;
+}
+
+static const EipUint8 kConnectionPath[] = { 0x20, 0x04, 0x24, 0x97, 0x2C, 0x96,
+                                            0x2C, 0x64 };
+
+static bool ForwardOpen(const CipUsint trigger) {
+  EipUint8 data[64];
+  size_t length = 0;
+  data[length++] = 0x0A; /* priority, time tick */
+  data[length++] = 0x0E; /* timeout ticks */
+  PutUint32(data + length, 0); /* O->T connection id, chosen by the target */
+  PutUint32(data + length + 4, 0x55550001); /* T->O connection id */
+  length += 8;
+  length += EncodeConnectionTriple(data + length);
+  data[length++] = 0; /* timeout multiplier x4 */
+  memset(data + length, 0, 3);
+  length += 3;
+  PutUint32(data + length, g_rpi);
+  PutUint16(data + length + 4, 0x4800 | (kOutputSize + 6) );
+  PutUint32(data + length + 6, g_rpi);
+  PutUint16(data + length + 10, 0x4800 | (kInputSize + 2) );
+  length += 12;
+  data[length++] = trigger;
+  data[length++] = sizeof(kConnectionPath) / 2;
+  memcpy(data + length, kConnectionPath, sizeof(kConnectionPath) );
+  length += sizeof(kConnectionPath);
+
+  EipUint8 request[80];
+  const size_t request_length = HostTestEncodeRequest(request, 0x54, 0x06, 1,
+                                                      -1, data, length);
+  /* a third item: the T->O frames go to the receiver port */
+  EipUint8 packet[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  size_t packet_length = HostTestEncodeSendRRData(packet, g_session, request,
+                                                  request_length);
+  EipUint8 *item = packet + packet_length;
+  PutUint16(item, kCipItemIdSocketAddressInfoTargetToOriginator);
+  PutUint16(item + 2, 16);
+  struct sockaddr_in address = { .sin_family = htons(AF_INET),
+                                 .sin_port = htons(kReceiverPort),
+                                 .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+  memcpy(item + 4, &address, 16);
+  packet_length += 20;
+  PutUint16(packet + 2, (EipUint16)(packet_length -
+                                    ENCAPSULATION_HEADER_LENGTH) );
+  PutUint16(packet + ENCAPSULATION_HEADER_LENGTH + 6, 3); /* item count */
+
+  EipUint8 reply[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  Exchange(packet, packet_length, reply);
+  const EipUint8 *explicit_reply = ExplicitReply(reply);
+  if(kCipErrorSuccess != explicit_reply[2]) {
+    printf("Forward Open failed: status 0x%02X\n", explicit_reply[2]);
+    return false;
+  }
+  memcpy(&g_consumed_connection_id, explicit_reply + 4,
+         sizeof(g_consumed_connection_id) );
+  return true;
+}
+
+static void ForwardClose(void) {
+  EipUint8 data[32];
+  size_t length = 0;
+  data[length++] = 0x0A;
+  data[length++] = 0x0E;
+  length += EncodeConnectionTriple(data + length);
+  data[length++] = sizeof(kConnectionPath) / 2;
+  data[length++] = 0;
+  memcpy(data + length, kConnectionPath, sizeof(kConnectionPath) );
+  length += sizeof(kConnectionPath);
+  EipUint8 request[48];
+  HOST_TEST_CHECK(kCipErrorSuccess ==
+                  SendExplicit(request,
+                               HostTestEncodeRequest(request, 0x4E, 0x06, 1,
+                                                     -1, data, length) ) );
+  g_connection_serial_number++;
+}
+
+/* the scanner's O->T data, the same every RPI */
+static void *FeedConsumer(void *argument) {
+  (void)argument;
+  const int socket_handle = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in address = { .sin_family = AF_INET,
+                                 .sin_port = htons(kOpenerEipIoUdpPort),
+                                 .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+  EipUint8 frame[24 + kOutputSize] = { 2, 0, 0x02, 0x80, 8, 0 };
+  memcpy(frame + 6, &g_consumed_connection_id, 4);
+  PutUint16(frame + 14, kCipItemIdConnectedDataItem);
+  PutUint16(frame + 16, kOutputSize + 6);
+  frame[20] = 1; /* run */
+  for(CipUdint sequence_number = 1; !g_stop_feed; sequence_number++) {
+    PutUint32(frame + 10, sequence_number);
+    PutUint16(frame + 18, (EipUint16)sequence_number);
+    sendto(socket_handle, frame, sizeof(frame), 0,
+           (struct sockaddr *)&address, sizeof(address) );
+    usleep(g_rpi);
+  }
+  close(socket_handle);
+  return NULL;
+}
+
+typedef struct {
+  int frames;
+  long average_latency; /* write to the first frame with its value, us */
+} ProductionResult;
+
+static ProductionResult MeasureProduction(const int receiver,
+                                          const CipUsint trigger,
+                                          const Writes writes,
+                                          const CipUdint rpi,
+                                          const MicroSeconds write_period,
+                                          const MicroSeconds duration) {
+  ProductionResult result = { 0, 0 };
+  g_rpi = rpi;
+  if(!ForwardOpen(trigger) ) {
+    HOST_TEST_CHECK(false);
+    return result;
+  }
+  g_stop_feed = false;
+  pthread_t feeder;
+  pthread_create(&feeder, NULL, FeedConsumer, NULL);
+
+  EipUint8 frame[600];
+  while(recv(receiver, frame, sizeof(frame), MSG_DONTWAIT) > 0) {
+  }
+  EipUint8 value = 0;
+  EipUint8 pending_value = 0;
+  MicroSeconds last_write = 0;
+  MicroSeconds pending_since = 0;
+  long latency_sum = 0;
+  int latencies = 0;
+  const MicroSeconds end = GetMicroSeconds() + duration;
+  while(GetMicroSeconds() < end) {
+    const MicroSeconds now = GetMicroSeconds();
+    if(kWritesNone != writes && now - last_write >= write_period) {
+      last_write = now;
+      value = kWritesSameValue == writes ? 1 : (EipUint8)(value + 1);
+      HOST_TEST_CHECK(kCipErrorSuccess ==
+                      WriteIo(kWritesUnmapped == writes ? kUnmappedIo :
+                              kMappedIo, value) );
+      if(kWritesMapped == writes && 0 == pending_since) {
+        pending_since = now;
+        pending_value = value;
+      }
+    }
+    if(recv(receiver, frame, sizeof(frame), MSG_DONTWAIT) <=
+       kFrameDataOffset + kMappedIoOffset) {
+      usleep(100);
+      continue;
+    }
+    result.frames++;
+    /* the pending value or a later one, the values count up */
+    const EipUint8 age = (EipUint8)(frame[kFrameDataOffset + kMappedIoOffset] -
+                                    pending_value);
+    if(0 != pending_since && age < 0x80) {
+      latency_sum += (long)(GetMicroSeconds() - pending_since);
+      latencies++;
+      pending_since = 0;
+    }
+  }
+  ForwardClose();
+  g_stop_feed = true;
+  pthread_join(feeder, NULL);
+  result.average_latency = latencies > 0 ? latency_sum / latencies : 0;
+  return result;
+}
+
+/* the PIT after the check, or -1 if the Forward Open is rejected */
+static int CheckProductionInhibitTime(const CipByte trigger,
+                                      const CipUint pit,
+                                      const CipUdint rpi) {
+  CipConnectionObject connection = { .transport_class_trigger = trigger,
+                                     .production_inhibit_time = pit,
+                                     .t_to_o_requested_packet_interval = rpi };
+  if(kConnectionManagerExtendedStatusCodeSuccess !=
+     ProcessProductionInhibitTime(&connection) ) {
+    return -1;
+  }
+  return connection.production_inhibit_time;
+}
+
+static void TestProductionInhibitTime(void) {
+  /* without a PIT segment it is a fourth of the RPI */
+  HOST_TEST_CHECK(12 == CheckProductionInhibitTime(kChangeOfStateTrigger,
+                                                   kNoPitSegment, 50000) );
+  HOST_TEST_CHECK(0 == CheckProductionInhibitTime(kApplicationTrigger,
+                                                  kNoPitSegment, 500) );
+  /* up to the RPI, which is in us */
+  HOST_TEST_CHECK(10 == CheckProductionInhibitTime(kChangeOfStateTrigger, 10,
+                                                   10000) );
+  HOST_TEST_CHECK(-1 == CheckProductionInhibitTime(kChangeOfStateTrigger, 11,
+                                                   10999) );
+  HOST_TEST_CHECK(0 == CheckProductionInhibitTime(kChangeOfStateTrigger, 0,
+                                                  500) );
+  HOST_TEST_CHECK(-1 == CheckProductionInhibitTime(kApplicationTrigger, 1,
+                                                   999) );
+  /* a cyclic connection produces at the RPI, its PIT is not used */
+  HOST_TEST_CHECK(200 == CheckProductionInhibitTime(kCyclicTrigger, 200,
+                                                    10000) );
+  HOST_TEST_CHECK(kNoPitSegment ==
+                  CheckProductionInhibitTime(kCyclicTrigger, kNoPitSegment,
+                                             10000) );
+}
+
+static void TestChangeOfState(const int receiver) {
+  static const char *const kWritesNames[] = {
+    "no writes", "mapped io", "unmapped io", "same value"
+  };
+  ProductionResult result[4];
+
+  printf("Frames in 1 s, RPI 50 ms, a write every 2 ms:\n");
+  for(Writes writes = kWritesNone; writes <= kWritesSameValue; writes++) {
+    result[writes] = MeasureProduction(receiver, kChangeOfStateTrigger,
+                                       writes, 50000, 2000, 1000000);
+    printf("  change of state, %-12s %3d\n", kWritesNames[writes],
+           result[writes].frames);
+  }
+  const ProductionResult cyclic = MeasureProduction(receiver, kCyclicTrigger,
+                                                    kWritesMapped, 50000, 2000,
+                                                    1000000);
+  printf("  cyclic, %-22s %3d\n", kWritesNames[kWritesMapped], cyclic.frames);
+
+  /* 20 heartbeats; mapped changes produce at most once per PIT, the RPI/4
+   * default of 12.5 ms */
+  HOST_TEST_CHECK(result[kWritesNone].frames >= 15 &&
+                  result[kWritesNone].frames <= 30);
+  HOST_TEST_CHECK(result[kWritesMapped].frames > 50 &&
+                  result[kWritesMapped].frames <= 110);
+  HOST_TEST_CHECK(result[kWritesUnmapped].frames <= 30);
+  HOST_TEST_CHECK(result[kWritesSameValue].frames <= 30);
+  HOST_TEST_CHECK(cyclic.frames >= 15 && cyclic.frames <= 30);
+
+  const ProductionResult change_of_state =
+    MeasureProduction(receiver, kChangeOfStateTrigger, kWritesMapped, 500000,
+                      200000, 2000000);
+  const ProductionResult slow_cyclic =
+    MeasureProduction(receiver, kCyclicTrigger, kWritesMapped, 500000, 200000,
+                      2000000);
+  printf("RPI 500 ms, a write every 200 ms, latency to the first frame with "
+         "the value:\n  change of state %ld us, cyclic %ld us\n",
+         change_of_state.average_latency, slow_cyclic.average_latency);
+  /* the cyclic connection waits for the next RPI, 250 ms on average; a
+   * change is produced at once unless the PIT of 125 ms is still running */
+  HOST_TEST_CHECK(change_of_state.average_latency > 0 &&
+                  change_of_state.average_latency < 50000);
+}
+
+int main(void) {
+  TestProductionInhibitTime();
+  HostTestInitializeStack();
+  if(kEipStatusOk != NetworkHandlerInitialize() ) {
+    printf("NetworkHandlerInitialize() failed\n");
+    return EXIT_FAILURE;
+  }
+  pthread_t handler;
+  pthread_create(&handler, NULL, RunNetworkHandler, NULL);
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  pthread_t io_task;
+  pthread_create(&io_task, NULL, RunIoTask, NULL);
+#endif
+
+  const int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in address = { .sin_family = AF_INET,
+                                 .sin_port = htons(kReceiverPort),
+                                 .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+  g_client = socket(AF_INET, SOCK_STREAM, 0);
+  if(0 != bind(receiver, (struct sockaddr *)&address, sizeof(address) ) ) {
+    perror("bind");
+    return EXIT_FAILURE;
+  }
+  address.sin_port = htons(kOpenerEthernetPort);
+  if(0 != connect(g_client, (struct sockaddr *)&address, sizeof(address) ) ) {
+    perror("connect");
+    return EXIT_FAILURE;
+  }
+  EipUint8 packet[64];
+  EipUint8 reply[64];
+  Exchange(packet, HostTestEncodeRegisterSession(packet), reply);
+  memcpy(&g_session, reply + 4, sizeof(g_session) );
+
+  TestChangeOfState(receiver);
+
+  close(g_client);
+  close(receiver);
+  g_stop_handler = true;
+  pthread_join(handler, NULL);
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  IoHandlerWakeUp();
+  pthread_join(io_task, NULL);
+#endif
+  NetworkHandlerFinish();
+  return HostTestResult();
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* Indexes of the active connections by consumed connection ID and by
+ * connection triad: random adds, removes and state changes, checked after
+ * every step against a linear walk over the active connections. The keys
+ * are drawn from narrow ranges, so probe sequences collide, triads repeat
+ * and clusters wrap around the end of the tables. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hosttest.h"
+
+#include "cipconnectionmanager.h"
+#include "opener_user_conf.h"
+
+/* not in a header, the connection manager calls it on a Forward Open */
+CipConnectionObject *CheckForExistingConnection(
+  const CipConnectionObject *const connection_object);
+
+/* same as in cipconnectionmanager.c */
+#define kIndexSize (2 * (OPENER_CIP_NUM_EXPLICIT_CONNS + \
+                         OPENER_CIP_NUM_INPUT_ONLY_CONNS + \
+                         OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS + \
+                         OPENER_CIP_NUM_LISTEN_ONLY_CONNS) )
+/* the connection list has a node for each connection that can be active */
+#define kMaxActive (kIndexSize / 2)
+#define kCandidateIds 24
+#define kSteps 200000
+
+static CipConnectionObject g_connections[kMaxActive];
+static bool g_is_active[kMaxActive];
+static CipUdint g_candidate_ids[kCandidateIds];
+static CipUdint g_random = 0x2545F491U;
+
+static CipUdint Random(void) {
+  g_random ^= g_random << 13;
+  g_random ^= g_random >> 17;
+  g_random ^= g_random << 5;
+  return g_random;
+}
+
+/* mirrors ConnectionIndexHash(), used to pick keys at the end of the table */
+static size_t Hash(CipUdint key) {
+  key ^= key >> 16;
+  key *= 0x45D9F3BU;
+  key ^= key >> 16;
+  return key % kIndexSize;
+}
+
+/* most candidate IDs hash to the last two or the first slot, so their
+ * clusters wrap around; the rest land anywhere */
+static void PickCandidateIds(void) {
+  int picked = 0;
+  for(CipUdint id = 1; picked < kCandidateIds * 3 / 4; id++) {
+    const size_t slot = Hash(id);
+    if(slot >= kIndexSize - 2 || 0 == slot) {
+      g_candidate_ids[picked++] = id;
+    }
+  }
+  while(picked < kCandidateIds) {
+    g_candidate_ids[picked++] = Random();
+  }
+}
+
+static bool IsIdInUse(const CipUdint connection_id) {
+  for(int i = 0; i < kMaxActive; i++) {
+    if(g_is_active[i] &&
+       connection_id == g_connections[i].cip_consumed_connection_id) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* narrow ranges: triads repeat among the active connections */
+static void SetRandomTriad(CipConnectionObject *const connection) {
+  connection->connection_serial_number = (CipUint)(Random() % 6);
+  connection->originator_vendor_id = (CipUint)(Random() % 2);
+  connection->originator_serial_number = Random() % 2;
+}
+
+static void Add(const int i) {
+  CipConnectionObject *const connection = &g_connections[i];
+  ConnectionObjectInitializeEmpty(connection);
+  CipUdint connection_id;
+  do {
+    connection_id = g_candidate_ids[Random() % kCandidateIds];
+  } while(IsIdInUse(connection_id) );
+  connection->cip_consumed_connection_id = connection_id;
+  SetRandomTriad(connection);
+  AddNewActiveConnection(connection);
+  g_is_active[i] = true;
+}
+
+static void Remove(const int i) {
+  RemoveFromActiveConnections(&g_connections[i]);
+  g_is_active[i] = false;
+}
+
+static bool IsEstablished(const int i) {
+  return g_is_active[i] && kConnectionObjectStateEstablished ==
+         ConnectionObjectGetState(&g_connections[i]);
+}
+
+/* GetConnectedObject() has to find the established connection with the ID,
+ * if there is one */
+static bool CheckConnectionId(const CipUdint connection_id) {
+  const CipConnectionObject *expected = NULL;
+  for(int i = 0; i < kMaxActive; i++) {
+    if(IsEstablished(i) &&
+       connection_id == g_connections[i].cip_consumed_connection_id) {
+      expected = &g_connections[i];
+    }
+  }
+  return expected == GetConnectedObject(connection_id);
+}
+
+/* CheckForExistingConnection() has to find an established connection with
+ * the triad, if there is one; which one of several does not matter */
+static bool CheckTriad(const CipConnectionObject *const probe) {
+  const CipConnectionObject *found = CheckForExistingConnection(probe);
+  bool exists = false;
+  for(int i = 0; i < kMaxActive; i++) {
+    if(IsEstablished(i) &&
+       EqualConnectionTriad(probe, &g_connections[i]) ) {
+      exists = true;
+      if(found == &g_connections[i]) {
+        return true;
+      }
+    }
+  }
+  return !exists && NULL == found;
+}
+
+static void TestChurn(void) {
+  long lookups = 0;
+  int most_active = 0;
+  int failures = 0;
+  for(long step = 0; step < kSteps && failures < 10; step++) {
+    const int i = (int)(Random() % kMaxActive);
+    const CipUdint operation = Random() % 8;
+    if(!g_is_active[i]) {
+      Add(i);
+    } else if(operation < 3) {
+      Remove(i);
+    } else if(operation < 4) {
+      /* timed out connections stay indexed, but are not found */
+      ConnectionObjectSetState(&g_connections[i],
+                               IsEstablished(i) ?
+                               kConnectionObjectStateTimedOut :
+                               kConnectionObjectStateEstablished);
+    }
+
+    int active = 0;
+    for(int k = 0; k < kMaxActive; k++) {
+      active += g_is_active[k];
+    }
+    if(active > most_active) {
+      most_active = active;
+    }
+
+    for(int k = 0; k < kCandidateIds; k++) {
+      if(!CheckConnectionId(g_candidate_ids[k]) ) {
+        printf("step %ld: connection ID 0x%08" PRIX32 "\n", step,
+               g_candidate_ids[k]);
+        failures++;
+      }
+    }
+    CipConnectionObject probe;
+    SetRandomTriad(&probe);
+    if(!CheckTriad(&probe) ) {
+      printf("step %ld: triad %u/%u/%" PRIu32 "\n", step,
+             probe.connection_serial_number, probe.originator_vendor_id,
+             probe.originator_serial_number);
+      failures++;
+    }
+    lookups += kCandidateIds + 1;
+  }
+  printf("%ld lookups, up to %d of %d slots used\n", lookups, most_active,
+         kIndexSize);
+  HOST_TEST_CHECK(0 == failures);
+  HOST_TEST_CHECK(kMaxActive == most_active);
+
+  for(int i = 0; i < kMaxActive; i++) {
+    if(g_is_active[i]) {
+      Remove(i);
+    }
+  }
+  for(int k = 0; k < kCandidateIds; k++) {
+    HOST_TEST_CHECK(NULL == GetConnectedObject(g_candidate_ids[k]) );
+  }
+}
+
+int main(void) {
+  HostTestInitializeStack();
+  PickCandidateIds();
+  TestChurn();
+  return HostTestResult();
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Connection timers on the microsecond clock: a randomized check of the timer
+ * wheel against a plain array, and the production jitter of one connection
+ * driven by the network handler at RPIs below the application tick. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hosttest.h"
+
+#include "cipconnectionmanager.h"
+#include "cipconnectionobject.h"
+#include "generic_networkhandler.h"
+#include "timerwheel.h"
+
+#define kWheelEntries 200
+#define kMaxSends 20000
+
+static TimerWheel g_wheel;
+static TimerWheelEntry g_entries[kWheelEntries];
+static MicroSeconds g_reference[kWheelEntries]; /* deadline, 0 if idle */
+static long g_early_expiries = 0;
+
+static void ReferenceExpiry(TimerWheelEntry *const entry) {
+  const size_t index = (size_t)(entry - g_entries);
+  if(0 == g_reference[index] ||
+     g_reference[index] > TimerWheelGetTime(&g_wheel) ) {
+    g_early_expiries++;
+  }
+  g_reference[index] = 0;
+}
+
+static MicroSeconds ReferenceNextDeadline(const MicroSeconds latest_time) {
+  MicroSeconds next = latest_time;
+  for(size_t i = 0; i < kWheelEntries; i++) {
+    if(0 != g_reference[i] && g_reference[i] < next) {
+      next = g_reference[i];
+    }
+  }
+  return next;
+}
+
+static void TestTimerWheel(void) {
+  long late_expiries = 0;
+  long wrong_next_deadlines = 0;
+  srand(1);
+  TimerWheelInitialize(&g_wheel);
+  for(size_t i = 0; i < kWheelEntries; i++) {
+    g_entries[i].expiry_function = ReferenceExpiry;
+  }
+  for(long step = 0; step < 200000; step++) {
+    const size_t index = (size_t)rand() % kWheelEntries;
+    const MicroSeconds now = TimerWheelGetTime(&g_wheel);
+    switch(rand() % 4) {
+      case 0:
+        TimerWheelCancel(&g_entries[index]);
+        g_reference[index] = 0;
+        break;
+      case 1: {
+        /* up to 2 revolutions ahead */
+        const MicroSeconds deadline = now + 1 + (MicroSeconds)rand() % 600000;
+        TimerWheelSchedule(&g_wheel, &g_entries[index], deadline);
+        g_reference[index] = deadline;
+        break;
+      }
+      default: {
+        const MicroSeconds latest_time = now + 1 + (MicroSeconds)rand() % 300000;
+        if(ReferenceNextDeadline(latest_time) !=
+           TimerWheelGetNextDeadline(&g_wheel, latest_time) ) {
+          wrong_next_deadlines++;
+        }
+        /* short steps mostly, sometimes a stall */
+        const MicroSeconds elapsed = 0 == rand() % 8 ?
+                                     (MicroSeconds)rand() % 700000 :
+                                     (MicroSeconds)rand() % 3000;
+        TimerWheelAdvance(&g_wheel, now + elapsed);
+        for(size_t i = 0; i < kWheelEntries; i++) {
+          if(0 != g_reference[i] &&
+             g_reference[i] <= TimerWheelGetTime(&g_wheel) ) {
+            late_expiries++;
+            g_reference[i] = 0;
+          }
+        }
+        break;
+      }
+    }
+  }
+  printf("timer wheel: %ld early, %ld late expiries, %ld wrong next deadlines\n",
+         g_early_expiries, late_expiries, wrong_next_deadlines);
+  HOST_TEST_CHECK(0 == g_early_expiries);
+  HOST_TEST_CHECK(0 == late_expiries);
+  HOST_TEST_CHECK(0 == wrong_next_deadlines);
+}
+
+static MicroSeconds g_send_times[kMaxSends];
+static int g_sends = 0;
+
+static EipStatus RecordSend(CipConnectionObject *connection_object) {
+  (void)connection_object;
+  if(g_sends < kMaxSends) {
+    g_send_times[g_sends++] = GetMicroSeconds();
+  }
+  return kEipStatusOk;
+}
+
+static void IgnoreTimeout(CipConnectionObject *connection_object) {
+  (void)connection_object;
+}
+
+static int CompareLong(const void *first, const void *second) {
+  const long a = *(const long *)first;
+  const long b = *(const long *)second;
+  return (a > b) - (a < b);
+}
+
+/* sends of one cyclic connection over the given time; the network handler
+ * has to wake up for each RPI, not only at the application tick */
+static void MeasureJitter(const CipUdint rpi, const MicroSeconds duration) {
+  static CipConnectionObject connection;
+  static long deviations[kMaxSends];
+
+  ConnectionObjectInitializeEmpty(&connection);
+  connection.o_to_t_requested_packet_interval = rpi;
+  connection.t_to_o_requested_packet_interval = rpi;
+  connection.transport_class_trigger = 0x01; /* client, cyclic, class 1 */
+  ConnectionObjectSetExpectedPacketRate(&connection);
+  ConnectionObjectGeneralConfiguration(&connection);
+  connection.connection_timeout_function = IgnoreTimeout;
+  connection.connection_send_data_function = RecordSend;
+  connection.socket[kUdpCommuncationDirectionProducing] = 1000; /* not used */
+  g_sends = 0;
+  AddNewActiveConnection(&connection);
+
+  const MicroSeconds end = GetMicroSeconds() + duration;
+  while(GetMicroSeconds() < end) {
+    NetworkHandlerProcessCyclic();
+  }
+  RemoveFromActiveConnections(&connection);
+
+  const int intervals = g_sends - 1;
+  for(int i = 0; i < intervals; i++) {
+    deviations[i] = labs( (long)(g_send_times[i + 1] - g_send_times[i]) -
+                          (long)rpi );
+  }
+  qsort(deviations, intervals, sizeof(deviations[0]), CompareLong);
+  const double expected = (double)duration / rpi;
+  const long median = intervals > 0 ? deviations[intervals / 2] : 0;
+  printf("  RPI %5u us: %5d sends (expected %.0f), p50 %5ld us, p99 %5ld us\n",
+         (unsigned)rpi, g_sends, expected, median,
+         intervals > 0 ? deviations[intervals * 99 / 100] : 0);
+  /* production used to follow the 10 ms tick: half the sends at 0.5 ms,
+   * twice the sends at 2 ms, and a median deviation of one RPI. The margin
+   * leaves room for scheduling delays of the host. */
+  HOST_TEST_CHECK(g_sends > 0.75 * expected && g_sends < 1.25 * expected);
+  HOST_TEST_CHECK(median < (long)rpi / 2);
+}
+
+int main(void) {
+  HostTestInitializeStack();
+  TestTimerWheel();
+
+  if(kEipStatusOk != NetworkHandlerInitialize() ) {
+    printf("NetworkHandlerInitialize() failed\n");
+    return EXIT_FAILURE;
+  }
+  for(int i = 0; i < 3; i++) {
+    NetworkHandlerProcessCyclic();
+  }
+  printf("|interval - RPI| of a cyclic production:\n");
+  MeasureJitter(500, 1000000);
+  MeasureJitter(1000, 1000000);
+  MeasureJitter(2000, 1000000);
+  MeasureJitter(10000, 1000000);
+  NetworkHandlerFinish();
+  return HostTestResult();
+}
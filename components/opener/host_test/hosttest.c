@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hosttest.h"
+
+#include "cipconnectionobject.h"
+#include "cipmessagerouter.h"
+#include "cpf.h"
+#include "doublylinkedlist.h"
+#include "encap.h"
+#include "generic_networkhandler.h"
+#include "socket_timer.h"
+
+static int g_failed_checks = 0;
+
+void HostTestCheck(const bool condition,
+                   const char *const text,
+                   const char *const file,
+                   const int line) {
+  if(!condition) {
+    g_failed_checks++;
+    printf("%s:%d: check failed: %s\n", file, line, text);
+  }
+}
+
+int HostTestResult(void) {
+  if(0 != g_failed_checks) {
+    printf("%d checks failed\n", g_failed_checks);
+    return EXIT_FAILURE;
+  }
+  printf("all checks passed\n");
+  return EXIT_SUCCESS;
+}
+
+void HostTestInitializeStack(void) {
+  DoublyLinkedListInitialize(&connection_list,
+                             CipConnectionObjectListArrayAllocator,
+                             CipConnectionObjectListArrayFree);
+  /* also calls ApplicationInitialization() */
+  if(kEipStatusOk != CipStackInit(1) ) {
+    printf("CipStackInit() failed\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+double HostTestNanoSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static size_t EncodeLogicalSegment(EipUint8 *const buffer,
+                                   const EipUint8 segment,
+                                   const EipUint16 value) {
+  if(value <= UINT8_MAX) {
+    buffer[0] = segment;
+    buffer[1] = (EipUint8)value;
+    return 2;
+  }
+  buffer[0] = segment | 0x01; /* 16 bit format, padded */
+  buffer[1] = 0;
+  buffer[2] = (EipUint8)value;
+  buffer[3] = (EipUint8)(value >> 8);
+  return 4;
+}
+
+size_t HostTestEncodeRequest(EipUint8 *const buffer,
+                             const CipUsint service,
+                             const CipUint class_id,
+                             const CipInstanceNum instance,
+                             const int attribute,
+                             const EipUint8 *const data,
+                             const size_t data_length) {
+  size_t length = 2;
+  buffer[0] = service;
+  length += EncodeLogicalSegment(buffer + length, 0x20, class_id);
+  length += EncodeLogicalSegment(buffer + length, 0x24, instance);
+  if(attribute >= 0) {
+    length += EncodeLogicalSegment(buffer + length, 0x30, (EipUint16)attribute);
+  }
+  buffer[1] = (EipUint8)( (length - 2) / 2); /* path size in words */
+  if(0 != data_length) {
+    memcpy(buffer + length, data, data_length);
+  }
+  return length + data_length;
+}
+
+EipStatus HostTestSendRequest(const EipUint8 *const request,
+                              const size_t request_length,
+                              CipMessageRouterResponse *const response) {
+  /* the router parses in place, keep the caller's request intact */
+  EipUint8 buffer[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  memcpy(buffer, request, request_length);
+  memset(response, 0, sizeof(*response) );
+  return NotifyMessageRouter(buffer, (int)request_length, response, NULL, 0);
+}
+
+double HostTestMeasureRequest(const EipUint8 *const request,
+                              const size_t request_length,
+                              const long repetitions,
+                              const int runs) {
+  CipMessageRouterResponse response;
+  double best = 0;
+  for(int run = 0; run < runs; run++) {
+    const double start = HostTestNanoSeconds();
+    for(long i = 0; i < repetitions; i++) {
+      (void)HostTestSendRequest(request, request_length, &response);
+    }
+    const double per_request = (HostTestNanoSeconds() - start) / repetitions;
+    if(0 == run || per_request < best) {
+      best = per_request;
+    }
+  }
+  return best;
+}
+
+void HostTestInitializeEncapsulation(void) {
+  EncapsulationInit();
+  SocketTimerArrayInitialize(g_timestamps, OPENER_NUMBER_OF_SUPPORTED_SESSIONS);
+}
+
+static EipUint8 *PutUint16(EipUint8 *const buffer,
+                           const EipUint16 value) {
+  buffer[0] = (EipUint8)value;
+  buffer[1] = (EipUint8)(value >> 8);
+  return buffer + 2;
+}
+
+static EipUint8 *PutUint32(EipUint8 *const buffer,
+                           const EipUint32 value) {
+  return PutUint16(PutUint16(buffer, (EipUint16)value),
+                   (EipUint16)(value >> 16) );
+}
+
+/* encapsulation header with zero status, sender context and options */
+static EipUint8 *EncodeEncapsulationHeader(EipUint8 *const buffer,
+                                           const EipUint16 command,
+                                           const size_t data_length,
+                                           const CipSessionHandle session) {
+  memset(buffer, 0, ENCAPSULATION_HEADER_LENGTH);
+  PutUint32(PutUint16(PutUint16(buffer, command), (EipUint16)data_length),
+            session);
+  return buffer + ENCAPSULATION_HEADER_LENGTH;
+}
+
+size_t HostTestEncodeRegisterSession(EipUint8 *const buffer) {
+  EipUint8 *data = EncodeEncapsulationHeader(buffer, 0x0065, 4, 0);
+  PutUint16(PutUint16(data, 1), 0); /* protocol version, options */
+  return ENCAPSULATION_HEADER_LENGTH + 4;
+}
+
+size_t HostTestEncodeSendRRData(EipUint8 *const buffer,
+                                const CipSessionHandle session,
+                                const EipUint8 *const request,
+                                const size_t request_length) {
+  const size_t data_length = 16 + request_length;
+  EipUint8 *cursor = EncodeEncapsulationHeader(buffer, 0x006F, data_length,
+                                               session);
+  cursor = PutUint32(cursor, 0); /* interface handle */
+  cursor = PutUint16(cursor, 0); /* timeout */
+  cursor = PutUint16(cursor, 2); /* item count */
+  cursor = PutUint16(PutUint16(cursor, kCipItemIdNullAddress), 0);
+  cursor = PutUint16(cursor, kCipItemIdUnconnectedDataItem);
+  cursor = PutUint16(cursor, (EipUint16)request_length);
+  memcpy(cursor, request, request_length);
+  return ENCAPSULATION_HEADER_LENGTH + data_length;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef OPENER_HOSTTEST_H_
+#define OPENER_HOSTTEST_H_
+
+/** @file hosttest.h
+ *  @brief Helpers shared by the host tests
+ *
+ *  Each test is a program of its own. Failed checks are printed and counted,
+ *  HostTestResult() turns them into the exit status ctest looks at.
+ *  Measurements are printed to stdout.
+ */
+
+#include <stddef.h>
+
+#include "opener_api.h"
+#include "ciptypes.h"
+
+#define HOST_TEST_CHECK(condition) \
+  HostTestCheck( (condition), #condition, __FILE__, __LINE__)
+
+/** @brief Counts and prints a failed check */
+void HostTestCheck(const bool condition,
+                   const char *const text,
+                   const char *const file,
+                   const int line);
+
+/** @brief Prints the number of failed checks
+ *
+ *  @return EXIT_SUCCESS if all checks passed, EXIT_FAILURE otherwise
+ */
+int HostTestResult(void);
+
+/** @brief Initializes the connection list and the stack, including the
+ *  application (the DX200 simulator)
+ */
+void HostTestInitializeStack(void);
+
+/** @brief Monotonic time in nanoseconds */
+double HostTestNanoSeconds(void);
+
+/** @brief Encodes an explicit request with logical class, instance and
+ *  attribute segments
+ *
+ *  @param buffer receives the request
+ *  @param service service code
+ *  @param class_id class
+ *  @param instance instance
+ *  @param attribute attribute, or -1 for a request without attribute segment
+ *  @param data request data following the path
+ *  @param data_length length of @p data
+ *  @return length of the request
+ */
+size_t HostTestEncodeRequest(EipUint8 *const buffer,
+                             const CipUsint service,
+                             const CipUint class_id,
+                             const CipInstanceNum instance,
+                             const int attribute,
+                             const EipUint8 *const data,
+                             const size_t data_length);
+
+/** @brief Sends a request to the message router
+ *
+ *  @param request the encoded request, see HostTestEncodeRequest()
+ *  @param request_length length of @p request
+ *  @param response receives the reply
+ *  @return the status of NotifyMessageRouter()
+ */
+EipStatus HostTestSendRequest(const EipUint8 *const request,
+                              const size_t request_length,
+                              CipMessageRouterResponse *const response);
+
+/** @brief Measures the message router time of a request
+ *
+ *  @return nanoseconds per request, best of @p runs runs of @p repetitions
+ */
+double HostTestMeasureRequest(const EipUint8 *const request,
+                              const size_t request_length,
+                              const long repetitions,
+                              const int runs);
+
+/** @brief Initializes the encapsulation layer and its session timers without
+ *  opening sockets, see NetworkHandlerInitialize()
+ */
+void HostTestInitializeEncapsulation(void);
+
+/** @brief Encodes a RegisterSession command
+ *
+ *  @param buffer receives the command
+ *  @return length of the command
+ */
+size_t HostTestEncodeRegisterSession(EipUint8 *const buffer);
+
+/** @brief Encodes a SendRRData command carrying an explicit request
+ *
+ *  @param buffer receives the command
+ *  @param session session handle from the RegisterSession reply
+ *  @param request the request, see HostTestEncodeRequest()
+ *  @param request_length length of @p request
+ *  @return length of the command
+ */
+size_t HostTestEncodeSendRRData(EipUint8 *const buffer,
+                                const CipSessionHandle session,
+                                const EipUint8 *const request,
+                                const size_t request_length);
+
+#endif /* OPENER_HOSTTEST_H_ */
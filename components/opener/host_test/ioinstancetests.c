@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Instance lookup: Get/Set_Attribute_Single on the IO class of the simulator,
+ * the instance index of a class with real instances, and the lookup cost over
+ * the instance number. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hosttest.h"
+
+#define kIoClass 0x78
+#define kIoInstances 8220
+#define kIndexTestClass 0x3E0
+#define kIndexTestInstances 2000
+#define kSparseInstance 60000
+
+static void TestIoClassRequests(void) {
+  static const CipInstanceNum existing[] = { 1, 100, 1000, 5300, kIoInstances };
+  EipUint8 request[32];
+  CipMessageRouterResponse response;
+
+  for(size_t i = 0; i < sizeof(existing) / sizeof(existing[0]); i++) {
+    size_t length = HostTestEncodeRequest(request, kGetAttributeSingle,
+                                          kIoClass, existing[i], 1, NULL, 0);
+    HostTestSendRequest(request, length, &response);
+    HOST_TEST_CHECK(kCipErrorSuccess == response.general_status);
+    HOST_TEST_CHECK(1 == response.message.used_message_length);
+  }
+
+  size_t length = HostTestEncodeRequest(request, kGetAttributeSingle, kIoClass,
+                                        kIoInstances + 1, 1, NULL, 0);
+  HostTestSendRequest(request, length, &response);
+  HOST_TEST_CHECK(kCipErrorPathDestinationUnknown == response.general_status);
+
+  const EipUint8 value = 7;
+  length = HostTestEncodeRequest(request, kSetAttributeSingle, kIoClass,
+                                 kIoInstances, 1, &value, sizeof(value) );
+  HostTestSendRequest(request, length, &response);
+  HOST_TEST_CHECK(kCipErrorSuccess == response.general_status);
+  length = HostTestEncodeRequest(request, kGetAttributeSingle, kIoClass,
+                                 kIoInstances, 1, NULL, 0);
+  HostTestSendRequest(request, length, &response);
+  HOST_TEST_CHECK(1 == response.message.used_message_length &&
+                  value == response.message.message_buffer[0]);
+}
+
+static bool AllInstancesFound(const CipClass *const cip_class) {
+  for(CipInstanceNum number = 1; number <= kIndexTestInstances; number++) {
+    const CipInstance *instance = GetCipInstance(cip_class, number);
+    if(NULL == instance || number != instance->instance_number) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void TestInstanceIndex(void) {
+  CipClass *cip_class = CreateCipClass(kIndexTestClass, 0, 7, 2, 0, 0, 0,
+                                       kIndexTestInstances, "HostTestClass",
+                                       1, NULL);
+  HOST_TEST_CHECK(NULL != cip_class);
+  if(NULL == cip_class) {
+    return;
+  }
+  HOST_TEST_CHECK(AllInstancesFound(cip_class) );
+  HOST_TEST_CHECK(NULL == GetCipInstance(cip_class, kIndexTestInstances + 1) );
+
+  /* too sparse for the index, found by the list walk */
+  CipInstance *sparse = AddCipInstance(cip_class, kSparseInstance);
+  HOST_TEST_CHECK(NULL != sparse);
+  HOST_TEST_CHECK(sparse == GetCipInstance(cip_class, kSparseInstance) );
+  HOST_TEST_CHECK(NULL == GetCipInstance(cip_class, kSparseInstance - 1) );
+  HOST_TEST_CHECK(AllInstancesFound(cip_class) );
+
+  /* adding an existing instance number returns that instance */
+  HOST_TEST_CHECK(GetCipInstance(cip_class, 17) ==
+                  AddCipInstance(cip_class, 17) );
+}
+
+static void MeasureIoClassLookup(void) {
+  static const CipInstanceNum instances[] = { 1, 100, 1000, 5300, kIoInstances };
+  double cost[sizeof(instances) / sizeof(instances[0])];
+  EipUint8 request[32];
+
+  printf("Get_Attribute_Single on the IO class, ns/request:\n");
+  for(size_t i = 0; i < sizeof(instances) / sizeof(instances[0]); i++) {
+    size_t length = HostTestEncodeRequest(request, kGetAttributeSingle,
+                                          kIoClass, instances[i], 1, NULL, 0);
+    cost[i] = HostTestMeasureRequest(request, length, 20000, 5);
+    printf("  instance %5u: %7.1f\n", (unsigned)instances[i], cost[i]);
+  }
+  /* a list walk costs about 90 times more at the last instance */
+  HOST_TEST_CHECK(cost[4] < 4 * cost[0]);
+}
+
+int main(void) {
+  HostTestInitializeStack();
+  TestIoClassRequests();
+  TestInstanceIndex();
+  MeasureIoClassLookup();
+  return HostTestResult();
+}
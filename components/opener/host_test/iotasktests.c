@@ -0,0 +1,433 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* Implicit messaging in a task of its own: a producer stopped while the
+ * production queue is full, and the production of a class 1 connection while
+ * an explicit messaging flood keeps the network handler busy. The I/O task
+ * runs in a thread of its own, with SCHED_FIFO if the host allows it.
+ * Configured with -DCMAKE_C_FLAGS=-DOPENER_IO_TASK=0 the same measurement
+ * shows the production from the network handler loop, without checks. */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+
+#include "cipassembly.h"
+#include "cipconnectionmanager.h"
+#include "cipconnectionobject.h"
+#include "cipioconnection.h"
+#include "encap.h"
+#include "generic_networkhandler.h"
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+#include "generic_iohandler.h"
+#endif
+
+/* not in a header, the connection manager calls them on a Forward Open */
+void SetIoConnectionCallbacks(CipConnectionObject *const io_connection_object);
+void PrepareProducedFrame(CipConnectionObject *const connection_object);
+
+#define kInputAssembly 190 /* created by the test, not by the application */
+#define kReceiverPort 23456
+#define kMaxFrames 40000
+#define kSequenceNumberOffset 10 /* item count, address item, connection id */
+
+static EipByte g_input_data[32];
+static atomic_bool g_stop;
+static int g_frames;
+static MicroSeconds g_frame_times[kMaxFrames];
+static CipUdint g_sequence_numbers[kMaxFrames];
+static int g_watchdog_timeouts;
+static atomic_long g_flood_replies;
+
+static int OpenLoopbackSocket(const int type, const int port) {
+  const int socket_handle = socket(AF_INET, type, 0);
+  struct sockaddr_in address = { .sin_family = AF_INET,
+                                 .sin_port = htons(port),
+                                 .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+  struct timeval timeout = { 0, 100000 };
+  setsockopt(socket_handle, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+             sizeof(timeout) );
+  setsockopt(socket_handle, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+             sizeof(timeout) );
+  if(SOCK_DGRAM == type) {
+    if(0 != bind(socket_handle, (struct sockaddr *)&address,
+                 sizeof(address) ) ) {
+      perror("bind");
+      exit(EXIT_FAILURE);
+    }
+  } else if(0 != connect(socket_handle, (struct sockaddr *)&address,
+                         sizeof(address) ) ) {
+    perror("connect");
+    exit(EXIT_FAILURE);
+  }
+  return socket_handle;
+}
+
+/* the originator: records the time and the sequence number of each frame */
+static void *ReceiveFrames(void *argument) {
+  const int socket_handle = *(int *)argument;
+  EipUint8 frame[600];
+  while(!g_stop) {
+    const long length = recv(socket_handle, frame, sizeof(frame), 0);
+    if(length >= kSequenceNumberOffset + 4 && g_frames < kMaxFrames) {
+      g_frame_times[g_frames] = GetMicroSeconds();
+      memcpy(&g_sequence_numbers[g_frames], frame + kSequenceNumberOffset, 4);
+      g_frames++;
+    }
+  }
+  return NULL;
+}
+
+/* the originator's O->T data, keeps the consuming watchdog alive */
+static void *FeedConsumer(void *argument) {
+  const CipUdint rpi = *(CipUdint *)argument;
+  const int socket_handle = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in address = { .sin_family = AF_INET,
+                                 .sin_port = htons(kOpenerEipIoUdpPort),
+                                 .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+  EipUint8 frame[28] = { 2, 0, 0x02, 0x80, 8, 0, 0x11, 0x11, 0, 0, 0, 0, 0, 0,
+                         0xB1, 0, 10, 0 };
+  CipUdint sequence_number = 0;
+  MicroSeconds next = GetMicroSeconds();
+  while(!g_stop) {
+    next += rpi;
+    const MicroSeconds now = GetMicroSeconds();
+    if(next > now) {
+      usleep(next - now);
+    }
+    sequence_number++;
+    memcpy(frame + kSequenceNumberOffset, &sequence_number, 4);
+    sendto(socket_handle, frame, sizeof(frame), 0,
+           (struct sockaddr *)&address, sizeof(address) );
+  }
+  close(socket_handle);
+  return NULL;
+}
+
+static void *ReadFloodReplies(void *argument) {
+  const int socket_handle = *(int *)argument;
+  static EipUint8 buffer[65536];
+  size_t have = 0;
+  while(!g_stop) {
+    const long length = recv(socket_handle, buffer + have, sizeof(buffer) - have,
+                             0);
+    if(length <= 0) {
+      continue;
+    }
+    have += length;
+    size_t offset = 0;
+    while(have - offset >= ENCAPSULATION_HEADER_LENGTH) {
+      const size_t packet_length = ENCAPSULATION_HEADER_LENGTH +
+                                   (buffer[offset + 2] |
+                                    buffer[offset + 3] << 8);
+      if(have - offset < packet_length) {
+        break;
+      }
+      g_flood_replies++;
+      offset += packet_length;
+    }
+    memmove(buffer, buffer + offset, have - offset);
+    have -= offset;
+  }
+  return NULL;
+}
+
+/* bursts of 64 Get_Attribute_All requests of robot position instance 1 */
+static void *Flood(void *argument) {
+  (void)argument;
+  int socket_handle = OpenLoopbackSocket(SOCK_STREAM, kOpenerEthernetPort);
+  EipUint8 frame[64];
+  size_t length = HostTestEncodeRegisterSession(frame);
+  send(socket_handle, frame, length, 0);
+  EipUint8 reply[28];
+  long received = 0;
+  while(received < (long)sizeof(reply) ) {
+    const long bytes = recv(socket_handle, reply + received,
+                            sizeof(reply) - received, 0);
+    if(bytes > 0) {
+      received += bytes;
+    }
+  }
+  CipSessionHandle session;
+  memcpy(&session, reply + 4, sizeof(session) );
+
+  EipUint8 request[16];
+  const size_t request_length = HostTestEncodeRequest(request,
+                                                      kGetAttributeAll, 0x75,
+                                                      1, -1, NULL, 0);
+  length = HostTestEncodeSendRRData(frame, session, request, request_length);
+  static EipUint8 burst[64 * sizeof(frame)];
+  for(int i = 0; i < 64; i++) {
+    memcpy(burst + i * length, frame, length);
+  }
+  pthread_t reader;
+  pthread_create(&reader, NULL, ReadFloodReplies, &socket_handle);
+  while(!g_stop) {
+    send(socket_handle, burst, 64 * length, 0);
+  }
+  pthread_join(reader, NULL);
+  close(socket_handle);
+  return NULL;
+}
+
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+static void *RunIoTask(void *argument) {
+  (void)argument;
+  while(!g_stop) {
+    IoHandlerProcessCyclic();
+  }
+  return NULL;
+}
+
+/* above the network handler, like the I/O task priority on the target */
+static bool StartIoTask(pthread_t *const thread) {
+  pthread_attr_t attributes;
+  struct sched_param parameter = { .sched_priority = 10 };
+  pthread_attr_init(&attributes);
+  pthread_attr_setinheritsched(&attributes, PTHREAD_EXPLICIT_SCHED);
+  pthread_attr_setschedpolicy(&attributes, SCHED_FIFO);
+  pthread_attr_setschedparam(&attributes, &parameter);
+  const bool is_real_time =
+    0 == pthread_create(thread, &attributes, RunIoTask, NULL);
+  pthread_attr_destroy(&attributes);
+  if(!is_real_time) {
+    pthread_create(thread, NULL, RunIoTask, NULL);
+  }
+  return is_real_time;
+}
+
+static int CountFrames(const int socket_handle) {
+  EipUint8 frame[600];
+  int frames = 0;
+  while(recv(socket_handle, frame, sizeof(frame), MSG_DONTWAIT) > 0) {
+    frames++;
+  }
+  return frames;
+}
+
+static void RunIoHandler(const MicroSeconds duration) {
+  const MicroSeconds end = GetMicroSeconds() + duration;
+  while(GetMicroSeconds() < end) {
+    IoHandlerProcessCyclic();
+  }
+}
+
+/* a stop has to take effect also if the queue cannot take the request */
+static void TestStopWithFullQueue(void) {
+  static int producer;
+  static int other_producer;
+  const int receiver = OpenLoopbackSocket(SOCK_DGRAM, kReceiverPort + 1);
+  const struct sockaddr_in address = {
+    .sin_family = AF_INET, .sin_port = htons(kReceiverPort + 1),
+    .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+  };
+  ENIPMessage message;
+  InitializeENIPMessage(&message);
+  message.used_message_length = 20;
+
+  IoHandlerProduce(&producer, &address, GetMicroSeconds(), 1000, true,
+                   &message);
+  RunIoHandler(20000);
+  const int running = CountFrames(receiver);
+
+  /* requests of another producer the I/O task has not taken yet */
+  int queued = 0;
+  while(kEipStatusOk == IoHandlerProduce(&other_producer, &address,
+                                         GetMicroSeconds() + 1000000, 1000000,
+                                         true, &message) ) {
+    queued++;
+  }
+  IoHandlerStopProducing(&producer);
+  RunIoHandler(20000);
+  const int stopped = CountFrames(receiver);
+
+  IoHandlerProduce(&producer, &address, GetMicroSeconds(), 1000, true,
+                   &message);
+  RunIoHandler(20000);
+  const int restarted = CountFrames(receiver);
+  IoHandlerStopProducing(&producer);
+  IoHandlerStopProducing(&other_producer);
+  RunIoHandler(20000);
+  const int all_stopped = CountFrames(receiver);
+  close(receiver);
+
+  printf("stop with %d requests queued, frames in 20 ms: running %d, "
+         "stopped %d, restarted %d, all stopped %d\n", queued, running,
+         stopped, restarted, all_stopped);
+  HOST_TEST_CHECK(queued > 0);
+  HOST_TEST_CHECK(running > 0);
+  /* the stop used to be dropped, the producer went on at 1 ms */
+  HOST_TEST_CHECK(0 == stopped);
+  HOST_TEST_CHECK(restarted > 0);
+  HOST_TEST_CHECK(all_stopped <= 1);
+}
+#endif
+
+static void CountWatchdogTimeout(CipConnectionObject *connection_object) {
+  g_watchdog_timeouts++;
+  ConnectionObjectResetInactivityWatchdogTimerValue(connection_object);
+}
+
+static void IgnoreClose(CipConnectionObject *connection_object) {
+  (void)connection_object;
+}
+
+static int CompareLong(const void *first, const void *second) {
+  const long a = *(const long *)first;
+  const long b = *(const long *)second;
+  return (a > b) - (a < b);
+}
+
+static void MeasureUnderFlood(CipUdint rpi, const MicroSeconds duration) {
+  static CipConnectionObject connection;
+  static long deviations[kMaxFrames];
+  pthread_t threads[4];
+  int number_of_threads = 0;
+  bool is_real_time = false;
+
+  g_stop = false;
+  g_frames = 0;
+  g_watchdog_timeouts = 0;
+  g_flood_replies = 0;
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  is_real_time = StartIoTask(&threads[number_of_threads++]);
+#endif
+  int receiver = OpenLoopbackSocket(SOCK_DGRAM, kReceiverPort);
+  pthread_create(&threads[number_of_threads++], NULL, ReceiveFrames,
+                 &receiver);
+
+  ConnectionObjectInitializeEmpty(&connection);
+  connection.o_to_t_requested_packet_interval = rpi;
+  connection.t_to_o_requested_packet_interval = rpi;
+  connection.transport_class_trigger = 0x81; /* server, cyclic, class 1 */
+  connection.connection_timeout_multiplier = 0; /* watchdog 4 x RPI */
+  connection.originator_address.sin_family = AF_INET;
+  connection.originator_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  connection.remote_address = connection.originator_address;
+  connection.remote_address.sin_port = htons(kReceiverPort);
+  connection.producing_instance =
+    GetCipInstance(GetCipClass(kCipAssemblyClassCode), kInputAssembly);
+  SetIoConnectionCallbacks(&connection);
+  connection.connection_timeout_function = CountWatchdogTimeout;
+  connection.connection_close_function = IgnoreClose;
+  ConnectionObjectSetExpectedPacketRate(&connection);
+  ConnectionObjectGeneralConfiguration(&connection);
+  connection.socket[kUdpCommuncationDirectionProducing] = CreateUdpSocket();
+  connection.socket[kUdpCommuncationDirectionConsuming] =
+    connection.socket[kUdpCommuncationDirectionProducing];
+  connection.cip_consumed_connection_id = 0x1111;
+  connection.cip_produced_connection_id = 0x2222;
+  PrepareProducedFrame(&connection);
+  AddNewActiveConnection(&connection);
+  pthread_create(&threads[number_of_threads++], NULL, FeedConsumer, &rpi);
+  pthread_create(&threads[number_of_threads++], NULL, Flood, NULL);
+
+  const MicroSeconds end = GetMicroSeconds() + duration;
+  while(GetMicroSeconds() < end) {
+    NetworkHandlerProcessCyclic();
+  }
+  CloseCommunicationChannelsAndRemoveFromActiveConnectionsList(&connection);
+  const int frames_at_close = g_frames;
+  const MicroSeconds close_end = GetMicroSeconds() + 50000;
+  while(GetMicroSeconds() < close_end) {
+    NetworkHandlerProcessCyclic();
+  }
+  const int frames_after_close = g_frames - frames_at_close;
+
+  g_stop = true;
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  IoHandlerWakeUp();
+#endif
+  for(int i = 0; i < number_of_threads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  close(receiver);
+  /* let the network handler release the flood connection */
+  for(int i = 0; i < 10; i++) {
+    NetworkHandlerProcessCyclic();
+  }
+
+  const int intervals = frames_at_close - 1;
+  int sequence_gaps = 0;
+  for(int i = 0; i < intervals; i++) {
+    deviations[i] = labs( (long)(g_frame_times[i + 1] - g_frame_times[i]) -
+                          (long)rpi );
+    if(g_sequence_numbers[i + 1] != g_sequence_numbers[i] + 1) {
+      sequence_gaps++;
+    }
+  }
+  qsort(deviations, intervals, sizeof(deviations[0]), CompareLong);
+  const double expected = (double)duration / rpi;
+  printf("  RPI %4u us: %5d frames (expected %.0f), p50 %5ld us, "
+         "p99 %5ld us, %d sequence gaps, %d watchdog timeouts, "
+         "%ld flood replies, %d frames after close\n",
+         (unsigned)rpi, frames_at_close, expected,
+         intervals > 0 ? deviations[intervals / 2] : 0,
+         intervals > 0 ? deviations[intervals * 99 / 100] : 0,
+         sequence_gaps, g_watchdog_timeouts, (long)g_flood_replies,
+         frames_after_close);
+
+  HOST_TEST_CHECK(g_flood_replies > 0);
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  HOST_TEST_CHECK(0 == sequence_gaps);
+  HOST_TEST_CHECK(0 == frames_after_close);
+  /* from the network handler loop, about half the frames at 2 ms and a
+   * tenth at 0.5 ms came through. A busy host still delays the task now and
+   * then, late productions are skipped. Without SCHED_FIFO the host
+   * scheduler decides, the count is not checked then. */
+  if(is_real_time) {
+    HOST_TEST_CHECK(frames_at_close > 0.75 * expected &&
+                    frames_at_close < 1.25 * expected);
+  }
+#else
+  (void)is_real_time;
+#endif
+}
+
+int main(void) {
+  HostTestInitializeStack();
+  CreateAssemblyObject(kInputAssembly, g_input_data, sizeof(g_input_data) );
+  if(kEipStatusOk != NetworkHandlerInitialize() ) {
+    printf("NetworkHandlerInitialize() failed\n");
+    return EXIT_FAILURE;
+  }
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  TestStopWithFullQueue();
+  printf("Production from the I/O task under an explicit messaging flood:\n");
+#else
+  printf("Production from the network handler under an explicit messaging "
+         "flood:\n");
+#endif
+  MeasureUnderFlood(2000, 2000000);
+  MeasureUnderFlood(500, 2000000);
+  NetworkHandlerFinish();
+  return HostTestResult();
+}
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* INFORM job playback: compiling valid and invalid jobs, the line and step
+ * sequence of the player driving the motion engine, and the job file size
+ * limit of the simulator, each file loaded by a stack started in a child
+ * process. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+
+#include "motoman_job.h"
+#include "motoman_motion.h"
+
+#define kJobFile "jobtests.JBI" /* CONFIG_MOTOMAN_JOB_FILE of the library */
+#define kMaxJobFileSize (512 * 1024) /* as in motoman_dx200_simulator.c */
+#define kJobInfoClass 0x73
+#define kVariables 100
+#define kStepPeriod 4000 /* us */
+#define kInstructionsPerStep 8
+#define kMaxLineLength 255 /* characters, as in motoman_job.c */
+
+static const char kJob[] =
+  "/JOB\n"
+  "//NAME JOBTEST\n"
+  "//POS\n"
+  "///NPOS 2,0,0,0,0,0\n"
+  "///POSTYPE PULSE\n"
+  "///PULSE\n"
+  "C00000=0,0,0,0,0,0\n"
+  "C00001=4000,-2000,0,0,0,0\n"
+  "//INST\n"
+  "///DATE 2026/10/17 12:00\n"
+  "NOP\n"                     /* line 0 */
+  "*TOP\n"                    /* line 1 */
+  "MOVJ C00001 VJ=100.00\n"   /* line 2, step 1 */
+  "SET B000 1\n"              /* line 3 */
+  "TIMER T=0.20\n"            /* line 4 */
+  "INC I000\n"                /* line 5 */
+  "MOVJ C00000 VJ=50.00\n"    /* line 6, step 2 */
+  "ADD D000 1000\n"           /* line 7 */
+  "SUB R000 0.5\n"            /* line 8 */
+  "JUMP *TOP\n"               /* line 9 */
+  "END\n";                    /* line 10 */
+
+static EipUint8 g_b[kVariables];
+static EipInt16 g_i[kVariables];
+static EipInt32 g_d[kVariables];
+static float g_r[kVariables];
+static const MotomanJobVariables g_variables = {
+  .b = g_b, .i = g_i, .d = g_d, .r = g_r, .count = kVariables
+};
+
+static bool Compile(MotomanJob *const job, const char *const text) {
+  return MotomanJobCompile(job, text, strlen(text), kVariables);
+}
+
+/* the instruction lines of kJob replaced by the given ones */
+static bool CompileInstructions(const char *const instructions) {
+  static char text[sizeof(kJob) + 256];
+  snprintf(text, sizeof(text), "%.*s%s",
+           (int)(strstr(kJob, "NOP\n") - kJob), kJob, instructions);
+  MotomanJob job;
+  const bool compiled = Compile(&job, text);
+  HOST_TEST_CHECK(compiled || (NULL == job.instructions &&
+                               0 == job.instruction_count) );
+  MotomanJobFree(&job);
+  return compiled;
+}
+
+static void TestCompile(void) {
+  MotomanJob job;
+  HOST_TEST_CHECK(Compile(&job, kJob) );
+  HOST_TEST_CHECK(0 == strcmp("JOBTEST", job.name) );
+  HOST_TEST_CHECK(11 == job.instruction_count && 2 == job.position_count);
+  HOST_TEST_CHECK(4000 == job.positions[1][0] && -2000 == job.positions[1][1]);
+  const MotomanJobInstruction *instructions = job.instructions;
+  HOST_TEST_CHECK(kMotomanJobOpMoveJoint == instructions[2].opcode &&
+                  1 == instructions[2].index && 1 == instructions[2].argument &&
+                  10000 == instructions[2].value.integer);
+  HOST_TEST_CHECK(2 == instructions[6].argument &&
+                  5000 == instructions[6].value.integer);
+  HOST_TEST_CHECK(kMotomanJobOpTimer == instructions[4].opcode &&
+                  20 == instructions[4].value.integer);
+  /* INC is an ADD of 1 */
+  HOST_TEST_CHECK(kMotomanJobOpAdd == instructions[5].opcode &&
+                  kMotomanJobVariableI == instructions[5].destination &&
+                  kMotomanJobConstant == instructions[5].source &&
+                  1 == instructions[5].value.integer);
+  /* the jump goes to the label line */
+  HOST_TEST_CHECK(kMotomanJobOpJump == instructions[9].opcode &&
+                  1 == instructions[9].index);
+  HOST_TEST_CHECK(kMotomanJobOpEnd == instructions[10].opcode);
+  MotomanJobFree(&job);
+
+  /* an END is added, unsupported instructions keep their line as NOP */
+  HOST_TEST_CHECK(CompileInstructions("MOVL C00001 V=100.0\n"
+                                      "MOVJ C00000 VJ=10\n"
+                                      "SET D099 -2147483648\n") );
+  HOST_TEST_CHECK(Compile(&job, "//NAME X\n//INST\nNOP\n") );
+  HOST_TEST_CHECK(2 == job.instruction_count &&
+                  kMotomanJobOpEnd == job.instructions[1].opcode);
+  MotomanJobFree(&job);
+}
+
+static void TestCompileErrors(void) {
+  /* labels */
+  HOST_TEST_CHECK(!CompileInstructions("*TOP\nJUMP *NOWHERE\n") );
+  HOST_TEST_CHECK(!CompileInstructions("*TOP\nNOP\n*TOP\nJUMP *TOP\n") );
+  HOST_TEST_CHECK(!CompileInstructions("*TOP\n*TOP\n") );
+  HOST_TEST_CHECK(CompileInstructions("*TOP\n*NEXT\nJUMP *NEXT\n") );
+  HOST_TEST_CHECK(!CompileInstructions("JUMP *TOP\n") );
+  HOST_TEST_CHECK(!CompileInstructions("*TOOLONGLABEL\nJUMP *TOOLONGLABEL\n") );
+  /* positions, speeds and times */
+  HOST_TEST_CHECK(!CompileInstructions("MOVJ C00002 VJ=50.00\n") );
+  HOST_TEST_CHECK(!CompileInstructions("MOVJ C00001 VJ=0\n") );
+  HOST_TEST_CHECK(!CompileInstructions("MOVJ C00001 VJ=100.01\n") );
+  HOST_TEST_CHECK(!CompileInstructions("MOVJ C00001\n") );
+  /* C00000 is below the highest position, but not defined */
+  MotomanJob job;
+  HOST_TEST_CHECK(Compile(&job,
+                          "///PULSE\nC00001=1\n//INST\nMOVJ C00001 VJ=1\n") );
+  MotomanJobFree(&job);
+  HOST_TEST_CHECK(!Compile(&job,
+                           "///PULSE\nC00001=1\n//INST\nMOVJ C00000 VJ=1\n") );
+  HOST_TEST_CHECK(!CompileInstructions("TIMER T=0\n") );
+  /* variables and constants */
+  HOST_TEST_CHECK(!CompileInstructions("SET B100 1\n") );
+  HOST_TEST_CHECK(!CompileInstructions("SET B000 256\n") );
+  HOST_TEST_CHECK(!CompileInstructions("SET I000 32768\n") );
+  HOST_TEST_CHECK(!CompileInstructions("ADD D000 1.5\n") );
+  HOST_TEST_CHECK(!CompileInstructions("INC X000\n") );
+  HOST_TEST_CHECK(!CompileInstructions("END END\n") );
+
+  /* the file itself */
+  HOST_TEST_CHECK(!Compile(&job, "//NAME X\nNOP\n") ); /* no //INST */
+  HOST_TEST_CHECK(!Compile(&job, "///POSTYPE ROBOT\n//INST\nNOP\n") );
+  HOST_TEST_CHECK(!Compile(&job, "///PULSE\nC00000=1,x\n//INST\nNOP\n") );
+  HOST_TEST_CHECK(!Compile(&job, "///PULSE\nC01000=0\n//INST\nNOP\n") );
+
+  /* a comment of the longest line length, then one character more */
+  char comment[kMaxLineLength + 3];
+  memset(comment, 'x', sizeof(comment) );
+  comment[0] = '\'';
+  comment[kMaxLineLength] = '\n';
+  comment[kMaxLineLength + 1] = '\0';
+  HOST_TEST_CHECK(CompileInstructions(comment) );
+  comment[kMaxLineLength] = 'x';
+  comment[kMaxLineLength + 1] = '\n';
+  comment[kMaxLineLength + 2] = '\0';
+  HOST_TEST_CHECK(!CompileInstructions(comment) );
+}
+
+/* line and step of the job at each change, and the motion step it
+ * happened at */
+typedef struct {
+  EipUint16 line;
+  EipUint16 step;
+  long motion_step;
+} JobEvent;
+
+/* plays the job like the simulator: while the robot does not move, the job
+ * runs with a budget of instructions per motion step */
+static int PlayJob(MotomanJob *const job,
+                   MotomanMotion *const motion,
+                   JobEvent *const events,
+                   const int max_events) {
+  int count = 0;
+  for(long motion_step = 0; count < max_events && motion_step < 100000;
+      motion_step++) {
+    if(!MotomanMotionIsMoving(motion) ) {
+      unsigned int budget = kInstructionsPerStep;
+      MotomanJobMove move;
+      while(MotomanJobRun(job, &g_variables, kStepPeriod, &budget, &move) ) {
+        if(MotomanMotionMoveTo(motion, move.target, move.speed_ratio) ) {
+          break;
+        }
+      }
+      if(0 == count || job->line != events[count - 1].line ||
+         job->step != events[count - 1].step) {
+        events[count++] = (JobEvent){ job->line, job->step, motion_step };
+      }
+    }
+    MotomanMotionStep(motion);
+  }
+  return count;
+}
+
+static void TestPlayback(void) {
+  MotomanJob job;
+  HOST_TEST_CHECK(Compile(&job, kJob) );
+  MotomanMotion motion = {
+    .step_period = kStepPeriod, .acceleration_steps = 50, .axis_count = 6
+  };
+  for(int axis = 0; axis < 6; axis++) {
+    motion.axes[axis].max_speed = 100000;
+  }
+  const EipInt32 home[MOTOMAN_MOTION_MAX_AXES] = { 0 };
+  MotomanMotionInit(&motion, home);
+
+  /* two cycles and the start of the third */
+  JobEvent events[7];
+  HOST_TEST_CHECK(7 == PlayJob(&job, &motion, events, 7) );
+  static const EipUint16 expected[7][2] = {
+    { 2, 1 }, { 4, 1 }, { 6, 2 }, { 2, 1 }, { 4, 1 }, { 6, 2 }, { 2, 1 }
+  };
+  bool is_expected = true;
+  for(int k = 0; k < 7; k++) {
+    is_expected &= expected[k][0] == events[k].line &&
+                   expected[k][1] == events[k].step;
+  }
+  HOST_TEST_CHECK(is_expected);
+  /* the move to C00001 */
+  HOST_TEST_CHECK(46 == events[1].motion_step - events[0].motion_step);
+  /* T=0.20 is 50 steps of 4 ms, including the step of the TIMER */
+  HOST_TEST_CHECK(50 == events[2].motion_step - events[1].motion_step);
+  HOST_TEST_CHECK(events[4].motion_step - events[3].motion_step ==
+                  events[1].motion_step - events[0].motion_step);
+  HOST_TEST_CHECK(MotomanMotionIsMoving(&motion) );
+
+  /* the variables were updated once per cycle */
+  HOST_TEST_CHECK(1 == g_b[0] && 2 == g_i[0] && 2000 == g_d[0] &&
+                  -1.0f == g_r[0]);
+  MotomanJobFree(&job);
+
+  /* a loop without moves runs for its budget only */
+  HOST_TEST_CHECK(Compile(&job, "//INST\n*LOOP\nINC D001\nJUMP *LOOP\n") );
+  unsigned int budget = kInstructionsPerStep;
+  MotomanJobMove move;
+  HOST_TEST_CHECK(!MotomanJobRun(&job, &g_variables, kStepPeriod, &budget,
+                                 &move) );
+  HOST_TEST_CHECK(0 == budget && 3 == g_d[1]);
+  MotomanJobFree(&job);
+}
+
+/* runs in a child process: the job name of the Job Info object after the
+ * stack and the simulator started */
+static int CheckJobName(const char *const expected) {
+  HostTestInitializeStack();
+  EipUint8 request[16];
+  CipMessageRouterResponse response;
+  HostTestSendRequest(request,
+                      HostTestEncodeRequest(request, kGetAttributeSingle,
+                                            kJobInfoClass, 1, 1, NULL, 0),
+                      &response);
+  HOST_TEST_CHECK(32 == response.message.used_message_length);
+  HOST_TEST_CHECK(0 == strcmp(expected,
+                              (const char *)response.message.message_buffer) );
+  return HostTestResult();
+}
+
+/* writes the job file, padded with empty lines to size bytes, or removes it
+ * if size is 0, and checks the job name in a new stack */
+static void TestJobFile(const size_t size, const char *const expected) {
+  remove(kJobFile);
+  if(0 != size) {
+    FILE *file = fopen(kJobFile, "wb");
+    HOST_TEST_CHECK(NULL != file);
+    if(NULL == file) {
+      return;
+    }
+    fputs(kJob, file);
+    for(size_t length = strlen(kJob); length < size; length++) {
+      fputc('\n', file);
+    }
+    fclose(file);
+  }
+  fflush(stdout);
+  const pid_t child = fork();
+  if(0 == child) {
+    exit(CheckJobName(expected) );
+  }
+  int status = -1;
+  HOST_TEST_CHECK(child > 0 && child == waitpid(child, &status, 0) );
+  printf("job file of %zu bytes: %s\n", size, expected);
+  HOST_TEST_CHECK(WIFEXITED(status) && EXIT_SUCCESS == WEXITSTATUS(status) );
+}
+
+int main(void) {
+  TestCompile();
+  TestCompileErrors();
+  TestPlayback();
+
+  TestJobFile(0, "WELD001.JBI");
+  TestJobFile(sizeof(kJob) - 1, "JOBTEST.JBI");
+  TestJobFile(kMaxJobFileSize, "JOBTEST.JBI");
+  TestJobFile(kMaxJobFileSize + 1, "WELD001.JBI");
+  remove(kJobFile);
+  return HostTestResult();
+}
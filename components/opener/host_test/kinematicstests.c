@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* Forward kinematics of the base position instances: the single precision
+ * chain against a double precision 4x4 product for every model, the cost of
+ * one call, and instances 101 and 1 of the position class over the message
+ * router. */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hosttest.h"
+
+#include "motoman_kinematics.h"
+
+#define kPositionClass 0x75
+#define kBasePositionInstance 101
+#define kRandomPoses 200000
+#define kAngleUnitsPerDegree 10000.0
+
+/* the catalogue dimensions and pulse resolutions of motoman_kinematics.c:
+ * base height, L offset, lower arm, U offset, upper arm, flange */
+static const double kDimensions[kMotomanRobotModelCount][6] = {
+  { 330, 40, 445, 40, 440, 80 }, { 330, 40, 345, 40, 340, 80 },
+  { 450, 155, 614, 200, 640, 100 }, { 505, 150, 760, 200, 795, 100 }
+};
+static const double kPulsesPerDegree[kMotomanRobotModelCount][6] = {
+  { 1435, 1435, 1435, 730, 730, 435 }, { 1435, 1435, 1435, 730, 730, 435 },
+  { 1150, 1150, 1150, 620, 620, 360 }, { 1000, 1000, 1000, 560, 560, 330 }
+};
+
+static double Radians(const double degrees) {
+  return degrees * M_PI / 180.0;
+}
+
+/* plain product of the Denavit-Hartenberg transforms */
+static void ReferenceForward(const MotomanRobotModel model,
+                             const EipInt32 *const pulses,
+                             double *const cartesian) {
+  static const double kAlpha[6] = { -90, 0, -90, 90, -90, 0 };
+  static const double kThetaOffset[6] = { 0, -90, 0, 0, 0, 0 };
+  static const double kDirection[6] = { 1, 1, -1, -1, -1, -1 };
+  const double *dimensions = kDimensions[model];
+  const double a[6] = { dimensions[1], dimensions[2], dimensions[3], 0, 0, 0 };
+  const double d[6] = { dimensions[0], 0, 0, dimensions[4], 0, dimensions[5] };
+  double transform[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 },
+                             { 0, 0, 0, 1 } };
+
+  for(int axis = 0; axis < 6; axis++) {
+    const double theta = Radians(kDirection[axis] * pulses[axis] /
+                                 kPulsesPerDegree[model][axis] +
+                                 kThetaOffset[axis]);
+    const double c = cos(theta);
+    const double s = sin(theta);
+    const double ca = round(cos(Radians(kAlpha[axis]) ) );
+    const double sa = round(sin(Radians(kAlpha[axis]) ) );
+    const double link[4][4] = { { c, -s * ca, s * sa, a[axis] * c },
+                                { s, c * ca, -c * sa, a[axis] * s },
+                                { 0, sa, ca, d[axis] }, { 0, 0, 0, 1 } };
+    double product[4][4];
+    for(int row = 0; row < 4; row++) {
+      for(int column = 0; column < 4; column++) {
+        product[row][column] = 0;
+        for(int k = 0; k < 4; k++) {
+          product[row][column] += transform[row][k] * link[k][column];
+        }
+      }
+    }
+    memcpy(transform, product, sizeof(transform) );
+  }
+  for(int i = 0; i < 3; i++) {
+    cartesian[i] = transform[i][3] * 1000.0; /* um */
+  }
+  const double cos_ry = hypot(transform[0][0], transform[1][0]);
+  cartesian[4] = atan2(-transform[2][0], cos_ry);
+  if(cos_ry > 1e-5) {
+    cartesian[3] = atan2(transform[2][1], transform[2][2]);
+    cartesian[5] = atan2(transform[1][0], transform[0][0]);
+  } else {
+    cartesian[3] = 0;
+    cartesian[5] = atan2(-transform[0][1], transform[1][1]);
+  }
+  for(int i = 3; i < 6; i++) {
+    cartesian[i] *= 180.0 / M_PI * kAngleUnitsPerDegree;
+  }
+}
+
+static double AngleDifference(const double first, const double second) {
+  const double turn = 360.0 * kAngleUnitsPerDegree;
+  double difference = fmod(first - second, turn);
+  if(difference > turn / 2) {
+    difference -= turn;
+  } else if(difference < -turn / 2) {
+    difference += turn;
+  }
+  return fabs(difference);
+}
+
+static void TestAgainstReference(void) {
+  MotomanKinematics kinematics;
+  printf("Largest difference to the double precision reference, %d poses:\n",
+         kRandomPoses);
+  for(int model = 0; model < kMotomanRobotModelCount; model++) {
+    HOST_TEST_CHECK(MotomanKinematicsInit(&kinematics, model) );
+    double position_error = 0;
+    double angle_error = 0;
+    srand(model + 1);
+    for(int pose = 0; pose < kRandomPoses; pose++) {
+      EipInt32 pulses[MOTOMAN_KINEMATICS_AXES];
+      EipInt32 cartesian[MOTOMAN_KINEMATICS_AXES];
+      double reference[MOTOMAN_KINEMATICS_AXES];
+      for(int axis = 0; axis < MOTOMAN_KINEMATICS_AXES; axis++) {
+        pulses[axis] = rand() % 720001 - 360000;
+      }
+      MotomanKinematicsForward(&kinematics, pulses, cartesian);
+      ReferenceForward(model, pulses, reference);
+      for(int i = 0; i < 3; i++) {
+        position_error = fmax(position_error, fabs(cartesian[i] - reference[i]) );
+      }
+      /* Rx and Rz are not independent near Ry = +-90 degrees */
+      if(fabs(fabs(reference[4]) - 90 * kAngleUnitsPerDegree) >=
+         kAngleUnitsPerDegree) {
+        for(int i = 3; i < 6; i++) {
+          angle_error = fmax(angle_error,
+                             AngleDifference(cartesian[i], reference[i]) );
+        }
+      }
+    }
+    printf("  %-4s %.2f um, %.4f degree\n",
+           MotomanKinematicsGetModelName(model), position_error,
+           angle_error / kAngleUnitsPerDegree);
+    HOST_TEST_CHECK(position_error < 2.0);
+    HOST_TEST_CHECK(angle_error < 50);
+  }
+  HOST_TEST_CHECK(!MotomanKinematicsInit(&kinematics, kMotomanRobotModelCount) );
+  HOST_TEST_CHECK(NULL == MotomanKinematicsGetModelName(kMotomanRobotModelCount) );
+}
+
+static void MeasureForward(void) {
+  static EipInt32 poses[1024][MOTOMAN_KINEMATICS_AXES];
+  const long calls = 2000000;
+  MotomanKinematics kinematics;
+  EipInt32 cartesian[MOTOMAN_KINEMATICS_AXES];
+  volatile EipInt32 sink = 0;
+
+  MotomanKinematicsInit(&kinematics, kMotomanRobotModelGp7);
+  for(int pose = 0; pose < 1024; pose++) {
+    for(int axis = 0; axis < MOTOMAN_KINEMATICS_AXES; axis++) {
+      poses[pose][axis] = rand() % 200000 - 100000;
+    }
+  }
+  const double start = HostTestNanoSeconds();
+  for(long i = 0; i < calls; i++) {
+    MotomanKinematicsForward(&kinematics, poses[i & 1023], cartesian);
+    sink += cartesian[0] ^ cartesian[5];
+  }
+  printf("Forward kinematics: %.1f ns per call\n",
+         (HostTestNanoSeconds() - start) / calls);
+}
+
+static EipInt32 GetPositionAttribute(const CipInstanceNum instance,
+                                     const int attribute) {
+  EipUint8 request[16];
+  CipMessageRouterResponse response;
+  HostTestSendRequest(request,
+                      HostTestEncodeRequest(request, kGetAttributeSingle,
+                                            kPositionClass, instance,
+                                            attribute, NULL, 0),
+                      &response);
+  HOST_TEST_CHECK(kCipErrorSuccess == response.general_status &&
+                  4 == response.message.used_message_length);
+  const EipUint8 *data = response.message.message_buffer;
+  return (EipInt32)( (EipUint32)data[0] | (EipUint32)data[1] << 8 |
+                     (EipUint32)data[2] << 16 | (EipUint32)data[3] << 24);
+}
+
+/* instance 101 reports the kinematics of the pulses in instance 1, a clean
+ * read costs no more than a read of the pulses */
+static void TestBasePositionInstance(void) {
+  EipInt32 pulses[MOTOMAN_KINEMATICS_AXES];
+  EipInt32 expected[MOTOMAN_KINEMATICS_AXES];
+  MotomanKinematics kinematics;
+
+  /* attribute 2 is the first axis */
+  for(int axis = 0; axis < MOTOMAN_KINEMATICS_AXES; axis++) {
+    pulses[axis] = GetPositionAttribute(1, axis + 2);
+  }
+  MotomanKinematicsInit(&kinematics, kMotomanRobotModelGp7);
+  MotomanKinematicsForward(&kinematics, pulses, expected);
+  bool is_equal = true;
+  for(int axis = 0; axis < MOTOMAN_KINEMATICS_AXES; axis++) {
+    is_equal = is_equal &&
+               expected[axis] ==
+               GetPositionAttribute(kBasePositionInstance, axis + 2);
+  }
+  printf("Instance %d: X %d Y %d Z %d um, Rx %d Ry %d Rz %d x 0.0001 degree\n",
+         kBasePositionInstance, (int)expected[0], (int)expected[1],
+         (int)expected[2], (int)expected[3], (int)expected[4],
+         (int)expected[5]);
+  HOST_TEST_CHECK(is_equal);
+
+  EipUint8 request[16];
+  const size_t pulse_length = HostTestEncodeRequest(request,
+                                                    kGetAttributeSingle,
+                                                    kPositionClass, 1, 2,
+                                                    NULL, 0);
+  const double pulse_cost = HostTestMeasureRequest(request, pulse_length,
+                                                   100000, 5);
+  const size_t base_length = HostTestEncodeRequest(request,
+                                                   kGetAttributeSingle,
+                                                   kPositionClass,
+                                                   kBasePositionInstance, 2,
+                                                   NULL, 0);
+  const double base_cost = HostTestMeasureRequest(request, base_length,
+                                                  100000, 5);
+  printf("Get_Attribute_Single, ns/request: instance 1 %.1f, instance %d "
+         "%.1f\n", pulse_cost, kBasePositionInstance, base_cost);
+  /* the kinematics on every read would add about twice the request cost */
+  HOST_TEST_CHECK(base_cost < 1.5 * pulse_cost);
+}
+
+int main(void) {
+  HostTestInitializeStack();
+  TestAgainstReference();
+  MeasureForward();
+  TestBasePositionInstance();
+  return HostTestResult();
+}
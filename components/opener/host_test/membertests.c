@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* Member ID segments: single members and member ranges of array attributes,
+ * members outside the array, members of attributes that are no array, and
+ * the 16 bit segment format. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hosttest.h"
+
+#define kAxisConfigClass 0x74
+#define kPositionClass 0x75
+#define kAxes 8
+
+static EipUint8 g_request[32];
+static CipMessageRouterResponse g_response;
+
+/* Get_Attribute_Single of a member, or of the range first to last if last is
+ * not 0 */
+static CipUsint GetMembers(const CipUint class_id,
+                           const int attribute,
+                           const EipUint16 first,
+                           const EipUint16 last) {
+  size_t length = HostTestEncodeRequest(g_request, kGetAttributeSingle,
+                                        class_id, 1, attribute, NULL, 0);
+  const EipUint16 members[] = { first, last };
+  for(size_t i = 0; i < (0 == last ? 1U : 2U); i++) {
+    if(members[i] <= UINT8_MAX) {
+      g_request[length++] = 0x28;
+      g_request[length++] = (EipUint8)members[i];
+    } else {
+      g_request[length++] = 0x29; /* 16 bit, padded */
+      g_request[length++] = 0;
+      g_request[length++] = (EipUint8)members[i];
+      g_request[length++] = (EipUint8)(members[i] >> 8);
+    }
+  }
+  g_request[1] = (EipUint8)( (length - 2) / 2);
+  HostTestSendRequest(g_request, length, &g_response);
+  return g_response.general_status;
+}
+
+static EipInt32 GetPositionAttribute(const int attribute) {
+  HostTestSendRequest(g_request,
+                      HostTestEncodeRequest(g_request, kGetAttributeSingle,
+                                            kPositionClass, 1, attribute, NULL,
+                                            0),
+                      &g_response);
+  HOST_TEST_CHECK(4 == g_response.message.used_message_length);
+  EipInt32 value;
+  memcpy(&value, g_response.message.message_buffer, sizeof(value) );
+  return value;
+}
+
+static void TestValidMembers(void) {
+  /* members 1 to 8 of attribute 2 are the axis data of attributes 2 to 9 */
+  EipInt32 axes[kAxes];
+  for(int axis = 0; axis < kAxes; axis++) {
+    axes[axis] = GetPositionAttribute(2 + axis);
+  }
+  HOST_TEST_CHECK(1250 == axes[0] && -15230 == axes[1]);
+
+  HOST_TEST_CHECK(kCipErrorSuccess == GetMembers(kPositionClass, 2, 1, 8) );
+  HOST_TEST_CHECK(sizeof(axes) == g_response.message.used_message_length &&
+                  0 == memcmp(axes, g_response.message.message_buffer,
+                              sizeof(axes) ) );
+
+  HOST_TEST_CHECK(kCipErrorSuccess == GetMembers(kPositionClass, 2, 3, 0) );
+  HOST_TEST_CHECK(4 == g_response.message.used_message_length &&
+                  0 == memcmp(&axes[2], g_response.message.message_buffer,
+                              4) );
+
+  HOST_TEST_CHECK(kCipErrorSuccess == GetMembers(kPositionClass, 2, 2, 4) );
+  HOST_TEST_CHECK(12 == g_response.message.used_message_length &&
+                  0 == memcmp(&axes[1], g_response.message.message_buffer,
+                              12) );
+
+  /* a range of one member */
+  HOST_TEST_CHECK(kCipErrorSuccess == GetMembers(kPositionClass, 2, 8, 8) );
+  HOST_TEST_CHECK(4 == g_response.message.used_message_length &&
+                  0 == memcmp(&axes[7], g_response.message.message_buffer,
+                              4) );
+
+  /* BYTE members, one per axis */
+  HOST_TEST_CHECK(kCipErrorSuccess == GetMembers(kAxisConfigClass, 2, 1, 8) );
+  HOST_TEST_CHECK(kAxes == g_response.message.used_message_length);
+
+  /* the whole attribute is unchanged */
+  HOST_TEST_CHECK(1250 == GetPositionAttribute(2) );
+}
+
+static void TestInvalidMembers(void) {
+  /* outside the array */
+  HOST_TEST_CHECK(kCipErrorInvalidMemberId ==
+                  GetMembers(kPositionClass, 2, 9, 0) );
+  HOST_TEST_CHECK(0 == g_response.message.used_message_length);
+  HOST_TEST_CHECK(kCipErrorInvalidMemberId ==
+                  GetMembers(kPositionClass, 2, 7, 9) );
+  HOST_TEST_CHECK(kCipErrorInvalidMemberId ==
+                  GetMembers(kPositionClass, 2, 0, 0) );
+  HOST_TEST_CHECK(kCipErrorInvalidMemberId ==
+                  GetMembers(kPositionClass, 2, 0x100, 0) );
+  HOST_TEST_CHECK(kCipErrorInvalidMemberId ==
+                  GetMembers(kAxisConfigClass, 2, 9, 0) );
+
+  /* attributes that are no array */
+  HOST_TEST_CHECK(kCipErrorInvalidMemberId ==
+                  GetMembers(kPositionClass, 3, 1, 0) );
+  HOST_TEST_CHECK(kCipErrorInvalidMemberId ==
+                  GetMembers(kPositionClass, 1, 1, 0) );
+  HOST_TEST_CHECK(kCipErrorInvalidMemberId ==
+                  GetMembers(kAxisConfigClass, 1, 1, 0) );
+
+  /* a range ending before it starts is no valid path */
+  HOST_TEST_CHECK(kCipErrorSuccess != GetMembers(kPositionClass, 2, 5, 3) );
+  HOST_TEST_CHECK(0 == g_response.message.used_message_length);
+}
+
+int main(void) {
+  HostTestInitializeStack();
+  TestValidMembers();
+  TestInvalidMembers();
+  return HostTestResult();
+}
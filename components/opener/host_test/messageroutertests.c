@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Class and service lookup tables of the message router: agreement with the
+ * registered classes and service arrays, services outside the index, class
+ * codes above 0xFF, and the lookup cost per class. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hosttest.h"
+
+#include "cipcommon.h"
+
+#define kRoutingTestClass 0x3E1
+
+static int g_test_service_calls = 0;
+
+static EipStatus TestService(CipInstance *instance,
+                             CipMessageRouterRequest *message_router_request,
+                             CipMessageRouterResponse *message_router_response,
+                             const struct sockaddr *originator_address,
+                             const CipSessionHandle encapsulation_session) {
+  (void)instance;
+  (void)originator_address;
+  (void)encapsulation_session;
+  g_test_service_calls++;
+  message_router_response->reply_service =
+    (0x80 | message_router_request->service);
+  message_router_response->general_status = kCipErrorSuccess;
+  message_router_response->size_of_additional_status = 0;
+  return kEipStatusOkSend;
+}
+
+static const CipServiceStruct *FindServiceInArray(const CipClass *cip_class,
+                                                  const CipUsint number) {
+  for(EipUint16 i = 0; i < cip_class->number_of_services; i++) {
+    if(NULL != cip_class->services[i].service_function &&
+       number == cip_class->services[i].service_number) {
+      return &cip_class->services[i];
+    }
+  }
+  return NULL;
+}
+
+/* the index must agree with the service array for every service number */
+static bool ServiceIndexMatches(const CipClass *const cip_class) {
+  const CipInstance probe = { .cip_class = (CipClass *)cip_class };
+  for(unsigned number = 0; number <= UINT8_MAX; number++) {
+    const CipServiceStruct *expected = number < CIP_SERVICE_INDEX_SIZE ?
+                                       FindServiceInArray(cip_class, number) :
+                                       NULL;
+    if(expected != GetCipService(&probe, (CipUsint)number) ) {
+      printf("%s: service 0x%02X\n", cip_class->class_name, number);
+      return false;
+    }
+  }
+  return true;
+}
+
+static void TestRegisteredClasses(void) {
+  int classes = 0;
+  for(CipUdint class_code = 0; class_code <= UINT8_MAX; class_code++) {
+    const CipClass *cip_class = GetCipClass(class_code);
+    if(NULL == cip_class) {
+      continue;
+    }
+    classes++;
+    HOST_TEST_CHECK(class_code == cip_class->class_code);
+    HOST_TEST_CHECK(ServiceIndexMatches(cip_class) );
+    HOST_TEST_CHECK(ServiceIndexMatches(cip_class->class_instance.cip_class) );
+  }
+  printf("%d classes checked\n", classes);
+  HOST_TEST_CHECK(classes > 20);
+}
+
+static void TestInsertService(void) {
+  CipClass *cip_class = CreateCipClass(kRoutingTestClass, 0, 7, 2, 0, 0, 2, 1,
+                                       "HostTestRouting", 1, NULL);
+  HOST_TEST_CHECK(NULL != cip_class);
+  if(NULL == cip_class) {
+    return;
+  }
+  HOST_TEST_CHECK(cip_class == GetCipClass(kRoutingTestClass) );
+
+  InsertService(cip_class, 0x4B, &TestService, "TestService");
+  /* outside the index: ignored, the slot stays free */
+  InsertService(cip_class, 0x80, &TestService, "OutsideIndex");
+  InsertService(cip_class, 0xFF, &TestService, "OutsideIndex");
+  InsertService(cip_class, 0x4C, &TestService, "TestService");
+  HOST_TEST_CHECK(ServiceIndexMatches(cip_class) );
+  HOST_TEST_CHECK(0x4C == cip_class->services[1].service_number);
+
+  /* routed through the class list, the class code is above 0xFF */
+  EipUint8 request[16];
+  CipMessageRouterResponse response;
+  HostTestSendRequest(request,
+                      HostTestEncodeRequest(request, 0x4C, kRoutingTestClass, 1,
+                                            -1, NULL, 0),
+                      &response);
+  HOST_TEST_CHECK(1 == g_test_service_calls);
+  HOST_TEST_CHECK(kCipErrorSuccess == response.general_status);
+  HostTestSendRequest(request,
+                      HostTestEncodeRequest(request, 0x4D, kRoutingTestClass, 1,
+                                            -1, NULL, 0),
+                      &response);
+  HOST_TEST_CHECK(kCipErrorServiceNotSupported == response.general_status);
+}
+
+/* best of 5 runs, ns per lookup; the instance lookup is left out if
+ * with_instance is false */
+static double MeasureCase(const CipUdint class_code,
+                          const CipUsint service,
+                          const bool with_instance) {
+  const long repetitions = 1000000;
+  double best = 0;
+  for(int run = 0; run < 5; run++) {
+    volatile const void *sink = NULL;
+    const double start = HostTestNanoSeconds();
+    for(long i = 0; i < repetitions; i++) {
+      CipClass *cip_class = GetCipClass(class_code);
+      const CipInstance probe = { .cip_class = cip_class };
+      const CipInstance *instance = with_instance ?
+                                    GetCipInstance(cip_class, 1) : &probe;
+      sink = GetCipService(instance, service);
+    }
+    const double cost = (HostTestNanoSeconds() - start) / repetitions;
+    HOST_TEST_CHECK(NULL != sink);
+    if(0 == run || cost < best) {
+      best = cost;
+    }
+  }
+  return best;
+}
+
+static void MeasureLookup(void) {
+  static const struct {
+    const char *name;
+    CipUdint class_code;
+    CipUsint service;
+  } cases[] = {
+    { "Identity (0x01) GAS", 0x01, kGetAttributeSingle },
+    { "Register (0x79) GAS", 0x79, kGetAttributeSingle },
+    { "Variable S (0x8C) SAS", 0x8C, kSetAttributeSingle },
+    { "Variable EX (0x81) 0x4C", 0x81, 0x4C },
+  };
+  double fastest = 0;
+  double slowest = 0;
+
+  printf("Lookup cost, best of 5 x 1M, ns:\n  %-24s %22s %15s\n", "",
+         "class+instance+service", "class+service");
+  for(size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+    const double full = MeasureCase(cases[k].class_code, cases[k].service,
+                                    true);
+    const double routing = MeasureCase(cases[k].class_code, cases[k].service,
+                                       false);
+    printf("  %-24s %22.1f %15.1f\n", cases[k].name, full, routing);
+    if(0 == k || routing < fastest) {
+      fastest = routing;
+    }
+    if(routing > slowest) {
+      slowest = routing;
+    }
+  }
+  /* walking the class list and the service arrays cost up to 6 times more,
+   * depending on the registration order and the service position */
+  HOST_TEST_CHECK(slowest < 3 * fastest);
+}
+
+int main(void) {
+  HostTestInitializeStack();
+  TestRegisteredClasses();
+  TestInsertService();
+  MeasureLookup();
+  return HostTestResult();
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* Fixed step motion engine of the simulated robot: trapezoidal and
+ * triangular profiles, arrival at the exact target, and the same trajectory
+ * for the same move on every run. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hosttest.h"
+
+#include "motoman_motion.h"
+
+#define kAxes 6
+#define kStepPeriod 4000 /* us */
+#define kAccelerationSteps 50
+#define kMaxSpeed 100000 /* pulses/s, 400 pulses per step */
+#define kMaxSteps (1L << 23)
+
+static EipUint32 g_random = 0x9E3779B9U;
+
+static EipUint32 Random(void) {
+  g_random ^= g_random << 13;
+  g_random ^= g_random >> 17;
+  g_random ^= g_random << 5;
+  return g_random;
+}
+
+static void InitializeMotion(MotomanMotion *const motion,
+                             const EipInt32 *const position) {
+  memset(motion, 0, sizeof(*motion) );
+  motion->step_period = kStepPeriod;
+  motion->acceleration_steps = kAccelerationSteps;
+  motion->position_gain = 30;
+  motion->axis_count = kAxes;
+  for(int axis = 0; axis < kAxes; axis++) {
+    motion->axes[axis].max_speed = kMaxSpeed;
+  }
+  MotomanMotionInit(motion, position);
+}
+
+static long Abs(const long value) {
+  return value < 0 ? -value : value;
+}
+
+/* runs the move to its end, checks that every axis moves monotonically
+ * towards the target, and returns the number of steps; the speed of axis 0
+ * per step is stored in speeds if not NULL */
+static long RunMove(MotomanMotion *const motion,
+                    const EipInt32 *const target,
+                    EipInt32 *const speeds) {
+  EipInt32 start[kAxes];
+  memcpy(start, motion->position, sizeof(start) );
+  long steps = 0;
+  bool is_monotonic = true;
+  while(MotomanMotionIsMoving(motion) && steps < kMaxSteps) {
+    MotomanMotionStep(motion);
+    if(NULL != speeds) {
+      speeds[steps] = motion->velocity[0];
+    }
+    steps++;
+    for(int axis = 0; axis < kAxes; axis++) {
+      const long direction = target[axis] >= start[axis] ? 1 : -1;
+      is_monotonic &= direction * motion->velocity[axis] >= 0;
+    }
+  }
+  HOST_TEST_CHECK(is_monotonic);
+  return steps;
+}
+
+static bool IsAtTarget(const MotomanMotion *const motion,
+                       const EipInt32 *const target) {
+  return 0 == memcmp(motion->position, target, kAxes * sizeof(EipInt32) );
+}
+
+/* long enough to reach the speed: ramp up, constant speed, ramp down */
+static void TestTrapezoidalProfile(void) {
+  static EipInt32 speeds[400];
+  const EipInt32 start[kAxes] = { 0 };
+  const EipInt32 target[kAxes] = { 100000, -50000, 25000, 0, 1, -1 };
+  MotomanMotion motion;
+  InitializeMotion(&motion, start);
+
+  HOST_TEST_CHECK(MotomanMotionMoveTo(&motion, target,
+                                      MOTOMAN_MOTION_FULL_SPEED) );
+  /* 250 steps at 400 pulses per step, plus the ramps */
+  HOST_TEST_CHECK(300 == motion.move_steps);
+  HOST_TEST_CHECK(kAccelerationSteps == motion.move_acceleration_steps);
+  HOST_TEST_CHECK(300 == RunMove(&motion, target, speeds) );
+  HOST_TEST_CHECK(IsAtTarget(&motion, target) );
+
+  bool is_ramp_up = true;
+  bool is_cruise = true;
+  bool is_ramp_down = true;
+  for(int step = 1; step < 300; step++) {
+    if(step < kAccelerationSteps) {
+      is_ramp_up &= speeds[step] >= speeds[step - 1];
+    } else if(step < 250) {
+      is_cruise &= Abs(speeds[step] - 400) <= 1;
+    } else {
+      is_ramp_down &= speeds[step] <= speeds[step - 1];
+    }
+  }
+  HOST_TEST_CHECK(is_ramp_up && is_cruise && is_ramp_down);
+  HOST_TEST_CHECK(speeds[0] <= 8 && speeds[299] <= 8);
+
+  /* at rest once velocity and acceleration have dropped to zero */
+  HOST_TEST_CHECK(!MotomanMotionIsAtRest(&motion) );
+  MotomanMotionStep(&motion);
+  MotomanMotionStep(&motion);
+  HOST_TEST_CHECK(MotomanMotionIsAtRest(&motion) );
+  HOST_TEST_CHECK(IsAtTarget(&motion, target) );
+  HOST_TEST_CHECK(!MotomanMotionMoveTo(&motion, target,
+                                       MOTOMAN_MOTION_FULL_SPEED) );
+}
+
+/* too short to reach the speed: ramp up and down with the same
+ * acceleration, no constant speed phase */
+static void TestTriangularProfile(void) {
+  static EipInt32 speeds[100];
+  const EipInt32 start[kAxes] = { 1000, 1000, 1000, 1000, 1000, 1000 };
+  const EipInt32 target[kAxes] = { -3000, 1000, 1000, 1000, 1000, 1000 };
+  MotomanMotion motion;
+  InitializeMotion(&motion, start);
+
+  HOST_TEST_CHECK(MotomanMotionMoveTo(&motion, target,
+                                      MOTOMAN_MOTION_FULL_SPEED) );
+  /* 10 steps at full speed: a * a = 10 * 50 */
+  HOST_TEST_CHECK(23 == motion.move_acceleration_steps);
+  HOST_TEST_CHECK(46 == motion.move_steps);
+  HOST_TEST_CHECK(46 == RunMove(&motion, target, speeds) );
+  HOST_TEST_CHECK(IsAtTarget(&motion, target) );
+
+  /* the peak is in the middle and stays below the full speed */
+  int peak = 0;
+  for(int step = 1; step < 46; step++) {
+    if(speeds[step] < speeds[peak]) {
+      peak = step;
+    }
+  }
+  HOST_TEST_CHECK(22 == peak || 23 == peak);
+  HOST_TEST_CHECK(speeds[peak] > -400 && speeds[peak] < -100);
+  HOST_TEST_CHECK(speeds[peak - 2] > speeds[peak] &&
+                  speeds[peak + 2] > speeds[peak]);
+}
+
+/* whatever the distance and the speed, the last step ends on the target */
+static void TestExactTarget(void) {
+  static const EipUint32 ratios[] = { 1, 37, 2500, 9999,
+                                      MOTOMAN_MOTION_FULL_SPEED };
+  MotomanMotion motion;
+  EipInt32 position[kAxes] = { 0 };
+  InitializeMotion(&motion, position);
+
+  int misses = 0;
+  for(int move = 0; move < 2000; move++) {
+    EipInt32 target[kAxes];
+    for(int axis = 0; axis < kAxes; axis++) {
+      /* mostly short moves, some up to 2^20 pulses */
+      const EipUint32 range = 0 == move % 10 ? 1U << 20 : 5000;
+      target[axis] = (EipInt32)(Random() % (2 * range + 1) ) - (EipInt32)range;
+    }
+    const EipUint32 ratio = move % 50 == 0 ?
+                            ratios[(move / 50) % 5] : 1000 + Random() % 9001;
+    MotomanMotionMoveTo(&motion, target, ratio);
+    RunMove(&motion, target, NULL);
+    if(!IsAtTarget(&motion, target) ) {
+      printf("move %d: axis 0 at %" PRId32 ", target %" PRId32 "\n", move,
+             motion.position[0], target[0]);
+      misses++;
+    }
+  }
+  HOST_TEST_CHECK(0 == misses);
+
+  /* the slowest move is sped up to the step limit */
+  const EipInt32 far[kAxes] = { 2000000000 };
+  InitializeMotion(&motion, position);
+  HOST_TEST_CHECK(MotomanMotionMoveTo(&motion, far, 1) );
+  HOST_TEST_CHECK(MOTOMAN_MOTION_MAX_MOVE_STEPS == motion.move_steps);
+  RunMove(&motion, far, NULL);
+  HOST_TEST_CHECK(IsAtTarget(&motion, far) );
+
+  /* more than INT32_MAX pulses: the first move stops that far from the
+   * start, the second one reaches the target */
+  const EipInt32 low[kAxes] = { -2000000000, 2000000000 };
+  const EipInt32 high[kAxes] = { 2000000000, -2000000000 };
+  InitializeMotion(&motion, low);
+  HOST_TEST_CHECK(MotomanMotionMoveTo(&motion, high,
+                                      MOTOMAN_MOTION_FULL_SPEED) );
+  RunMove(&motion, high, NULL);
+  HOST_TEST_CHECK(low[0] + INT32_MAX == motion.position[0] &&
+                  low[1] + INT32_MIN == motion.position[1]);
+  HOST_TEST_CHECK(MotomanMotionMoveTo(&motion, high,
+                                      MOTOMAN_MOTION_FULL_SPEED) );
+  RunMove(&motion, high, NULL);
+  HOST_TEST_CHECK(IsAtTarget(&motion, high) );
+}
+
+/* the pulses of a step only depend on the move and the step number */
+static void TestDeterminism(void) {
+  const EipInt32 start[kAxes] = { 5, -7, 11, 0, 300, -300 };
+  const EipInt32 target[kAxes] = { 77777, -12345, 11, 4000, -99999, 300 };
+  MotomanMotion first;
+  MotomanMotion second;
+  InitializeMotion(&first, start);
+  InitializeMotion(&second, start);
+  MotomanMotionMoveTo(&first, target, 7300);
+  MotomanMotionMoveTo(&second, target, 7300);
+
+  bool is_same = true;
+  while(MotomanMotionIsMoving(&first) ) {
+    MotomanMotionStep(&first);
+    MotomanMotionStep(&second);
+    is_same &= 0 == memcmp(first.position, second.position,
+                           sizeof(first.position) ) &&
+               0 == memcmp(first.velocity, second.velocity,
+                           sizeof(first.velocity) );
+  }
+  HOST_TEST_CHECK(is_same && !MotomanMotionIsMoving(&second) );
+
+  /* a move replaced halfway starts from where the robot is */
+  MotomanMotionMoveTo(&first, start, 7300);
+  for(EipUint32 step = 0; step < first.move_steps / 2; step++) {
+    MotomanMotionStep(&first);
+  }
+  const EipInt32 halfway = first.position[0];
+  MotomanMotionMoveTo(&first, target, MOTOMAN_MOTION_FULL_SPEED);
+  HOST_TEST_CHECK(halfway == first.start[0]);
+  RunMove(&first, target, NULL);
+  HOST_TEST_CHECK(IsAtTarget(&first, target) );
+}
+
+static void MeasureStep(void) {
+  const EipInt32 start[kAxes] = { 0 };
+  const EipInt32 target[kAxes] = { 4000000, -3000000, 2000000, 1000000,
+                                   -500000, 250000 };
+  MotomanMotion motion;
+  InitializeMotion(&motion, start);
+  MotomanMotionMoveTo(&motion, target, MOTOMAN_MOTION_FULL_SPEED);
+  const double begin = HostTestNanoSeconds();
+  const long steps = RunMove(&motion, target, NULL);
+  printf("%d axis step: %.1f ns (%ld steps)\n", kAxes,
+         (HostTestNanoSeconds() - begin) / steps, steps);
+}
+
+int main(void) {
+  TestTrapezoidalProfile();
+  TestTriangularProfile();
+  TestExactTarget();
+  TestDeterminism();
+  MeasureStep();
+  return HostTestResult();
+}
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Multiple Service Packet service of the message router: reply layout, status
+ * codes, the reply space check before an embedded request is executed, and
+ * the cost against single requests. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hosttest.h"
+
+#include "encap.h"
+
+#define kRegisterClass 0x79
+#define kVariableDClass 0x7C
+#define kVariableSClass 0x8C
+#define kUnknownClass 0x99
+#define kBenchRequests 50
+
+/* PC_OPENER_ETHERNET_BUFFER_SIZE minus CIP_MULTIPLE_SERVICE_REPLY_OVERHEAD */
+#define kReplyLimit (PC_OPENER_ETHERNET_BUFFER_SIZE - 50)
+
+typedef struct {
+  CipUsint service;
+  CipUint class_id;
+  CipInstanceNum instance;
+  const EipUint8 *data;
+  size_t data_length;
+} EmbeddedRequest;
+
+static size_t EncodeMultipleServicePacket(EipUint8 *const buffer,
+                                          const EmbeddedRequest *const requests,
+                                          const size_t count) {
+  EipUint8 *data = buffer + 6;
+  size_t length = 2 + 2 * count;
+  data[0] = (EipUint8)count;
+  data[1] = (EipUint8)(count >> 8);
+  for(size_t i = 0; i < count; i++) {
+    data[2 + 2 * i] = (EipUint8)length;
+    data[3 + 2 * i] = (EipUint8)(length >> 8);
+    length += HostTestEncodeRequest(data + length, requests[i].service,
+                                    requests[i].class_id, requests[i].instance,
+                                    1, requests[i].data,
+                                    requests[i].data_length);
+  }
+  /* the router instance 1 */
+  const EipUint8 path[] = { kMultipleServicePacket, 2, 0x20, 0x02, 0x24, 0x01 };
+  memcpy(buffer, path, sizeof(path) );
+  return sizeof(path) + length;
+}
+
+static size_t EncodeGets(EipUint8 *const buffer,
+                         const CipUint class_id,
+                         const size_t count) {
+  EmbeddedRequest requests[kBenchRequests];
+  for(size_t i = 0; i < count; i++) {
+    requests[i] = (EmbeddedRequest){ kGetAttributeSingle, class_id,
+                                     (CipInstanceNum)(i + 1), NULL, 0 };
+  }
+  return EncodeMultipleServicePacket(buffer, requests, count);
+}
+
+static EipUint16 GetUint16(const EipUint8 *const buffer) {
+  return (EipUint16)(buffer[0] | buffer[1] << 8);
+}
+
+/* reply header of the embedded request at position index */
+static const EipUint8 *EmbeddedReply(const CipMessageRouterResponse *response,
+                                     const size_t index) {
+  const EipUint8 *reply = response->message.message_buffer;
+  return reply + GetUint16(reply + 2 + 2 * index);
+}
+
+static void TestReplies(void) {
+  EipUint8 request[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  CipMessageRouterResponse response;
+
+  /* registers 1 to 3 hold 100, 250 and 500 */
+  HostTestSendRequest(request, EncodeGets(request, kRegisterClass, 3),
+                      &response);
+  HOST_TEST_CHECK(kCipErrorSuccess == response.general_status);
+  HOST_TEST_CHECK(26 == response.message.used_message_length);
+  HOST_TEST_CHECK(3 == GetUint16(response.message.message_buffer) );
+  static const EipUint16 values[] = { 100, 250, 500 };
+  for(size_t i = 0; i < 3; i++) {
+    const EipUint8 *reply = EmbeddedReply(&response, i);
+    HOST_TEST_CHECK(0x8E == reply[0] && kCipErrorSuccess == reply[2]);
+    HOST_TEST_CHECK(values[i] == GetUint16(reply + 4) );
+  }
+
+  /* 50 replies of 8 bytes do not fit, the last ones are answered 0x11 */
+  HostTestSendRequest(request, EncodeGets(request, kVariableDClass, 50),
+                      &response);
+  HOST_TEST_CHECK(kCipErrorEmbeddedServiceError == response.general_status);
+  HOST_TEST_CHECK(response.message.used_message_length <= kReplyLimit);
+  HOST_TEST_CHECK(kCipErrorReplyDataTooLarge == EmbeddedReply(&response, 49)[2]);
+
+  HostTestSendRequest(request, EncodeGets(request, kUnknownClass, 2),
+                      &response);
+  HOST_TEST_CHECK(kCipErrorEmbeddedServiceError == response.general_status);
+  HOST_TEST_CHECK(kCipErrorPathDestinationUnknown ==
+                  EmbeddedReply(&response, 1)[2]);
+
+  size_t length = EncodeGets(request, kRegisterClass, 2);
+  request[6 + 2] = 0xFF; /* first offset out of range */
+  HostTestSendRequest(request, length, &response);
+  HOST_TEST_CHECK(kCipErrorInvalidParameter == response.general_status);
+  HOST_TEST_CHECK(0 == response.message.used_message_length);
+
+  HostTestSendRequest(request, 6, &response); /* no service count */
+  HOST_TEST_CHECK(kCipErrorNotEnoughData == response.general_status);
+
+  /* nested packets are not routed */
+  const EmbeddedRequest nested = { kMultipleServicePacket, 0x02, 1, NULL, 0 };
+  HostTestSendRequest(request,
+                      EncodeMultipleServicePacket(request, &nested, 1),
+                      &response);
+  HOST_TEST_CHECK(kCipErrorEmbeddedServiceError == response.general_status);
+  HOST_TEST_CHECK(kCipErrorServiceNotSupported ==
+                  EmbeddedReply(&response, 0)[2]);
+}
+
+static EipUint16 ReadRegister(const CipInstanceNum instance) {
+  EipUint8 request[16];
+  CipMessageRouterResponse response;
+  HostTestSendRequest(request,
+                      HostTestEncodeRequest(request, kGetAttributeSingle,
+                                            kRegisterClass, instance, 1, NULL,
+                                            0),
+                      &response);
+  return GetUint16(response.message.message_buffer);
+}
+
+static void WriteRegister(const CipInstanceNum instance, const EipUint16 value) {
+  const EipUint8 data[] = { (EipUint8)value, (EipUint8)(value >> 8) };
+  EipUint8 request[16];
+  CipMessageRouterResponse response;
+  HostTestSendRequest(request,
+                      HostTestEncodeRequest(request, kSetAttributeSingle,
+                                            kRegisterClass, instance, 1, data,
+                                            sizeof(data) ),
+                      &response);
+}
+
+/* 11 string Gets (36 byte replies), then more and more register Gets, then a
+ * Set of register 2, which must only be executed if its reply fits */
+static void TestReplySpace(void) {
+  static const EipUint8 value[] = { 0x34, 0x12 };
+  EipUint8 request[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  CipMessageRouterResponse response;
+  EmbeddedRequest requests[20];
+  const size_t strings = 11;
+  for(size_t i = 0; i < strings; i++) {
+    requests[i] = (EmbeddedRequest){ kGetAttributeSingle, kVariableSClass, 1,
+                                     NULL, 0 };
+  }
+
+  printf("Set of register 2 behind string and register Gets:\n");
+  for(size_t registers = 0; registers < 7; registers++) {
+    for(size_t i = strings; i < strings + registers; i++) {
+      requests[i] = (EmbeddedRequest){ kGetAttributeSingle, kRegisterClass, 1,
+                                       NULL, 0 };
+    }
+    const size_t count = strings + registers + 1;
+    requests[count - 1] = (EmbeddedRequest){ kSetAttributeSingle,
+                                             kRegisterClass, 2, value,
+                                             sizeof(value) };
+    WriteRegister(2, 0);
+    HostTestSendRequest(request,
+                        EncodeMultipleServicePacket(request, requests, count),
+                        &response);
+    const EipUint8 *reply = EmbeddedReply(&response, count - 1);
+    const size_t space = kReplyLimit -
+                         (size_t)(reply - response.message.message_buffer);
+    const EipUint16 written = ReadRegister(2);
+    printf("  %zu bytes left: status 0x%02X, register 2 = 0x%04X\n", space,
+           reply[2], written);
+    if(space >= 4 + 2 * MAX_SIZE_OF_ADD_STATUS) {
+      HOST_TEST_CHECK(kCipErrorSuccess == reply[2] && 0x1234 == written);
+    } else {
+      HOST_TEST_CHECK(kCipErrorReplyDataTooLarge == reply[2] && 0 == written);
+    }
+  }
+}
+
+static void MeasureRegisterReads(void) {
+  static EipUint8 singles[kBenchRequests][16];
+  size_t single_lengths[kBenchRequests];
+  EipUint8 packet[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  CipMessageRouterResponse response;
+  const int repetitions = 2000;
+
+  for(size_t i = 0; i < kBenchRequests; i++) {
+    single_lengths[i] = HostTestEncodeRequest(singles[i], kGetAttributeSingle,
+                                              kRegisterClass,
+                                              (CipInstanceNum)(i + 1), 1,
+                                              NULL, 0);
+  }
+  const size_t packet_length = EncodeGets(packet, kRegisterClass,
+                                          kBenchRequests);
+  HostTestSendRequest(packet, packet_length, &response);
+  HOST_TEST_CHECK(kCipErrorSuccess == response.general_status);
+
+  double start = HostTestNanoSeconds();
+  for(int k = 0; k < repetitions; k++) {
+    for(size_t i = 0; i < kBenchRequests; i++) {
+      HostTestSendRequest(singles[i], single_lengths[i], &response);
+    }
+  }
+  const double router_singles = (HostTestNanoSeconds() - start) / repetitions;
+  start = HostTestNanoSeconds();
+  for(int k = 0; k < repetitions; k++) {
+    HostTestSendRequest(packet, packet_length, &response);
+  }
+  const double router_packet = (HostTestNanoSeconds() - start) / repetitions;
+
+  /* the same through the encapsulation layer */
+  HostTestInitializeEncapsulation();
+  static ENIPMessage outgoing;
+  struct sockaddr_in originator = { .sin_family = AF_INET };
+  int remaining = 0;
+  EipUint8 frame[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  InitializeENIPMessage(&outgoing);
+  size_t frame_length = HostTestEncodeRegisterSession(frame);
+  HandleReceivedExplictTcpData(7, frame, frame_length, &remaining,
+                               (struct sockaddr *)&originator, &outgoing);
+  const CipSessionHandle session = GetUint16(outgoing.message_buffer + 4) |
+                                   GetUint16(outgoing.message_buffer + 6) << 16;
+
+  static EipUint8 single_frames[kBenchRequests][64];
+  size_t single_frame_lengths[kBenchRequests];
+  for(size_t i = 0; i < kBenchRequests; i++) {
+    single_frame_lengths[i] = HostTestEncodeSendRRData(single_frames[i],
+                                                       session, singles[i],
+                                                       single_lengths[i]);
+  }
+  static EipUint8 packet_frame[2 * PC_OPENER_ETHERNET_BUFFER_SIZE];
+  const size_t packet_frame_length = HostTestEncodeSendRRData(packet_frame,
+                                                              session, packet,
+                                                              packet_length);
+  start = HostTestNanoSeconds();
+  for(int k = 0; k < repetitions; k++) {
+    for(size_t i = 0; i < kBenchRequests; i++) {
+      InitializeENIPMessage(&outgoing);
+      HandleReceivedExplictTcpData(7, single_frames[i],
+                                   single_frame_lengths[i], &remaining,
+                                   (struct sockaddr *)&originator, &outgoing);
+    }
+  }
+  const double encap_singles = (HostTestNanoSeconds() - start) / repetitions;
+  const size_t single_reply = outgoing.used_message_length;
+  start = HostTestNanoSeconds();
+  for(int k = 0; k < repetitions; k++) {
+    InitializeENIPMessage(&outgoing);
+    HandleReceivedExplictTcpData(7, packet_frame, packet_frame_length,
+                                 &remaining, (struct sockaddr *)&originator,
+                                 &outgoing);
+  }
+  const double encap_packet = (HostTestNanoSeconds() - start) / repetitions;
+  HOST_TEST_CHECK(outgoing.used_message_length > 24 + 16 + 4 + 2 * 50);
+
+  printf("Reading %d registers, us:\n", kBenchRequests);
+  printf("  router: %d x Get_Attribute_Single %6.1f, 1 x MSP %6.1f\n",
+         kBenchRequests, router_singles / 1e3, router_packet / 1e3);
+  printf("  encapsulation: %d x SendRRData %6.1f (%zu byte replies), "
+         "1 x SendRRData MSP %6.1f (%zu byte reply)\n", kBenchRequests,
+         encap_singles / 1e3, single_reply, encap_packet / 1e3,
+         outgoing.used_message_length);
+  HOST_TEST_CHECK(encap_packet < encap_singles);
+}
+
+int main(void) {
+  HostTestInitializeStack();
+  TestReplies();
+  TestReplySpace();
+  MeasureRegisterReads();
+  return HostTestResult();
+}
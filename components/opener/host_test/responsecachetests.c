@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/* Response cache of read-mostly classes: hit and miss counters, replies
+ * identical to the uncached ones, invalidation by a Set, by another service
+ * and by the application, and the bypass for classes with a
+ * PreGetCallback. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hosttest.h"
+
+#include "cipcommon.h"
+#include "cipidentity.h"
+
+#define kCacheTestClass 0x3E2
+#define kPreGetTestClass 0x3E3
+
+static CipUint g_value = 1000;
+static CipUint g_constant = 42;
+static CipUint g_pre_get_count = 0;
+
+static int DecodeTestValue(
+  void *const data,
+  CipMessageRouterRequest *const message_router_request,
+  CipMessageRouterResponse *const message_router_response) {
+  return DecodeCipUint( (CipUint *)data, message_router_request,
+                        message_router_response);
+}
+
+static CipClass *CreateCacheTestClass(void) {
+  CipClass *cip_class = CreateCipClass(kCacheTestClass, 0, 7, 2, 2, 2, 3, 1,
+                                       "HostTestCache", 1, NULL);
+  if(NULL == cip_class) {
+    return NULL;
+  }
+  CipInstance *instance = GetCipInstance(cip_class, 1);
+  InsertAttribute(instance, 1, kCipUint, EncodeCipUint, DecodeTestValue,
+                  &g_value, kSetAndGetAble);
+  InsertAttribute(instance, 2, kCipUint, EncodeCipUint, NULL, &g_constant,
+                  kGetableSingleAndAll);
+  InsertService(cip_class, kGetAttributeSingle, &GetAttributeSingle,
+                "GetAttributeSingle");
+  InsertService(cip_class, kGetAttributeAll, &GetAttributeAll,
+                "GetAttributeAll");
+  InsertService(cip_class, kSetAttributeSingle, &SetAttributeSingle,
+                "SetAttributeSingle");
+  if(kEipStatusOk != EnableCipResponseCache(cip_class, 4) ) {
+    return NULL;
+  }
+  return cip_class;
+}
+
+static CipUint GetValue(const int attribute) {
+  EipUint8 request[16];
+  CipMessageRouterResponse response;
+  HostTestSendRequest(request,
+                      HostTestEncodeRequest(request, kGetAttributeSingle,
+                                            kCacheTestClass, 1, attribute,
+                                            NULL, 0),
+                      &response);
+  HOST_TEST_CHECK(kCipErrorSuccess == response.general_status &&
+                  2 == response.message.used_message_length);
+  return (CipUint)(response.message.message_buffer[0] |
+                   response.message.message_buffer[1] << 8);
+}
+
+static void TestCounters(const CipClass *const cip_class) {
+  const CipResponseCacheCounters *counters =
+    GetCipResponseCacheCounters(cip_class);
+  HOST_TEST_CHECK(NULL != counters);
+  HOST_TEST_CHECK(NULL == GetCipResponseCacheCounters(GetCipClass(0x02) ) );
+
+  const CipUdint hits = counters->hits;
+  const CipUdint misses = counters->misses;
+  HOST_TEST_CHECK(1000 == GetValue(1) );
+  HOST_TEST_CHECK(hits == counters->hits && misses + 1 == counters->misses);
+  HOST_TEST_CHECK(1000 == GetValue(1) );
+  HOST_TEST_CHECK(1000 == GetValue(1) );
+  HOST_TEST_CHECK(hits + 2 == counters->hits &&
+                  misses + 1 == counters->misses);
+
+  /* an error reply is not cached */
+  EipUint8 request[16];
+  CipMessageRouterResponse response;
+  const size_t length = HostTestEncodeRequest(request, kGetAttributeSingle,
+                                              kCacheTestClass, 1, 9, NULL, 0);
+  HostTestSendRequest(request, length, &response);
+  HostTestSendRequest(request, length, &response);
+  HOST_TEST_CHECK(kCipErrorAttributeNotSupported == response.general_status);
+  HOST_TEST_CHECK(hits + 2 == counters->hits &&
+                  misses + 3 == counters->misses);
+}
+
+static void TestInvalidation(const CipClass *const cip_class) {
+  const CipResponseCacheCounters *counters =
+    GetCipResponseCacheCounters(cip_class);
+  EipUint8 request[16];
+  CipMessageRouterResponse response;
+
+  HOST_TEST_CHECK(1000 == GetValue(1) );
+  HOST_TEST_CHECK(42 == GetValue(2) );
+  const EipUint8 value[] = { 0x39, 0x30 };
+  HostTestSendRequest(request,
+                      HostTestEncodeRequest(request, kSetAttributeSingle,
+                                            kCacheTestClass, 1, 1, value,
+                                            sizeof(value) ),
+                      &response);
+  HOST_TEST_CHECK(kCipErrorSuccess == response.general_status);
+  HOST_TEST_CHECK(12345 == g_value);
+
+  /* every entry is dropped, not only the attribute that was set */
+  CipUdint misses = counters->misses;
+  HOST_TEST_CHECK(12345 == GetValue(1) );
+  HOST_TEST_CHECK(42 == GetValue(2) );
+  HOST_TEST_CHECK(misses + 2 == counters->misses);
+
+  /* changes made by the application itself */
+  g_value = 7;
+  HOST_TEST_CHECK(12345 == GetValue(1) );
+  InvalidateCipResponseCache(cip_class);
+  HOST_TEST_CHECK(7 == GetValue(1) );
+
+  /* a rejected Set drops the cache as well, the data stays */
+  misses = counters->misses;
+  HostTestSendRequest(request,
+                      HostTestEncodeRequest(request, kSetAttributeSingle,
+                                            kCacheTestClass, 1, 2, value,
+                                            sizeof(value) ),
+                      &response);
+  HOST_TEST_CHECK(kCipErrorSuccess != response.general_status);
+  HOST_TEST_CHECK(7 == GetValue(1) );
+  HOST_TEST_CHECK(misses + 1 == counters->misses);
+}
+
+/* the identity setters invalidate the cache of the Identity class */
+static EipStatus CountPreGet(CipInstance *const instance,
+                             CipAttributeStruct *const attribute,
+                             CipByte service) {
+  (void)instance;
+  (void)attribute;
+  (void)service;
+  g_pre_get_count++;
+  return kEipStatusOk;
+}
+
+/* the callback updates the data for every Get, a cached reply would miss
+ * the update */
+static void TestPreGetCallback(void) {
+  CipClass *cip_class = CreateCipClass(kPreGetTestClass, 0, 7, 2, 1, 1, 1, 1,
+                                       "HostTestPreGet", 1, NULL);
+  HOST_TEST_CHECK(NULL != cip_class);
+  if(NULL == cip_class) {
+    return;
+  }
+  InsertAttribute(GetCipInstance(cip_class, 1), 1, kCipUint, EncodeCipUint,
+                  NULL, &g_pre_get_count, kGetableSingleAndAll | kPreGetFunc);
+  InsertService(cip_class, kGetAttributeSingle, &GetAttributeSingle,
+                "GetAttributeSingle");
+  InsertGetSetCallback(cip_class, CountPreGet, kPreGetFunc);
+  HOST_TEST_CHECK(kEipStatusOk == EnableCipResponseCache(cip_class, 4) );
+
+  EipUint8 request[16];
+  CipMessageRouterResponse response;
+  const size_t length = HostTestEncodeRequest(request, kGetAttributeSingle,
+                                              kPreGetTestClass, 1, 1, NULL, 0);
+  for(CipUint get = 1; get <= 3; get++) {
+    HostTestSendRequest(request, length, &response);
+    HOST_TEST_CHECK(kCipErrorSuccess == response.general_status &&
+                    get == response.message.message_buffer[0]);
+  }
+  const CipResponseCacheCounters *counters =
+    GetCipResponseCacheCounters(cip_class);
+  HOST_TEST_CHECK(0 == counters->hits && 0 == counters->misses);
+}
+
+static void TestIdentity(void) {
+  EipUint8 request[16];
+  CipMessageRouterResponse response;
+  const size_t length = HostTestEncodeRequest(request, kGetAttributeSingle,
+                                              kCipIdentityClassCode, 1, 6,
+                                              NULL, 0);
+  const CipResponseCacheCounters *counters =
+    GetCipResponseCacheCounters(GetCipClass(kCipIdentityClassCode) );
+
+  SetDeviceSerialNumber(0x11223344);
+  HostTestSendRequest(request, length, &response);
+  const CipUdint hits = counters->hits;
+  HostTestSendRequest(request, length, &response);
+  HOST_TEST_CHECK(hits + 1 == counters->hits);
+  HOST_TEST_CHECK(4 == response.message.used_message_length &&
+                  0x44 == response.message.message_buffer[0]);
+
+  SetDeviceSerialNumber(0x55667788);
+  HostTestSendRequest(request, length, &response);
+  HOST_TEST_CHECK(hits + 1 == counters->hits);
+  HOST_TEST_CHECK(4 == response.message.used_message_length &&
+                  0x88 == response.message.message_buffer[0] &&
+                  0x55 == response.message.message_buffer[3]);
+}
+
+int main(void) {
+  HostTestInitializeStack();
+  const CipClass *cip_class = CreateCacheTestClass();
+  HOST_TEST_CHECK(NULL != cip_class);
+  if(NULL != cip_class) {
+    TestCounters(cip_class);
+    TestInvalidation(cip_class);
+  }
+  TestPreGetCallback();
+  TestIdentity();
+  return HostTestResult();
+}
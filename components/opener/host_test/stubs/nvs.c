@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* In-memory stand-in for the ESP-IDF NVS API, enough for system_config.c */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "nvs.h"
+
+#define HOST_NVS_KEYS 16
+#define HOST_NVS_KEY_LENGTH 16
+#define HOST_NVS_VALUE_SIZE 4096
+
+typedef struct {
+  char key[HOST_NVS_KEY_LENGTH];
+  unsigned char value[HOST_NVS_VALUE_SIZE];
+  size_t length;
+} HostNvsEntry;
+
+static HostNvsEntry g_host_nvs[HOST_NVS_KEYS];
+
+static HostNvsEntry *FindEntry(const char *key, const bool create) {
+  for(size_t i = 0; i < HOST_NVS_KEYS; i++) {
+    if(0 == strncmp(g_host_nvs[i].key, key, HOST_NVS_KEY_LENGTH) ) {
+      return &g_host_nvs[i];
+    }
+  }
+  if(create && strlen(key) < HOST_NVS_KEY_LENGTH) {
+    for(size_t i = 0; i < HOST_NVS_KEYS; i++) {
+      if('\0' == g_host_nvs[i].key[0]) {
+        strcpy(g_host_nvs[i].key, key);
+        return &g_host_nvs[i];
+      }
+    }
+  }
+  return NULL;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode,
+                   nvs_handle_t *out_handle) {
+  (void)name;
+  (void)open_mode;
+  *out_handle = 1;
+  return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+  (void)handle;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+  (void)handle;
+  return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value,
+                       size_t *length) {
+  (void)handle;
+  const HostNvsEntry *entry = FindEntry(key, false);
+  if(NULL == entry) {
+    return ESP_ERR_NVS_NOT_FOUND;
+  }
+  if(NULL != out_value) {
+    if(*length < entry->length) {
+      return ESP_FAIL;
+    }
+    memcpy(out_value, entry->value, entry->length);
+  }
+  *length = entry->length;
+  return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value,
+                       size_t length) {
+  (void)handle;
+  HostNvsEntry *entry = FindEntry(key, true);
+  if(NULL == entry || length > HOST_NVS_VALUE_SIZE) {
+    return ESP_ERR_NO_MEM;
+  }
+  memcpy(entry->value, value, length);
+  entry->length = length;
+  return ESP_OK;
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out_value) {
+  size_t length = sizeof(*out_value);
+  return nvs_get_blob(handle, key, out_value, &length);
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value) {
+  return nvs_set_blob(handle, key, &value, sizeof(value) );
+}
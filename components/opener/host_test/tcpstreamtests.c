@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Reassembly of TCP encapsulation streams: split headers and bodies, several
+ * packets per read, oversized packets, a connection closed by its own packet,
+ * and the cost of pipelined requests. The client talks to
+ * HandleDataOnTcpSocket() over a socket pair. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+
+#include "encap.h"
+
+/* not in a header, the network handler calls it on select() wakeups */
+EipStatus HandleDataOnTcpSocket(int socket);
+
+#define kReplyStatusOffset (ENCAPSULATION_HEADER_LENGTH + 16 + 2)
+#define kMaxInFlight 16
+
+static int g_server = -1;
+static int g_client = -1;
+
+/* bytes waiting for the client, -1 if none */
+static long ReceiveReplies(EipUint8 *const buffer, const size_t size) {
+  return recv(g_client, buffer, size, MSG_DONTWAIT);
+}
+
+static CipSessionHandle OpenConnection(void) {
+  int sockets[2];
+  if(0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) ) {
+    perror("socketpair");
+    exit(EXIT_FAILURE);
+  }
+  g_server = sockets[0];
+  g_client = sockets[1];
+
+  EipUint8 frame[64];
+  const size_t length = HostTestEncodeRegisterSession(frame);
+  HOST_TEST_CHECK(length == (size_t)write(g_client, frame, length) );
+  HandleDataOnTcpSocket(g_server);
+  EipUint8 reply[64];
+  HOST_TEST_CHECK(28 == ReceiveReplies(reply, sizeof(reply) ) );
+  CipSessionHandle session;
+  memcpy(&session, reply + 4, sizeof(session) );
+  return session;
+}
+
+static void Send(const EipUint8 *const data, const size_t length) {
+  HOST_TEST_CHECK(length == (size_t)write(g_client, data, length) );
+}
+
+static void TestReassembly(const EipUint8 *const frame,
+                           const size_t frame_length,
+                           const long reply_length) {
+  EipUint8 reply[PC_OPENER_ETHERNET_BUFFER_SIZE];
+
+  /* header split, then the body split */
+  Send(frame, 3);
+  HOST_TEST_CHECK(kEipStatusOk == HandleDataOnTcpSocket(g_server) );
+  Send(frame + 3, 20);
+  HOST_TEST_CHECK(kEipStatusOk == HandleDataOnTcpSocket(g_server) );
+  HOST_TEST_CHECK(-1 == ReceiveReplies(reply, sizeof(reply) ) );
+  Send(frame + 23, frame_length - 23);
+  HOST_TEST_CHECK(kEipStatusOk == HandleDataOnTcpSocket(g_server) );
+  HOST_TEST_CHECK(reply_length == ReceiveReplies(reply, sizeof(reply) ) );
+  HOST_TEST_CHECK(kCipErrorSuccess == reply[kReplyStatusOffset]);
+
+  /* two and a half packets in one read */
+  EipUint8 packets[3 * 64];
+  for(int i = 0; i < 3; i++) {
+    memcpy(packets + i * frame_length, frame, frame_length);
+  }
+  Send(packets, 2 * frame_length + 10);
+  HandleDataOnTcpSocket(g_server);
+  HOST_TEST_CHECK(2 * reply_length == ReceiveReplies(reply, sizeof(reply) ) );
+  Send(packets + 2 * frame_length + 10, frame_length - 10);
+  HandleDataOnTcpSocket(g_server);
+  HOST_TEST_CHECK(reply_length == ReceiveReplies(reply, sizeof(reply) ) );
+
+  /* an oversized packet is dropped, the one behind it is still served */
+  static EipUint8 oversized[ENCAPSULATION_HEADER_LENGTH + 500 + 64];
+  const size_t oversized_length = ENCAPSULATION_HEADER_LENGTH + 500;
+  memset(oversized, 0, sizeof(oversized) );
+  oversized[0] = 0x6F;
+  oversized[2] = (EipUint8)500;
+  oversized[3] = (EipUint8)(500 >> 8);
+  memcpy(oversized + oversized_length, frame, frame_length);
+  Send(oversized, 300);
+  HandleDataOnTcpSocket(g_server);
+  Send(oversized + 300, oversized_length + frame_length - 300);
+  HOST_TEST_CHECK(kEipStatusOk == HandleDataOnTcpSocket(g_server) );
+  HOST_TEST_CHECK(reply_length == ReceiveReplies(reply, sizeof(reply) ) );
+  HOST_TEST_CHECK(kCipErrorSuccess == reply[kReplyStatusOffset]);
+}
+
+static void MeasurePipelining(const EipUint8 *const frame,
+                              const size_t frame_length,
+                              const long reply_length) {
+  static EipUint8 packets[kMaxInFlight * 64];
+  static const int in_flight[] = { 1, 4, kMaxInFlight };
+  for(int i = 0; i < kMaxInFlight; i++) {
+    memcpy(packets + i * frame_length, frame, frame_length);
+  }
+
+  printf("Pipelined identity Get_Attribute_Single over SendRRData:\n");
+  for(size_t k = 0; k < sizeof(in_flight) / sizeof(in_flight[0]); k++) {
+    const int count = in_flight[k];
+    const int rounds = 20000 / count;
+    long wakeups = 0;
+    const double start = HostTestNanoSeconds();
+    for(int round = 0; round < rounds; round++) {
+      Send(packets, frame_length * count);
+      long received = 0;
+      while(received < reply_length * count) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(g_server, &readable);
+        struct timeval timeout = { 0, 10000 };
+        if(select(g_server + 1, &readable, NULL, NULL, &timeout) > 0) {
+          wakeups++;
+          HandleDataOnTcpSocket(g_server);
+        }
+        EipUint8 replies[kMaxInFlight * 128];
+        const long bytes = ReceiveReplies(replies, sizeof(replies) );
+        if(bytes > 0) {
+          received += bytes;
+        }
+      }
+    }
+    const double requests = (double)rounds * count;
+    const double wakeups_per_request = wakeups / requests;
+    printf("  %2d in flight: %5.2f us/request, %.2f wakeups/request\n", count,
+           (HostTestNanoSeconds() - start) / 1e3 / requests,
+           wakeups_per_request);
+    /* one wakeup per packet before the stream was reassembled */
+    HOST_TEST_CHECK(wakeups_per_request <= 1.0 / count + 0.01);
+  }
+}
+
+/* UnregisterSession closes the connection, the request behind it in the same
+ * read must not be served from the released buffer */
+static void TestClosedByOwnPacket(const EipUint8 *const request,
+                                  const size_t request_length) {
+  const CipSessionHandle session = OpenConnection();
+  EipUint8 packets[ENCAPSULATION_HEADER_LENGTH + 64] = { 0x66 };
+  memcpy(packets + 4, &session, sizeof(session) );
+  const size_t frame_length = HostTestEncodeSendRRData(
+    packets + ENCAPSULATION_HEADER_LENGTH, session, request, request_length);
+  Send(packets, ENCAPSULATION_HEADER_LENGTH + frame_length);
+  HOST_TEST_CHECK(kEipStatusOk == HandleDataOnTcpSocket(g_server) );
+  HOST_TEST_CHECK(NULL == GetEncapsulationSession(g_server) );
+  EipUint8 reply[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  HOST_TEST_CHECK(ReceiveReplies(reply, sizeof(reply) ) <= 0);
+  close(g_client);
+}
+
+int main(void) {
+  HostTestInitializeStack();
+  HostTestInitializeEncapsulation();
+
+  const CipSessionHandle session = OpenConnection();
+  HOST_TEST_CHECK(session == GetSessionFromSocket(g_server) );
+  EipUint8 request[16];
+  const size_t request_length = HostTestEncodeRequest(request,
+                                                      kGetAttributeSingle, 0x01,
+                                                      1, 7, NULL, 0);
+  EipUint8 frame[64];
+  const size_t frame_length = HostTestEncodeSendRRData(frame, session, request,
+                                                       request_length);
+  EipUint8 reply[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  Send(frame, frame_length);
+  HandleDataOnTcpSocket(g_server);
+  const long reply_length = ReceiveReplies(reply, sizeof(reply) );
+  HOST_TEST_CHECK(reply_length > kReplyStatusOffset &&
+                  kCipErrorSuccess == reply[kReplyStatusOffset]);
+
+  TestReassembly(frame, frame_length, reply_length);
+  MeasurePipelining(frame, frame_length, reply_length);
+
+  /* the peer closed: the connection and its session are released */
+  close(g_client);
+  HOST_TEST_CHECK(kEipStatusError == HandleDataOnTcpSocket(g_server) );
+  HOST_TEST_CHECK(NULL == GetEncapsulationSession(g_server) );
+
+  TestClosedByOwnPacket(request, request_length);
+  return HostTestResult();
+}
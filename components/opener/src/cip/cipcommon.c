@@ -99,6 +99,117 @@ void ShutdownCipStack(void) {
   DeleteAllClasses();
 }
 
+/** @brief Largest reply kept by a response cache entry */
+#define CIP_RESPONSE_CACHE_MAX_REPLY_SIZE 64
+
+/** @brief A cached Get_Attribute_Single or Get_Attribute_All reply */
+typedef struct {
+  CipUdint data_version; /**< data version the reply was built from */
+  CipInstanceNum instance_number; /**< instance the reply belongs to */
+  CipUsint service; /**< service of the request */
+  EipUint16 attribute_number; /**< requested attribute, 0 for Get_Attribute_All */
+  EipUint16 length; /**< length of the reply data */
+  CipOctet reply[CIP_RESPONSE_CACHE_MAX_REPLY_SIZE]; /**< reply data */
+} CipResponseCacheEntry;
+
+/** @brief Direct mapped cache of the replies of a class */
+typedef struct cip_response_cache {
+  CipUdint data_version; /**< bumped whenever the class' data changes */
+  CipResponseCacheCounters counters; /**< hit and miss counters */
+  EipUint16 number_of_entries; /**< entries in the cache, a power of two */
+  EipUint16 instance_stride; /**< entries used per instance: Get_Attribute_All
+                               and one per attribute */
+  CipResponseCacheEntry entries[]; /**< cached replies */
+} CipResponseCache;
+
+/** @brief Call a service of a class with response cache
+ *
+ * Get_Attribute_Single and Get_Attribute_All requests are answered from the
+ * cache if a reply built from the current data is present, successful
+ * replies are stored. Requests for attribute members bypass the cache.
+ * Every service other than the Get services is assumed to change the data.
+ *
+ * @param cache response cache of the addressed class
+ * @param service service to be called
+ * @param instance addressed instance
+ * @param message_router_request request message
+ * @param message_router_response reply message
+ * @param originator_address address struct of the originator as received
+ * @param encapsulation_session associated encapsulation session of the explicit message
+ * @return the status of the service
+ */
+static EipStatus CallServiceWithResponseCache(
+  CipResponseCache *const cache,
+  const CipServiceStruct *const service,
+  CipInstance *const instance,
+  CipMessageRouterRequest *const message_router_request,
+  CipMessageRouterResponse *const message_router_response,
+  const struct sockaddr *originator_address,
+  const CipSessionHandle encapsulation_session) {
+  const CipUsint service_number = message_router_request->service;
+
+  if( (kGetAttributeSingle != service_number &&
+       kGetAttributeAll != service_number) ||
+      0 != message_router_request->request_data_size ||
+      0 != message_router_request->request_path.number_of_members ) {
+    const EipStatus status = service->service_function(instance,
+                                                        message_router_request,
+                                                        message_router_response,
+                                                        originator_address,
+                                                        encapsulation_session);
+    if(kGetAttributeList != service_number &&
+       kGetAttributeSingle != service_number &&
+       kGetAttributeAll != service_number) {
+      cache->data_version++;
+    }
+    return status;
+  }
+
+  const EipUint16 attribute_number = (kGetAttributeSingle == service_number) ?
+                                     (EipUint16) message_router_request->
+                                     request_path.attribute_number : 0;
+  CipResponseCacheEntry *const entry =
+    &cache->entries[ ( (size_t) instance->instance_number *
+                       cache->instance_stride + attribute_number ) &
+                     (cache->number_of_entries - 1U)];
+  ENIPMessage *const message = &message_router_response->message;
+
+  if(cache->data_version == entry->data_version &&
+     instance->instance_number == entry->instance_number &&
+     service_number == entry->service &&
+     attribute_number == entry->attribute_number) {
+    cache->counters.hits++;
+    message_router_response->reply_service = (0x80 | service_number);
+    message_router_response->general_status = kCipErrorSuccess;
+    message_router_response->size_of_additional_status = 0;
+    memcpy(message->message_buffer, entry->reply, entry->length);
+    message->current_message_position = message->message_buffer +
+                                        entry->length;
+    message->used_message_length = entry->length;
+    return kEipStatusOkSend;
+  }
+
+  cache->counters.misses++;
+  const CipUdint data_version = cache->data_version;
+  const EipStatus status = service->service_function(instance,
+                                                      message_router_request,
+                                                      message_router_response,
+                                                      originator_address,
+                                                      encapsulation_session);
+  if(kEipStatusOkSend == status &&
+     kCipErrorSuccess == message_router_response->general_status &&
+     0 == message_router_response->size_of_additional_status &&
+     CIP_RESPONSE_CACHE_MAX_REPLY_SIZE >= message->used_message_length) {
+    entry->data_version = data_version;
+    entry->instance_number = instance->instance_number;
+    entry->service = service_number;
+    entry->attribute_number = attribute_number;
+    entry->length = (EipUint16) message->used_message_length;
+    memcpy(entry->reply, message->message_buffer, entry->length);
+  }
+  return status;
+}
+
 EipStatus NotifyClass(const CipClass *RESTRICT const cip_class,
                       CipMessageRouterRequest *const message_router_request,
                       CipMessageRouterResponse *const message_router_response,
@@ -108,32 +219,38 @@ EipStatus NotifyClass(const CipClass *RESTRICT const cip_class,
   /* find the instance: if instNr==0, the class is addressed, else find the instance */
   CipInstanceNum instance_number =
     message_router_request->request_path.instance_number;                           /* get the instance number */
-  CipInstance *instance = GetCipInstance(cip_class, instance_number); /* look up the instance (note that if inst==0 this will be the class itself) */
+  CipInstance virtual_instance; /* keeps an instance of the virtual range for the whole request */
+  CipInstance *instance = ResolveCipInstance(cip_class, instance_number,
+                                             &virtual_instance); /* look up the instance (note that if inst==0 this will be the class itself) */
   if(instance) /* if instance is found */
   {
     OPENER_TRACE_INFO("notify: found instance %d%s\n",
                       instance_number,
                       instance_number == 0 ? " (class object)" : "");
 
-    CipServiceStruct *service = instance->cip_class->services; /* get pointer to array of services */
-    if(NULL != service) /* if services are defined */
+    CipServiceStruct *service = GetCipService(instance,
+                                              message_router_request->service);
+    if(NULL != service) /* if the service is supported */
     {
-      for(size_t i = 0; i < instance->cip_class->number_of_services; i++) /* seach the services list */
-      {
-        if(message_router_request->service == service->service_number) /* if match is found */
-        {
-          /* call the service, and return what it returns */
-          OPENER_TRACE_INFO("notify: calling %s service\n", service->name);
-          OPENER_ASSERT(NULL != service->service_function);
-          return service->service_function(instance,
-                                           message_router_request,
-                                           message_router_response,
-                                           originator_address,
-                                           encapsulation_session);
-        } else {
-          service++;
-        }
+      /* call the service, and return what it returns */
+      OPENER_TRACE_INFO("notify: calling %s service\n", service->name);
+      OPENER_ASSERT(NULL != service->service_function);
+      /* a PreGetCallback may update the data before every Get */
+      if(NULL != cip_class->response_cache &&
+         NULL == cip_class->PreGetCallback) {
+        return CallServiceWithResponseCache(cip_class->response_cache,
+                                            service,
+                                            instance,
+                                            message_router_request,
+                                            message_router_response,
+                                            originator_address,
+                                            encapsulation_session);
       }
+      return service->service_function(instance,
+                                       message_router_request,
+                                       message_router_response,
+                                       originator_address,
+                                       encapsulation_session);
     } OPENER_TRACE_WARN(
       "notify: service 0x%x not supported\n", message_router_request->service);
     message_router_response->general_status = kCipErrorServiceNotSupported; /* if no services or service not found, return an error reply*/
@@ -162,99 +279,258 @@ CipUint GetMaxInstanceNumber(CipClass *RESTRICT const cip_class) {
     }
     instance = instance->next;
   }
+  if(0 != cip_class->number_of_virtual_instances) {
+    const CipUint last_virtual_instance = cip_class->first_virtual_instance +
+                                          cip_class->number_of_virtual_instances
+                                          - 1;
+    if(last_virtual_instance > max_instance) {
+      max_instance = last_virtual_instance;
+    }
+  }
   return max_instance;
 }
 
-CipInstance *AddCipInstances(CipClass *RESTRICT const cip_class,
-                             const CipInstanceNum number_of_instances) {
-  CipInstance **next_instance = NULL;
-  CipInstance *first_instance = NULL; /* Initialize to error result */
-  CipInstanceNum instance_number = 1; /* the first instance is number 1 */
-  int new_instances = 0;
+/** @brief Smallest number of lookup slots the instance index may grow to
+ *  regardless of how many instances the class currently holds */
+#define CIP_INSTANCE_INDEX_MIN_SLOTS 32
 
-  OPENER_TRACE_INFO("adding %d instances to class %s\n",
-                    number_of_instances,
-                    cip_class->class_name);
+/** @brief Enter an instance into the class' direct lookup index
+ *
+ * The index grows geometrically as long as the instance numbers stay dense
+ * (no more than twice the instance count plus some slack). Instances with
+ * numbers beyond that, or for which the index cannot be grown, are left
+ * unindexed and GetCipInstance() falls back to the instance list for them.
+ *
+ * @param cip_class class owning the instance
+ * @param instance instance to add to the index
+ */
+static void IndexCipInstance(CipClass *RESTRICT const cip_class,
+                             CipInstance *const instance) {
+  const CipInstanceNum instance_number = instance->instance_number;
+  if(0 == instance_number) {
+    return;
+  }
 
-  /* Allocate and initialize all needed instances one by one. */
-  for(new_instances = 0; new_instances < number_of_instances; new_instances++) {
+  if(instance_number > cip_class->instance_index_size) {
+    size_t allowed_size = 2 * (size_t)cip_class->number_of_instances +
+                          CIP_INSTANCE_INDEX_MIN_SLOTS;
+    if(instance_number > allowed_size) {
+      return; /* too sparse, keep the instance in the list only */
+    }
+    size_t new_size = 2 * (size_t)cip_class->instance_index_size;
+    if(new_size < CIP_INSTANCE_INDEX_MIN_SLOTS) {
+      new_size = CIP_INSTANCE_INDEX_MIN_SLOTS;
+    }
+    if(new_size < instance_number) {
+      new_size = instance_number;
+    }
+    if(new_size > allowed_size) {
+      new_size = allowed_size;
+    }
+    if(new_size > kCipInstanceNumMax) {
+      new_size = kCipInstanceNumMax;
+    }
+    CipInstance **new_index = (CipInstance **) CipCalloc(new_size,
+                                                         sizeof(CipInstance *) );
+    if(NULL == new_index) {
+      return; /* lookup still works through the instance list */
+    }
+    if(NULL != cip_class->instance_index) {
+      memcpy(new_index, cip_class->instance_index,
+             cip_class->instance_index_size * sizeof(CipInstance *) );
+      CipFree(cip_class->instance_index);
+    }
+    cip_class->instance_index = new_index;
+    cip_class->instance_index_size = (CipInstanceNum)new_size;
+  }
 
-    /* Find next free instance number */
-    CipBool found_free_number = false;
+  if(NULL == cip_class->instance_index[instance_number - 1]) {
+    cip_class->instance_index[instance_number - 1] = instance;
+    cip_class->number_of_indexed_instances++;
+  }
+}
 
-    while (!found_free_number) {
-      next_instance = &cip_class->instances;           /* set pointer to head of existing instances chain */
+/** @brief Remove an instance from the class' direct lookup index
+ *
+ * @param cip_class class owning the instance
+ * @param instance instance to remove, no-op if it was never indexed
+ */
+static void UnindexCipInstance(CipClass *RESTRICT const cip_class,
+                               const CipInstance *const instance) {
+  const CipInstanceNum instance_number = instance->instance_number;
+  if(0 != instance_number &&
+     instance_number <= cip_class->instance_index_size &&
+     instance == cip_class->instance_index[instance_number - 1]) {
+    cip_class->instance_index[instance_number - 1] = NULL;
+    cip_class->number_of_indexed_instances--;
+  }
+}
 
-      found_free_number = true; /* anticipate instance_number is not in use*/
+/** @brief Header of a block holding instances created by one AddCipInstances*() call
+ *
+ * The block is laid out as this header, followed by the array of instances,
+ * followed by the attribute arrays of all instances. It is released once the
+ * last of its instances has been freed.
+ */
+typedef struct cip_instance_slab {
+  struct cip_instance_slab *next; /**< next block of the same class */
+  CipInstance *first_instance; /**< first instance carved from this block */
+  CipInstanceNum number_of_instances; /**< number of instances in this block */
+  CipInstanceNum live_instances; /**< instances not freed yet */
+} CipInstanceSlab;
 
-      /* loop through existing instances */
-      while (*next_instance)           /* as long as what next_instance points to is not zero */
-      {
-        /* check if instance number in use */
-        if(instance_number == (*next_instance)->instance_number) {
-          found_free_number = false;  /* instance number exists already */
-          break;
-        }
-        next_instance = &(*next_instance)->next;                /* get next instance in instances chain*/
-      }
+CipInstance *AddCipInstances(CipClass *RESTRICT const cip_class,
+                             const CipInstanceNum number_of_instances) {
+  return AddCipInstancesWithAllocator(cip_class, number_of_instances, NULL);
+}
 
-      if(!found_free_number) {
-        instance_number++;                         /* try next instance_number and loop again through existing instances */
-      }
+CipInstance *AddCipInstancesWithAllocator(CipClass *RESTRICT const cip_class,
+                                          const CipInstanceNum number_of_instances,
+                                          CipInstanceAllocator allocator) {
+  OPENER_TRACE_INFO("adding %d instances to class %s\n",
+                    number_of_instances,
+                    cip_class->class_name);
 
-    }
+  if(0 == number_of_instances) {
+    return NULL;
+  }
+  if(NULL == allocator) {
+    allocator = &CipCalloc;
+  }
 
-    CipInstance *current_instance =
-      (CipInstance *) CipCalloc( 1, sizeof(CipInstance) );
-    OPENER_ASSERT(NULL != current_instance); /* fail if run out of memory */
-    if(NULL == current_instance) {
-      break;
-    }
-    if(NULL == first_instance) {
-      first_instance = current_instance; /* remember the first allocated instance */
+  /* One block for the header, all instances and all attribute arrays.
+   * Instances of classes with a descriptor table need no attribute array. */
+  const size_t attributes_per_instance =
+    (NULL == cip_class->attribute_descriptors) ?
+    cip_class->number_of_attributes : 0;
+  const size_t slab_size = sizeof(CipInstanceSlab) +
+                           number_of_instances * (sizeof(CipInstance) +
+                                                  attributes_per_instance *
+                                                  sizeof(CipAttributeStruct) );
+  CipInstanceSlab *slab = (CipInstanceSlab *) allocator(1, slab_size);
+  OPENER_ASSERT(NULL != slab); /* fail if run out of memory */
+  if(NULL == slab) {
+    OPENER_TRACE_ERR(
+      "ERROR: Could not allocate %d instances for class %s\n",
+      number_of_instances,
+      cip_class->class_name);
+    return NULL;
+  }
+  CipInstance *const first_instance = (CipInstance *) (slab + 1);
+  CipAttributeStruct *attributes =
+    (CipAttributeStruct *) (first_instance + number_of_instances);
+  slab->first_instance = first_instance;
+  slab->number_of_instances = number_of_instances;
+  slab->live_instances = number_of_instances;
+
+  /* find the end of the instance chain once */
+  CipInstance **next_instance = &cip_class->instances;
+  while(NULL != *next_instance) {
+    next_instance = &(*next_instance)->next;
+  }
+
+  CipInstanceNum instance_number = 1; /* the first instance is number 1 */
+  for(CipInstanceNum i = 0; i < number_of_instances; i++) {
+    /* Find next free instance number */
+    while(NULL != GetCipInstance(cip_class, instance_number) ) {
+      instance_number++;
     }
 
+    CipInstance *current_instance = &first_instance[i];
     current_instance->instance_number = instance_number; /* assign the next sequential instance number */
     current_instance->cip_class = cip_class; /* point each instance to its class */
-
-    if(cip_class->number_of_attributes) /* if the class calls for instance attributes */
-    { /* then allocate storage for the attribute array */
-      current_instance->attributes = (CipAttributeStruct *) CipCalloc(
-        cip_class->number_of_attributes,
-        sizeof(CipAttributeStruct) );
-      OPENER_ASSERT(NULL != current_instance->attributes);/* fail if run out of memory */
-      if(NULL == current_instance->attributes) {
-        break;
-      }
+    if(0 != attributes_per_instance) { /* if the class calls for instance attributes */
+      current_instance->attributes = attributes;
+      attributes += attributes_per_instance;
     }
 
     *next_instance = current_instance; /* link the previous pointer to this new node */
     next_instance = &current_instance->next; /* update pp to point to the next link of the current node */
+    IndexCipInstance(cip_class, current_instance);
     cip_class->number_of_instances += 1; /* update the total number of instances recorded by the class */
+    if(instance_number > cip_class->max_instance) {
+      cip_class->max_instance = instance_number; /* update largest instance number (class Attribute 2) */
+    }
     instance_number++; /* update to the number of the next node*/
   }
 
-  cip_class->max_instance = GetMaxInstanceNumber(cip_class); /* update largest instance number (class Attribute 2) */
+  slab->next = cip_class->instance_slabs;
+  cip_class->instance_slabs = slab;
 
-  if(new_instances != number_of_instances) {
-    /* TODO: Free again all attributes and instances allocated so far in this call. */
-    OPENER_TRACE_ERR(
-      "ERROR: Allocated only %d instances of requested %d for class %s\n",
-      new_instances,
-      number_of_instances,
-      cip_class->class_name);
-    first_instance = NULL; /* failed to allocate all instances / attributes */
-  }
   return first_instance;
 }
 
+void FreeCipInstance(CipClass *RESTRICT const cip_class,
+                     CipInstance *const instance) {
+  for(CipInstanceSlab **slab = &cip_class->instance_slabs; NULL != *slab;
+      slab = &(*slab)->next) {
+    CipInstanceSlab *const current_slab = *slab;
+    if(instance >= current_slab->first_instance &&
+       instance <
+       current_slab->first_instance + current_slab->number_of_instances) {
+      if(0 == --current_slab->live_instances) {
+        *slab = current_slab->next;
+        CipFree(current_slab);
+      }
+      return;
+    }
+  }
+  /* not created by AddCipInstances*(), free instance and attributes individually */
+  CipFree(instance->attributes);
+  CipFree(instance);
+}
+
+EipStatus AddCipVirtualInstances(CipClass *RESTRICT const cip_class,
+                                 const CipInstanceNum first_instance,
+                                 const CipInstanceNum number_of_instances,
+                                 void *const data,
+                                 const size_t stride) {
+  OPENER_TRACE_INFO("adding virtual instances %d..%d to class %s\n",
+                    first_instance,
+                    first_instance + number_of_instances - 1,
+                    cip_class->class_name);
+
+  /* only one range per class, it must not overlap existing instances */
+  if(0 == first_instance || 0 == number_of_instances || NULL == data ||
+     0 != cip_class->number_of_virtual_instances ||
+     (size_t)first_instance + number_of_instances - 1 > kCipInstanceNumMax) {
+    return kEipStatusError;
+  }
+  for(CipInstance *instance = cip_class->instances; NULL != instance;
+      instance = instance->next) {
+    if(instance->instance_number >= first_instance &&
+       instance->instance_number - first_instance < number_of_instances) {
+      return kEipStatusError;
+    }
+  }
+
+  if(NULL == cip_class->virtual_instance) {
+    cip_class->virtual_instance = (CipInstance *) CipCalloc(1,
+                                                            sizeof(CipInstance) );
+    if(NULL == cip_class->virtual_instance) {
+      return kEipStatusError;
+    }
+  }
+  cip_class->virtual_instance->cip_class = cip_class;
+  cip_class->first_virtual_instance = first_instance;
+  cip_class->number_of_virtual_instances = number_of_instances;
+  cip_class->virtual_instance_data = (EipUint8 *) data;
+  cip_class->virtual_instance_stride = stride;
+
+  cip_class->number_of_instances += number_of_instances; /* update the total number of instances recorded by the class */
+  cip_class->max_instance = GetMaxInstanceNumber(cip_class); /* update largest instance number (class Attribute 2) */
+  return kEipStatusOk;
+}
+
 CipInstance *AddCipInstance(CipClass *RESTRICT const cip_class,
                             const CipInstanceNum instance_id) {
   CipInstance *instance = GetCipInstance(cip_class, instance_id);
 
   if(NULL == instance) { /*we have no instance with given id*/
     instance = AddCipInstances(cip_class, 1);
+    UnindexCipInstance(cip_class, instance);
     instance->instance_number = instance_id;
+    IndexCipInstance(cip_class, instance);
   }
 
   cip_class->max_instance = GetMaxInstanceNumber(cip_class); /* update largest instance number (class Attribute 2) */
@@ -403,6 +679,60 @@ CipClass *CreateCipClass(const CipUdint class_code,
   return cip_class;
 }
 
+/** @brief Set the access bits of an attribute in the bit masks of its class
+ *
+ * @param cip_class class the attribute belongs to
+ * @param attribute_number number of the attribute
+ * @param cip_flags access flags of the attribute
+ */
+static void SetAttributeBitMasks(CipClass *const cip_class,
+                                 const EipUint16 attribute_number,
+                                 const EipByte cip_flags) {
+  OPENER_ASSERT(attribute_number <= cip_class->highest_attribute_number);
+
+  size_t index = CalculateIndex(attribute_number);
+
+  cip_class->get_single_bit_mask[index] |=
+    (cip_flags & kGetableSingle) ? 1 << (attribute_number) % 8 : 0;
+  const bool in_get_all = 0 != ( cip_class->get_all_bit_mask[index] &
+                                  ( 1 << (attribute_number) % 8 ) );
+  cip_class->get_all_bit_mask[index] |=
+    ( cip_flags & (kGetableAll | kGetableAllDummy) ) ? 1 <<
+      (attribute_number) % 8 : 0;
+  cip_class->set_bit_mask[index] |= ( (cip_flags & kSetable) ? 1 : 0 ) <<
+                                    ( (attribute_number) % 8 );
+
+  /* keep the GetAttributeAll attributes sorted by attribute number */
+  if( !in_get_all && ( cip_flags & (kGetableAll | kGetableAllDummy) ) ) {
+    EipUint16 position = cip_class->number_of_get_all_attributes;
+    while(0 < position &&
+          cip_class->get_all_attributes[position - 1] > attribute_number) {
+      cip_class->get_all_attributes[position] =
+        cip_class->get_all_attributes[position - 1];
+      position--;
+    }
+    cip_class->get_all_attributes[position] = attribute_number;
+    cip_class->number_of_get_all_attributes++;
+  }
+}
+
+/** @brief Remember the position of an attribute for GetCipAttribute()
+ *
+ * The first position an attribute number is inserted at wins; instances
+ * deviating from it are served by a search.
+ *
+ * @param cip_class class the attribute belongs to
+ * @param attribute_number number of the attribute
+ * @param slot position of the attribute in the attribute array or descriptor table
+ */
+static void SetAttributeSlot(CipClass *const cip_class,
+                             const EipUint16 attribute_number,
+                             const size_t slot) {
+  if(slot < UINT8_MAX && 0 == cip_class->attribute_slots[attribute_number]) {
+    cip_class->attribute_slots[attribute_number] = (EipUint8) (slot + 1);
+  }
+}
+
 void InsertAttribute(CipInstance *const instance,
                      const EipUint16 attribute_number,
                      const EipUint8 cip_type,
@@ -426,18 +756,10 @@ void InsertAttribute(CipInstance *const instance,
       attribute->decode = decode_function;
       attribute->attribute_flags = cip_flags;
       attribute->data = data;
+      attribute->number_of_members = 0;
 
-      OPENER_ASSERT(attribute_number <= cip_class->highest_attribute_number);
-
-      size_t index = CalculateIndex(attribute_number);
-
-      cip_class->get_single_bit_mask[index] |=
-        (cip_flags & kGetableSingle) ? 1 << (attribute_number) % 8 : 0;
-      cip_class->get_all_bit_mask[index] |=
-        ( cip_flags & (kGetableAll | kGetableAllDummy) ) ? 1 <<
-          (attribute_number) % 8 : 0;
-      cip_class->set_bit_mask[index] |= ( (cip_flags & kSetable) ? 1 : 0 ) <<
-                                        ( (attribute_number) % 8 );
+      SetAttributeBitMasks(cip_class, attribute_number, cip_flags);
+      SetAttributeSlot(cip_class, attribute_number, i);
 
       return;
     }
@@ -451,6 +773,50 @@ void InsertAttribute(CipInstance *const instance,
   /* trying to insert too many attributes*/
 }
 
+void SetCipAttributeMembers(CipInstance *const instance,
+                            const EipUint16 attribute_number,
+                            const EipUint8 number_of_members) {
+  CipAttributeStruct *const attribute = GetCipAttribute(instance,
+                                                        attribute_number);
+  /* only attributes of an own attribute array can be changed */
+  OPENER_ASSERT(NULL != attribute && NULL != instance->attributes);
+  /* members are addressed by the size of the attribute type */
+  OPENER_ASSERT(0 != GetCipDataTypeLength(attribute->type, NULL) );
+  attribute->number_of_members = number_of_members;
+}
+
+EipStatus InsertAttributeDescriptors(CipClass *const cip_class,
+                                     const CipAttributeDescriptor *const descriptors,
+                                     const EipUint16 number_of_descriptors) {
+  /* only one table per class, descriptors are found by their slot */
+  if(NULL != cip_class->attribute_descriptors ||
+     number_of_descriptors >= UINT8_MAX) {
+    OPENER_TRACE_ERR("%s: attribute descriptor table rejected\n",
+                     cip_class->class_name);
+    return kEipStatusError;
+  }
+
+  if(NULL == cip_class->resolved_attribute) {
+    cip_class->resolved_attribute = (CipAttributeStruct *) CipCalloc(1,
+                                                                     sizeof(
+                                                                       CipAttributeStruct) );
+    if(NULL == cip_class->resolved_attribute) {
+      OPENER_TRACE_ERR("%s: no memory for the attribute descriptor table\n",
+                       cip_class->class_name);
+      return kEipStatusError;
+    }
+  }
+  cip_class->attribute_descriptors = descriptors;
+  cip_class->number_of_attribute_descriptors = number_of_descriptors;
+
+  for(EipUint16 i = 0; i < number_of_descriptors; i++) {
+    SetAttributeBitMasks(cip_class, descriptors[i].attribute_number,
+                         descriptors[i].attribute_flags);
+    SetAttributeSlot(cip_class, descriptors[i].attribute_number, i);
+  }
+  return kEipStatusOk;
+}
+
 void InsertService(const CipClass *const cip_class,
                    const EipUint8 service_number,
                    const CipServiceFunction service_function,
@@ -461,8 +827,15 @@ void InsertService(const CipClass *const cip_class,
                     cip_class->class_name, cip_class->number_of_services,
                     service_number);
   OPENER_ASSERT(service != NULL);
+  /* services are only reached through the index, see GetCipService() */
+  if(service_number >= CIP_SERVICE_INDEX_SIZE) {
+    OPENER_TRACE_ERR("%s: service 0x%x is outside the service index, ignored\n",
+                     cip_class->class_name, service_number);
+    return;
+  }
   /* adding a service to a class that was not declared to have services is not allowed*/
-  for(int i = 0; i < cip_class->number_of_services; i++) /* Iterate over all service slots attached to the class */
+  /* the index stores the slot + 1 in a byte, so slots past UINT8_MAX - 1 are unreachable */
+  for(int i = 0; i < cip_class->number_of_services && i < UINT8_MAX; i++) /* Iterate over all service slots attached to the class */
   {
     if(service->service_number == service_number ||
        service->service_function == NULL)                                              /* found undefined service slot*/
@@ -470,10 +843,14 @@ void InsertService(const CipClass *const cip_class,
       service->service_number = service_number; /* fill in service number*/
       service->service_function = service_function; /* fill in function address*/
       service->name = service_name;
+      ( (CipClass *) cip_class )->service_index[service_number] =
+        (EipUint8) (i + 1);
       return;
     }
     ++service;
   }
+  OPENER_TRACE_ERR("%s: no free slot for service 0x%x, ignored\n",
+                   cip_class->class_name, service_number);
   OPENER_ASSERT(false);
   /* adding more services than were declared is a no-no*/
 }
@@ -497,8 +874,99 @@ void InsertGetSetCallback(CipClass *const cip_class,
   }
 }
 
+EipStatus EnableCipResponseCache(CipClass *const cip_class,
+                                 const EipUint16 number_of_entries) {
+  OPENER_ASSERT(NULL == cip_class->response_cache); /* only one cache per class */
+  OPENER_ASSERT(0 != number_of_entries &&
+                0 == (number_of_entries & (number_of_entries - 1) ) ); /* power of two */
+
+  CipResponseCache *const cache = (CipResponseCache *) CipCalloc(1,
+                                                                 sizeof(
+                                                                   CipResponseCache)
+                                                                 + number_of_entries *
+                                                                 sizeof(
+                                                                   CipResponseCacheEntry) );
+  if(NULL == cache) {
+    return kEipStatusError;
+  }
+  cache->data_version = 1; /* the zeroed entries are outdated from the start */
+  cache->number_of_entries = number_of_entries;
+  cache->instance_stride = cip_class->highest_attribute_number + 1;
+  cip_class->response_cache = cache;
+  return kEipStatusOk;
+}
+
+void InvalidateCipResponseCache(const CipClass *const cip_class) {
+  if(NULL != cip_class && NULL != cip_class->response_cache) {
+    cip_class->response_cache->data_version++;
+  }
+}
+
+const CipResponseCacheCounters *GetCipResponseCacheCounters(
+  const CipClass *const cip_class) {
+  if(NULL == cip_class->response_cache) {
+    return NULL;
+  }
+  return &cip_class->response_cache->counters;
+}
+
+/** @brief Get the attribute of an instance described by the class' descriptor table
+ *
+ * @param instance instance without an own attribute array
+ * @param attribute_number number of the attribute
+ * @param storage attribute the descriptor is resolved into
+ * @return storage, NULL if the attribute is not defined
+ */
+static CipAttributeStruct *GetCipAttributeFromDescriptor(
+  const CipInstance *const instance,
+  const EipUint16 attribute_number,
+  CipAttributeStruct *const storage) {
+  const CipClass *const cip_class = instance->cip_class;
+
+  const EipUint8 slot = attribute_number <= cip_class->highest_attribute_number ?
+                        cip_class->attribute_slots[attribute_number] : 0;
+  if(0 == slot) {
+    OPENER_TRACE_WARN("attribute %d not defined\n", attribute_number);
+    return NULL;
+  }
+  const CipAttributeDescriptor *const descriptor =
+    &cip_class->attribute_descriptors[slot - 1];
+
+  CipAttributeStruct *const attribute = storage;
+  attribute->attribute_number = descriptor->attribute_number;
+  attribute->type = descriptor->type;
+  attribute->encode = descriptor->encode;
+  attribute->decode = descriptor->decode;
+  attribute->attribute_flags = descriptor->attribute_flags;
+  attribute->data = (EipUint8 *) instance->data + descriptor->data_offset;
+  attribute->number_of_members = descriptor->number_of_members;
+  return attribute;
+}
+
 CipAttributeStruct *GetCipAttribute(const CipInstance *const instance,
                                     const EipUint16 attribute_number) {
+  return ResolveCipAttribute(instance, attribute_number,
+                             instance->cip_class->resolved_attribute);
+}
+
+CipAttributeStruct *ResolveCipAttribute(const CipInstance *const instance,
+                                        const EipUint16 attribute_number,
+                                        CipAttributeStruct *const storage) {
+
+  if(NULL == instance->attributes &&
+     NULL != instance->cip_class->attribute_descriptors) {
+    return GetCipAttributeFromDescriptor(instance, attribute_number, storage);
+  }
+
+  const CipClass *const cip_class = instance->cip_class;
+  if(NULL != cip_class->attribute_slots &&
+     attribute_number <= cip_class->highest_attribute_number) {
+    const EipUint8 slot = cip_class->attribute_slots[attribute_number];
+    if(0 != slot && slot <= cip_class->number_of_attributes &&
+       attribute_number == instance->attributes[slot - 1].attribute_number) {
+      return &instance->attributes[slot - 1];
+    }
+  }
 
   CipAttributeStruct *attribute = instance->attributes; /* init pointer to array of attributes*/
   for(int i = 0; i < instance->cip_class->number_of_attributes; i++) {
@@ -524,6 +992,51 @@ void GenerateGetAttributeSingleHeader(
   message_router_response->size_of_additional_status = 0;
 }
 
+/** @brief Check the Member ID range of a request against an attribute
+ *
+ * @param attribute attribute addressed by the request
+ * @param request_path decoded path of the request
+ * @param message reply message the members are going to be added to
+ * @return kCipErrorSuccess if the requested members can be encoded
+ */
+static CipError CheckAttributeMembers(const CipAttributeStruct *const attribute,
+                                      const CipEpath *const request_path,
+                                      const ENIPMessage *const message) {
+  const size_t member_size = GetCipDataTypeLength(attribute->type, NULL);
+  if(0 == member_size || 0 == request_path->member_id ||
+     (EipUint32) request_path->member_id + request_path->number_of_members - 1 >
+     attribute->number_of_members) {
+    return kCipErrorInvalidMemberId;
+  }
+  if(member_size * request_path->number_of_members >
+     PC_OPENER_ETHERNET_BUFFER_SIZE - message->used_message_length) {
+    return kCipErrorReplyDataTooLarge;
+  }
+  return kCipErrorSuccess;
+}
+
+/** @brief Encode the requested members of an array attribute
+ *
+ * Each member is encoded with the encode function of the attribute, which
+ * handles one element of the attribute type.
+ *
+ * @param attribute attribute addressed by the request
+ * @param request_path decoded path of the request, already checked with
+ *                     CheckAttributeMembers()
+ * @param outgoing_message reply message
+ */
+static void EncodeAttributeMembers(const CipAttributeStruct *const attribute,
+                                   const CipEpath *const request_path,
+                                   ENIPMessage *const outgoing_message) {
+  const size_t member_size = GetCipDataTypeLength(attribute->type, NULL);
+  const EipUint8 *member = (const EipUint8 *) attribute->data +
+                           (request_path->member_id - 1) * member_size;
+  for(EipUint16 i = 0; i < request_path->number_of_members; i++) {
+    attribute->encode(member, outgoing_message);
+    member += member_size;
+  }
+}
+
 /* TODO this needs to check for buffer overflow*/
 EipStatus GetAttributeSingle(CipInstance *RESTRICT const instance,
                              CipMessageRouterRequest *const message_router_request,
@@ -536,8 +1049,10 @@ EipStatus GetAttributeSingle(CipInstance *RESTRICT const instance,
 
   /* Mask for filtering get-ability */
 
-  CipAttributeStruct *attribute = GetCipAttribute(instance,
-                                                  message_router_request->request_path.attribute_number);
+  CipAttributeStruct resolved_attribute;
+  CipAttributeStruct *attribute = ResolveCipAttribute(instance,
+                                                      message_router_request->request_path.attribute_number,
+                                                      &resolved_attribute);
 
   GenerateGetAttributeSingleHeader(message_router_request,
                                    message_router_response);
@@ -549,7 +1064,18 @@ EipStatus GetAttributeSingle(CipInstance *RESTRICT const instance,
     uint8_t get_bit_mask =
       (instance->cip_class->get_single_bit_mask[CalculateIndex(attribute_number)
        ]);
+    const CipEpath *const request_path = &message_router_request->request_path;
     if( 0 != ( get_bit_mask & ( 1 << (attribute_number % 8) ) ) ) {
+      if(0 != request_path->number_of_members) {
+        message_router_response->general_status =
+          CheckAttributeMembers(attribute, request_path,
+                                &message_router_response->message);
+        if(kCipErrorSuccess != message_router_response->general_status) {
+          OPENER_TRACE_WARN("getAttribute %d: invalid member %d\n",
+                            attribute_number, request_path->member_id);
+          return kEipStatusOkSend;
+        }
+      }
       OPENER_TRACE_INFO("getAttribute %d\n",
                         message_router_request->request_path.attribute_number); /* create a reply message containing the data*/
 
@@ -562,7 +1088,12 @@ EipStatus GetAttributeSingle(CipInstance *RESTRICT const instance,
       }
 
       OPENER_ASSERT(NULL != attribute);
-      attribute->encode(attribute->data, &message_router_response->message);
+      if(0 == request_path->number_of_members) {
+        attribute->encode(attribute->data, &message_router_response->message);
+      } else {
+        EncodeAttributeMembers(attribute, request_path,
+                               &message_router_response->message);
+      }
       message_router_response->general_status = kCipErrorSuccess;
 
       /* Call the PostGetCallback if enabled for this attribute and the class provides one. */
@@ -788,8 +1319,10 @@ EipStatus SetAttributeSingle(CipInstance *RESTRICT const instance,
   (void)originator_address;
   (void)encapsulation_session;
 
-  CipAttributeStruct *attribute = GetCipAttribute(instance,
-                                                  message_router_request->request_path.attribute_number);
+  CipAttributeStruct resolved_attribute;
+  CipAttributeStruct *attribute = ResolveCipAttribute(instance,
+                                                      message_router_request->request_path.attribute_number,
+                                                      &resolved_attribute);
 
   GenerateSetAttributeSingleHeader(message_router_request,
                                    message_router_response);
@@ -808,7 +1341,12 @@ EipStatus SetAttributeSingle(CipInstance *RESTRICT const instance,
     } else {
       uint8_t set_bit_mask =
         (instance->cip_class->set_bit_mask[CalculateIndex(attribute_number)]);
-      if( 0 != ( set_bit_mask & ( 1 << (attribute_number % 8) ) ) ) {
+      if(0 != message_router_request->request_path.number_of_members) {
+        /* members can only be read, a set has to write the whole attribute */
+        message_router_response->general_status = kCipErrorInvalidMemberId;
+        OPENER_TRACE_WARN("SetAttributeSingle: Attribute %d member not setable!\n\r",
+                          attribute_number);
+      } else if( 0 != ( set_bit_mask & ( 1 << (attribute_number % 8) ) ) ) {
         OPENER_TRACE_INFO("setAttribute %d\n", attribute_number);
 
         /* Call the PreSetCallback if enabled for this attribute and the class provides one. */
@@ -1060,15 +1598,12 @@ int DecodeCipShortString(CipShortString *data,
 
 CipServiceStruct *GetCipService(const CipInstance *const instance,
                                 CipUsint service_number) {
-  CipServiceStruct *service = instance->cip_class->services;
-  for(size_t i = 0; i < instance->cip_class->number_of_services; i++) /* hunt for the GET_ATTRIBUTE_SINGLE service*/
-  {
-    if(service->service_number == service_number) {
-      return service; /* found the service */
-    }
-    service++;
+  const CipClass *const cip_class = instance->cip_class;
+  if(service_number >= CIP_SERVICE_INDEX_SIZE ||
+     0 == cip_class->service_index[service_number]) {
+    return NULL; /* didn't find the service */
   }
-  return NULL; /* didn't find the service */
+  return &cip_class->services[cip_class->service_index[service_number] - 1];
 }
 
 EipStatus GetAttributeAll(CipInstance *instance,
@@ -1094,20 +1629,18 @@ EipStatus GetAttributeAll(CipInstance *instance,
     GenerateGetAttributeSingleHeader(message_router_request,
                                      message_router_response);
     message_router_response->general_status = kCipErrorSuccess;
-    /* Iterate through attributes by attribute number (1 to highest_attribute_number)
-     * rather than by array index, to handle missing attributes correctly */
-    for(EipUint16 attr_num = 1; attr_num <= instance->cip_class->highest_attribute_number; attr_num++) {
-      /* Check if this attribute is flagged for GetAttributeAll */
-      if( (instance->cip_class->get_all_bit_mask[CalculateIndex(attr_num)
-           ]) & ( 1 << (attr_num % 8) ) ) {
-        /* Find the attribute by number */
-        CipAttributeStruct *attribute = GetCipAttribute(instance, attr_num);
-        if(attribute != NULL && attribute->data != NULL) {
-          /* only return attributes that are flagged as being part of GetAttributeAll */
-          message_router_request->request_path.attribute_number = attr_num;
-
-          attribute->encode(attribute->data, &message_router_response->message);
-        }
+    /* Iterate through the attributes flagged for GetAttributeAll in
+     * ascending attribute number order, missing attributes are skipped */
+    const CipClass *const cip_class = instance->cip_class;
+    for(EipUint16 i = 0; i < cip_class->number_of_get_all_attributes; i++) {
+      const EipUint16 attr_num = cip_class->get_all_attributes[i];
+      CipAttributeStruct resolved_attribute;
+      CipAttributeStruct *attribute = ResolveCipAttribute(instance, attr_num,
+                                                          &resolved_attribute);
+      if(attribute != NULL && attribute->data != NULL) {
+        message_router_request->request_path.attribute_number = attr_num;
+
+        attribute->encode(attribute->data, &message_router_response->message);
       }
     }
   }
@@ -1135,6 +1668,7 @@ EipStatus GetAttributeList(CipInstance *instance,
   if(0 != attribute_count_request) {
 
     EipUint16 attribute_number = 0;
+    CipAttributeStruct resolved_attribute;
     CipAttributeStruct *attribute = NULL;
 
     CipOctet *attribute_count_responst_position =
@@ -1144,7 +1678,8 @@ EipStatus GetAttributeList(CipInstance *instance,
 
     for(size_t j = 0; j < attribute_count_request; j++) {
       attribute_number = GetUintFromMessage(&message_router_request->data);
-      attribute = GetCipAttribute(instance, attribute_number);
+      attribute = ResolveCipAttribute(instance, attribute_number,
+                                      &resolved_attribute);
 
       const int_fast64_t needed_message_space = NULL != attribute
           ? (int_fast64_t) GetCipDataTypeLength(attribute->type,
@@ -1241,6 +1776,7 @@ EipStatus SetAttributeList(CipInstance *instance,
   if(0 != attribute_count_request) {
 
     EipUint16 attribute_number = 0;
+    CipAttributeStruct resolved_attribute;
     CipAttributeStruct *attribute = NULL;
 
     CipOctet *attribute_count_responst_position =
@@ -1250,7 +1786,8 @@ EipStatus SetAttributeList(CipInstance *instance,
 
     for(size_t j = 0; j < attribute_count_request; j++) {
       attribute_number = GetUintFromMessage(&message_router_request->data);
-      attribute = GetCipAttribute(instance, attribute_number);
+      attribute = ResolveCipAttribute(instance, attribute_number,
+                                      &resolved_attribute);
 
       const int_fast64_t needed_message_space = NULL != attribute
           ? (int_fast64_t) GetCipDataTypeLength(attribute->type,
@@ -1388,6 +1925,31 @@ void EncodeEPath(const void *const data,
     message->used_message_length - start_length);
 }
 
+/** @brief Add a Member ID segment to a decoded EPath
+ *
+ * The first Member ID selects a single member, a second one turns it into
+ * the range of members from the first up to and including the second.
+ *
+ * @param epath EPath being decoded
+ * @param member_id value of the Member ID segment
+ * @return kEipStatusError if the segment does not extend the path sensibly
+ */
+static EipStatus DecodeEPathMember(CipEpath *const epath,
+                                   const EipUint16 member_id) {
+  if(0 == epath->number_of_members) {
+    epath->member_id = member_id;
+    epath->number_of_members = 1;
+    return kEipStatusOk;
+  }
+  if(1 == epath->number_of_members && member_id >= epath->member_id &&
+     member_id - epath->member_id < UINT16_MAX) {
+    epath->number_of_members = member_id - epath->member_id + 1;
+    return kEipStatusOk;
+  }
+  OPENER_TRACE_ERR("unsupported member segment %d\n", member_id);
+  return kEipStatusError;
+}
+
 EipStatus DecodePaddedEPath(CipEpath *epath,
                             const EipUint8 **message,
                             size_t *const bytes_consumed) {
@@ -1401,6 +1963,8 @@ EipStatus DecodePaddedEPath(CipEpath *epath,
   epath->class_id = 0;
   epath->instance_number = 0;
   epath->attribute_number = 0;
+  epath->member_id = 0;
+  epath->number_of_members = 0;
 
   while(number_of_decoded_elements < epath->path_size) {
     if( kSegmentTypeReserved == ( (*message_runner) & kSegmentTypeReserved ) ) {
@@ -1451,11 +2015,19 @@ EipStatus DecodePaddedEPath(CipEpath *epath,
 
       case SEGMENT_TYPE_LOGICAL_SEGMENT + LOGICAL_SEGMENT_TYPE_MEMBER_ID +
         LOGICAL_SEGMENT_FORMAT_EIGHT_BIT:
+        if(kEipStatusOk !=
+           DecodeEPathMember(epath, *(EipUint8 *) (message_runner + 1) ) ) {
+          return kEipStatusError;
+        }
         message_runner += 2;
         break;
       case SEGMENT_TYPE_LOGICAL_SEGMENT + LOGICAL_SEGMENT_TYPE_MEMBER_ID +
         LOGICAL_SEGMENT_FORMAT_SIXTEEN_BIT:
         message_runner += 2;
+        if(kEipStatusOk !=
+           DecodeEPathMember(epath, GetUintFromMessage( &(message_runner) ) ) ) {
+          return kEipStatusError;
+        }
         number_of_decoded_elements++;
         break;
 
@@ -1531,6 +2103,10 @@ EipStatus CipDeleteService(CipInstance *RESTRICT const instance,
 
   CipClass *const class = instance->cip_class;
 
+  if(IsCipVirtualInstance(instance) ) {
+    return kEipStatusOk; /* instances of the virtual range are not deletable */
+  }
+
   /* Call the PreDeleteCallback if the class provides one. */
   if (NULL != class->PreDeleteCallback) {
     internal_state = class->PreDeleteCallback(instance, message_router_request,
@@ -1563,7 +2139,8 @@ EipStatus CipDeleteService(CipInstance *RESTRICT const instance,
                                 message_router_response);
     }
 
-    CipFree(instance);  // delete instance
+    UnindexCipInstance(class, instance);
+    FreeCipInstance(class, instance);  // delete instance
 
     class->number_of_instances--; /* update the total number of instances
                                             recorded by the class - Attr. 3 */
@@ -1618,6 +2195,10 @@ void AllocateAttributeMasks(CipClass *target_class) {
   target_class->get_single_bit_mask = CipCalloc( size, sizeof(uint8_t) );
   target_class->set_bit_mask = CipCalloc( size, sizeof(uint8_t) );
   target_class->get_all_bit_mask = CipCalloc( size, sizeof(uint8_t) );
+  target_class->attribute_slots = CipCalloc(
+    1 + (size_t) target_class->highest_attribute_number, sizeof(EipUint8) );
+  target_class->get_all_attributes = CipCalloc(
+    1 + (size_t) target_class->highest_attribute_number, sizeof(EipUint16) );
 }
 
 size_t CalculateIndex(EipUint16 attribute_number) {
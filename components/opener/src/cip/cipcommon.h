@@ -33,6 +33,15 @@ EipStatus NotifyClass(const CipClass *const RESTRICT cip_class,
                       const struct sockaddr *originator_address,
                       const CipSessionHandle encapsulation_session);
 
+/** @brief Look up a service of the class an instance belongs to
+ *
+ * @param instance instance (or class object) addressed by the request
+ * @param service_number service code of the request
+ * @return the service structure, NULL if the service is not supported
+ */
+CipServiceStruct *GetCipService(const CipInstance *const instance,
+                                CipUsint service_number);
+
 /** @brief Get largest instance_number present in class instances
  *
  * @param cip_class class to be considered
@@ -40,6 +49,18 @@ EipStatus NotifyClass(const CipClass *const RESTRICT cip_class,
  */
 CipUint GetMaxInstanceNumber(CipClass *RESTRICT const cip_class);                      
 
+/** @brief Release the storage of an instance of a class
+ *
+ * Instances created by AddCipInstances() share one memory block per call,
+ * which is freed together with its last instance. The instance has to be
+ * removed from the class' instance list beforehand.
+ *
+ * @param cip_class class the instance belongs to
+ * @param instance instance to be freed
+ */
+void FreeCipInstance(CipClass *RESTRICT const cip_class,
+                     CipInstance *const instance);
+
 void GenerateGetAttributeSingleHeader(
   const CipMessageRouterRequest *const message_router_request,
   CipMessageRouterResponse *const message_router_response);
@@ -78,9 +78,137 @@ typedef struct {
 
 static ConnectionManagerStatistics g_connection_manager_stats = {0};
 
+TimerWheel g_timer_wheel;
+
 /* Dummy data pointer for attribute 9 (Connection Entry List) - dynamically encoded, not used */
 static CipUint g_connection_entry_list_dummy = 0;
 
+/** @brief Number of slots of the active connection indexes, twice the number
+ *  of connections which can be active, so probe sequences stay short and
+ *  always end at a free slot */
+enum {
+  kConnectionIndexSize = 2 * (OPENER_CIP_NUM_EXPLICIT_CONNS +
+                              OPENER_CIP_NUM_INPUT_ONLY_CONNS +
+                              OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS +
+                              OPENER_CIP_NUM_LISTEN_ONLY_CONNS)
+};
+
+/** @brief Hash table of active connections, open addressing with linear
+ *  probing */
+typedef struct {
+  CipConnectionObject *slots[kConnectionIndexSize];
+  size_t number_of_entries; /**< kept below the size, so every probe sequence ends */
+} ConnectionIndex;
+
+/** @brief Active connections by consumed connection ID */
+static ConnectionIndex g_connections_by_consumed_id;
+
+/** @brief Active connections by connection triad */
+static ConnectionIndex g_connections_by_triad;
+
+static size_t ConnectionIndexHash(CipUdint key) {
+  key ^= key >> 16;
+  key *= 0x45D9F3BU;
+  key ^= key >> 16;
+  return key % kConnectionIndexSize;
+}
+
+static size_t ConnectionIdIndexSlot(const CipUdint connection_id) {
+  return ConnectionIndexHash(connection_id);
+}
+
+static size_t ConnectionTriadIndexSlot(const CipUint connection_serial_number,
+                                       const CipUint originator_vendor_id,
+                                       const CipUdint originator_serial_number)
+{
+  return ConnectionIndexHash( ( (CipUdint) originator_vendor_id << 16 |
+                                connection_serial_number ) ^
+                              ConnectionIndexHash(originator_serial_number) );
+}
+
+static size_t ConnectionIdIndexSlotOf(
+  const CipConnectionObject *const connection_object) {
+  return ConnectionIdIndexSlot(connection_object->cip_consumed_connection_id);
+}
+
+static size_t ConnectionTriadIndexSlotOf(
+  const CipConnectionObject *const connection_object) {
+  return ConnectionTriadIndexSlot(connection_object->connection_serial_number,
+                                  connection_object->originator_vendor_id,
+                                  connection_object->originator_serial_number);
+}
+
+/** @brief Get the connection at a slot of an index probe sequence and move to
+ *  the next slot
+ *
+ *  @param index index to probe
+ *  @param slot slot to look at, start with the slot of the searched key
+ *  @return connection sharing the probe sequence with the key, NULL at the end
+ *          of the sequence
+ */
+static CipConnectionObject *ConnectionIndexProbe(
+  const ConnectionIndex *const index,
+  size_t *const slot) {
+  CipConnectionObject *const connection_object = index->slots[*slot];
+  if(NULL != connection_object) {
+    *slot = (*slot + 1) % kConnectionIndexSize;
+  }
+  return connection_object;
+}
+
+static void ConnectionIndexInsert(ConnectionIndex *const index,
+                                  size_t slot,
+                                  CipConnectionObject *const connection_object)
+{
+  if(kConnectionIndexSize - 1 == index->number_of_entries) {
+    OPENER_TRACE_ERR("Active connection index full\n");
+    return;
+  }
+  while(NULL != index->slots[slot]) {
+    slot = (slot + 1) % kConnectionIndexSize;
+  }
+  index->slots[slot] = connection_object;
+  index->number_of_entries++;
+}
+
+/** @brief Take a connection out of an index
+ *
+ *  The entries following it in the probe sequence are moved back into the gap
+ *  if their own slot allows, so no deleted markers are needed and lookups
+ *  still end at the first free slot.
+ */
+static void ConnectionIndexRemove(ConnectionIndex *const index,
+                                  size_t (*const SlotOf)(
+                                    const CipConnectionObject *const),
+                                  const CipConnectionObject *const
+                                  connection_object) {
+  size_t gap = SlotOf(connection_object);
+  while(index->slots[gap] != connection_object) {
+    if(NULL == index->slots[gap]) {
+      return;
+    }
+    gap = (gap + 1) % kConnectionIndexSize;
+  }
+  index->slots[gap] = NULL;
+  index->number_of_entries--;
+
+  for(size_t slot = (gap + 1) % kConnectionIndexSize;
+      NULL != index->slots[slot];
+      slot = (slot + 1) % kConnectionIndexSize) {
+    const size_t home = SlotOf(index->slots[slot]);
+    /* the entry may fill the gap if its home slot is not between the gap and
+     * its current slot */
+    const bool gap_is_on_probe_sequence = (gap < slot) ?
+                                          (home <= gap || home > slot) :
+                                          (home <= gap && home > slot);
+    if(gap_is_on_probe_sequence) {
+      index->slots[gap] = index->slots[slot];
+      index->slots[slot] = NULL;
+      gap = slot;
+    }
+  }
+}
+
 #ifdef OPENER_ESP32_PORT
 /* CPU utilization reporting disabled; always report 0%. */
 void vApplicationIdleHook(void) { }
@@ -855,11 +983,14 @@ EipStatus ForwardClose(CipInstance *instance,
                     originator_vendor_id,
                     originator_serial_number);
 
-  DoublyLinkedListNode *node = connection_list.first;
+  size_t slot = ConnectionTriadIndexSlot(connection_serial_number,
+                                         originator_vendor_id,
+                                         originator_serial_number);
+  CipConnectionObject *connection_object = NULL;
 
-  while(NULL != node) {
+  while(NULL != ( connection_object =
+                    ConnectionIndexProbe(&g_connections_by_triad, &slot) ) ) {
     /* this check should not be necessary as only established connections should be in the active connection list */
-    CipConnectionObject *connection_object = node->data;
     if( (kConnectionObjectStateEstablished ==
          ConnectionObjectGetState(connection_object) )
         || (kConnectionObjectStateTimedOut ==
@@ -883,7 +1014,6 @@ EipStatus ForwardClose(CipInstance *instance,
         break;
       }
     }
-    node = node->next;
   }
   if(kConnectionManagerExtendedStatusCodeErrorConnectionTargetConnectionNotFound
      == connection_status) {
@@ -996,13 +1126,14 @@ EipStatus SearchConnectionData(CipInstance *instance,
     Originator_serial_number);
 
   //search connection
-  DoublyLinkedListNode *iterator = connection_list.first;
+  size_t slot = ConnectionTriadIndexSlot(Connection_serial_number,
+                                         Originator_vendor_id,
+                                         Originator_serial_number);
   CipConnectionObject *search_connection_object = NULL;
   CipConnectionObject *connection_object = NULL;
 
-  while(NULL != iterator) {
-    search_connection_object = iterator->data;
-
+  while(NULL != ( search_connection_object =
+                    ConnectionIndexProbe(&g_connections_by_triad, &slot) ) ) {
     if( (search_connection_object->connection_serial_number ==
          Connection_serial_number)
         && (search_connection_object->originator_vendor_id ==
@@ -1013,7 +1144,6 @@ EipStatus SearchConnectionData(CipInstance *instance,
       connection_object = search_connection_object;
       break;
     }
-    iterator = iterator->next;
   }
   if(NULL != connection_object) {
     /* assemble response message */
@@ -1032,6 +1162,12 @@ EipStatus SearchConnectionData(CipInstance *instance,
 void AssembleConnectionDataResponseMessage(
   CipMessageRouterResponse *message_router_response,
   CipConnectionObject *connection_object) {
+  /* time until the next production, in ms like the former countdown timer */
+  const MicroSeconds now = TimerWheelGetTime(&g_timer_wheel);
+  const CipUdint transmission_trigger_timer =
+    (connection_object->transmission_trigger_deadline > now) ?
+    (CipUdint)( (connection_object->transmission_trigger_deadline - now) /
+                1000U ) : 0;
 
   // Connection number UINT
   AddIntToMessage(connection_object->connection_number,
@@ -1072,7 +1208,7 @@ void AssembleConnectionDataResponseMessage(
   AddDintToMessage(connection_object->o_to_t_requested_packet_interval,
                    &message_router_response->message);
   // Originator API O->T UDINT
-  AddDintToMessage(connection_object->transmission_trigger_timer,
+  AddDintToMessage(transmission_trigger_timer,
                    &message_router_response->message);
   // Originator T->O CID UDINT
   AddDintToMessage(connection_object->cip_produced_connection_id,
@@ -1093,122 +1229,162 @@ void AssembleConnectionDataResponseMessage(
   AddDintToMessage(connection_object->t_to_o_requested_packet_interval,
                    &message_router_response->message);
   // Originator API T->O UDINT
-  AddDintToMessage(connection_object->transmission_trigger_timer,
+  AddDintToMessage(transmission_trigger_timer,
                    &message_router_response->message);
 }
 
-EipStatus ManageConnections(MilliSeconds elapsed_time) {
-  //OPENER_TRACE_INFO("Entering ManageConnections\n");
-  /*Inform application that it can execute */
-  HandleApplication();
-  ManageEncapsulationMessages(elapsed_time);
+/** @brief Check if the inactivity watchdog of a connection has to be supervised */
+static bool ConnectionHasInactivityWatchdog(
+  const CipConnectionObject *const connection_object) {
+  return (NULL != connection_object->consuming_instance) || /* we have a consuming connection check inactivity watchdog timer */
+         (kConnectionObjectTransportClassTriggerDirectionServer ==
+          ConnectionObjectGetTransportClassTriggerDirection(connection_object) ); /* all server connections have to maintain an inactivity watchdog timer */
+}
 
-  DoublyLinkedListNode *node = connection_list.first;
+/** @brief Check if a connection produces data, only true for the master connection */
+static bool ConnectionIsProducing(
+  const CipConnectionObject *const connection_object) {
+  return (0 != ConnectionObjectGetExpectedPacketRate(connection_object) ) &&
+         (kEipInvalidSocket !=
+          connection_object->socket[kUdpCommuncationDirectionProducing]);
+}
 
-  while(NULL != node) {
-    //OPENER_TRACE_INFO("Entering Connection Object loop\n");
-    CipConnectionObject *connection_object = node->data;
-    
-    DoublyLinkedListNode *next_node = node->next;
-
-    /* Clean up stale timed-out connections (grace period expired) */
-    if(kConnectionObjectStateTimedOut ==
-       ConnectionObjectGetState(connection_object)) {
-      /* For multicast connections that timed out, we set inactivity_watchdog_timer
-       * to a grace period (10 seconds). Count it down and clean up when expired. */
-      if(connection_object->inactivity_watchdog_timer > 0) {
-        if(elapsed_time >= connection_object->inactivity_watchdog_timer) {
-          /* Grace period expired - clean up the timed-out connection */
-          OPENER_TRACE_INFO(
-            "Cleaning up stale timed-out connection after grace period (ConnNr: %u)\n",
-            connection_object->connection_serial_number);
-          if(NULL != connection_object->connection_close_function) {
-            connection_object->connection_close_function(connection_object);
-          }
-        } else {
-          connection_object->inactivity_watchdog_timer -= elapsed_time;
-        }
+/** @brief Get the earliest deadline at which a connection has to be handled
+ *
+ * Deadlines moved to a later time do not reschedule the connection, it is
+ * looked at once at the old deadline and scheduled for the new one then.
+ */
+static MicroSeconds GetConnectionTimerDeadline(
+  const CipConnectionObject *const connection_object) {
+  const MicroSeconds kConnectionTimerIdleInterval = 1000000;
+  MicroSeconds deadline = TimerWheelGetTime(&g_timer_wheel) +
+                          kConnectionTimerIdleInterval;
+
+  switch(ConnectionObjectGetState(connection_object) ) {
+    case kConnectionObjectStateTimedOut:
+      deadline = connection_object->inactivity_watchdog_deadline;
+      break;
+    case kConnectionObjectStateEstablished:
+      if(ConnectionHasInactivityWatchdog(connection_object) &&
+         connection_object->inactivity_watchdog_deadline < deadline) {
+        deadline = connection_object->inactivity_watchdog_deadline;
+      }
+      if(ConnectionIsProducing(connection_object) &&
+         connection_object->transmission_trigger_deadline < deadline) {
+        deadline = connection_object->transmission_trigger_deadline;
+      }
+      break;
+    default:
+      break;
+  }
+  return deadline;
+}
+
+/** @brief Timer wheel expiry function of the active connections
+ *
+ * Performs the watchdog time out actions and produces the data of a
+ * connection when its deadlines have been reached.
+ */
+static void HandleConnectionTimer(TimerWheelEntry *const timer_entry) {
+  CipConnectionObject *const connection_object = timer_entry->data;
+  const MicroSeconds now = TimerWheelGetTime(&g_timer_wheel);
+
+  /* keep the connection scheduled while handling it, closing the connection
+   * removes it from the wheel */
+  TimerWheelSchedule(&g_timer_wheel, timer_entry, now + 1);
+
+  /* Clean up stale timed-out connections (grace period expired) */
+  if(kConnectionObjectStateTimedOut ==
+     ConnectionObjectGetState(connection_object) ) {
+    /* For multicast connections that timed out, the inactivity watchdog
+     * deadline is set to the end of a grace period (10 seconds). */
+    if(connection_object->inactivity_watchdog_deadline <= now) {
+      /* Grace period expired - clean up the timed-out connection */
+      OPENER_TRACE_INFO(
+        "Cleaning up stale timed-out connection after grace period (ConnNr: %u)\n",
+        connection_object->connection_serial_number);
+      if(NULL != connection_object->connection_close_function) {
+        connection_object->connection_close_function(connection_object);
+      } else {
+        TimerWheelCancel(timer_entry);
       }
-      /* Skip to next connection - don't process timed-out connections further */
-      node = next_node;
-      continue;
     }
-    
+  } else if(kConnectionObjectStateEstablished ==
+            ConnectionObjectGetState(connection_object) ) {
+    if(ConnectionHasInactivityWatchdog(connection_object) &&
+       connection_object->inactivity_watchdog_deadline <= now) {
+      /* we have a timed out connection perform watchdog time out action*/
+      OPENER_TRACE_INFO(">>>>>>>>>>Connection ConnNr: %u timed out\n",
+                        connection_object->connection_serial_number);
+      g_connection_manager_stats.connection_timeouts++;  /* Increment timeout counter */
+      OPENER_ASSERT(NULL != connection_object->connection_timeout_function);
+      connection_object->connection_timeout_function(connection_object);
+    }
+    /* only if the connection has not timed out check if data is to be send */
     if(kConnectionObjectStateEstablished ==
-       ConnectionObjectGetState(connection_object) ) {
-      if( (NULL != connection_object->consuming_instance) || /* we have a consuming connection check inactivity watchdog timer */
-          (kConnectionObjectTransportClassTriggerDirectionServer ==
-           ConnectionObjectGetTransportClassTriggerDirection(connection_object) ) ) /* all server connections have to maintain an inactivity watchdog timer */
-      {
-        if(elapsed_time >= connection_object->inactivity_watchdog_timer) {
-          /* we have a timed out connection perform watchdog time out action*/
-          OPENER_TRACE_INFO(">>>>>>>>>>Connection ConnNr: %u timed out\n",
-                            connection_object->connection_serial_number);
-          g_connection_manager_stats.connection_timeouts++;  /* Increment timeout counter */
-          OPENER_ASSERT(NULL != connection_object->connection_timeout_function);
-          connection_object->connection_timeout_function(connection_object);
-        } else {
-          connection_object->inactivity_watchdog_timer -= elapsed_time;
-          connection_object->last_package_watchdog_timer -= elapsed_time;
-        }
+       ConnectionObjectGetState(connection_object) &&
+       ConnectionIsProducing(connection_object) &&
+       connection_object->transmission_trigger_deadline <= now) { /* need to send package */
+      OPENER_ASSERT(
+        NULL != connection_object->connection_send_data_function);
+      EipStatus eip_status =
+        connection_object->connection_send_data_function(connection_object);
+      if(eip_status == kEipStatusError) {
+        OPENER_TRACE_ERR(
+          "sending of UDP data in manage Connection failed\n");
       }
-      /* only if the connection has not timed out check if data is to be send */
-      if(kConnectionObjectStateEstablished ==
-         ConnectionObjectGetState(connection_object) ) {
-        /* client connection */
-        if( (0 != ConnectionObjectGetExpectedPacketRate(connection_object) )
-            && (kEipInvalidSocket !=
-                connection_object->socket[kUdpCommuncationDirectionProducing]) ) /* only produce for the master connection */
-        {
-          if(kConnectionObjectTransportClassTriggerProductionTriggerCyclic !=
-             ConnectionObjectGetTransportClassTriggerProductionTrigger(
-               connection_object) ) {
-            /* non cyclic connections have to decrement production inhibit timer */
-            if(elapsed_time <= connection_object->production_inhibit_timer) {
-              //The connection is allowed to send again
-            } else {
-              connection_object->production_inhibit_timer -= elapsed_time;
-            }
-          }
-
-          if(connection_object->transmission_trigger_timer <= elapsed_time) { /* need to send package */
-            OPENER_ASSERT(
-              NULL != connection_object->connection_send_data_function);
-            EipStatus eip_status =
-              connection_object->connection_send_data_function(connection_object);
-            if(eip_status == kEipStatusError) {
-              OPENER_TRACE_ERR(
-                "sending of UDP data in manage Connection failed\n");
-            }
-            /* add the RPI to the timer value */
-            connection_object->transmission_trigger_timer +=
-              ConnectionObjectGetRequestedPacketInterval(connection_object);
-            /* decrecment the elapsed time from timer value, if less than timer value */
-            if (connection_object->transmission_trigger_timer > elapsed_time) {
-              connection_object->transmission_trigger_timer -= elapsed_time;
-            } else {  /* elapsed time was longer than RPI */
-              connection_object->transmission_trigger_timer = 0;
-              OPENER_TRACE_INFO("elapsed time: %lu ms was longer than RPI: %u ms\n",
-                                elapsed_time,
-                                ConnectionObjectGetRequestedPacketInterval(connection_object));
-            }
-            if(kConnectionObjectTransportClassTriggerProductionTriggerCyclic !=
-               ConnectionObjectGetTransportClassTriggerProductionTrigger(
-                 connection_object) ) {
-              /* non cyclic connections have to reload the production inhibit timer */
-              ConnectionObjectResetProductionInhibitTimer(connection_object);
-            }
-          } else {
-            connection_object->transmission_trigger_timer -= elapsed_time;
-          }
-        }
+      /* add the RPI to the deadline, keeping the production phase */
+      connection_object->transmission_trigger_deadline +=
+        ConnectionObjectGetRequestedPacketInterval(connection_object);
+      if(connection_object->transmission_trigger_deadline <= now) { /* elapsed time was longer than RPI */
+        OPENER_TRACE_INFO("production is late by %" PRIu64 " us, RPI: %" PRIu32 " us\n",
+                          (uint64_t) (now - connection_object->transmission_trigger_deadline),
+                          ConnectionObjectGetRequestedPacketInterval(connection_object) );
+        connection_object->transmission_trigger_deadline = now;
+      }
+      if(kConnectionObjectTransportClassTriggerProductionTriggerCyclic !=
+         ConnectionObjectGetTransportClassTriggerProductionTrigger(
+           connection_object) ) {
+        /* non cyclic connections have to reload the production inhibit timer */
+        ConnectionObjectResetProductionInhibitTimer(connection_object);
       }
     }
-    node = node->next;
   }
+
+  if(TimerWheelIsScheduled(timer_entry) ) {
+    TimerWheelSchedule(&g_timer_wheel, timer_entry,
+                       GetConnectionTimerDeadline(connection_object) );
+  }
+}
+
+void UpdateConnectionTimer(CipConnectionObject *const connection_object) {
+  TimerWheelEntry *const timer_entry = &connection_object->timer_entry;
+  if(TimerWheelIsScheduled(timer_entry) ) {
+    const MicroSeconds deadline = GetConnectionTimerDeadline(connection_object);
+    if(deadline < timer_entry->deadline) {
+      TimerWheelSchedule(&g_timer_wheel, timer_entry, deadline);
+    }
+  }
+}
+
+EipStatus ManageConnections(MilliSeconds elapsed_time) {
+  (void) elapsed_time; /* the timers run on ManageConnectionTimers() */
+  //OPENER_TRACE_INFO("Entering ManageConnections\n");
+  /*Inform application that it can execute */
+  HandleApplication();
   return kEipStatusOk;
 }
 
+void ManageConnectionTimers(const MicroSeconds current_time) {
+  /* only the connections, sessions and delayed messages whose deadlines have
+   * been reached are handled */
+  TimerWheelAdvance(&g_timer_wheel, current_time);
+}
+
+MicroSeconds GetNextConnectionTimerDeadline(const MicroSeconds latest_time) {
+  return TimerWheelGetNextDeadline(&g_timer_wheel, latest_time);
+}
+
 /** @brief Assembles the Forward Open Response
  *
  * @param connection_object pointer to connection Object
@@ -1400,16 +1576,18 @@ EipStatus AssembleForwardCloseResponse(EipUint16 connection_serial_number,
 }
 
 CipConnectionObject *GetConnectedObject(const EipUint32 connection_id) {
-  DoublyLinkedListNode *iterator = connection_list.first;
+  size_t slot = ConnectionIdIndexSlot(connection_id);
+  CipConnectionObject *connection_object = NULL;
 
-  while(NULL != iterator) {
+  while(NULL != ( connection_object =
+                    ConnectionIndexProbe(&g_connections_by_consumed_id,
+                                         &slot) ) ) {
     if(kConnectionObjectStateEstablished ==
-       ConnectionObjectGetState(iterator->data)
+       ConnectionObjectGetState(connection_object)
        && connection_id ==
-       ConnectionObjectGetCipConsumedConnectionID(iterator->data) ) {
-      return iterator->data;
+       ConnectionObjectGetCipConsumedConnectionID(connection_object) ) {
+      return connection_object;
     }
-    iterator = iterator->next;
   }
   return NULL;
 }
@@ -1437,16 +1615,17 @@ CipConnectionObject *GetConnectedOutputAssembly(
 CipConnectionObject *CheckForExistingConnection(
   const CipConnectionObject *const connection_object) {
 
-  DoublyLinkedListNode *iterator = connection_list.first;
+  size_t slot = ConnectionTriadIndexSlotOf(connection_object);
+  CipConnectionObject *active_connection = NULL;
 
-  while(NULL != iterator) {
+  while(NULL != ( active_connection =
+                    ConnectionIndexProbe(&g_connections_by_triad, &slot) ) ) {
     if(kConnectionObjectStateEstablished ==
-       ConnectionObjectGetState(iterator->data) ) {
-      if(EqualConnectionTriad(connection_object, iterator->data) ) {
-        return iterator->data;
+       ConnectionObjectGetState(active_connection) ) {
+      if(EqualConnectionTriad(connection_object, active_connection) ) {
+        return active_connection;
       }
     }
-    iterator = iterator->next;
   }
 
   return NULL;
@@ -1888,6 +2067,7 @@ void CloseConnection(CipConnectionObject *RESTRICT connection_object) {
     CloseUdpSocket(connection_object->socket[kUdpCommuncationDirectionProducing]);
     connection_object->socket[kUdpCommuncationDirectionProducing] =
       kEipInvalidSocket;
+    StopProducingUdpData(connection_object);
   }
   RemoveFromActiveConnections(connection_object);
   ConnectionObjectInitializeEmpty(connection_object);
@@ -1896,11 +2076,26 @@ void CloseConnection(CipConnectionObject *RESTRICT connection_object) {
 
 void AddNewActiveConnection(CipConnectionObject *const connection_object) {
   DoublyLinkedListInsertAtHead(&connection_list, connection_object);
+  ConnectionIndexInsert(&g_connections_by_consumed_id,
+                        ConnectionIdIndexSlotOf(connection_object),
+                        connection_object);
+  ConnectionIndexInsert(&g_connections_by_triad,
+                        ConnectionTriadIndexSlotOf(connection_object),
+                        connection_object);
   ConnectionObjectSetState(connection_object,
                            kConnectionObjectStateEstablished);
+  connection_object->timer_entry.expiry_function = HandleConnectionTimer;
+  connection_object->timer_entry.data = connection_object;
+  TimerWheelSchedule(&g_timer_wheel, &connection_object->timer_entry,
+                     GetConnectionTimerDeadline(connection_object) );
 }
 
 void RemoveFromActiveConnections(CipConnectionObject *const connection_object) {
+  TimerWheelCancel(&connection_object->timer_entry);
+  ConnectionIndexRemove(&g_connections_by_consumed_id, ConnectionIdIndexSlotOf,
+                        connection_object);
+  ConnectionIndexRemove(&g_connections_by_triad, ConnectionTriadIndexSlotOf,
+                        connection_object);
   for(DoublyLinkedListNode *iterator = connection_list.first; iterator != NULL;
       iterator = iterator->next) {
     if(iterator->data == connection_object) {
@@ -1966,22 +2161,30 @@ GetConnectionManagementEntry(const EipUint32 class_id) {
 EipStatus TriggerConnections(unsigned int output_assembly,
                              unsigned int input_assembly) {
   EipStatus status = kEipStatusError;
+  const MicroSeconds now = TimerWheelGetTime(&g_timer_wheel);
 
+  /* several input only and listen only connections may share the points */
   DoublyLinkedListNode *node = connection_list.first;
   while(NULL != node) {
     CipConnectionObject *connection_object = node->data;
     if( (output_assembly == connection_object->consumed_path.instance_id) &&
-        (input_assembly == connection_object->produced_path.instance_id) ) {
-      if(
-        kConnectionObjectTransportClassTriggerProductionTriggerApplicationObject
-        == ConnectionObjectGetTransportClassTriggerProductionTrigger(
+        (input_assembly == connection_object->produced_path.instance_id) &&
+        kConnectionObjectStateEstablished ==
+        ConnectionObjectGetState(connection_object) &&
+        kConnectionObjectTransportClassTriggerProductionTriggerCyclic !=
+        ConnectionObjectGetTransportClassTriggerProductionTrigger(
           connection_object) ) {
-        /* produce at the next allowed occurrence */
-        connection_object->transmission_trigger_timer =
-          connection_object->production_inhibit_time;
-        status = kEipStatusOk;
+      /* produce at the next allowed occurrence, the production inhibit time
+       * is reloaded with every production */
+      MicroSeconds deadline = connection_object->production_inhibit_deadline;
+      if(deadline < now) {
+        deadline = now;
       }
-      break;
+      if(deadline < connection_object->transmission_trigger_deadline) {
+        connection_object->transmission_trigger_deadline = deadline;
+        UpdateConnectionTimer(connection_object);
+      }
+      status = kEipStatusOk;
     }
     node = node->next;
   }
@@ -2016,6 +2219,10 @@ void InitializeConnectionManagerData() {
   memset(g_connection_management_list,
          0,
          g_kNumberOfConnectableObjects * sizeof(ConnectionManagementHandling) );
+  TimerWheelInitialize(&g_timer_wheel);
+  memset(&g_connections_by_consumed_id, 0,
+         sizeof(g_connections_by_consumed_id) );
+  memset(&g_connections_by_triad, 0, sizeof(g_connections_by_triad) );
   InitializeClass3ConnectionData();
   InitializeIoConnectionData();
   
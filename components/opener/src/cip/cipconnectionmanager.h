@@ -162,6 +162,13 @@ typedef enum {
 /** @brief Connection Manager class code */
 static const CipUint kCipConnectionManagerClassCode = 0x06U;
 
+/** @brief Timer wheel of the connection manager
+ *
+ *  Advanced by ManageConnectionTimers(), all connection, session and delayed
+ *  message timers are scheduled on it.
+ */
+extern TimerWheel g_timer_wheel;
+
 /* public functions */
 
 /** @brief Initialize the data of the connection manager object
@@ -218,6 +225,15 @@ void AddNewActiveConnection(CipConnectionObject *const connection_object);
  */
 void RemoveFromActiveConnections(CipConnectionObject *const connection_object);
 
+/** @brief Make the connection manager look at a connection again when one of
+ *  its deadlines has been moved forward
+ *
+ *  Has no effect for connections which are not in the active connection list.
+ *
+ * @param connection_object connection whose deadlines have changed
+ */
+void UpdateConnectionTimer(CipConnectionObject *const connection_object);
+
 
 CipUdint GetConnectionId(void);
 
@@ -93,7 +93,7 @@ void CipConnectionObjectListArrayFree(DoublyLinkedListNode **node) {
 }
 
 /* Private methods declaration */
-uint64_t ConnectionObjectCalculateRegularInactivityWatchdogTimerValue(
+MicroSeconds ConnectionObjectCalculateRegularInactivityWatchdogTimerValue(
   const CipConnectionObject *const connection_object);
 
 void ConnectionObjectSetInitialInactivityWatchdogTimerValue(
@@ -442,34 +442,31 @@ CipUint ConnectionObjectGetExpectedPacketRate(
   return connection_object->expected_packet_rate;
 }
 
-CipUint ConnectionObjectGetRequestedPacketInterval(
+CipUdint ConnectionObjectGetRequestedPacketInterval(
   const CipConnectionObject *const connection_object) {
-  CipUdint remainder_to_resolution =
-    (connection_object->t_to_o_requested_packet_interval) %
-    (kOpenerTimerTickInMilliSeconds * 1000);
-  if(0 == remainder_to_resolution) { /* Value can be represented in multiples of the timer resolution */
-    return (CipUint) (connection_object->t_to_o_requested_packet_interval /
-                      1000);
-  } else {
-    return (CipUint) (connection_object->t_to_o_requested_packet_interval /
-                      1000 - remainder_to_resolution / 1000);
+  const CipUdint requested_packet_interval =
+    connection_object->t_to_o_requested_packet_interval;
+  if(requested_packet_interval < kOpenerTimerResolutionInMicroSeconds) {
+    return (CipUdint) kOpenerTimerResolutionInMicroSeconds;
   }
+  return requested_packet_interval -
+         (CipUdint) (requested_packet_interval %
+                     kOpenerTimerResolutionInMicroSeconds);
 }
 
 void ConnectionObjectSetExpectedPacketRate(
   CipConnectionObject *const connection_object) {
+  CipUdint expected_packet_rate =
+    connection_object->t_to_o_requested_packet_interval;
   CipUdint remainder_to_resolution =
-    (connection_object->t_to_o_requested_packet_interval) %
-    (kOpenerTimerTickInMilliSeconds * 1000);
-  if(0 == remainder_to_resolution) { /* Value can be represented in multiples of the timer resolution */
-    connection_object->expected_packet_rate =
-      connection_object->t_to_o_requested_packet_interval / 1000;
-  } else {
-    connection_object->expected_packet_rate =
-      connection_object->t_to_o_requested_packet_interval / 1000
-      + ( (CipUdint)
-          kOpenerTimerTickInMilliSeconds - remainder_to_resolution / 1000 );
+    expected_packet_rate % kOpenerTimerResolutionInMicroSeconds;
+  if(0 != remainder_to_resolution) { /* round up to the next serviceable increment */
+    expected_packet_rate +=
+      (CipUdint) kOpenerTimerResolutionInMicroSeconds - remainder_to_resolution;
   }
+  /* the attribute has a resolution of milliseconds */
+  connection_object->expected_packet_rate =
+    (CipUint) ( (expected_packet_rate + 999) / 1000 );
 }
 
 CipUdint ConnectionObjectGetCipProducedConnectionID(
@@ -584,38 +581,42 @@ void ConnectionObjectSetProductionInhibitTime(
 /*setup the preconsumption timer: max(ConnectionTimeoutMultiplier * ExpectedPacketRate, 10s) */
 void ConnectionObjectSetInitialInactivityWatchdogTimerValue(
   CipConnectionObject *const connection_object) {
-  const uint64_t kMinimumInitialTimeoutValue = 10000;
-  const uint64_t calculated_timeout_value =
+  const MicroSeconds kMinimumInitialTimeoutValue = 10000000;
+  const MicroSeconds calculated_timeout_value =
     ConnectionObjectCalculateRegularInactivityWatchdogTimerValue(
       connection_object);
-  connection_object->inactivity_watchdog_timer =
-    (calculated_timeout_value >
-     kMinimumInitialTimeoutValue) ? calculated_timeout_value :
-    kMinimumInitialTimeoutValue;
+  connection_object->inactivity_watchdog_deadline =
+    TimerWheelGetTime(&g_timer_wheel) +
+    ( (calculated_timeout_value >
+       kMinimumInitialTimeoutValue) ? calculated_timeout_value :
+      kMinimumInitialTimeoutValue);
+  UpdateConnectionTimer(connection_object);
 }
 
 void ConnectionObjectResetInactivityWatchdogTimerValue(
   CipConnectionObject *const connection_object) {
-  connection_object->inactivity_watchdog_timer =
+  connection_object->inactivity_watchdog_deadline =
+    TimerWheelGetTime(&g_timer_wheel) +
     ConnectionObjectCalculateRegularInactivityWatchdogTimerValue(
       connection_object);
+  UpdateConnectionTimer(connection_object);
 }
 
 void ConnectionObjectResetLastPackageInactivityTimerValue(
   CipConnectionObject *const connection_object) {
-  connection_object->last_package_watchdog_timer =
+  connection_object->last_package_watchdog_deadline =
+    TimerWheelGetTime(&g_timer_wheel) +
     ConnectionObjectCalculateRegularInactivityWatchdogTimerValue(
       connection_object);
 }
 
-uint64_t ConnectionObjectCalculateRegularInactivityWatchdogTimerValue(
+MicroSeconds ConnectionObjectCalculateRegularInactivityWatchdogTimerValue(
   const CipConnectionObject *const connection_object) {
   CipUdint packet_interval = connection_object->o_to_t_requested_packet_interval;
   if (connection_object->t_to_o_requested_packet_interval > packet_interval) {
     packet_interval = connection_object->t_to_o_requested_packet_interval;
   }
-  return ( ( (uint64_t)(packet_interval) /
-             (uint64_t) 1000 ) <<
+  return ( (MicroSeconds)(packet_interval) <<
            (2 + connection_object->connection_timeout_multiplier) );
 }
 
@@ -916,8 +917,9 @@ void ConnectionObjectResetSequenceCounts(
 
 void ConnectionObjectResetProductionInhibitTimer(
   CipConnectionObject *const connection_object) {
-  connection_object->production_inhibit_timer =
-    connection_object->production_inhibit_time;
+  connection_object->production_inhibit_deadline =
+    TimerWheelGetTime(&g_timer_wheel) +
+    (MicroSeconds) connection_object->production_inhibit_time * 1000U;
 }
 
 void ConnectionObjectGeneralConfiguration(
@@ -951,7 +953,9 @@ void ConnectionObjectGeneralConfiguration(
 
   ConnectionObjectResetProductionInhibitTimer(connection_object);
 
-  connection_object->transmission_trigger_timer = 0;
+  /* produce with the next tick */
+  connection_object->transmission_trigger_deadline =
+    TimerWheelGetTime(&g_timer_wheel);
 }
 
 bool ConnectionObjectEqualOriginator(const CipConnectionObject *const object1,
@@ -12,6 +12,7 @@
 #include "opener_user_conf.h"
 #include "opener_api.h"
 #include "doublylinkedlist.h"
+#include "timerwheel.h"
 #include "cipelectronickey.h"
 #include "cipepath.h"
 
@@ -135,10 +136,13 @@ struct cip_connection_object {
   CipUint requested_produced_connection_size;
   CipUint requested_consumed_connection_size;
 
-  uint64_t transmission_trigger_timer;
-  uint64_t inactivity_watchdog_timer;
-  uint64_t last_package_watchdog_timer;
-  uint64_t production_inhibit_timer;
+  /* absolute deadlines in microseconds, in the time base of the connection
+   * manager timer wheel */
+  MicroSeconds transmission_trigger_deadline;
+  MicroSeconds inactivity_watchdog_deadline;
+  MicroSeconds last_package_watchdog_deadline;
+  MicroSeconds production_inhibit_deadline;
+  TimerWheelEntry timer_entry; /**< next time the connection has to be looked at, scheduled while in the active connection list */
 
   CipUint connection_serial_number;
   CipUint originator_vendor_id;
@@ -193,6 +197,12 @@ struct cip_connection_object {
   ConnectionReceiveDataFunction connection_receive_data_function;
 
   ENIPMessage last_reply_sent;
+
+  ENIPMessage produced_frame; /**< frame of a producing I/O connection, encoded
+                                 when the connection is opened, a production
+                                 only fills in the sequence counts and the data */
+  size_t produced_frame_data_offset; /**< start of the application data in
+                                        produced_frame */
   CipBool is_large_forward_open;
 };
 
@@ -268,7 +278,13 @@ void ConnectionObjectSetConsumedConnectionSize(
 CipUint ConnectionObjectGetExpectedPacketRate(
   const CipConnectionObject *const connection_object);
 
-CipUint ConnectionObjectGetRequestedPacketInterval(
+/** @brief Get the interval at which the connection produces
+ *
+ * The T->O RPI rounded down to kOpenerTimerResolutionInMicroSeconds
+ *
+ * @return production interval in microseconds, at least the timer resolution
+ */
+CipUdint ConnectionObjectGetRequestedPacketInterval(
   const CipConnectionObject *const connection_object);
 
 /**
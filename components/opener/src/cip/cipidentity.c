@@ -55,36 +55,47 @@ CipIdentityObject g_identity = { .vendor_id = OPENER_DEVICE_VENDOR_ID, /* Attrib
                                  .state = kStateSelfTesting /* Attribute 8: State */
                                  };
 
+/** @brief Drop the cached Identity replies after g_identity changed */
+static void IdentityDataChanged(void) {
+  InvalidateCipResponseCache(GetCipClass(kCipIdentityClassCode) );
+}
+
 /* The Doxygen comment is with the function's prototype in opener_api.h. */
 void SetDeviceRevision(EipUint8 major, EipUint8 minor) {
   g_identity.revision.major_revision = major;
   g_identity.revision.minor_revision = minor;
+  IdentityDataChanged();
 }
 
 /* The Doxygen comment is with the function's prototype in opener_api.h. */
 void SetDeviceSerialNumber(const EipUint32 serial_number) {
   g_identity.serial_number = serial_number;
+  IdentityDataChanged();
 }
 
 /* The Doxygen comment is with the function's prototype in opener_api.h. */
 void SetDeviceType(const EipUint16 type) {
   g_identity.device_type = type;
+  IdentityDataChanged();
 }
 
 /* The Doxygen comment is with the function's prototype in opener_api.h. */
 void SetDeviceProductCode(const EipUint16 code) {
   g_identity.product_code = code;
+  IdentityDataChanged();
 }
 
 /* The Doxygen comment is with the function's prototype in opener_api.h. */
 void SetDeviceStatus(const CipWord status) {
   g_identity.status = status;
   g_identity.ext_status = status & kExtStatusMask;
+  IdentityDataChanged();
 }
 
 /* The Doxygen comment is with the function's prototype in opener_api.h. */
 void SetDeviceVendorId(CipUint vendor_id) {
   g_identity.vendor_id = vendor_id;
+  IdentityDataChanged();
 }
 
 /* The Doxygen comment is with the function's prototype in opener_api.h. */
@@ -98,6 +109,7 @@ void SetDeviceProductName(const char *product_name) {
     return;
 
   SetCipShortStringByCstr(&g_identity.product_name, product_name);
+  IdentityDataChanged();
 }
 
 /* The Doxygen comment is with the function's prototype in opener_api.h. */
@@ -116,6 +128,7 @@ static inline void MergeStatusAndExtStatus(void) {
     ext_status = kMajorFault;
   }
   g_identity.status = status_flags | ext_status;
+  IdentityDataChanged();
 }
 
 /** @brief Set status flags of the device's Status word
@@ -296,5 +309,10 @@ EipStatus CipIdentityInit() {
   InsertService(class, kSetAttributeList, &SetAttributeList,
                 "SetAttributeList");
 
+  /* the Identity data only changes through the setters above */
+  if(kEipStatusOk != EnableCipResponseCache(class, 16) ) {
+    return kEipStatusError;
+  }
+
   return kEipStatusOk;
 }
@@ -62,10 +62,23 @@ void HandleIoConnectionTimeOut(CipConnectionObject *connection_object);
  */
 EipStatus SendConnectedData(CipConnectionObject *connection_object);
 
+/** @brief Encode the frame the connection produces
+ *
+ * Only the sequence counts and the application data change between two
+ * productions, SendConnectedData() fills them into this frame.
+ *      @param connection_object  pointer to the producing connection object
+ */
+void PrepareProducedFrame(CipConnectionObject *const connection_object);
+
 EipStatus HandleReceivedIoConnectionData(CipConnectionObject *connection_object,
                                          const EipUint8 *data,
                                          EipUint16 data_length);
 
+/** @brief Offset of the sequence number in a produced frame, the item count
+ *  and the type, length and connection ID of the sequenced address item
+ *  precede it */
+static const size_t kProducedFrameSequenceNumberOffset = 10;
+
 /**** Global variables ****/
 EipUint8 *g_config_data_buffer = NULL; /**< buffers for the config data coming with a forward open request. */
 unsigned int g_config_data_length = 0; /**< length of g_config_data_buffer. Initialized with 0 */
@@ -102,27 +115,29 @@ bool CipRunIdleHeaderGetT2O(void) {
 
 EipUint16 ProcessProductionInhibitTime(
   CipConnectionObject *io_connection_object) {
+  /* the PIT spaces the productions of change of state and application
+   * triggered connections only, cyclic ones produce at the RPI */
   if( kConnectionObjectTransportClassTriggerProductionTriggerCyclic ==
       ConnectionObjectGetTransportClassTriggerProductionTrigger(
-        io_connection_object) )
-  {
-    if( 256 ==
-        ConnectionObjectGetProductionInhibitTime(io_connection_object) ) {
-      OPENER_TRACE_INFO("No PIT segment available\n");
-      /* there was no PIT segment in the connection path; set PIT to one fourth of RPI */
-      ConnectionObjectSetProductionInhibitTime(io_connection_object,
-                                               ConnectionObjectGetTToORequestedPacketInterval(
-                                                 io_connection_object) / 4000);
-    } else {
-      /* If a production inhibit time is provided, it needs to be smaller than the Requested Packet Interval */
-      if( ConnectionObjectGetProductionInhibitTime(io_connection_object) >
-          (ConnectionObjectGetTToORequestedPacketInterval(io_connection_object)
-           /
-           1000) ) {
-        /* see section C-1.4.3.3 */
-        return
-          kConnectionManagerExtendedStatusCodeProductionInhibitTimerGreaterThanRpi;
-      }
+        io_connection_object) ) {
+    return kConnectionManagerExtendedStatusCodeSuccess;
+  }
+  if( 256 ==
+      ConnectionObjectGetProductionInhibitTime(io_connection_object) ) {
+    OPENER_TRACE_INFO("No PIT segment available\n");
+    /* there was no PIT segment in the connection path; set PIT to one fourth of RPI */
+    ConnectionObjectSetProductionInhibitTime(io_connection_object,
+                                             ConnectionObjectGetTToORequestedPacketInterval(
+                                               io_connection_object) / 4000);
+  } else {
+    /* If a production inhibit time is provided, it must not exceed the
+     * Requested Packet Interval; the PIT is in ms, the RPI in us */
+    if( (CipUdint)ConnectionObjectGetProductionInhibitTime(
+          io_connection_object) * 1000U >
+        ConnectionObjectGetTToORequestedPacketInterval(io_connection_object) ) {
+      /* see section C-1.4.3.3 */
+      return
+        kConnectionManagerExtendedStatusCodeProductionInhibitTimerGreaterThanRpi;
     }
   }
   return kConnectionManagerExtendedStatusCodeSuccess;
@@ -395,6 +410,11 @@ CipError EstablishIoConnection(
     return cip_error;
   }
 
+  if(target_to_originator_connection_type !=
+     kConnectionObjectConnectionTypeNull) {
+    PrepareProducedFrame(io_connection_object);
+  }
+
   AddNewActiveConnection(io_connection_object);
   CheckIoConnectionEvent(io_connection_object->consumed_path.instance_id,
                          io_connection_object->produced_path.instance_id,
@@ -744,6 +764,7 @@ static int transfer_master_connection(CipConnectionObject *connection_object) {
   }
 
   OPENER_TRACE_INFO("Transferring socket ownership\n");
+  StopProducingUdpData(connection_object);
   active->socket[kUdpCommuncationDirectionProducing] =
     connection_object->socket[kUdpCommuncationDirectionProducing];
   connection_object->socket[kUdpCommuncationDirectionProducing] =
@@ -755,8 +776,9 @@ static int transfer_master_connection(CipConnectionObject *connection_object) {
     connection_object->eip_level_sequence_count_producing;
   active->sequence_count_producing =
     connection_object->sequence_count_producing;
-  active->transmission_trigger_timer =
-    connection_object->transmission_trigger_timer;
+  active->transmission_trigger_deadline =
+    connection_object->transmission_trigger_deadline;
+  UpdateConnectionTimer(active);
 
   return 0;
 }
@@ -809,8 +831,8 @@ void HandleIoConnectionTimeOut(CipConnectionObject *connection_object) {
                          kIoConnectionEventTimedOut);
   ConnectionObjectSetState(connection_object, kConnectionObjectStateTimedOut);
 
-  if(connection_object->last_package_watchdog_timer ==
-     connection_object->inactivity_watchdog_timer) {
+  if(connection_object->last_package_watchdog_deadline ==
+     connection_object->inactivity_watchdog_deadline) {
     CheckForTimedOutConnectionsAndCloseTCPConnections(connection_object,
                                                       CloseEncapsulationSessionBySockAddr);
   }
@@ -861,45 +883,78 @@ void HandleIoConnectionTimeOut(CipConnectionObject *connection_object) {
     CloseCommunicationChannelsAndRemoveFromActiveConnectionsList(connection_object);
   } else {
     /* Multicast with handover - set timer for delayed cleanup (10 seconds grace period) */
-    connection_object->inactivity_watchdog_timer = 10000; /* 10 seconds in milliseconds */
+    connection_object->inactivity_watchdog_deadline =
+      TimerWheelGetTime(&g_timer_wheel) + 10000000; /* 10 seconds in microseconds */
+    UpdateConnectionTimer(connection_object);
   }
 }
 
-EipStatus SendConnectedData(CipConnectionObject *connection_object) {
-
-  /* TODO think of adding an own send buffer to each connection object in order to preset up the whole message on connection opening and just change the variable data items e.g., sequence number */
-
-  CipCommonPacketFormatData *common_packet_format_data =
-    &g_common_packet_format_data_item;
-  /* TODO think on adding a CPF data item to the S_CIP_ConnectionObject in order to remove the code here or even better allocate memory in the connection object for storing the message to send and just change the application data*/
-
-  connection_object->eip_level_sequence_count_producing++;
+void PrepareProducedFrame(CipConnectionObject *const connection_object) {
+  CipCommonPacketFormatData common_packet_format_data = { 0 };
+  CipByteArray *producing_instance_attributes =
+    (CipByteArray *) connection_object->producing_instance->attributes->data;
+  const bool is_class_1 =
+    kConnectionObjectTransportClassTriggerTransportClass1 ==
+    ConnectionObjectGetTransportClassTriggerTransportClass(connection_object);
 
-  /* assembleCPFData */
-  common_packet_format_data->item_count = 2;
+  common_packet_format_data.item_count = 2;
   if( kConnectionObjectTransportClassTriggerTransportClass0 !=
       ConnectionObjectGetTransportClassTriggerTransportClass(connection_object) )
   /* use Sequenced Address Items if not Connection Class 0 */
   {
-    common_packet_format_data->address_item.type_id =
+    common_packet_format_data.address_item.type_id =
       kCipItemIdSequencedAddressItem;
-    common_packet_format_data->address_item.length = 8;
-    common_packet_format_data->address_item.data.sequence_number =
-      connection_object->eip_level_sequence_count_producing;
+    common_packet_format_data.address_item.length = 8;
   } else {
-    common_packet_format_data->address_item.type_id =
+    common_packet_format_data.address_item.type_id =
       kCipItemIdConnectionAddress;
-    common_packet_format_data->address_item.length = 4;
-
+    common_packet_format_data.address_item.length = 4;
   }
-  common_packet_format_data->address_item.data.connection_identifier =
+  common_packet_format_data.address_item.data.connection_identifier =
     connection_object->cip_produced_connection_id;
+  common_packet_format_data.data_item.type_id = kCipItemIdConnectedDataItem;
+  common_packet_format_data.data_item.length =
+    producing_instance_attributes->length + (is_class_1 ? 2 : 0);
+  common_packet_format_data.data_item.data =
+    producing_instance_attributes->data;
+
+  ENIPMessage *const produced_frame = &connection_object->produced_frame;
+  InitializeENIPMessage(produced_frame);
+  /* the connected data item is encoded without its data, the class 1
+   * sequence count and the application data follow */
+  const EipUint16 data_length = common_packet_format_data.data_item.length;
+  common_packet_format_data.data_item.length = 0;
+  AssembleIOMessage(&common_packet_format_data, produced_frame);
+  MoveMessageNOctets(-2, produced_frame);
+  AddIntToMessage(data_length, produced_frame);
+  if(is_class_1) {
+    AddIntToMessage(0, produced_frame);
+  }
+  connection_object->produced_frame_data_offset =
+    produced_frame->used_message_length;
+  OPENER_ASSERT(produced_frame->used_message_length +
+                producing_instance_attributes->length <=
+                sizeof(produced_frame->message_buffer) );
+  MoveMessageNOctets(producing_instance_attributes->length, produced_frame);
+}
 
-  common_packet_format_data->data_item.type_id = kCipItemIdConnectedDataItem;
+/** @brief Overwrite a value already encoded into the produced frame */
+static void UpdateProducedFrameValue(CipOctet *const position,
+                                     const CipUdint value,
+                                     const size_t size) {
+  for(size_t i = 0; i < size; i++) {
+    position[i] = (CipOctet) (value >> (8 * i) );
+  }
+}
 
+EipStatus SendConnectedData(CipConnectionObject *connection_object) {
+  ENIPMessage *const produced_frame = &connection_object->produced_frame;
+  CipOctet *const data = produced_frame->message_buffer +
+                         connection_object->produced_frame_data_offset;
   CipByteArray *producing_instance_attributes =
     (CipByteArray *) connection_object->producing_instance->attributes->data;
-  common_packet_format_data->data_item.length = 0;
+
+  connection_object->eip_level_sequence_count_producing++;
 
   /* notify the application that data will be sent immediately after the call */
   if( BeforeAssemblyDataSend(connection_object->producing_instance) ) {
@@ -907,41 +962,25 @@ EipStatus SendConnectedData(CipConnectionObject *connection_object) {
     connection_object->sequence_count_producing++;
   }
 
-  /* set AddressInfo Items to invalid Type */
-  common_packet_format_data->address_info_item[0].type_id = 0;
-  common_packet_format_data->address_info_item[1].type_id = 0;
-
-  ENIPMessage outgoing_message;
-  InitializeENIPMessage(&outgoing_message);
-  AssembleIOMessage(common_packet_format_data, &outgoing_message);
-
-  MoveMessageNOctets(-2, &outgoing_message);
-  common_packet_format_data->data_item.length =
-    producing_instance_attributes->length;
-
-  if( kConnectionObjectTransportClassTriggerTransportClass1 ==
-      ConnectionObjectGetTransportClassTriggerTransportClass(connection_object) )
-  {
-    common_packet_format_data->data_item.length += 2;
-    AddIntToMessage(common_packet_format_data->data_item.length,
-                    &outgoing_message);
-    AddIntToMessage(connection_object->sequence_count_producing,
-                    &outgoing_message);
-  } else {
-    AddIntToMessage(common_packet_format_data->data_item.length,
-                    &outgoing_message);
+  const ConnectionObjectTransportClassTriggerTransportClass transport_class =
+    ConnectionObjectGetTransportClassTriggerTransportClass(connection_object);
+  if(kConnectionObjectTransportClassTriggerTransportClass0 != transport_class) {
+    UpdateProducedFrameValue(produced_frame->message_buffer +
+                             kProducedFrameSequenceNumberOffset,
+                             connection_object->eip_level_sequence_count_producing,
+                             sizeof(CipUdint) );
+  }
+  if(kConnectionObjectTransportClassTriggerTransportClass1 == transport_class) {
+    UpdateProducedFrameValue(data - 2,
+                             connection_object->sequence_count_producing,
+                             sizeof(CipUint) );
   }
 
-  memcpy(outgoing_message.current_message_position,
+  memcpy(data,
          producing_instance_attributes->data,
          producing_instance_attributes->length);
 
-  outgoing_message.current_message_position +=
-    producing_instance_attributes->length;
-  outgoing_message.used_message_length += producing_instance_attributes->length;
-
-  return SendUdpData(&connection_object->remote_address,
-                     &outgoing_message);
+  return ProduceUdpData(connection_object, produced_frame);
 }
 
 EipStatus HandleReceivedIoConnectionData(CipConnectionObject *connection_object,
@@ -1066,6 +1105,7 @@ void CloseCommunicationChannelsAndRemoveFromActiveConnectionsList(
   if(kEipInvalidSocket !=
      connection_object->socket[kUdpCommuncationDirectionProducing]) {
     CloseUdpSocket(connection_object->socket[kUdpCommuncationDirectionProducing]);
+    StopProducingUdpData(connection_object);
   }
 
   RemoveFromActiveConnections(connection_object);
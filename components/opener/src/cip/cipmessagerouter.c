@@ -3,6 +3,8 @@
  * All rights reserved.
  *
  ******************************************************************************/
+#include <string.h>
+
 #include "opener_api.h"
 #include "cipcommon.h"
 #include "endianconv.h"
@@ -14,6 +16,23 @@
 
 CipMessageRouterRequest g_message_router_request;
 
+/** @brief Bytes needed next to a Multiple Service Packet reply in the Ethernet
+ *  buffer: encapsulation header (24), CPF with connected address and
+ *  sequence count items (22) and the message router reply header (4) */
+#define CIP_MULTIPLE_SERVICE_REPLY_OVERHEAD 50
+
+/** @brief Smallest embedded reply: service, reserved, general status and
+ *  additional status size */
+#define CIP_EMBEDDED_REPLY_HEADER_SIZE 4
+
+/** @brief Largest embedded reply without data: header and the additional
+ *  status words */
+#define CIP_EMBEDDED_STATUS_REPLY_MAX_SIZE \
+  (CIP_EMBEDDED_REPLY_HEADER_SIZE + sizeof(CipUint) * MAX_SIZE_OF_ADD_STATUS)
+
+/** @brief Reply buffer for the requests embedded in a Multiple Service Packet */
+static CipMessageRouterResponse g_embedded_message_router_response;
+
 /** @brief A class registry list node
  *
  * A linked list of this  object is the registry of classes known to the message router
@@ -29,6 +48,14 @@ typedef struct cip_message_router_object {
 /** @brief Pointer to first registered object in MessageRouter*/
 CipMessageRouterObject *g_first_object = NULL;
 
+/** @brief Number of class codes resolved through g_class_table, covers all
+ *  8 bit logical class segments */
+#define CIP_CLASS_TABLE_SIZE 256
+
+/** @brief Registered objects indexed by class code; classes with larger
+ *  class codes are only found in the g_first_object list */
+static CipMessageRouterObject *g_class_table[CIP_CLASS_TABLE_SIZE];
+
 /** @brief Register a CIP Class to the message router
  *  @param cip_class Pointer to a class object to be registered.
  *  @return kEipStatusOk on success
@@ -87,7 +114,7 @@ EipStatus CipMessageRouterInit() {
                                             2, /* # of class services */
                                             0, /* # of instance attributes */
                                             0, /* # highest instance attribute number */
-                                            1, /* # of instance services */
+                                            2, /* # of instance services */
                                             1, /* # of instances */
                                             "message router", /* class name */
                                             1, /* # class revision*/
@@ -99,6 +126,10 @@ EipStatus CipMessageRouterInit() {
                 kGetAttributeSingle,
                 &GetAttributeSingle,
                 "GetAttributeSingle");
+  InsertService(message_router,
+                kMultipleServicePacket,
+                &MultipleServicePacket,
+                "MultipleServicePacket");
 
   /* reserved for future use -> set to zero */
   return kEipStatusOk;
@@ -112,6 +143,9 @@ EipStatus CipMessageRouterInit() {
  *      NULL .. Class not registered
  */
 CipMessageRouterObject *GetRegisteredObject(EipUint32 class_id) {
+  if(class_id < CIP_CLASS_TABLE_SIZE) {
+    return g_class_table[class_id];
+  }
   CipMessageRouterObject *object = g_first_object; /* get pointer to head of class registration list */
 
   while(NULL != object) /* for each entry in list*/
@@ -138,11 +172,43 @@ CipClass *GetCipClass(const CipUdint class_code) {
 
 CipInstance *GetCipInstance(const CipClass *RESTRICT const cip_class,
                             const CipInstanceNum instance_number) {
+  return ResolveCipInstance(cip_class, instance_number,
+                            cip_class->virtual_instance);
+}
+
+CipInstance *ResolveCipInstance(const CipClass *RESTRICT const cip_class,
+                                const CipInstanceNum instance_number,
+                                CipInstance *const storage) {
 
   if(instance_number == 0) {
     return (CipInstance *) cip_class; /* if the instance number is zero, return the class object itself*/
 
   }
+  if(instance_number <= cip_class->instance_index_size) {
+    CipInstance *instance = cip_class->instance_index[instance_number - 1];
+    if(NULL != instance) {
+      return instance;
+    }
+  }
+  if(instance_number >= cip_class->first_virtual_instance &&
+     instance_number - cip_class->first_virtual_instance <
+     cip_class->number_of_virtual_instances) {
+    CipInstance *instance = storage;
+    instance->instance_number = instance_number;
+    instance->attributes = NULL;
+    instance->cip_class = (CipClass *) cip_class;
+    instance->next = NULL;
+    instance->data = cip_class->virtual_instance_data +
+                     (size_t)(instance_number -
+                              cip_class->first_virtual_instance) *
+                     cip_class->virtual_instance_stride;
+    return instance;
+  }
+  if(cip_class->number_of_indexed_instances +
+     cip_class->number_of_virtual_instances ==
+     cip_class->number_of_instances) {
+    return NULL; /* every instance is indexed or virtual, no need to search the list */
+  }
   /* pointer to linked list of instances from the class object*/
   for(CipInstance *instance = cip_class->instances; instance;
       instance = instance->next)                                                         /* follow the list*/
@@ -155,6 +221,15 @@ CipInstance *GetCipInstance(const CipClass *RESTRICT const cip_class,
   return NULL;
 }
 
+bool IsCipVirtualInstance(const CipInstance *const instance) {
+  const CipClass *const cip_class = instance->cip_class;
+  /* real instances never share a number with the virtual range */
+  return 0 != instance->instance_number &&
+         instance->instance_number >= cip_class->first_virtual_instance &&
+         instance->instance_number - cip_class->first_virtual_instance <
+         cip_class->number_of_virtual_instances;
+}
+
 EipStatus RegisterCipClass(CipClass *cip_class) {
   CipMessageRouterObject **message_router_object = &g_first_object;
 
@@ -170,6 +245,9 @@ EipStatus RegisterCipClass(CipClass *cip_class) {
   }
   (*message_router_object)->cip_class = cip_class; /* fill in the new node*/
   (*message_router_object)->next = NULL;
+  if(cip_class->class_code < CIP_CLASS_TABLE_SIZE) {
+    g_class_table[cip_class->class_code] = *message_router_object;
+  }
 
   return kEipStatusOk;
 }
@@ -240,6 +318,188 @@ EipStatus NotifyMessageRouter(EipUint8 *data,
   return eip_status;
 }
 
+/** @brief Append an embedded reply consisting of the header only
+ *
+ * @param service service code of the embedded request
+ * @param general_status status of the embedded reply
+ * @param message reply message of the Multiple Service Packet
+ */
+static void AddEmbeddedErrorReply(const CipUsint service,
+                                  const CipUsint general_status,
+                                  ENIPMessage *const message) {
+  AddSintToMessage(0x80 | service, message);
+  AddSintToMessage(0, message); /* reserved */
+  AddSintToMessage(general_status, message);
+  AddSintToMessage(0, message); /* no additional status */
+}
+
+EipStatus MultipleServicePacket(CipInstance *RESTRICT const instance,
+                                CipMessageRouterRequest *const message_router_request,
+                                CipMessageRouterResponse *const message_router_response,
+                                const struct sockaddr *originator_address,
+                                const CipSessionHandle encapsulation_session) {
+  /* Suppress unused parameter compiler warning. */
+  (void) instance;
+
+  ENIPMessage *const message = &message_router_response->message;
+  InitializeENIPMessage(message);
+  message_router_response->reply_service =
+    (0x80 | message_router_request->service);
+  message_router_response->general_status = kCipErrorSuccess;
+  message_router_response->size_of_additional_status = 0;
+
+  const CipOctet *const request_data = message_router_request->data;
+  const size_t request_data_size = message_router_request->request_data_size;
+  if(request_data_size < sizeof(CipUint) ) {
+    message_router_response->general_status = kCipErrorNotEnoughData;
+    return kEipStatusOkSend;
+  }
+  const CipOctet *data = request_data;
+  const CipUint number_of_services = GetUintFromMessage(&data);
+  const size_t offset_table_end = sizeof(CipUint) *
+                                  (1 + (size_t)number_of_services);
+  if(0 == number_of_services || request_data_size < offset_table_end) {
+    message_router_response->general_status = kCipErrorNotEnoughData;
+    return kEipStatusOkSend;
+  }
+
+  /* the offsets of the embedded requests have to be ascending and in range */
+  CipUint previous_offset = 0;
+  for(CipUint i = 0; i < number_of_services; i++) {
+    const CipUint offset = GetUintFromMessage(&data);
+    if(offset < offset_table_end || offset <= previous_offset ||
+       offset >= request_data_size) {
+      message_router_response->general_status = kCipErrorInvalidParameter;
+      return kEipStatusOkSend;
+    }
+    previous_offset = offset;
+  }
+
+  const size_t reply_limit = PC_OPENER_ETHERNET_BUFFER_SIZE -
+                             CIP_MULTIPLE_SERVICE_REPLY_OVERHEAD;
+  if(offset_table_end + CIP_EMBEDDED_REPLY_HEADER_SIZE *
+     (size_t)number_of_services > reply_limit) {
+    message_router_response->general_status = kCipErrorReplyDataTooLarge;
+    return kEipStatusOkSend;
+  }
+
+  AddIntToMessage(number_of_services, message);
+  CipOctet *offset_table_position = message->current_message_position;
+  MoveMessageNOctets(sizeof(CipUint) * number_of_services, message);
+
+  bool reply_buffer_full = false;
+  for(CipUint i = 0; i < number_of_services; i++) {
+    const CipOctet *offset_data = request_data + sizeof(CipUint) * (1 + i);
+    const CipUint offset = GetUintFromMessage(&offset_data);
+    const size_t next_offset = (i + 1 < number_of_services) ?
+                               GetUintFromMessage(&offset_data) :
+                               request_data_size;
+    const CipOctet *const embedded_request_data = request_data + offset;
+    const CipUsint embedded_service = *embedded_request_data;
+
+    /* fill in the offset of this reply */
+    CipOctet *const save_current_position = message->current_message_position;
+    const size_t save_used_message_length = message->used_message_length;
+    message->current_message_position = offset_table_position;
+    AddIntToMessage( (CipUint) save_used_message_length, message );
+    offset_table_position = message->current_message_position;
+    message->current_message_position = save_current_position;
+    message->used_message_length = save_used_message_length;
+
+    if(reply_buffer_full) {
+      AddEmbeddedErrorReply(embedded_service, kCipErrorReplyDataTooLarge,
+                            message);
+      continue;
+    }
+
+    CipMessageRouterRequest embedded_request;
+    CipMessageRouterResponse *const embedded_response =
+      &g_embedded_message_router_response;
+    /* the services initialize the message themselves, only reset it here */
+    embedded_response->message.current_message_position =
+      embedded_response->message.message_buffer;
+    embedded_response->message.used_message_length = 0;
+    embedded_response->reply_service = (0x80 | embedded_service);
+    embedded_response->reserved = 0;
+    embedded_response->general_status = kCipErrorSuccess;
+    embedded_response->size_of_additional_status = 0;
+
+    CipError status = CreateMessageRouterRequestStructure(
+      embedded_request_data, (EipInt16) (next_offset - offset),
+      &embedded_request);
+    if(kCipErrorSuccess == status &&
+       kMultipleServicePacket == embedded_request.service) {
+      status = kCipErrorServiceNotSupported; /* no nesting */
+    }
+    CipMessageRouterObject *registered_object = NULL;
+    if(kCipErrorSuccess == status) {
+      registered_object =
+        GetRegisteredObject(embedded_request.request_path.class_id);
+      if(NULL == registered_object) {
+        status = kCipErrorPathDestinationUnknown;
+      }
+    }
+    if(kCipErrorSuccess != status) {
+      AddEmbeddedErrorReply(embedded_service, status, message);
+      message_router_response->general_status = kCipErrorEmbeddedServiceError;
+      continue;
+    }
+
+    /* leave room for the minimal replies of the remaining requests */
+    const size_t reply_space = reply_limit - message->used_message_length -
+                               CIP_EMBEDDED_REPLY_HEADER_SIZE *
+                               (size_t)(number_of_services - i - 1);
+    if(reply_space < CIP_EMBEDDED_STATUS_REPLY_MAX_SIZE) {
+      /* not even a status reply fits, the request is not executed */
+      reply_buffer_full = true;
+      AddEmbeddedErrorReply(embedded_service, kCipErrorReplyDataTooLarge,
+                            message);
+      message_router_response->general_status = kCipErrorEmbeddedServiceError;
+      continue;
+    }
+
+    NotifyClass(registered_object->cip_class,
+                &embedded_request,
+                embedded_response,
+                originator_address,
+                encapsulation_session);
+
+    /* only a reply carrying data can be too large here; the service has been
+     * executed, services with side effects reply with a status only */
+    const size_t reply_length = CIP_EMBEDDED_REPLY_HEADER_SIZE +
+                                sizeof(CipUint) *
+                                embedded_response->size_of_additional_status +
+                                embedded_response->message.used_message_length;
+    if(reply_length > reply_space) {
+      reply_buffer_full = true;
+      AddEmbeddedErrorReply(embedded_service, kCipErrorReplyDataTooLarge,
+                            message);
+      message_router_response->general_status = kCipErrorEmbeddedServiceError;
+      continue;
+    }
+
+    AddSintToMessage(embedded_response->reply_service, message);
+    AddSintToMessage(0, message); /* reserved */
+    AddSintToMessage(embedded_response->general_status, message);
+    AddSintToMessage(embedded_response->size_of_additional_status, message);
+    for(size_t j = 0; j < embedded_response->size_of_additional_status &&
+        j < MAX_SIZE_OF_ADD_STATUS; j++) {
+      AddIntToMessage(embedded_response->additional_status[j], message);
+    }
+    memcpy(message->current_message_position,
+           embedded_response->message.message_buffer,
+           embedded_response->message.used_message_length);
+    MoveMessageNOctets(embedded_response->message.used_message_length,
+                       message);
+
+    if(kCipErrorSuccess != embedded_response->general_status) {
+      message_router_response->general_status = kCipErrorEmbeddedServiceError;
+    }
+  }
+
+  return kEipStatusOkSend;
+}
+
 CipError CreateMessageRouterRequestStructure(const EipUint8 *data,
                                              EipInt16 data_length,
                                              CipMessageRouterRequest *message_router_request)
@@ -282,11 +542,8 @@ void DeleteAllClasses(void) {
     while(NULL != instance) {
       instance_to_delete = instance;
       instance = instance->next;
-      if(message_router_object_to_delete->cip_class->number_of_attributes) /* if the class has instance attributes */
-      { /* then free storage for the attribute array */
-        CipFree(instance_to_delete->attributes);
-      }
-      CipFree(instance_to_delete);
+      FreeCipInstance(message_router_object_to_delete->cip_class,
+                      instance_to_delete);
     }
 
     /* free meta class data*/
@@ -297,6 +554,8 @@ void DeleteAllClasses(void) {
     CipFree(meta_class->get_single_bit_mask);
     CipFree(meta_class->set_bit_mask);
     CipFree(meta_class->get_all_bit_mask);
+    CipFree(meta_class->attribute_slots);
+    CipFree(meta_class->get_all_attributes);
     CipFree(meta_class);
 
     /* free class data*/
@@ -305,11 +564,18 @@ void DeleteAllClasses(void) {
     CipFree(cip_class->get_single_bit_mask);
     CipFree(cip_class->set_bit_mask);
     CipFree(cip_class->get_all_bit_mask);
+    CipFree(cip_class->attribute_slots);
+    CipFree(cip_class->get_all_attributes);
     CipFree(cip_class->class_instance.attributes);
     CipFree(cip_class->services);
+    CipFree(cip_class->response_cache);
+    CipFree(cip_class->instance_index);
+    CipFree(cip_class->virtual_instance);
+    CipFree(cip_class->resolved_attribute);
     CipFree(cip_class);
     /* free message router object */
     CipFree(message_router_object_to_delete);
   }
   g_first_object = NULL;
+  memset(g_class_table, 0, sizeof(g_class_table) );
 }
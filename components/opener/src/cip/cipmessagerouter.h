@@ -40,6 +40,29 @@ EipStatus NotifyMessageRouter(EipUint8 *data,
                               const struct sockaddr *const originator_address,
                               const CipSessionHandle encapsulation_session);
 
+/** @brief Multiple Service Packet service of the message router instance
+ *
+ *  Each embedded request is routed through the normal NotifyClass() path and
+ *  its reply is appended to the reply, preceded by the offset table. A request
+ *  is only executed if at least a status reply still fits into the Ethernet
+ *  buffer. If the data of a reply does not fit, the reply is replaced by one
+ *  with status "reply data too large"; the service has been executed then,
+ *  which is harmless for the services replying with data, the Get services.
+ *  The remaining requests are not executed and answered with the same
+ *  status.
+ *  @param instance message router instance
+ *  @param message_router_request request containing the embedded requests
+ *  @param message_router_response reply holding the embedded replies
+ *  @param originator_address address struct of the originator as received
+ *  @param encapsulation_session associated encapsulation session of the explicit message
+ *  @return kEipStatusOkSend
+ */
+EipStatus MultipleServicePacket(CipInstance *RESTRICT const instance,
+                                CipMessageRouterRequest *const message_router_request,
+                                CipMessageRouterResponse *const message_router_response,
+                                const struct sockaddr *originator_address,
+                                const CipSessionHandle encapsulation_session);
+
 /*! Register a class at the message router.
  *  In order that the message router can deliver
  *  explicit messages each class has to register.
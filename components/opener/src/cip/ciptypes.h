@@ -231,6 +231,10 @@ typedef struct {
   EipUint16 class_id;   /**< Class ID of the linked object */
   CipInstanceNum instance_number;   /**< Requested Instance Number of the linked object */
   EipUint16 attribute_number;   /**< Requested Attribute Number of the linked object */
+  EipUint16 member_id;   /**< First requested Member of the attribute, starting at 1 */
+  EipUint16 number_of_members;   /**< Number of requested Members, 0 if the
+                                    whole attribute is addressed. A second
+                                    Member ID segment ends a Member range. */
 } CipEpath;
 
 typedef enum connection_point_type {
@@ -271,6 +275,8 @@ typedef struct {
 
 #define MAX_SIZE_OF_ADD_STATUS 2 /* for now we support extended status codes up to 2 16bit values there is mostly only one 16bit value used */
 
+#define CIP_SERVICE_INDEX_SIZE 0x80 /* request service codes are 7 bit wide, bit 7 marks the reply */
+
 typedef struct enip_message ENIPMessage;
 
 /** @brief CIP Message Router Response
@@ -306,12 +312,32 @@ typedef int (*CipAttributeDecodeFromMessage)(void *const data,
 typedef struct {
   EipUint16 attribute_number;   /**< The attribute number of this attribute. */
   EipUint8 type;   /**< The @ref CipDataType of this attribute. */
+  EipUint8 number_of_members;   /**< Number of array elements of the @ref type
+                                   addressable by Member ID, 0 if none; takes
+                                   the padding byte after @ref type */
   CipAttributeEncodeInMessage encode;   /**< Self-describing its data encoding */
   CipAttributeDecodeFromMessage decode;   /**< Self-describing its data decoding */
   CIPAttributeFlag attribute_flags;   /**< See @ref CIPAttributeFlag declaration for valid values. */
   void *data;
 } CipAttributeStruct;
 
+/** @brief Structure to describe a CIP attribute shared by all instances of a class
+ *
+ * Instead of a data pointer the descriptor holds the offset of the attribute
+ * value from the data of the instance (CipInstance::data), so one constant
+ * table can serve any number of instances.
+ */
+typedef struct {
+  EipUint16 attribute_number;   /**< The attribute number of this attribute. */
+  EipUint8 type;   /**< The @ref CipDataType of this attribute. */
+  EipUint8 number_of_members;   /**< Number of array elements of the @ref type
+                                   addressable by Member ID, 0 if none */
+  CipAttributeEncodeInMessage encode;   /**< Self-describing its data encoding */
+  CipAttributeDecodeFromMessage decode;   /**< Self-describing its data decoding */
+  CIPAttributeFlag attribute_flags;   /**< See @ref CIPAttributeFlag declaration for valid values. */
+  size_t data_offset;   /**< offset of the value from the instance data */
+} CipAttributeDescriptor;
+
 /** @brief Type definition of one instance of an Ethernet/IP object
  *
  *  All instances are stored in a linked list that originates from the CipClass::instances
@@ -363,6 +389,12 @@ typedef EipStatus (*CipCallback)(CipInstance *const instance,
                                  CipMessageRouterResponse *const
                                  message_router_response);
 
+/** @brief Counters of a class' response cache */
+typedef struct {
+  CipUdint hits;   /**< requests answered from the cache */
+  CipUdint misses;   /**< cacheable requests passed to the service */
+} CipResponseCacheCounters;
+
 /** @brief Type definition of CipClass that is a subclass of CipInstance */
 typedef struct cip_class {
   CipInstance class_instance;   /**< This is the instance that contains the
@@ -380,10 +412,48 @@ typedef struct cip_class {
   uint8_t *get_single_bit_mask;   /**< bit mask for GetAttributeSingle */
   uint8_t *set_bit_mask;   /**< bit mask for SetAttributeSingle */
   uint8_t *get_all_bit_mask;   /**< bit mask for GetAttributeAll */
+  EipUint8 *attribute_slots;   /**< entry n holds the position + 1 of
+                                  attribute n in the attribute arrays of the
+                                  instances or in attribute_descriptors, 0 if
+                                  not known */
+  EipUint16 *get_all_attributes;   /**< numbers of the GetAttributeAll
+                                      attributes in ascending order */
+  EipUint16 number_of_get_all_attributes;   /**< entries in get_all_attributes */
 
   EipUint16 number_of_services;   /**< number of services supported */
   CipInstance *instances;   /**< pointer to the list of instances */
+  CipInstance **instance_index;   /**< direct lookup table, entry n - 1 holds
+                                     instance n or NULL */
+  CipInstanceNum instance_index_size;   /**< number of entries in instance_index */
+  CipInstanceNum number_of_indexed_instances;   /**< instances reachable via
+                                                   instance_index; instances too
+                                                   sparse to index are only found
+                                                   in the instances list */
+  struct cip_instance_slab *instance_slabs;   /**< memory blocks the instances
+                                                were allocated from */
+  const CipAttributeDescriptor *attribute_descriptors;   /**< attributes of
+                                                           instances without an
+                                                           own attribute array */
+  EipUint16 number_of_attribute_descriptors;   /**< entries in attribute_descriptors */
+  CipAttributeStruct *resolved_attribute;   /**< attribute returned by
+                                               GetCipAttribute() for a
+                                               descriptor */
+  CipInstanceNum first_virtual_instance;   /**< first instance number of the
+                                              range backed by virtual_instance_data */
+  CipInstanceNum number_of_virtual_instances;   /**< size of the virtual
+                                                   instance range, 0 if none */
+  EipUint8 *virtual_instance_data;   /**< data of the first virtual instance */
+  size_t virtual_instance_stride;   /**< distance between the data of two
+                                       consecutive virtual instances */
+  CipInstance *virtual_instance;   /**< instance returned by GetCipInstance()
+                                      for an instance of the virtual range */
   struct cip_service_struct *services;   /**< pointer to the array of services */
+  struct cip_response_cache *response_cache;   /**< cached replies, NULL if
+                                                the class does not cache */
+  EipUint8 service_index[CIP_SERVICE_INDEX_SIZE];   /**< entry n holds the
+                                                      position in services + 1
+                                                      of service n, 0 if the
+                                                      service is not supported */
   char *class_name;   /**< class name */
   /** Is called in GetAttributeSingle* before the response is assembled from
    * the object's attributes */
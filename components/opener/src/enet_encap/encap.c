@@ -64,7 +64,7 @@ typedef enum {
 
 /** @brief Delayed Encapsulation Message structure */
 typedef struct {
-  EipInt32 time_out; /**< time out in milli seconds */
+  TimerWheelEntry timer_entry; /**< sends the message when expired */
   int socket; /**< associated socket */
   struct sockaddr_in receiver;
   ENIPMessage outgoing_message;
@@ -72,7 +72,12 @@ typedef struct {
 
 EncapsulationServiceInformation g_service_information;
 
-int g_registered_sessions[OPENER_NUMBER_OF_SUPPORTED_SESSIONS];
+/** @brief pool of OPENER_NUMBER_OF_SUPPORTED_SESSIONS TCP connection records,
+ *  allocated with the first connection */
+static EncapsulationSession *g_encapsulation_sessions;
+
+/** @brief index + 1 of the record of each socket, 0 if the socket has none */
+static CipUsint g_encapsulation_session_by_socket[FD_SETSIZE];
 
 DelayedEncapsulationMessage g_delayed_encapsulation_messages[ENCAP_NUMBER_OF_SUPPORTED_DELAYED_ENCAP_MESSAGES];
 
@@ -90,12 +95,16 @@ EipStatus HandleReceivedSendUnitDataCommand(const EncapsulationData *const recei
 
 EipStatus HandleReceivedInvalidCommand(const EncapsulationData *const receive_data, ENIPMessage *const outgoing_message);
 
-int GetFreeSessionIndex(void);
+static void ReleaseEncapsulationSession(EncapsulationSession *const session);
 
 SessionStatus CheckRegisteredSessions(const EncapsulationData *const receive_data);
 
 void DetermineDelayTime(const EipByte *buffer_start, DelayedEncapsulationMessage *const delayed_message_buffer);
 
+static void SendDelayedEncapsulationMessage(TimerWheelEntry *const timer_entry);
+
+static void HandleEncapsulationInactivityTimer(TimerWheelEntry *const timer_entry);
+
 /*   @brief Initializes session list and interface information. */
 void EncapsulationInit(void) {
 
@@ -105,13 +114,13 @@ void EncapsulationInit(void) {
    * we use the ip address as seed as suggested in the spec */
   srand(g_tcpip.interface_configuration.ip_address);
 
-  /* initialize Sessions to invalid == free session */
-  for(size_t i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; i++) {
-    g_registered_sessions[i] = kEipInvalidSocket;
-  }
+  OPENER_ASSERT(OPENER_NUMBER_OF_SUPPORTED_SESSIONS < 256); /* fits the socket table */
 
   for(size_t i = 0; i < ENCAP_NUMBER_OF_SUPPORTED_DELAYED_ENCAP_MESSAGES; i++) {
+    memset(&g_delayed_encapsulation_messages[i], 0, sizeof(g_delayed_encapsulation_messages[i]));
     g_delayed_encapsulation_messages[i].socket = kEipInvalidSocket;
+    g_delayed_encapsulation_messages[i].timer_entry.expiry_function = SendDelayedEncapsulationMessage;
+    g_delayed_encapsulation_messages[i].timer_entry.data = &g_delayed_encapsulation_messages[i];
   }
 
   /*TODO make the service information configurable*/
@@ -413,7 +422,15 @@ void DetermineDelayTime(const EipByte *buffer_start, DelayedEncapsulationMessage
     maximum_delay_time = kListIdentityMinimumDelayTime;
   }
 
-  delayed_message_buffer->time_out = rand() % maximum_delay_time;
+  TimerWheelSchedule(&g_timer_wheel, &delayed_message_buffer->timer_entry, TimerWheelGetTime(&g_timer_wheel) + (MicroSeconds) (rand() % maximum_delay_time) * 1000U);
+}
+
+/** @brief Send a delayed message once its delay has passed */
+static void SendDelayedEncapsulationMessage(TimerWheelEntry *const timer_entry) {
+  DelayedEncapsulationMessage *const delayed_message = timer_entry->data;
+  sendto(delayed_message->socket, (char*) delayed_message->outgoing_message.message_buffer, delayed_message->outgoing_message.used_message_length, 0,
+    (struct sockaddr*) &(delayed_message->receiver), sizeof(struct sockaddr));
+  delayed_message->socket = kEipInvalidSocket;
 }
 
 void EncapsulateRegisterSessionCommandResponseMessage(const EncapsulationData *const receive_data, const CipSessionHandle session_handle,
@@ -433,7 +450,6 @@ void EncapsulateRegisterSessionCommandResponseMessage(const EncapsulationData *c
  * @param receive_data Pointer to received data with request/response.
  */
 void HandleReceivedRegisterSessionCommand(int socket, const EncapsulationData *const receive_data, ENIPMessage *const outgoing_message) {
-  int session_index = 0;
   CipSessionHandle session_handle = 0;
   EncapsulationProtocolErrorCode encapsulation_protocol_status = kEncapsulationProtocolSuccess;
 
@@ -442,34 +458,35 @@ void HandleReceivedRegisterSessionCommand(int socket, const EncapsulationData *c
 
   /* check if requested protocol version is supported and the register session option flag is zero*/
   if((0 < protocol_version) && (protocol_version <= kSupportedProtocolVersion) && (0 == option_flag)) { /*Option field should be zero*/
-    /* check if the socket has already a session open */
-    for(unsigned int i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; ++i) {
-      if(g_registered_sessions[i] == socket) {
-        /* the socket has already registered a session this is not allowed*/
-        OPENER_TRACE_INFO(
-            "Error: A session is already registered at socket %d\n",
-            socket);
-        session_handle = i + 1; /*return the already assigned session back, the cip spec is not clear about this needs to be tested*/
-        encapsulation_protocol_status = kEncapsulationProtocolInvalidCommand;
-        session_index = kSessionStatusInvalid;
-        break;
-      }
+    /* the record is normally created on accept */
+    EncapsulationSession *session = GetEncapsulationSession(socket);
+    if(NULL == session) {
+      session = CreateEncapsulationSession(socket, NULL);
     }
 
-    if(kSessionStatusInvalid != session_index) {
-      session_index = GetFreeSessionIndex();
-      if(kSessionStatusInvalid == session_index) /* no more sessions available */
-      {
-        encapsulation_protocol_status = kEncapsulationProtocolInsufficientMemory;
-      } else { /* successful session registered */
-        SocketTimer *socket_timer = SocketTimerArrayGetEmptySocketTimer(g_timestamps,
-        OPENER_NUMBER_OF_SUPPORTED_SESSIONS);
-        SocketTimerSetSocket(socket_timer, socket);
-        SocketTimerSetLastUpdate(socket_timer, g_actual_time);
-        g_registered_sessions[session_index] = socket; /* store associated socket */
-        session_handle = (CipSessionHandle)(session_index + 1);
-        encapsulation_protocol_status = kEncapsulationProtocolSuccess;
+    if(NULL == session) { /* no more sessions available */
+      encapsulation_protocol_status = kEncapsulationProtocolInsufficientMemory;
+    } else if(0 != session->session_handle) {
+      /* the socket has already registered a session this is not allowed*/
+      OPENER_TRACE_INFO(
+          "Error: A session is already registered at socket %d\n",
+          socket);
+      session_handle = session->session_handle; /*return the already assigned session back, the cip spec is not clear about this needs to be tested*/
+      encapsulation_protocol_status = kEncapsulationProtocolInvalidCommand;
+    } else { /* successful session registered */
+      SocketTimer *socket_timer = SocketTimerArrayGetEmptySocketTimer(g_timestamps,
+      OPENER_NUMBER_OF_SUPPORTED_SESSIONS);
+      SocketTimerSetSocket(socket_timer, socket);
+      SocketTimerSetLastUpdate(socket_timer, g_actual_time);
+      session->socket_timer = socket_timer;
+      session->session_handle = (CipSessionHandle)(session - g_encapsulation_sessions + 1);
+      if(NULL != socket_timer) {
+        session->inactivity_timer_entry.expiry_function = HandleEncapsulationInactivityTimer;
+        session->inactivity_timer_entry.data = session;
+        TimerWheelSchedule(&g_timer_wheel, &session->inactivity_timer_entry, TimerWheelGetTime(&g_timer_wheel) + 1);
       }
+      session_handle = session->session_handle;
+      encapsulation_protocol_status = kEncapsulationProtocolSuccess;
     }
   } else { /* protocol not supported */
     encapsulation_protocol_status = kEncapsulationProtocolUnsupportedProtocol;
@@ -488,13 +505,13 @@ void HandleReceivedRegisterSessionCommand(int socket, const EncapsulationData *c
  */
 EipStatus HandleReceivedUnregisterSessionCommand(const EncapsulationData *const receive_data, ENIPMessage *const outgoing_message) {
   OPENER_TRACE_INFO("encap.c: Unregister Session Command\n");
-  if((0 < receive_data->session_handle) && (receive_data->session_handle <=
+  if((NULL != g_encapsulation_sessions) && (0 < receive_data->session_handle) && (receive_data->session_handle <=
   OPENER_NUMBER_OF_SUPPORTED_SESSIONS)) {
-    CipSessionHandle i = receive_data->session_handle - 1;
-    if(kEipInvalidSocket != g_registered_sessions[i]) {
-      CloseTcpSocket(g_registered_sessions[i]);
-      g_registered_sessions[i] = kEipInvalidSocket;
-      CloseClass3ConnectionBasedOnSession(i + 1);
+    EncapsulationSession *session = &g_encapsulation_sessions[receive_data->session_handle - 1];
+    if(0 != session->session_handle) {
+      CloseTcpSocket(session->socket);
+      ReleaseEncapsulationSession(session);
+      CloseClass3ConnectionBasedOnSession(receive_data->session_handle);
       return kEipStatusOk;
     }
   }
@@ -573,17 +590,75 @@ EipStatus HandleReceivedInvalidCommand(const EncapsulationData *const receive_da
 
 }
 
-/** @brief search for available sessions an return index.
- *  @return return index of free session in anRegisteredSessions.
- *                      kInvalidSession .. no free session available
- */
-int GetFreeSessionIndex(void) {
-  for(int session_index = 0; session_index < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; session_index++) {
-    if(kEipInvalidSocket == g_registered_sessions[session_index]) {
-      return session_index;
+EncapsulationSession *CreateEncapsulationSession(const int socket,
+                                                 const struct sockaddr *const peer_address) {
+  if(0 > socket || FD_SETSIZE <= socket) {
+    return NULL;
+  }
+  if(NULL == g_encapsulation_sessions) {
+    g_encapsulation_sessions = (EncapsulationSession*) CipCalloc(OPENER_NUMBER_OF_SUPPORTED_SESSIONS, sizeof(EncapsulationSession));
+    if(NULL == g_encapsulation_sessions) {
+      return NULL;
+    }
+    for(size_t i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; i++) {
+      g_encapsulation_sessions[i].socket = kEipInvalidSocket;
+      InitializeENIPMessage(&g_encapsulation_sessions[i].outgoing_message);
     }
   }
-  return kSessionStatusInvalid;
+
+  EncapsulationSession *session = GetEncapsulationSession(socket);
+  if(NULL != session) { /* the socket number was reused without the old record being removed */
+    RemoveSession(socket);
+  }
+  for(size_t i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; i++) {
+    if(kEipInvalidSocket == g_encapsulation_sessions[i].socket) {
+      session = &g_encapsulation_sessions[i];
+      break;
+    }
+  }
+  if(NULL == session) {
+    return NULL;
+  }
+
+  session->socket = socket;
+  memset(&session->peer_address, 0, sizeof(session->peer_address));
+  if(NULL != peer_address) {
+    session->peer_address = *peer_address;
+  } else {
+    socklen_t address_length = sizeof(session->peer_address);
+    if(getpeername(socket, &session->peer_address, &address_length) < 0) { /* got error */
+      int error_code = GetSocketErrorNumber();
+      char *error_message = GetErrorMessage(error_code);
+      OPENER_TRACE_ERR(
+          "encap.c: could not get peer name of socket %d: %d - %s\n",
+          socket, error_code, error_message);
+      FreeErrorMessage(error_message);
+    }
+  }
+  g_encapsulation_session_by_socket[socket] = (CipUsint)(session - g_encapsulation_sessions + 1);
+  return session;
+}
+
+EncapsulationSession *GetEncapsulationSession(const int socket) {
+  if(0 > socket || FD_SETSIZE <= socket || 0 == g_encapsulation_session_by_socket[socket]) {
+    return NULL;
+  }
+  return &g_encapsulation_sessions[g_encapsulation_session_by_socket[socket] - 1];
+}
+
+/** @brief Return the record of a TCP connection to the pool
+ *
+ *  Any partially received packet is dropped, the socket itself is not closed.
+ *  @param session record to be released
+ */
+static void ReleaseEncapsulationSession(EncapsulationSession *const session) {
+  TimerWheelCancel(&session->inactivity_timer_entry);
+  g_encapsulation_session_by_socket[session->socket] = 0;
+  session->socket = kEipInvalidSocket;
+  session->session_handle = 0;
+  session->socket_timer = NULL;
+  session->used_length = 0;
+  session->bytes_to_discard = 0;
 }
 
 /** @brief copy data from pa_buf in little endian to host in structure.
@@ -632,9 +707,9 @@ SessionStatus CheckRegisteredSessions(const EncapsulationData *const receive_dat
   return kSessionStatusValid;
 #endif
 
-  if((0 < receive_data->session_handle) && (receive_data->session_handle <=
+  if((NULL != g_encapsulation_sessions) && (0 < receive_data->session_handle) && (receive_data->session_handle <=
   OPENER_NUMBER_OF_SUPPORTED_SESSIONS)) {
-    if(kEipInvalidSocket != g_registered_sessions[receive_data->session_handle - 1]) {
+    if(0 != g_encapsulation_sessions[receive_data->session_handle - 1].session_handle) {
       return kSessionStatusValid;
     }
   }
@@ -644,86 +719,104 @@ SessionStatus CheckRegisteredSessions(const EncapsulationData *const receive_dat
 void CloseSessionBySessionHandle(const CipConnectionObject *const connection_object) {
   OPENER_TRACE_INFO("encap.c: Close session by handle\n");
   CipSessionHandle session_handle = connection_object->associated_encapsulation_session;
-  CloseTcpSocket(g_registered_sessions[session_handle - 1]);
-  g_registered_sessions[session_handle - 1] = kEipInvalidSocket;
+  if((NULL != g_encapsulation_sessions) && (0 < session_handle) && (session_handle <= OPENER_NUMBER_OF_SUPPORTED_SESSIONS)
+    && (0 != g_encapsulation_sessions[session_handle - 1].session_handle)) {
+    EncapsulationSession *session = &g_encapsulation_sessions[session_handle - 1];
+    CloseTcpSocket(session->socket);
+    ReleaseEncapsulationSession(session);
+  }
   OPENER_TRACE_INFO("encap.c: Close session by handle done\n");
 }
 
 void CloseSession(int socket) {
   OPENER_TRACE_INFO("encap.c: Close session\n");
-  for(unsigned int i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; ++i) {
-    if(g_registered_sessions[i] == socket) {
-      CloseTcpSocket(socket);
-      g_registered_sessions[i] = kEipInvalidSocket;
-      CloseClass3ConnectionBasedOnSession(i + 1);
-      break;
-    }
+  EncapsulationSession *session = GetEncapsulationSession(socket);
+  if(NULL != session && 0 != session->session_handle) {
+    CipSessionHandle session_handle = session->session_handle;
+    CloseTcpSocket(socket);
+    ReleaseEncapsulationSession(session);
+    CloseClass3ConnectionBasedOnSession(session_handle);
   }OPENER_TRACE_INFO("encap.c: Close session done\n");
 }
 
 void RemoveSession(const int socket) {
   OPENER_TRACE_INFO("encap.c: Removing session\n");
-  for(unsigned int i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; ++i) {
-    if(g_registered_sessions[i] == socket) {
-      g_registered_sessions[i] = kEipInvalidSocket;
-      CloseClass3ConnectionBasedOnSession(i + 1);
-      break;
+  EncapsulationSession *session = GetEncapsulationSession(socket);
+  if(NULL != session) {
+    CipSessionHandle session_handle = session->session_handle;
+    ReleaseEncapsulationSession(session);
+    if(0 != session_handle) {
+      CloseClass3ConnectionBasedOnSession(session_handle);
     }
   }OPENER_TRACE_INFO("encap.c: Session removed\n");
 }
 
 void EncapsulationShutDown(void) {
   OPENER_TRACE_INFO("encap.c: Encapsulation shutdown\n");
+  for(size_t i = 0; i < ENCAP_NUMBER_OF_SUPPORTED_DELAYED_ENCAP_MESSAGES; i++) {
+    TimerWheelCancel(&g_delayed_encapsulation_messages[i].timer_entry);
+    g_delayed_encapsulation_messages[i].socket = kEipInvalidSocket;
+  }
+  if(NULL == g_encapsulation_sessions) {
+    return;
+  }
   for(size_t i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; ++i) {
-    if(kEipInvalidSocket != g_registered_sessions[i]) {
-      CloseTcpSocket(g_registered_sessions[i]);
-      g_registered_sessions[i] = kEipInvalidSocket;
+    if(kEipInvalidSocket != g_encapsulation_sessions[i].socket) {
+      if(0 != g_encapsulation_sessions[i].session_handle) {
+        CloseTcpSocket(g_encapsulation_sessions[i].socket);
+      }
+      ReleaseEncapsulationSession(&g_encapsulation_sessions[i]);
     }
   }
+  CipFree(g_encapsulation_sessions);
+  g_encapsulation_sessions = NULL;
 }
 
-void ManageEncapsulationMessages(const MilliSeconds elapsed_time) {
-  for(size_t i = 0; i < ENCAP_NUMBER_OF_SUPPORTED_DELAYED_ENCAP_MESSAGES; i++) {
-    if(kEipInvalidSocket != g_delayed_encapsulation_messages[i].socket) {
-      g_delayed_encapsulation_messages[i].time_out -= elapsed_time;
-      if(0 >= g_delayed_encapsulation_messages[i].time_out) {
-        /* If delay is reached or passed, send the UDP message */
-        sendto(g_delayed_encapsulation_messages[i].socket, (char*) g_delayed_encapsulation_messages[i].outgoing_message.message_buffer,
-          g_delayed_encapsulation_messages[i].outgoing_message.used_message_length, 0, (struct sockaddr*) &(g_delayed_encapsulation_messages[i].receiver),
-          sizeof(struct sockaddr));
-        g_delayed_encapsulation_messages[i].socket = kEipInvalidSocket;
-      }
-    }
+/** @brief Close a session when the encapsulation inactivity timeout has passed
+ *  since its last packet
+ *
+ *  While the timeout is disabled the setting is looked at again every second.
+ */
+static void HandleEncapsulationInactivityTimer(TimerWheelEntry *const timer_entry) {
+  EncapsulationSession *const session = timer_entry->data;
+  const MicroSeconds kDisabledTimeoutCheckInterval = 1000000;
+  const MilliSeconds timeout = 1000UL * g_tcpip.encapsulation_inactivity_timeout;
+  const MicroSeconds now = TimerWheelGetTime(&g_timer_wheel);
+
+  if(0 == timeout) {
+    TimerWheelSchedule(&g_timer_wheel, timer_entry, now + kDisabledTimeoutCheckInterval);
+    return;
+  }
+
+  const MilliSeconds diff_milliseconds = g_actual_time - SocketTimerGetLastUpdate(session->socket_timer);
+  if(diff_milliseconds < timeout) {
+    TimerWheelSchedule(&g_timer_wheel, timer_entry, now + (MicroSeconds) (timeout - diff_milliseconds) * 1000U);
+    return;
   }
+
+  const int socket = session->socket;
+  CloseClass3ConnectionBasedOnSession(session->session_handle);
+  CloseTcpSocket(socket);
+  RemoveSession(socket);
 }
 
 void CloseEncapsulationSessionBySockAddr(const CipConnectionObject *const connection_object) {
+  if(NULL == g_encapsulation_sessions) {
+    return;
+  }
   for(size_t i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; ++i) {
-    if(kEipInvalidSocket != g_registered_sessions[i]) {
-      struct sockaddr_in encapsulation_session_addr = { 0 };
-      socklen_t addrlength = sizeof(encapsulation_session_addr);
-      if(getpeername(g_registered_sessions[i], (struct sockaddr*) &encapsulation_session_addr, &addrlength) < 0) { /* got error */
-        int error_code = GetSocketErrorNumber();
-        char *error_message = GetErrorMessage(error_code);
-        OPENER_TRACE_ERR(
-            "encap.c: error on getting peer name on closing session: %d - %s\n",
-            error_code, error_message);
-        FreeErrorMessage(error_message);
-      }
-      if(encapsulation_session_addr.sin_addr.s_addr == connection_object->originator_address.sin_addr.s_addr) {
-        CloseSession(g_registered_sessions[i]);
+    if(0 != g_encapsulation_sessions[i].session_handle) {
+      const struct sockaddr_in *encapsulation_session_addr = (const struct sockaddr_in*) &g_encapsulation_sessions[i].peer_address;
+      if(encapsulation_session_addr->sin_addr.s_addr == connection_object->originator_address.sin_addr.s_addr) {
+        CloseSession(g_encapsulation_sessions[i].socket);
       }
     }
   }
 }
 
 CipSessionHandle GetSessionFromSocket(const int socket_handle) {
-  for(CipSessionHandle i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; ++i) {
-    if(socket_handle == g_registered_sessions[i]) {
-      return i;
-    }
-  }
-  return OPENER_NUMBER_OF_SUPPORTED_SESSIONS;
+  const EncapsulationSession *const session = GetEncapsulationSession(socket_handle);
+  return NULL != session ? session->session_handle : 0;
 }
 
 void CloseClass3ConnectionBasedOnSession(CipSessionHandle encapsulation_session_handle) {
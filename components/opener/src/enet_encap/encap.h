@@ -9,6 +9,7 @@
 #include "typedefs.h"
 #include "cipconnectionobject.h"
 #include "generic_networkhandler.h"
+#include "enipmessage.h"
 
 /** @file encap.h
  * @brief This file contains the public interface of the encapsulation layer
@@ -22,6 +23,11 @@
 
 #define ENCAPSULATION_HEADER_LENGTH     24
 
+/** @brief Size of the receive buffer of a TCP connection, holds at least one
+ *  encapsulation packet of the maximum accepted size
+ */
+#define ENCAPSULATION_TCP_RECEIVE_BUFFER_SIZE PC_OPENER_ETHERNET_BUFFER_SIZE
+
 /** @brief definition of status codes in encapsulation protocol
  * All other codes are either legacy codes, or reserved for future use
  *  */
@@ -47,6 +53,26 @@ typedef struct encapsulation_data {
   const EipUint8 *current_communication_buffer_position; /**< The current position in the communication buffer during the decoding process */
 } EncapsulationData;
 
+/** @brief Record of an established TCP connection
+ *
+ *  The record is created when the connection is accepted, or when a session is
+ *  registered on a connection without one. It caches everything needed per
+ *  received packet and is found by socket or by session handle in constant
+ *  time. The handle of a session registered on the connection is the index of
+ *  the record + 1. The buffers are neither allocated nor cleared per packet.
+ */
+typedef struct encapsulation_session {
+  int socket; /**< socket of the connection, kEipInvalidSocket if unused */
+  CipSessionHandle session_handle; /**< handle of the registered session, 0 if none */
+  struct sockaddr peer_address; /**< address of the originator */
+  SocketTimer *socket_timer; /**< inactivity timer of the registered session */
+  TimerWheelEntry inactivity_timer_entry; /**< encapsulation inactivity timeout of the registered session */
+  size_t used_length; /**< received bytes not handled yet */
+  size_t bytes_to_discard; /**< rest of a dropped too large packet */
+  CipOctet receive_buffer[ENCAPSULATION_TCP_RECEIVE_BUFFER_SIZE]; /**< received data */
+  ENIPMessage outgoing_message; /**< reply, handed to send() as it is */
+} EncapsulationSession;
+
 typedef struct encapsulation_service_information {
   EipUint16 type_code;
   EipUint16 length;
@@ -71,14 +97,29 @@ void EncapsulationInit(void);
 void EncapsulationShutDown(void);
 
 /** @ingroup ENCAP
- * @brief Handle delayed encapsulation message responses
+ * @brief Create the record of a new TCP connection
+ *
+ * @param socket socket of the connection, below FD_SETSIZE
+ * @param peer_address address of the originator, NULL to look it up
+ * @return the record, NULL if no record is available
+ */
+EncapsulationSession *CreateEncapsulationSession(const int socket,
+                                                 const struct sockaddr *const peer_address);
+
+/** @ingroup ENCAP
+ * @brief Get the record of a TCP connection
  *
- * Certain encapsulation message requests require a delayed sending of the response
- * message. This functions checks if messages need to be sent and performs the
- * sending.
+ * @param socket socket of the connection
+ * @return the record, NULL if the socket has none
  */
-void ManageEncapsulationMessages(const MilliSeconds elapsed_time);
+EncapsulationSession *GetEncapsulationSession(const int socket);
 
+/** @ingroup ENCAP
+ * @brief Get the handle of the session registered on a TCP connection
+ *
+ * @param socket_handle socket of the connection
+ * @return the session handle, 0 if no session is registered
+ */
 CipSessionHandle GetSessionFromSocket(const int socket_handle);
 
 void RemoveSession(const int socket);
@@ -238,6 +238,11 @@ CipClass *GetCipClass(const CipUdint class_code);
 /** @ingroup CIP_API
  * @brief Get a pointer to an instance
  *
+ * All instances of the virtual range of a class (see AddCipVirtualInstances())
+ * are returned in one instance structure of the class, which is only valid
+ * until the next lookup of such an instance. Use ResolveCipInstance() to
+ * keep several of them.
+ *
  * @param cip_object pointer to the object the instance belongs to
  * @param instance_number number of the instance to retrieve
  * @return pointer to CIP Instance
@@ -246,11 +251,39 @@ CipClass *GetCipClass(const CipUdint class_code);
 CipInstance *GetCipInstance(const CipClass *RESTRICT const cip_object,
                             const CipInstanceNum instance_number);
 
+/** @ingroup CIP_API
+ * @brief Get a pointer to an instance, resolving virtual instances into storage
+ *
+ * Like GetCipInstance(), but an instance of the virtual range of the class
+ * is filled into storage, which stays valid as long as the caller keeps it.
+ *
+ * @param cip_class pointer to the object the instance belongs to
+ * @param instance_number number of the instance to retrieve
+ * @param storage instance structure for an instance of the virtual range
+ * @return pointer to CIP Instance, storage for a virtual instance
+ *          0 if instance is not in the object
+ */
+CipInstance *ResolveCipInstance(const CipClass *RESTRICT const cip_class,
+                                const CipInstanceNum instance_number,
+                                CipInstance *const storage);
+
+/** @ingroup CIP_API
+ * @brief Check if an instance belongs to the virtual range of its class
+ *
+ * @param instance instance returned by GetCipInstance() or ResolveCipInstance()
+ * @return true if the instance has no own instance structure
+ */
+bool IsCipVirtualInstance(const CipInstance *const instance);
+
 /** @ingroup CIP_API
  * @brief Get a pointer to an instance's attribute
  *
  * As instances and objects are selfsimilar this function can also be used
  * to retrieve the attribute of an object.
+ * Attributes taken from the class' attribute descriptor table are returned in
+ * one attribute structure of the class, which is only valid until the next
+ * lookup of such an attribute. Use ResolveCipAttribute() to keep several of
+ * them.
  * @param cip_instance  pointer to the instance the attribute belongs to
  * @param attribute_number number of the attribute to retrieve
  * @return pointer to attribute
@@ -259,6 +292,22 @@ CipInstance *GetCipInstance(const CipClass *RESTRICT const cip_object,
 CipAttributeStruct *GetCipAttribute(const CipInstance *const cip_instance,
                                     const EipUint16 attribute_number);
 
+/** @ingroup CIP_API
+ * @brief Get a pointer to an instance's attribute, resolving descriptors into storage
+ *
+ * Like GetCipAttribute(), but an attribute taken from the class' attribute
+ * descriptor table is filled into storage, which stays valid as long as the
+ * caller keeps it.
+ * @param cip_instance  pointer to the instance the attribute belongs to
+ * @param attribute_number number of the attribute to retrieve
+ * @param storage attribute structure for an attribute of a descriptor
+ * @return pointer to attribute, storage for a descriptor based attribute
+ *          0 if instance is not in the object
+ */
+CipAttributeStruct *ResolveCipAttribute(const CipInstance *const cip_instance,
+                                        const EipUint16 attribute_number,
+                                        CipAttributeStruct *const storage);
+
 typedef void (*InitializeCipClass)(CipClass *); /**< Initializer function for CIP class initialization */
 
 /** @ingroup CIP_API
@@ -298,6 +347,7 @@ CipClass *CreateCipClass(const CipUdint class_code,
  * @brief Add a number of CIP instances to a given CIP class
  *
  * The required number of instances are attached to the class as a linked list.
+ * The instances and their attribute arrays are allocated as one memory block.
  *
  * The instances are numbered sequentially -- i.e. the first node in the chain
  * is instance 1, the second is 2, and so on.
@@ -316,6 +366,28 @@ CipInstance *AddCipInstances(
   CipClass *RESTRICT const cip_object_to_add_instances,
   const CipInstanceNum number_of_instances);
 
+typedef void *(*CipInstanceAllocator)(size_t number_of_elements,
+                                      size_t size_of_element); /**< calloc-like allocator for instance storage */
+
+/** @ingroup CIP_API
+ * @brief Add a number of CIP instances to a given CIP class using a given allocator
+ *
+ * Same as AddCipInstances(), but the memory block holding the instances and
+ * their attribute arrays is obtained from @p allocator. This allows large
+ * object models to be placed in external RAM. The block is released with
+ * CipFree(), so the allocator has to return memory CipFree() can release.
+ *
+ * @param cip_object_to_add_instances CIP object the instances should be added
+ * @param number_of_instances number of instances to be generated.
+ * @param allocator allocator for the instance memory, NULL for CipCalloc()
+ * @return pointer to the first of the new instances
+ *              0 on error
+ */
+CipInstance *AddCipInstancesWithAllocator(
+  CipClass *RESTRICT const cip_object_to_add_instances,
+  const CipInstanceNum number_of_instances,
+  CipInstanceAllocator allocator);
+
 /** @ingroup CIP_API
  * @brief Create one instance of a given class with a certain instance number
  *
@@ -329,6 +401,29 @@ CipInstance *AddCipInstances(
 CipInstance *AddCipInstance(CipClass *RESTRICT const cip_class_to_add_instance,
                             const CipInstanceNum instance_id);
 
+/** @ingroup CIP_API
+ * @brief Back a range of instances of a CIP class directly by an array
+ *
+ * No instance structures are created for the range. A request to instance
+ * N of the range is resolved on the fly to the data at
+ * data + (N - first_instance) * stride, and its attributes are taken from the
+ * class' attribute descriptor table (see InsertAttributeDescriptors()).
+ * Only one range per class is supported and it must not overlap existing
+ * instances. Instances of the range cannot be deleted.
+ *
+ * @param cip_class class the instances should be added to
+ * @param first_instance instance number of the first element of data
+ * @param number_of_instances number of elements in data
+ * @param data pointer to the data of the first instance
+ * @param stride size in bytes of the data of one instance
+ * @return kEipStatusOk on success, kEipStatusError otherwise
+ */
+EipStatus AddCipVirtualInstances(CipClass *RESTRICT const cip_class,
+                                 const CipInstanceNum first_instance,
+                                 const CipInstanceNum number_of_instances,
+                                 void *const data,
+                                 const size_t stride);
+
 /** @ingroup CIP_API
  * @brief Insert an attribute in an instance of a CIP class
  *
@@ -352,6 +447,45 @@ void InsertAttribute(CipInstance *const instance,
                      void *const data,
                      const EipByte cip_flags);
 
+/** @ingroup CIP_API
+ * @brief Make the members of an array attribute addressable by Member ID
+ *
+ *  The attribute data is treated as an array of number_of_members elements
+ *  of the attribute's fixed size CIP type. A Get_Attribute_Single request
+ *  with a Member ID segment (or two of them for a range) returns only the
+ *  requested elements, each encoded with the attribute's encode function.
+ *  Descriptor based attributes set CipAttributeDescriptor::number_of_members
+ *  instead.
+ *
+ * @param instance instance the attribute was inserted into
+ * @param attribute_number number of the attribute
+ * @param number_of_members number of addressable members, starting at 1
+ */
+void SetCipAttributeMembers(CipInstance *const instance,
+                            const EipUint16 attribute_number,
+                            const EipUint8 number_of_members);
+
+/** @ingroup CIP_API
+ * @brief Set the attribute descriptor table of a CIP class
+ *
+ *  The table describes the attributes of all instances of the class which
+ *  do not have an own attribute array. Attribute values are located at
+ *  CipInstance::data plus the descriptor's data offset. The table is not
+ *  copied and has to stay valid, typically it is a const table. Lookups are
+ *  fastest if entry n - 1 describes attribute n.
+ *  Instances added by AddCipInstances() after the table has been set get no
+ *  attribute array, the application only sets their CipInstance::data.
+ *
+ *  @param cip_class class the table belongs to
+ *  @param descriptors table of attribute descriptors
+ *  @param number_of_descriptors number of entries in the table
+ *  @return kEipStatusOk on success, kEipStatusError if the class has a table
+ *          already, the table is too large or no memory is left
+ */
+EipStatus InsertAttributeDescriptors(CipClass *const cip_class,
+                                     const CipAttributeDescriptor *const descriptors,
+                                     const EipUint16 number_of_descriptors);
+
 /** @ingroup CIP_API
  * @brief Allocates Attribute bitmasks
  *
@@ -405,6 +539,40 @@ void InsertGetSetCallback(CipClass *const cip_class,
                           CipGetSetCallback callback_function,
                           CIPAttributeFlag callbacks_to_install);
 
+/** @ingroup CIP_API
+ * @brief Enable the serialized response cache of a CIP class
+ *
+ *  Successful Get_Attribute_Single and Get_Attribute_All replies of the
+ *  class and its instances are kept and answered by a copy on the next
+ *  identical request. Any other service addressed to the class drops the
+ *  cached replies, the application has to call InvalidateCipResponseCache()
+ *  whenever it changes the attribute data itself. Only classes with
+ *  read-mostly data benefit. A class with a PreGetCallback is answered
+ *  uncached, as the callback may update the data for every Get.
+ *
+ * @param cip_class class whose replies should be cached
+ * @param number_of_entries number of cached replies, a power of two
+ * @return kEipStatusOk on success, kEipStatusError if out of memory
+ */
+EipStatus EnableCipResponseCache(CipClass *const cip_class,
+                                 const EipUint16 number_of_entries);
+
+/** @ingroup CIP_API
+ * @brief Drop the cached replies of a CIP class after its data changed
+ *
+ * @param cip_class class whose data changed, may be NULL or without cache
+ */
+void InvalidateCipResponseCache(const CipClass *const cip_class);
+
+/** @ingroup CIP_API
+ * @brief Get the hit and miss counters of the response cache of a class
+ *
+ * @param cip_class class with response cache
+ * @return the counters, NULL if the class has no response cache
+ */
+const CipResponseCacheCounters *GetCipResponseCacheCounters(
+  const CipClass *const cip_class);
+
 //TODO: Update documentation
 /** @ingroup CIP_API
  * @brief Produce the data according to CIP encoding onto the message buffer.
@@ -786,33 +954,54 @@ EipStatus HandleReceivedConnectedData(const EipUint8 *const received_data,
                                       int received_data_length,
                                       struct sockaddr_in *from_address);
 
+/** @ingroup CIP_API
+ * @brief Inform the application that it can execute.
+ *
+ * This function should be called periodically once every @ref kOpenerTimerTickInMilliSeconds
+ * milliseconds. The connection timers are handled by ManageConnectionTimers().
+ *
+ * @param elapsed_time Elapsed time in milliseconds since the last call of
+ *          ManageConnections. Ignored, kept for existing callers.
+ *
+ * @return EIP_OK on success
+ */
+EipStatus ManageConnections(MilliSeconds elapsed_time);
+
 /** @ingroup CIP_API
  * @brief Check if any of the connection timers (TransmissionTrigger or
  * WatchdogTimeout) have timed out.
  *
  * If the a timeout occurs the function performs the necessary action. This
- * function should be called periodically once every @ref kOpenerTimerTickInMilliSeconds
- * milliseconds. In order to simplify the algorithm if more time was lapsed, the elapsed
- * time since the last call of the function is given as a parameter.
+ * function should be called whenever the time returned by
+ * GetNextConnectionTimerDeadline() has been reached, and before received data
+ * is handled.
  *
- * @param elapsed_time Elapsed time in milliseconds since the last call of ManageConnections
+ * @param current_time Current time of the monotonic clock of GetMicroSeconds()
+ */
+void ManageConnectionTimers(const MicroSeconds current_time);
+
+/** @ingroup CIP_API
+ * @brief Get the time at which ManageConnectionTimers() has to be called next
  *
- * @return EIP_OK on success
+ * @param latest_time Time returned if no timer expires before
+ * @return Expiry time of the next connection timer, at most @p latest_time
  */
-EipStatus ManageConnections(MilliSeconds elapsed_time);
+MicroSeconds GetNextConnectionTimerDeadline(const MicroSeconds latest_time);
 
 /** @ingroup CIP_API
- * @brief Trigger the production of an application triggered connection.
+ * @brief Trigger the production of change of state and application triggered
+ * connections.
  *
- * This will issue the production of the specified connection at the next
- * possible occasion. Depending on the values for the RPI and the production
- * inhibit timer. The application is informed via the
+ * This will issue the production of the specified connections at the next
+ * possible occasion, which is not before the production inhibit time has
+ * passed since their last production. The application is informed via the
  * EIP_BOOL8 BeforeAssemblyDataSend(S_CIP_Instance *pa_pstInstance)
  * callback function when the production will happen. This function should only
- * be invoked from void HandleApplication(void).
+ * be invoked from the task running the network handler, e.g. from
+ * void HandleApplication(void) or the assembly and attribute callbacks.
  *
- * The connection can only be triggered if the application is established and it
- * is of application application triggered type.
+ * Only established connections of change of state or application triggered
+ * type are triggered, cyclic connections keep producing at their RPI.
  *
  * @param output_assembly_id the output assembly connection point of the
  * connection
@@ -974,6 +1163,29 @@ int CreateUdpSocket(void);
 EipStatus SendUdpData(const struct sockaddr_in *const socket_data,
                       const ENIPMessage *const outgoing_message);
 
+/** @ingroup CIP_CALLBACK_API
+ * @brief Sends the data produced by an I/O connection
+ *
+ * Called for every production of the connection. Ports producing from the
+ * calling task send the message with SendUdpData(). Ports running the
+ * implicit messaging in a task of its own hand the message over to that task,
+ * which keeps producing the last message of a cyclic connection every RPI
+ * while the caller is busy.
+ *
+ * @param connection_object the producing connection
+ * @param outgoing_message The constructed outgoing message
+ * @return kEipStatusOk on success
+ */
+EipStatus ProduceUdpData(const CipConnectionObject *const connection_object,
+                         const ENIPMessage *const outgoing_message);
+
+/** @ingroup CIP_CALLBACK_API
+ * @brief Ends the production of the data handed over with ProduceUdpData()
+ *
+ * @param connection_object the connection no longer producing
+ */
+void StopProducingUdpData(const CipConnectionObject *const connection_object);
+
 /** @ingroup CIP_CALLBACK_API
  * @brief Close the given socket and clean up the stack
  *
@@ -1118,6 +1330,12 @@ void RegisterTimeoutChecker(TimeoutCheckerFunction timeout_checker_function);
  *     The received data has to be hand over to the Connection Manager Object
  *     with the function EIP_STATUS HandleReceivedConnectedData(EIP_UINT8
  * *data, int data_length)
+ *   - Send implicit connected data\n
+ *     OpENer hands the data of each production over with the call-back
+ *     function EipStatus ProduceUdpData(const CipConnectionObject *const
+ *     connection_object, const ENIPMessage *const outgoing_message). A port
+ *     may send it from a task of higher priority than the one handling the
+ *     explicit messages, see ports/generic_iohandler.h.
  *   - Close UDP and TCP sockets:
  *      -# Requested by OpENer through the call back function: void
  * CloseSocket(int socket_handle)
@@ -1128,8 +1346,10 @@ void RegisterTimeoutChecker(TimeoutCheckerFunction timeout_checker_function);
  *      .
  *   - Cyclically update the connection status:\n
  *     In order that OpENer can determine when to produce new data on
- *     connections or that a connection timed out every @ref kOpenerTimerTickInMilliSeconds
- * milliseconds the
+ *     connections or that a connection timed out the function
+ *     void ManageConnectionTimers(MicroSeconds) has to be called when the
+ *     time returned by GetNextConnectionTimerDeadline() has been reached.
+ *     Every @ref kOpenerTimerTickInMilliSeconds milliseconds the
  *     function EIP_STATUS ManageConnections(void) has to be called.
  *
  * @section callback_funcs_sec Callback Functions
@@ -1,17 +1,25 @@
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "esp_psram.h"
+#include "sdkconfig.h"
 #include "opener_api.h"
 #include "appcontype.h"
 #include "cipqos.h"
 #include "ciptypes.h"
 #include "typedefs.h"
 #include "cipcommon.h"
+#include "endianconv.h"
 #include "system_config.h"
+#include "networkhandler.h"
+#include "motoman_motion.h"
+#include "motoman_kinematics.h"
+#include "motoman_job.h"
 
 static const char *TAG = "motoman_dx200_simulator";
 
@@ -44,12 +52,79 @@ struct netif;
 #define MOTOMAN_MAX_AXES                      8
 #define MOTOMAN_MAX_POSITION_INSTANCES         108
 #define MOTOMAN_POSITION_ATTRIBUTES            13
+// Instances 101-108 are the base coordinates of the robots in instances 1-8
+#define MOTOMAN_BASE_POSITION_INSTANCE         101
+#define MOTOMAN_BASE_POSITION_INSTANCES        8
+#define MOTOMAN_POSITION_DATA_TYPE_BASE        16
 #define MOTOMAN_VARIABLE_P_ATTRIBUTES          13
 #define MOTOMAN_VARIABLE_BP_ATTRIBUTES         9
 #define MOTOMAN_VARIABLE_EX_ATTRIBUTES         9
 #define MOTOMAN_MAX_ACTIVE_ALARMS             4
 #define MOTOMAN_ALARM_HISTORY_SIZE            100
 
+// Vendor specific block services on the data classes; the request path
+// addresses the first instance, the request data starts with a UINT count
+#define MOTOMAN_SERVICE_READ_BLOCK            0x4B
+#define MOTOMAN_SERVICE_WRITE_BLOCK           0x4C
+// Encapsulation header, CPF items and reply header around a block reply
+#define MOTOMAN_BLOCK_REPLY_OVERHEAD          50
+
+// Class 1 I/O: input (T->O) and output (O->T) assemblies packed from and
+// unpacked into the robot data by the configured I/O map
+#define MOTOMAN_INPUT_ASSEMBLY                100
+#define MOTOMAN_OUTPUT_ASSEMBLY               150
+#define MOTOMAN_CONFIG_ASSEMBLY               151
+#define MOTOMAN_HEARTBEAT_INPUT_ONLY_ASSEMBLY 152
+#define MOTOMAN_HEARTBEAT_LISTEN_ONLY_ASSEMBLY 153
+#define MOTOMAN_MAX_ASSEMBLY_SIZE             256
+// Status data 1 and 2 are separate words, an entry may need a span for each
+#define MOTOMAN_MAX_IO_SPANS                  (2 * SYSTEM_MOTOMAN_IO_MAP_MAX_ENTRIES)
+
+// Motion engine step period, see the Motoman Simulator menu of the project
+// configuration; 4 ms is the interpolation period of the DX200
+#ifdef CONFIG_MOTOMAN_MOTION_PERIOD_US
+#define MOTOMAN_MOTION_PERIOD_US              CONFIG_MOTOMAN_MOTION_PERIOD_US
+#else
+#define MOTOMAN_MOTION_PERIOD_US              4000
+#endif
+// Steps one HandleApplication() call catches up with at most; a longer stall
+// of the OpENer task delays the motion instead of making it jump
+#define MOTOMAN_MOTION_MAX_STEPS_PER_CALL     16
+// Such delays are summed up and logged at most once per interval
+#define MOTOMAN_MOTION_DELAY_LOG_INTERVAL_US  10000000
+#define MOTOMAN_MOTION_ACCELERATION_TIME_US   250000
+#define MOTOMAN_MOTION_POSITION_GAIN          30
+// Demo moves run at 50% of the max speed times the speed override and rest
+// for a second at each end
+#define MOTOMAN_MOTION_DEMO_SPEED             5000
+#define MOTOMAN_MOTION_DEMO_DWELL_US          1000000
+
+#define MOTOMAN_STATUS1_RUNNING               0x00000008
+
+// INFORM job played back from startup, see the Motoman Simulator menu of the
+// project configuration; without the file the demo motion runs instead
+#ifdef CONFIG_MOTOMAN_JOB_FILE
+#define MOTOMAN_JOB_FILE                      CONFIG_MOTOMAN_JOB_FILE
+#else
+#define MOTOMAN_JOB_FILE                      "/spiffs/MAIN.JBI"
+#endif
+#define MOTOMAN_JOB_MAX_FILE_SIZE             (512 * 1024)
+// Instructions one motion step executes at most, so that a JUMP loop without
+// moves cannot hold up the OpENer task
+#define MOTOMAN_JOB_INSTRUCTIONS_PER_STEP     8
+
+// Manipulator whose kinematics convert the pulses into base coordinates, see
+// the Motoman Simulator menu of the project configuration
+#if defined(CONFIG_MOTOMAN_ROBOT_MODEL_GP8)
+#define MOTOMAN_ROBOT_MODEL                   kMotomanRobotModelGp8
+#elif defined(CONFIG_MOTOMAN_ROBOT_MODEL_GP12)
+#define MOTOMAN_ROBOT_MODEL                   kMotomanRobotModelGp12
+#elif defined(CONFIG_MOTOMAN_ROBOT_MODEL_GP25)
+#define MOTOMAN_ROBOT_MODEL                   kMotomanRobotModelGp25
+#else
+#define MOTOMAN_ROBOT_MODEL                   kMotomanRobotModelGp7
+#endif
+
 typedef struct {
     EipUint32 code;
     EipUint32 data;
@@ -101,6 +176,49 @@ static EipInt32 (*s_variable_ex)[MOTOMAN_VARIABLE_EX_ATTRIBUTES] = NULL;
 
 static bool s_rs022_enabled = true;
 
+// Generic values for a 6 axis arm in the payload range of a GP7, not the data
+// of a specific model; the holding torques are the initial torque values
+static const MotomanAxisModel s_axis_models[MOTOMAN_MAX_AXES] = {
+    {150000, 18500, 10000, 40000},  // S
+    {150000, 22300, 10000, 60000},  // L
+    {150000, 31200, 10000, 50000},  // U
+    {200000, 4500, 5000, 15000},    // R
+    {200000, 12800, 5000, 15000},   // B
+    {300000, 2100, 5000, 10000},    // T
+    {100000, 0, 10000, 40000},
+    {100000, 0, 10000, 40000},
+};
+
+static MotomanMotion s_motion;
+static MicroSeconds s_motion_next_step = 0;
+
+// Stalls the motion could not catch up with since the last log
+static EipUint32 s_motion_delays = 0;
+static MicroSeconds s_motion_longest_delay = 0;
+static MicroSeconds s_motion_delay_logged = 0;
+
+// Base coordinates are only computed when read, bit N set means the pulses of
+// robot N changed since its base position instance was last computed
+static MotomanKinematics s_kinematics;
+static EipUint8 s_base_position_dirty = (EipUint8)((1U << MOTOMAN_BASE_POSITION_INSTANCES) - 1);
+
+// The job runs from the motion steps; JobInfo replies are cached, every change
+// of the line or step number has to drop them
+static MotomanJob s_job;
+static MotomanJobVariables s_job_variables;
+static CipClass *s_job_info_class = NULL;
+
+#if defined(CONFIG_MOTOMAN_MOTION_DEMO)
+static const EipInt32 s_demo_offset[MOTOMAN_MAX_AXES] = {30000, 25000, -20000, 40000, -30000, 60000, 0, 0};
+static EipInt32 s_demo_home[MOTOMAN_MAX_AXES];
+static bool s_demo_away = false;
+static EipUint32 s_demo_dwell_steps = 0;
+#endif
+
+// Every write to robot data an I/O map source refers to has to be recorded so
+// that the input assembly is repacked and change of state connections produce
+static void MarkMotomanIoDirty(uint8_t source, size_t first, size_t count);
+
 static inline int GetArrayIndexFromInstance(int instance_number) {
     // Note: In CIP, instance 0 is reserved for the class object, so instance_number will always be >= 1.
     // RS022=1: "Specify the variable P number" - Variable 0 (P0) should be instance 0, but instance 0 is reserved.
@@ -275,6 +393,7 @@ static void InitializeRobotData(void) {
     // Initialize Job Info (per Manual 165838-1CD, Table 5-4)
     // Line number: 0 to 9999, Step number: 1 to 9998
     // Speed override: Unit 0.01% (10000 = 100.0%, 8550 = 85.5%)
+    // Name, line and step are replaced by those of a job played back
     s_job_line = 15;
     s_step_number = 42;  // Valid range: 1 to 9998
     s_speed_override = 8550;  // 85.5% (in units of 0.01%)
@@ -334,21 +453,11 @@ static void InitializeRobotData(void) {
         
         memset(&s_position_data[0][7], 0, 2 * sizeof(EipInt32));
         
-        // Initialize instance 102 (Robot Base, 101-108 range)
-        // Attribute 1: Data type = 16 (Base)
-        // Attributes 2-9: Axis data (X, Y, Z, RX, RY, RZ, 7th, 8th)
-        // Base coordinates: Length in μm (micrometers), Angle in 0.0001° units
-        // Sample values: X=1234.567mm, Y=2345.678mm, Z=3456.789mm
-        if (MOTOMAN_MAX_POSITION_INSTANCES > 102) {
-            s_position_data[101][0] = 16;      // Attribute 1: Data type = Base
-            s_position_data[101][1] = 1234567; // Attribute 2: X position = 1234.567 mm (in μm)
-            s_position_data[101][2] = 2345678; // Attribute 3: Y position = 2345.678 mm (in μm)
-            s_position_data[101][3] = 3456789; // Attribute 4: Z position = 3456.789 mm (in μm)
-            s_position_data[101][4] = 0;       // Attribute 5: RX rotation = 0 (angle in 0.0001°)
-            s_position_data[101][5] = 1234567;  // Attribute 6: X Position Robot Base (in μm) - matches Attribute 2
-            s_position_data[101][6] = 0;       // Attribute 7: RZ rotation = 0 (angle in 0.0001°)
-            s_position_data[101][7] = 0;        // Attribute 8: 7th axis = 0
-            s_position_data[101][8] = 0;        // Attribute 9: 8th axis = 0
+        // Instances 101-108 (Robot Base): Attribute 1: Data type = 16 (Base)
+        // Attributes 2-7: X, Y, Z in μm and Rx, Ry, Rz in 0.0001°, computed
+        // from the pulses of instances 1-8 when read
+        for (int robot = 0; robot < MOTOMAN_BASE_POSITION_INSTANCES; robot++) {
+            s_position_data[MOTOMAN_BASE_POSITION_INSTANCE - 1 + robot][0] = MOTOMAN_POSITION_DATA_TYPE_BASE;
         }
     }
     
@@ -585,6 +694,9 @@ static void EncodeMotomanAlarmString32(const void *const data, ENIPMessage *cons
     outgoing_message->used_message_length += 32;
 }
 
+// Per Manual 165838-1CD: data type and configuration (1, 10-13) precede the axis data (2-9)
+static const EipUint16 s_position_get_all_order[] = {1, 10, 11, 12, 13, 2, 3, 4, 5, 6, 7, 8, 9};
+
 static EipStatus GetAttributeAllPositionOrder(CipInstance *RESTRICT const instance,
                                               CipMessageRouterRequest *const message_router_request,
                                               CipMessageRouterResponse *const message_router_response,
@@ -603,14 +715,17 @@ static EipStatus GetAttributeAllPositionOrder(CipInstance *RESTRICT const instan
         return kEipStatusOkSend;
     }
 
-    EipUint16 attr_order[] = {1, 10, 11, 12, 13, 2, 3, 4, 5, 6, 7, 8, 9};
-    for (size_t i = 0; i < sizeof(attr_order) / sizeof(attr_order[0]); i++) {
-        EipUint16 attr_num = attr_order[i];
+    for (size_t i = 0; i < sizeof(s_position_get_all_order) / sizeof(s_position_get_all_order[0]); i++) {
+        EipUint16 attr_num = s_position_get_all_order[i];
         size_t index = attr_num / 8;
         if ((instance->cip_class->get_all_bit_mask[index]) & (1 << (attr_num % 8))) {
-            CipAttributeStruct *attribute = GetCipAttribute(instance, attr_num);
+            CipAttributeStruct resolved_attribute;
+            CipAttributeStruct *attribute = ResolveCipAttribute(instance, attr_num, &resolved_attribute);
             if (attribute != NULL && attribute->data != NULL) {
                 message_router_request->request_path.attribute_number = attr_num;
+                if ((attribute->attribute_flags & kPreGetFunc) && NULL != instance->cip_class->PreGetCallback) {
+                    instance->cip_class->PreGetCallback(instance, attribute, message_router_request->service);
+                }
                 attribute->encode(attribute->data, &message_router_response->message);
             }
         }
@@ -640,7 +755,8 @@ static EipStatus SetAttributeAll(CipInstance *RESTRICT const instance,
         size_t index = attr_num / 8;
         uint8_t set_bit_mask = instance->cip_class->set_bit_mask[index];
         if (0 != (set_bit_mask & (1 << (attr_num % 8)))) {
-            CipAttributeStruct *attribute = GetCipAttribute(instance, attr_num);
+            CipAttributeStruct resolved_attribute;
+            CipAttributeStruct *attribute = ResolveCipAttribute(instance, attr_num, &resolved_attribute);
             if (attribute != NULL && attribute->data != NULL && attribute->decode != NULL) {
                 if ((attribute->attribute_flags == kGetableAllDummy) ||
                     (attribute->attribute_flags == kNotSetOrGetable) ||
@@ -671,24 +787,190 @@ static EipStatus SetAttributeAll(CipInstance *RESTRICT const instance,
     return kEipStatusOkSend;
 }
 
+// Checks the instance range of a block request and returns the number of
+// instances, 0 if the request has been answered with an error already.
+static CipUint GetMotomanBlockCount(const CipInstance *const instance,
+                                    CipMessageRouterRequest *const message_router_request,
+                                    CipMessageRouterResponse *const message_router_response) {
+    const CipClass *const cip_class = instance->cip_class;
+
+    if (!IsCipVirtualInstance(instance)) {
+        message_router_response->general_status = kCipErrorServiceNotSupported;
+        return 0;
+    }
+    if (message_router_request->request_data_size < sizeof(CipUint)) {
+        message_router_response->general_status = kCipErrorNotEnoughData;
+        return 0;
+    }
+    const CipUint count = GetUintFromMessage(&message_router_request->data);
+    message_router_request->request_data_size -= sizeof(CipUint);
+    const size_t first_index = instance->instance_number - cip_class->first_virtual_instance;
+    if (0 == count || first_index + count > cip_class->number_of_virtual_instances) {
+        message_router_response->general_status = kCipErrorInvalidParameter;
+        return 0;
+    }
+    return count;
+}
+
+// Copies count consecutive instances starting at the addressed one from the
+// backing array into the reply. The arrays are stored little endian already.
+static EipStatus ReadMotomanBlock(CipInstance *RESTRICT const instance,
+                                  CipMessageRouterRequest *const message_router_request,
+                                  CipMessageRouterResponse *const message_router_response,
+                                  const struct sockaddr *originator_address,
+                                  const CipSessionHandle encapsulation_session) {
+    (void)originator_address;
+    (void)encapsulation_session;
+
+    InitializeENIPMessage(&message_router_response->message);
+    message_router_response->reply_service = (0x80 | message_router_request->service);
+    message_router_response->general_status = kCipErrorSuccess;
+    message_router_response->size_of_additional_status = 0;
+
+    const CipUint count = GetMotomanBlockCount(instance, message_router_request, message_router_response);
+    if (0 == count) {
+        return kEipStatusOkSend;
+    }
+    if (0 != message_router_request->request_data_size) {
+        message_router_response->general_status = kCipErrorTooMuchData;
+        return kEipStatusOkSend;
+    }
+    const size_t block_size = (size_t)count * instance->cip_class->virtual_instance_stride;
+    if (block_size > PC_OPENER_ETHERNET_BUFFER_SIZE - MOTOMAN_BLOCK_REPLY_OVERHEAD) {
+        message_router_response->general_status = kCipErrorReplyDataTooLarge;
+        return kEipStatusOkSend;
+    }
+
+    memcpy(message_router_response->message.current_message_position, instance->data, block_size);
+    MoveMessageNOctets(block_size, &message_router_response->message);
+    return kEipStatusOkSend;
+}
+
+// Records a write to count instances of the I/O or register class starting at
+// the addressed one, the other data classes are not mapped to I/O
+static void MarkMotomanIoInstancesDirty(const CipInstance *const instance, size_t count) {
+    const CipClass *const cip_class = instance->cip_class;
+    const size_t first_index = instance->instance_number - cip_class->first_virtual_instance;
+
+    if (MOTOMAN_CLASS_IO == cip_class->class_code) {
+        MarkMotomanIoDirty(SYSTEM_MOTOMAN_IO_SOURCE_IO, first_index, count);
+    } else if (MOTOMAN_CLASS_REGISTER == cip_class->class_code) {
+        MarkMotomanIoDirty(SYSTEM_MOTOMAN_IO_SOURCE_REGISTER, first_index, count);
+    }
+}
+
+// Copies the request data into count consecutive instances starting at the
+// addressed one; the data has to cover the whole block exactly.
+static EipStatus WriteMotomanBlock(CipInstance *RESTRICT const instance,
+                                   CipMessageRouterRequest *const message_router_request,
+                                   CipMessageRouterResponse *const message_router_response,
+                                   const struct sockaddr *originator_address,
+                                   const CipSessionHandle encapsulation_session) {
+    (void)originator_address;
+    (void)encapsulation_session;
+
+    InitializeENIPMessage(&message_router_response->message);
+    message_router_response->reply_service = (0x80 | message_router_request->service);
+    message_router_response->general_status = kCipErrorSuccess;
+    message_router_response->size_of_additional_status = 0;
+
+    const CipUint count = GetMotomanBlockCount(instance, message_router_request, message_router_response);
+    if (0 == count) {
+        return kEipStatusOkSend;
+    }
+    const size_t block_size = (size_t)count * instance->cip_class->virtual_instance_stride;
+    if (message_router_request->request_data_size < block_size) {
+        message_router_response->general_status = kCipErrorNotEnoughData;
+        return kEipStatusOkSend;
+    }
+    if (message_router_request->request_data_size > block_size) {
+        message_router_response->general_status = kCipErrorTooMuchData;
+        return kEipStatusOkSend;
+    }
+
+    memcpy(instance->data, message_router_request->data, block_size);
+    MarkMotomanIoInstancesDirty(instance, count);
+    return kEipStatusOkSend;
+}
+
+static void InsertMotomanBlockServices(CipClass *const cip_class) {
+    InsertService(cip_class, MOTOMAN_SERVICE_READ_BLOCK, &ReadMotomanBlock, "ReadBlock");
+    InsertService(cip_class, MOTOMAN_SERVICE_WRITE_BLOCK, &WriteMotomanBlock, "WriteBlock");
+}
+
+// Descriptor tables shared by all instances of a class; each instance only
+// carries its data base in instance->data. Fields not named are 0: no
+// decode function and no members.
+#define MOTOMAN_ATTRIBUTE(number, cip_type, encode_function, flags, offset) \
+    {.attribute_number = (number), .type = (cip_type), .encode = (encode_function), \
+     .attribute_flags = (flags), .data_offset = (offset)}
+// The only attribute of a class, its value at the start of the instance data
+#define MOTOMAN_SETTABLE_ATTRIBUTE(number, cip_type, encode_function, decode_function, flags) \
+    {.attribute_number = (number), .type = (cip_type), .encode = (encode_function), \
+     .decode = (CipAttributeDecodeFromMessage)(decode_function), .attribute_flags = (flags)}
+#define MOTOMAN_DINT_ATTRIBUTE(number, flags) \
+    {.attribute_number = (number), .type = kCipDint, .encode = EncodeCipDint, \
+     .decode = (CipAttributeDecodeFromMessage)DecodeCipDint, .attribute_flags = (flags), \
+     .data_offset = ((number) - 1) * sizeof(EipInt32)}
+#define MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(number) \
+    MOTOMAN_ATTRIBUTE(number, kCipDint, EncodeCipDint, kGetableSingleAndAll, ((number) - 1) * sizeof(EipInt32))
+// Same, with the DINTs of the following attributes also readable as members
+#define MOTOMAN_READ_ONLY_DINT_ARRAY_ATTRIBUTE(number, members) \
+    {.attribute_number = (number), .type = kCipDint, .number_of_members = (members), \
+     .encode = EncodeCipDint, .attribute_flags = kGetableSingleAndAll, \
+     .data_offset = ((number) - 1) * sizeof(EipInt32)}
+// Read only DINTs brought up to date by the pre get callback of the class
+#define MOTOMAN_COMPUTED_DINT_ATTRIBUTE(number) \
+    MOTOMAN_ATTRIBUTE(number, kCipDint, EncodeCipDint, kGetableSingleAndAll | kPreGetFunc, \
+                      ((number) - 1) * sizeof(EipInt32))
+#define MOTOMAN_COMPUTED_DINT_ARRAY_ATTRIBUTE(number, members) \
+    {.attribute_number = (number), .type = kCipDint, .number_of_members = (members), \
+     .encode = EncodeCipDint, .attribute_flags = kGetableSingleAndAll | kPreGetFunc, \
+     .data_offset = ((number) - 1) * sizeof(EipInt32)}
+
+static const CipAttributeDescriptor s_alarm_attributes[] = {
+    MOTOMAN_ATTRIBUTE(1, kCipUdint, EncodeCipUdint, kGetableSingleAndAll, offsetof(MotomanAlarm, code)),
+    MOTOMAN_ATTRIBUTE(2, kCipUdint, EncodeCipUdint, kGetableSingleAndAll, offsetof(MotomanAlarm, data)),
+    MOTOMAN_ATTRIBUTE(3, kCipUdint, EncodeCipUdint, kGetableSingleAndAll, offsetof(MotomanAlarm, data_type)),
+    MOTOMAN_ATTRIBUTE(4, 0xFF, EncodeMotomanAlarmDateTime16, kGetableSingleAndAll, offsetof(MotomanAlarm, date_time)),
+    MOTOMAN_ATTRIBUTE(5, 0xFF, EncodeMotomanAlarmString32, kGetableSingleAndAll, offsetof(MotomanAlarm, string)),
+};
+
+// The cache only saves work, without memory for it the class answers uncached
+static void EnableMotomanResponseCache(CipClass *const cip_class, const EipUint16 entries) {
+    if (kEipStatusOk != EnableCipResponseCache(cip_class, entries)) {
+        ESP_LOGW(TAG, "%s: no memory for %u cached replies, replies are not cached", cip_class->class_name,
+                 (unsigned)entries);
+    }
+}
+
+// Describes the instances 1..count of a class by descriptors and backs them by
+// the array data, false if the class cannot serve them
+static bool AddMotomanVirtualInstances(CipClass *const cip_class,
+                                       const CipAttributeDescriptor *const descriptors,
+                                       const EipUint16 number_of_descriptors,
+                                       const CipInstanceNum count,
+                                       void *const data,
+                                       const size_t stride) {
+    if (kEipStatusOk != InsertAttributeDescriptors(cip_class, descriptors, number_of_descriptors) ||
+        kEipStatusOk != AddCipVirtualInstances(cip_class, 1, count, data, stride)) {
+        ESP_LOGE(TAG, "%s: instances 1-%u not available", cip_class->class_name, (unsigned)count);
+        return false;
+    }
+    return true;
+}
+
 static void CreateMotomanAlarmClass(void) {
-    CipClass *alarm_class = CreateCipClass(MOTOMAN_CLASS_ALARM, 0, 7, 2, 5, 5, 2, MOTOMAN_MAX_ACTIVE_ALARMS, "MotomanAlarm", 1, NULL);
-    if (alarm_class != NULL && alarm_class->instances != NULL) {
-        CipInstance *instance = alarm_class->instances;
-        int i = 0;
-        while (instance != NULL && i < MOTOMAN_MAX_ACTIVE_ALARMS) {
-            InsertAttribute(instance, 1, kCipUdint, EncodeCipUdint, NULL, 
-                           &s_active_alarms[i].code, kGetableSingleAndAll);
-            InsertAttribute(instance, 2, kCipUdint, EncodeCipUdint, NULL, 
-                           &s_active_alarms[i].data, kGetableSingleAndAll);
-            InsertAttribute(instance, 3, kCipUdint, EncodeCipUdint, NULL, 
-                           &s_active_alarms[i].data_type, kGetableSingleAndAll);
-            InsertAttribute(instance, 4, 0xFF, EncodeMotomanAlarmDateTime16, NULL, 
-                           s_active_alarms[i].date_time, kGetableSingleAndAll);
-            InsertAttribute(instance, 5, 0xFF, EncodeMotomanAlarmString32, NULL, 
-                           s_active_alarms[i].string, kGetableSingleAndAll);
+    CipClass *alarm_class = CreateCipClass(MOTOMAN_CLASS_ALARM, 0, 7, 2, 5, 5, 2, 0, "MotomanAlarm", 1, NULL);
+    if (alarm_class != NULL) {
+        if (kEipStatusOk != InsertAttributeDescriptors(alarm_class, s_alarm_attributes, 5)) {
+            ESP_LOGE(TAG, "%s: attribute descriptors not set", alarm_class->class_name);
+            return;
+        }
+        CipInstance *instance = AddCipInstances(alarm_class, MOTOMAN_MAX_ACTIVE_ALARMS);
+        for (int i = 0; instance != NULL && i < MOTOMAN_MAX_ACTIVE_ALARMS; i++) {
+            instance->data = &s_active_alarms[i];
             instance = instance->next;
-            i++;
         }
         InsertService(alarm_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(alarm_class, kGetAttributeAll, &GetAttributeAll, "GetAttributeAll");
@@ -696,26 +978,21 @@ static void CreateMotomanAlarmClass(void) {
 }
 
 static void CreateMotomanAlarmHistoryClass(void) {
-    CipClass *alarm_history_class = CreateCipClass(MOTOMAN_CLASS_ALARM_HISTORY, 0, 7, 2, 5, 5, 2, MOTOMAN_ALARM_HISTORY_SIZE, "MotomanAlarmHistory", 1, NULL);
-    if (alarm_history_class != NULL && alarm_history_class->instances != NULL) {
-        CipInstance *instance = alarm_history_class->instances;
-        int i = 0;
-        while (instance != NULL && i < MOTOMAN_ALARM_HISTORY_SIZE) {
-            InsertAttribute(instance, 1, kCipUdint, EncodeCipUdint, NULL, 
-                           &s_alarm_history[i].code, kGetableSingleAndAll);
-            InsertAttribute(instance, 2, kCipUdint, EncodeCipUdint, NULL, 
-                           &s_alarm_history[i].data, kGetableSingleAndAll);
-            InsertAttribute(instance, 3, kCipUdint, EncodeCipUdint, NULL, 
-                           &s_alarm_history[i].data_type, kGetableSingleAndAll);
-            InsertAttribute(instance, 4, 0xFF, EncodeMotomanAlarmDateTime16, NULL, 
-                           s_alarm_history[i].date_time, kGetableSingleAndAll);
-            InsertAttribute(instance, 5, 0xFF, EncodeMotomanAlarmString32, NULL, 
-                           s_alarm_history[i].string, kGetableSingleAndAll);
+    CipClass *alarm_history_class = CreateCipClass(MOTOMAN_CLASS_ALARM_HISTORY, 0, 7, 2, 5, 5, 2, 0, "MotomanAlarmHistory", 1, NULL);
+    if (alarm_history_class != NULL) {
+        if (kEipStatusOk != InsertAttributeDescriptors(alarm_history_class, s_alarm_attributes, 5)) {
+            ESP_LOGE(TAG, "%s: attribute descriptors not set", alarm_history_class->class_name);
+            return;
+        }
+        CipInstance *instance = AddCipInstances(alarm_history_class, MOTOMAN_ALARM_HISTORY_SIZE);
+        for (int i = 0; instance != NULL && i < MOTOMAN_ALARM_HISTORY_SIZE; i++) {
+            instance->data = &s_alarm_history[i];
             instance = instance->next;
-            i++;
         }
         InsertService(alarm_history_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(alarm_history_class, kGetAttributeAll, &GetAttributeAll, "GetAttributeAll");
+        // The history only changes with new alarms; scanners mostly poll the latest entries
+        EnableMotomanResponseCache(alarm_history_class, 64);
     }
 }
 
@@ -753,6 +1030,8 @@ static void CreateMotomanJobInfoClass(void) {
                        &s_speed_override, kGetableSingleAndAll);
         InsertService(job_info_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(job_info_class, kGetAttributeAll, &GetAttributeAll, "GetAttributeAll");
+        EnableMotomanResponseCache(job_info_class, 8);
+        s_job_info_class = job_info_class;
     }
 }
 
@@ -764,43 +1043,95 @@ static void CreateMotomanAxisConfigClass(void) {
                        &s_axis_count, kGetableSingle);
         InsertAttribute(instance, 2, kCipByte, EncodeCipByte, NULL, 
                        s_axis_type, kGetableSingle);
+        // Member N addresses the type of axis N
+        SetCipAttributeMembers(instance, 2, MOTOMAN_MAX_AXES);
         InsertService(axis_config_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
+        EnableMotomanResponseCache(axis_config_class, 4);
     }
 }
 
+// Position, deviation and torque data are arrays of DINTs in attribute order.
+// The first axis attribute also addresses all axes by member: member N is axis N.
+static const CipAttributeDescriptor s_position_attributes[MOTOMAN_POSITION_ATTRIBUTES] = {
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(1),
+    MOTOMAN_COMPUTED_DINT_ARRAY_ATTRIBUTE(2, MOTOMAN_MAX_AXES),
+    MOTOMAN_COMPUTED_DINT_ATTRIBUTE(3),
+    MOTOMAN_COMPUTED_DINT_ATTRIBUTE(4),
+    MOTOMAN_COMPUTED_DINT_ATTRIBUTE(5),
+    MOTOMAN_COMPUTED_DINT_ATTRIBUTE(6),
+    MOTOMAN_COMPUTED_DINT_ATTRIBUTE(7),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(8),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(9),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(10),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(11),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(12),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(13),
+};
+
+static const CipAttributeDescriptor s_axis_attributes[MOTOMAN_MAX_AXES] = {
+    MOTOMAN_READ_ONLY_DINT_ARRAY_ATTRIBUTE(1, MOTOMAN_MAX_AXES),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(2),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(3),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(4),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(5),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(6),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(7),
+    MOTOMAN_READ_ONLY_DINT_ATTRIBUTE(8),
+};
+
+// Instances 101-108 follow the pulses of instances 1-8; the kinematics run on
+// the first read after the pulses changed, further reads use the result
+static EipStatus MotomanPositionPreGetCallback(CipInstance *const instance,
+                                               CipAttributeStruct *const attribute,
+                                               CipByte service) {
+    (void)attribute;
+    (void)service;
+
+    if (instance->instance_number < MOTOMAN_BASE_POSITION_INSTANCE) {
+        return kEipStatusOk;
+    }
+    const EipUint32 robot = instance->instance_number - MOTOMAN_BASE_POSITION_INSTANCE;
+    if (robot < MOTOMAN_BASE_POSITION_INSTANCES && 0 != (s_base_position_dirty & (1U << robot))) {
+        MotomanKinematicsForward(&s_kinematics, &s_position_data[robot][1],
+                                 &s_position_data[MOTOMAN_BASE_POSITION_INSTANCE - 1 + robot][1]);
+        s_base_position_dirty &= (EipUint8)~(1U << robot);
+    }
+    return kEipStatusOk;
+}
+
 static void CreateMotomanPositionClass(void) {
     // Per Manual 165838-1CD, Table 5-6: Instances 1-8, 11-18, 21-44, 101-108
     // Attributes 1-13: 1=Data type, 2-9=Axis data, 10-13=Config/Tool/Reservation/ExtConfig
-    CipClass *position_class = CreateCipClass(MOTOMAN_CLASS_POSITION, 0, 7, 2, MOTOMAN_POSITION_ATTRIBUTES, MOTOMAN_POSITION_ATTRIBUTES, 2, MOTOMAN_MAX_POSITION_INSTANCES, "MotomanPosition", 1, NULL);
-    if (position_class != NULL && position_class->instances != NULL && s_position_data != NULL) {
-        CipInstance *instance = position_class->instances;
-        int inst_num = 1;
-        while (instance != NULL && inst_num <= MOTOMAN_MAX_POSITION_INSTANCES) {
-            for (EipUint16 attr = 1; attr <= MOTOMAN_POSITION_ATTRIBUTES; attr++) {
-                EipInt32 *data_ptr = &s_position_data[inst_num - 1][attr - 1];
-                InsertAttribute(instance, attr, kCipDint, EncodeCipDint, NULL, 
-                               data_ptr, kGetableSingleAndAll);
-            }
+    CipClass *position_class = CreateCipClass(MOTOMAN_CLASS_POSITION, 0, 7, 2, MOTOMAN_POSITION_ATTRIBUTES, MOTOMAN_POSITION_ATTRIBUTES, 2, 0, "MotomanPosition", 1, NULL);
+    if (position_class != NULL && s_position_data != NULL) {
+        if (kEipStatusOk != InsertAttributeDescriptors(position_class, s_position_attributes, MOTOMAN_POSITION_ATTRIBUTES)) {
+            ESP_LOGE(TAG, "%s: attribute descriptors not set", position_class->class_name);
+            return;
+        }
+        CipInstance *instance = AddCipInstances(position_class, MOTOMAN_MAX_POSITION_INSTANCES);
+        for (int inst_num = 1; instance != NULL && inst_num <= MOTOMAN_MAX_POSITION_INSTANCES; inst_num++) {
+            instance->data = s_position_data[inst_num - 1];
             instance = instance->next;
-            inst_num++;
         }
         InsertService(position_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(position_class, kGetAttributeAll, &GetAttributeAllPositionOrder, "GetAttributeAll");
+        MotomanKinematicsInit(&s_kinematics, MOTOMAN_ROBOT_MODEL);
+        InsertGetSetCallback(position_class, MotomanPositionPreGetCallback, kPreGetFunc);
+        ESP_LOGI(TAG, "Base coordinates computed for a %s", MotomanKinematicsGetModelName(MOTOMAN_ROBOT_MODEL));
     }
 }
 
 static void CreateMotomanPositionDeviationClass(void) {
-    CipClass *position_deviation_class = CreateCipClass(MOTOMAN_CLASS_POSITION_DEVIATION, 0, 7, 2, MOTOMAN_MAX_AXES, MOTOMAN_MAX_AXES, 2, MOTOMAN_MAX_AXES, "MotomanPositionDeviation", 1, NULL);
-    if (position_deviation_class != NULL && position_deviation_class->instances != NULL) {
-        CipInstance *instance = position_deviation_class->instances;
-        int inst_num = 1;
-        while (instance != NULL && inst_num <= MOTOMAN_MAX_AXES) {
-            for (EipUint16 attr = 1; attr <= MOTOMAN_MAX_AXES; attr++) {
-                InsertAttribute(instance, attr, kCipDint, EncodeCipDint, NULL, 
-                               &s_position_deviation[attr - 1], kGetableSingleAndAll);
-            }
+    CipClass *position_deviation_class = CreateCipClass(MOTOMAN_CLASS_POSITION_DEVIATION, 0, 7, 2, MOTOMAN_MAX_AXES, MOTOMAN_MAX_AXES, 2, 0, "MotomanPositionDeviation", 1, NULL);
+    if (position_deviation_class != NULL) {
+        if (kEipStatusOk != InsertAttributeDescriptors(position_deviation_class, s_axis_attributes, MOTOMAN_MAX_AXES)) {
+            ESP_LOGE(TAG, "%s: attribute descriptors not set", position_deviation_class->class_name);
+            return;
+        }
+        CipInstance *instance = AddCipInstances(position_deviation_class, MOTOMAN_MAX_AXES);
+        while (instance != NULL) {
+            instance->data = s_position_deviation;
             instance = instance->next;
-            inst_num++;
         }
         InsertService(position_deviation_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(position_deviation_class, kGetAttributeAll, &GetAttributeAll, "GetAttributeAll");
@@ -808,196 +1139,214 @@ static void CreateMotomanPositionDeviationClass(void) {
 }
 
 static void CreateMotomanTorqueClass(void) {
-    CipClass *torque_class = CreateCipClass(MOTOMAN_CLASS_TORQUE, 0, 7, 2, MOTOMAN_MAX_AXES, MOTOMAN_MAX_AXES, 2, MOTOMAN_MAX_AXES, "MotomanTorque", 1, NULL);
-    if (torque_class != NULL && torque_class->instances != NULL) {
-        CipInstance *instance = torque_class->instances;
-        int inst_num = 1;
-        while (instance != NULL && inst_num <= MOTOMAN_MAX_AXES) {
-            for (EipUint16 attr = 1; attr <= MOTOMAN_MAX_AXES; attr++) {
-                InsertAttribute(instance, attr, kCipDint, EncodeCipDint, NULL, 
-                               &s_torque[attr - 1], kGetableSingleAndAll);
-            }
+    CipClass *torque_class = CreateCipClass(MOTOMAN_CLASS_TORQUE, 0, 7, 2, MOTOMAN_MAX_AXES, MOTOMAN_MAX_AXES, 2, 0, "MotomanTorque", 1, NULL);
+    if (torque_class != NULL) {
+        if (kEipStatusOk != InsertAttributeDescriptors(torque_class, s_axis_attributes, MOTOMAN_MAX_AXES)) {
+            ESP_LOGE(TAG, "%s: attribute descriptors not set", torque_class->class_name);
+            return;
+        }
+        CipInstance *instance = AddCipInstances(torque_class, MOTOMAN_MAX_AXES);
+        while (instance != NULL) {
+            instance->data = s_torque;
             instance = instance->next;
-            inst_num++;
         }
         InsertService(torque_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(torque_class, kGetAttributeAll, &GetAttributeAll, "GetAttributeAll");
     }
 }
 
+// The data classes below are backed directly by their arrays: instance N is
+// resolved to element N-1 on request and shares one const attribute table.
+static const CipAttributeDescriptor s_io_attributes[] = {
+    MOTOMAN_SETTABLE_ATTRIBUTE(1, kCipUsint, EncodeCipUsint, DecodeCipUsint, kSetAndGetAble | kPostSetFunc),
+};
+
+static EipStatus MotomanIoPostSetCallback(CipInstance *const instance,
+                                          CipAttributeStruct *const attribute,
+                                          CipByte service) {
+    (void)attribute;
+    (void)service;
+    MarkMotomanIoInstancesDirty(instance, 1);
+    return kEipStatusOk;
+}
+
 static void CreateMotomanIOClass(void) {
-    CipClass *io_class = CreateCipClass(MOTOMAN_CLASS_IO, 0, 7, 2, 1, 1, 2, MOTOMAN_MAX_IO_SIGNALS, "MotomanIO", 1, NULL);
-    if (io_class != NULL && io_class->instances != NULL) {
-        CipInstance *instance = io_class->instances;
-        int i = 0;
-        while (instance != NULL && i < MOTOMAN_MAX_IO_SIGNALS) {
-            InsertAttribute(instance, 1, kCipUsint, EncodeCipUsint, (CipAttributeDecodeFromMessage)DecodeCipUsint, 
-                           &s_io_data[i], kSetAndGetAble);
-            instance = instance->next;
-            i++;
+    CipClass *io_class = CreateCipClass(MOTOMAN_CLASS_IO, 0, 7, 2, 1, 1, 4, 0, "MotomanIO", 1, NULL);
+    if (io_class != NULL && s_io_data != NULL) {
+        if (!AddMotomanVirtualInstances(io_class, s_io_attributes, 1, MOTOMAN_MAX_IO_SIGNALS, s_io_data, sizeof(s_io_data[0]))) {
+            return;
         }
         InsertService(io_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(io_class, kSetAttributeSingle, &SetAttributeSingle, "SetAttributeSingle");
+        InsertGetSetCallback(io_class, MotomanIoPostSetCallback, kPostSetFunc);
+        InsertMotomanBlockServices(io_class);
     }
 }
 
+static const CipAttributeDescriptor s_register_attributes[] = {
+    MOTOMAN_SETTABLE_ATTRIBUTE(1, kCipUint, EncodeCipUint, DecodeCipUint, kSetAndGetAble | kPostSetFunc),
+};
+
 static void CreateMotomanRegisterClass(void) {
     // Note: In CIP, instance 0 is reserved for the class object, so we cannot create a data instance 0.
     // RS022=1: Instance 1 maps to Register[0], Instance 2 maps to Register[1], etc. (instance N = Register[N-1])
     // RS022=0: Instance 1 maps to Register[0], Instance 2 maps to Register[1], etc. (instance N = Register[N-1])
     // Both modes map the same way due to CIP's instance 0 reservation.
-    CipClass *register_class = CreateCipClass(MOTOMAN_CLASS_REGISTER, 0, 7, 2, 1, 1, 2, MOTOMAN_MAX_REGISTERS, "MotomanRegister", 1, NULL);
+    CipClass *register_class = CreateCipClass(MOTOMAN_CLASS_REGISTER, 0, 7, 2, 1, 1, 4, 0, "MotomanRegister", 1, NULL);
     if (register_class != NULL && s_registers != NULL) {
-        CipInstance *instance = register_class->instances;
-        while (instance != NULL) {
-            int array_idx = GetArrayIndexFromInstance(instance->instance_number);
-            if (array_idx >= 0 && array_idx < MOTOMAN_MAX_REGISTERS) {
-                InsertAttribute(instance, 1, kCipUint, EncodeCipUint, (CipAttributeDecodeFromMessage)DecodeCipUint, 
-                               &s_registers[array_idx], kSetAndGetAble);
-            }
-            instance = instance->next;
+        if (!AddMotomanVirtualInstances(register_class, s_register_attributes, 1, MOTOMAN_MAX_REGISTERS, s_registers, sizeof(s_registers[0]))) {
+            return;
         }
         InsertService(register_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(register_class, kSetAttributeSingle, &SetAttributeSingle, "SetAttributeSingle");
+        InsertGetSetCallback(register_class, MotomanIoPostSetCallback, kPostSetFunc);
+        InsertMotomanBlockServices(register_class);
     }
 }
 
+static const CipAttributeDescriptor s_variable_b_attributes[] = {
+    MOTOMAN_SETTABLE_ATTRIBUTE(1, kCipUsint, EncodeCipUsint, DecodeCipUsint, kSetAndGetAble),
+};
+
 static void CreateMotomanVariableBClass(void) {
     // Note: In CIP, instance 0 is reserved for the class object, so instance N maps to variable[N-1]
-    CipClass *var_b_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_B, 0, 7, 2, 1, 1, 2, MOTOMAN_MAX_VARIABLES, "MotomanVariableB", 1, NULL);
+    CipClass *var_b_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_B, 0, 7, 2, 1, 1, 4, 0, "MotomanVariableB", 1, NULL);
     if (var_b_class != NULL && s_variable_b != NULL) {
-        CipInstance *instance = var_b_class->instances;
-        while (instance != NULL) {
-            int array_idx = GetArrayIndexFromInstance(instance->instance_number);
-            if (array_idx >= 0 && array_idx < MOTOMAN_MAX_VARIABLES) {
-                InsertAttribute(instance, 1, kCipUsint, EncodeCipUsint, (CipAttributeDecodeFromMessage)DecodeCipUsint, 
-                               &s_variable_b[array_idx], kSetAndGetAble);
-            }
-            instance = instance->next;
+        if (!AddMotomanVirtualInstances(var_b_class, s_variable_b_attributes, 1, MOTOMAN_MAX_VARIABLES, s_variable_b, sizeof(s_variable_b[0]))) {
+            return;
         }
         InsertService(var_b_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(var_b_class, kSetAttributeSingle, &SetAttributeSingle, "SetAttributeSingle");
+        InsertMotomanBlockServices(var_b_class);
     }
 }
 
+static const CipAttributeDescriptor s_variable_i_attributes[] = {
+    MOTOMAN_SETTABLE_ATTRIBUTE(1, kCipInt, EncodeCipInt, DecodeCipInt, kSetAndGetAble),
+};
+
 static void CreateMotomanVariableIClass(void) {
     // Note: In CIP, instance 0 is reserved for the class object, so instance N maps to variable[N-1]
-    CipClass *var_i_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_I, 0, 7, 2, 1, 1, 2, MOTOMAN_MAX_VARIABLES, "MotomanVariableI", 1, NULL);
+    CipClass *var_i_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_I, 0, 7, 2, 1, 1, 4, 0, "MotomanVariableI", 1, NULL);
     if (var_i_class != NULL && s_variable_i != NULL) {
-        CipInstance *instance = var_i_class->instances;
-        while (instance != NULL) {
-            int array_idx = GetArrayIndexFromInstance(instance->instance_number);
-            if (array_idx >= 0 && array_idx < MOTOMAN_MAX_VARIABLES) {
-                InsertAttribute(instance, 1, kCipInt, EncodeCipInt, (CipAttributeDecodeFromMessage)DecodeCipInt, 
-                               &s_variable_i[array_idx], kSetAndGetAble);
-            }
-            instance = instance->next;
+        if (!AddMotomanVirtualInstances(var_i_class, s_variable_i_attributes, 1, MOTOMAN_MAX_VARIABLES, s_variable_i, sizeof(s_variable_i[0]))) {
+            return;
         }
         InsertService(var_i_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(var_i_class, kSetAttributeSingle, &SetAttributeSingle, "SetAttributeSingle");
+        InsertMotomanBlockServices(var_i_class);
     }
 }
 
+static const CipAttributeDescriptor s_variable_d_attributes[] = {
+    MOTOMAN_SETTABLE_ATTRIBUTE(1, kCipDint, EncodeCipDint, DecodeCipDint, kSetAndGetAble),
+};
+
 static void CreateMotomanVariableDClass(void) {
     // Note: In CIP, instance 0 is reserved for the class object, so instance N maps to variable[N-1]
-    CipClass *var_d_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_D, 0, 7, 2, 1, 1, 2, MOTOMAN_MAX_VARIABLES, "MotomanVariableD", 1, NULL);
+    CipClass *var_d_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_D, 0, 7, 2, 1, 1, 4, 0, "MotomanVariableD", 1, NULL);
     if (var_d_class != NULL && s_variable_d != NULL) {
-        CipInstance *instance = var_d_class->instances;
-        while (instance != NULL) {
-            int array_idx = GetArrayIndexFromInstance(instance->instance_number);
-            if (array_idx >= 0 && array_idx < MOTOMAN_MAX_VARIABLES) {
-                InsertAttribute(instance, 1, kCipDint, EncodeCipDint, (CipAttributeDecodeFromMessage)DecodeCipDint, 
-                               &s_variable_d[array_idx], kSetAndGetAble);
-            }
-            instance = instance->next;
+        if (!AddMotomanVirtualInstances(var_d_class, s_variable_d_attributes, 1, MOTOMAN_MAX_VARIABLES, s_variable_d, sizeof(s_variable_d[0]))) {
+            return;
         }
         InsertService(var_d_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(var_d_class, kSetAttributeSingle, &SetAttributeSingle, "SetAttributeSingle");
+        InsertMotomanBlockServices(var_d_class);
     }
 }
 
+static const CipAttributeDescriptor s_variable_r_attributes[] = {
+    MOTOMAN_SETTABLE_ATTRIBUTE(1, kCipReal, EncodeCipReal, DecodeCipReal, kSetAndGetAble),
+};
+
 static void CreateMotomanVariableRClass(void) {
     // Note: In CIP, instance 0 is reserved for the class object, so instance N maps to variable[N-1]
-    CipClass *var_r_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_R, 0, 7, 2, 1, 1, 2, MOTOMAN_MAX_VARIABLES, "MotomanVariableR", 1, NULL);
+    CipClass *var_r_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_R, 0, 7, 2, 1, 1, 4, 0, "MotomanVariableR", 1, NULL);
     if (var_r_class != NULL && s_variable_r != NULL) {
-        CipInstance *instance = var_r_class->instances;
-        while (instance != NULL) {
-            int array_idx = GetArrayIndexFromInstance(instance->instance_number);
-            if (array_idx >= 0 && array_idx < MOTOMAN_MAX_VARIABLES) {
-                InsertAttribute(instance, 1, kCipReal, EncodeCipReal, (CipAttributeDecodeFromMessage)DecodeCipReal, 
-                               &s_variable_r[array_idx], kSetAndGetAble);
-            }
-            instance = instance->next;
+        if (!AddMotomanVirtualInstances(var_r_class, s_variable_r_attributes, 1, MOTOMAN_MAX_VARIABLES, s_variable_r, sizeof(s_variable_r[0]))) {
+            return;
         }
         InsertService(var_r_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(var_r_class, kSetAttributeSingle, &SetAttributeSingle, "SetAttributeSingle");
+        InsertMotomanBlockServices(var_r_class);
     }
 }
 
+static const CipAttributeDescriptor s_variable_s_attributes[] = {
+    MOTOMAN_SETTABLE_ATTRIBUTE(1, 0xFF, EncodeMotomanString32, DecodeMotomanString32, kSetAndGetAble),
+};
+
 static void CreateMotomanVariableSClass(void) {
     // Note: In CIP, instance 0 is reserved for the class object, so instance N maps to variable[N-1]
-    CipClass *var_s_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_S, 0, 7, 2, 1, 1, 2, MOTOMAN_MAX_VARIABLES, "MotomanVariableS", 1, NULL);
+    CipClass *var_s_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_S, 0, 7, 2, 1, 1, 4, 0, "MotomanVariableS", 1, NULL);
     if (var_s_class != NULL && s_variable_s != NULL) {
-        CipInstance *instance = var_s_class->instances;
-        while (instance != NULL) {
-            int array_idx = GetArrayIndexFromInstance(instance->instance_number);
-            if (array_idx >= 0 && array_idx < MOTOMAN_MAX_VARIABLES) {
-                InsertAttribute(instance, 1, 0xFF, EncodeMotomanString32, (CipAttributeDecodeFromMessage)DecodeMotomanString32, 
-                               &s_variable_s[array_idx], kSetAndGetAble);
-            }
-            instance = instance->next;
+        if (!AddMotomanVirtualInstances(var_s_class, s_variable_s_attributes, 1, MOTOMAN_MAX_VARIABLES, s_variable_s, sizeof(s_variable_s[0]))) {
+            return;
         }
         InsertService(var_s_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(var_s_class, kSetAttributeSingle, &SetAttributeSingle, "SetAttributeSingle");
+        InsertMotomanBlockServices(var_s_class);
     }
 }
 
+static const CipAttributeDescriptor s_variable_p_attributes[MOTOMAN_VARIABLE_P_ATTRIBUTES] = {
+    MOTOMAN_DINT_ATTRIBUTE(1, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(2, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(3, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(4, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(5, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(6, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(7, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(8, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(9, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(10, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(11, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(12, kSetAndGetAble | kGetableAll),
+    MOTOMAN_DINT_ATTRIBUTE(13, kSetAndGetAble | kGetableAll),
+};
+
 static void CreateMotomanVariablePClass(void) {
     // Per Manual 165838-1CD, Table 5-16: Attributes 1-13 (same as Position class)
     // Attribute 1: Data type, Attributes 2-9: Axis data, Attributes 10-13: Config/Tool/UserCoord/ExtConfig
     // RS022=1: Instance 1 = P[1], Instance 2 = P[2], etc.
     // RS022=0: Instance 1 = P[0], Instance 2 = P[1], etc.
-    CipClass *var_p_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_P, 0, 7, 2, MOTOMAN_VARIABLE_P_ATTRIBUTES, MOTOMAN_VARIABLE_P_ATTRIBUTES, 4, MOTOMAN_MAX_VARIABLE_P, "MotomanVariableP", 1, NULL);
+    CipClass *var_p_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_P, 0, 7, 2, MOTOMAN_VARIABLE_P_ATTRIBUTES, MOTOMAN_VARIABLE_P_ATTRIBUTES, 6, 0, "MotomanVariableP", 1, NULL);
     if (var_p_class != NULL && s_variable_p != NULL) {
-        CipInstance *instance = var_p_class->instances;
-        while (instance != NULL) {
-            int array_idx = GetArrayIndexFromInstance(instance->instance_number);
-            if (array_idx >= 0 && array_idx < MOTOMAN_MAX_VARIABLE_P) {
-                for (EipUint16 attr = 1; attr <= MOTOMAN_VARIABLE_P_ATTRIBUTES; attr++) {
-                    EipInt32 *data_ptr = &s_variable_p[array_idx][attr - 1];
-                    InsertAttribute(instance, attr, kCipDint, EncodeCipDint, (CipAttributeDecodeFromMessage)DecodeCipDint, 
-                                   data_ptr, kSetAndGetAble | kGetableAll);
-                }
-            }
-            instance = instance->next;
+        if (!AddMotomanVirtualInstances(var_p_class, s_variable_p_attributes, MOTOMAN_VARIABLE_P_ATTRIBUTES, MOTOMAN_MAX_VARIABLE_P, s_variable_p, sizeof(s_variable_p[0]))) {
+            return;
         }
         InsertService(var_p_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(var_p_class, kGetAttributeAll, &GetAttributeAllPositionOrder, "GetAttributeAll");
         InsertService(var_p_class, kSetAttributeSingle, &SetAttributeSingle, "SetAttributeSingle");
         InsertService(var_p_class, kSetAttributeAll, &SetAttributeAll, "SetAttributeAll");
+        InsertMotomanBlockServices(var_p_class);
     }
 }
 
+static const CipAttributeDescriptor s_variable_axis_attributes[MOTOMAN_VARIABLE_BP_ATTRIBUTES] = {
+    MOTOMAN_DINT_ATTRIBUTE(1, kSetAndGetAble),
+    MOTOMAN_DINT_ATTRIBUTE(2, kSetAndGetAble),
+    MOTOMAN_DINT_ATTRIBUTE(3, kSetAndGetAble),
+    MOTOMAN_DINT_ATTRIBUTE(4, kSetAndGetAble),
+    MOTOMAN_DINT_ATTRIBUTE(5, kSetAndGetAble),
+    MOTOMAN_DINT_ATTRIBUTE(6, kSetAndGetAble),
+    MOTOMAN_DINT_ATTRIBUTE(7, kSetAndGetAble),
+    MOTOMAN_DINT_ATTRIBUTE(8, kSetAndGetAble),
+    MOTOMAN_DINT_ATTRIBUTE(9, kSetAndGetAble),
+};
+
 static void CreateMotomanVariableBPClass(void) {
     // Per Manual 165838-1CD, Table 5-17: Attributes 1-9
     // Attribute 1: Data type, Attributes 2-9: 1st-8th axis data
     // Note: In CIP, instance 0 is reserved for the class object, so instance N maps to variable[N-1]
-    CipClass *var_bp_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_BP, 0, 7, 2, MOTOMAN_VARIABLE_BP_ATTRIBUTES, MOTOMAN_VARIABLE_BP_ATTRIBUTES, 2, MOTOMAN_MAX_VARIABLES, "MotomanVariableBP", 1, NULL);
+    CipClass *var_bp_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_BP, 0, 7, 2, MOTOMAN_VARIABLE_BP_ATTRIBUTES, MOTOMAN_VARIABLE_BP_ATTRIBUTES, 4, 0, "MotomanVariableBP", 1, NULL);
     if (var_bp_class != NULL && s_variable_bp != NULL) {
-        CipInstance *instance = var_bp_class->instances;
-        while (instance != NULL) {
-            int array_idx = GetArrayIndexFromInstance(instance->instance_number);
-            if (array_idx >= 0 && array_idx < MOTOMAN_MAX_VARIABLES) {
-                for (EipUint16 attr = 1; attr <= MOTOMAN_VARIABLE_BP_ATTRIBUTES; attr++) {
-                    EipInt32 *data_ptr = &s_variable_bp[array_idx][attr - 1];
-                    InsertAttribute(instance, attr, kCipDint, EncodeCipDint, (CipAttributeDecodeFromMessage)DecodeCipDint, 
-                                   data_ptr, kSetAndGetAble);
-                }
-            }
-            instance = instance->next;
+        if (!AddMotomanVirtualInstances(var_bp_class, s_variable_axis_attributes, MOTOMAN_VARIABLE_BP_ATTRIBUTES, MOTOMAN_MAX_VARIABLES, s_variable_bp, sizeof(s_variable_bp[0]))) {
+            return;
         }
         InsertService(var_bp_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(var_bp_class, kSetAttributeSingle, &SetAttributeSingle, "SetAttributeSingle");
+        InsertMotomanBlockServices(var_bp_class);
     }
 }
 
@@ -1005,25 +1354,369 @@ static void CreateMotomanVariableEXClass(void) {
     // Per Manual 165838-1CD, Table 5-18: Attributes 1-9
     // Attribute 1: Data type, Attributes 2-9: 1st-8th axis data
     // Note: In CIP, instance 0 is reserved for the class object, so instance N maps to variable[N-1]
-    CipClass *var_ex_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_EX, 0, 7, 2, MOTOMAN_VARIABLE_EX_ATTRIBUTES, MOTOMAN_VARIABLE_EX_ATTRIBUTES, 2, MOTOMAN_MAX_VARIABLES, "MotomanVariableEX", 1, NULL);
+    CipClass *var_ex_class = CreateCipClass(MOTOMAN_CLASS_VARIABLE_EX, 0, 7, 2, MOTOMAN_VARIABLE_EX_ATTRIBUTES, MOTOMAN_VARIABLE_EX_ATTRIBUTES, 4, 0, "MotomanVariableEX", 1, NULL);
     if (var_ex_class != NULL && s_variable_ex != NULL) {
-        CipInstance *instance = var_ex_class->instances;
-        while (instance != NULL) {
-            int array_idx = GetArrayIndexFromInstance(instance->instance_number);
-            if (array_idx >= 0 && array_idx < MOTOMAN_MAX_VARIABLES) {
-                for (EipUint16 attr = 1; attr <= MOTOMAN_VARIABLE_EX_ATTRIBUTES; attr++) {
-                    EipInt32 *data_ptr = &s_variable_ex[array_idx][attr - 1];
-                    InsertAttribute(instance, attr, kCipDint, EncodeCipDint, (CipAttributeDecodeFromMessage)DecodeCipDint, 
-                                   data_ptr, kSetAndGetAble);
-                }
-            }
-            instance = instance->next;
+        if (!AddMotomanVirtualInstances(var_ex_class, s_variable_axis_attributes, MOTOMAN_VARIABLE_EX_ATTRIBUTES, MOTOMAN_MAX_VARIABLES, s_variable_ex, sizeof(s_variable_ex[0]))) {
+            return;
         }
         InsertService(var_ex_class, kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle");
         InsertService(var_ex_class, kSetAttributeSingle, &SetAttributeSingle, "SetAttributeSingle");
+        InsertMotomanBlockServices(var_ex_class);
+    }
+}
+
+// A run of assembly bytes backed by contiguous robot data, count elements of
+// source starting at first
+typedef struct {
+    EipUint8 *data;
+    size_t assembly_offset;
+    size_t length;
+    uint8_t source;
+    size_t first;
+    size_t count;
+} MotomanIoSpan;
+
+typedef struct {
+    CipInstance *instance;
+    EipUint8 data[MOTOMAN_MAX_ASSEMBLY_SIZE];
+    size_t length;
+    MotomanIoSpan spans[MOTOMAN_MAX_IO_SPANS];
+    size_t span_count;
+} MotomanIoAssembly;
+
+static MotomanIoAssembly s_input_assembly;
+static MotomanIoAssembly s_output_assembly;
+
+// Elements first up to end (exclusive) of a source written since the input
+// assembly has been packed last, empty if first == end
+typedef struct {
+    size_t first;
+    size_t end;
+} MotomanDirtyRange;
+
+static MotomanDirtyRange s_input_dirty_ranges[SYSTEM_MOTOMAN_IO_SOURCE_COUNT];
+static bool s_input_assembly_dirty = false;
+
+static const char *const s_io_source_names[SYSTEM_MOTOMAN_IO_SOURCE_COUNT] = {
+    [SYSTEM_MOTOMAN_IO_SOURCE_STATUS] = "status",
+    [SYSTEM_MOTOMAN_IO_SOURCE_POSITION] = "position",
+    [SYSTEM_MOTOMAN_IO_SOURCE_TORQUE] = "torque",
+    [SYSTEM_MOTOMAN_IO_SOURCE_IO] = "io",
+    [SYSTEM_MOTOMAN_IO_SOURCE_REGISTER] = "register",
+};
+
+// Returns the element of an I/O map source at index and its size, NULL if out of range
+static EipUint8 *GetMotomanIoElement(uint8_t source, size_t index, size_t *element_size) {
+    switch (source) {
+        case SYSTEM_MOTOMAN_IO_SOURCE_STATUS:
+            *element_size = sizeof(EipUint32);
+            return 0 == index ? (EipUint8 *)&s_status_data1 :
+                   1 == index ? (EipUint8 *)&s_status_data2 : NULL;
+        case SYSTEM_MOTOMAN_IO_SOURCE_POSITION:
+            *element_size = sizeof(s_position[0]);
+            return index < MOTOMAN_MAX_AXES ? (EipUint8 *)&s_position[index] : NULL;
+        case SYSTEM_MOTOMAN_IO_SOURCE_TORQUE:
+            *element_size = sizeof(s_torque[0]);
+            return index < MOTOMAN_MAX_AXES ? (EipUint8 *)&s_torque[index] : NULL;
+        case SYSTEM_MOTOMAN_IO_SOURCE_IO:
+            *element_size = sizeof(s_io_data[0]);
+            return index < MOTOMAN_MAX_IO_SIGNALS ? &s_io_data[index] : NULL;
+        case SYSTEM_MOTOMAN_IO_SOURCE_REGISTER:
+            *element_size = sizeof(s_registers[0]);
+            return index < MOTOMAN_MAX_REGISTERS ? (EipUint8 *)&s_registers[index] : NULL;
+        default:
+            return NULL;
     }
 }
 
+// The scanner may only write the data that is writable by explicit messages too
+static bool IsMotomanIoSourceWritable(uint8_t source) {
+    return SYSTEM_MOTOMAN_IO_SOURCE_IO == source || SYSTEM_MOTOMAN_IO_SOURCE_REGISTER == source;
+}
+
+// Lays the map entries out one after the other; elements that are contiguous
+// in the robot data and in the assembly are copied as one span.
+static void BuildMotomanIoAssembly(MotomanIoAssembly *const assembly,
+                                   const system_motoman_io_map_entry_t *const entries,
+                                   uint8_t entry_count,
+                                   bool output) {
+    assembly->length = 0;
+    assembly->span_count = 0;
+    for (uint8_t i = 0; i < entry_count; i++) {
+        const system_motoman_io_map_entry_t *entry = &entries[i];
+        if (entry->source >= SYSTEM_MOTOMAN_IO_SOURCE_COUNT ||
+            (output && !IsMotomanIoSourceWritable(entry->source))) {
+            ESP_LOGW(TAG, "I/O map: %s entry %u not usable, skipped", output ? "output" : "input", i);
+            continue;
+        }
+        for (size_t n = 0; n < entry->count; n++) {
+            size_t element_size = 0;
+            EipUint8 *element = GetMotomanIoElement(entry->source, (size_t)entry->first + n, &element_size);
+            if (element == NULL || assembly->length + element_size > MOTOMAN_MAX_ASSEMBLY_SIZE) {
+                ESP_LOGW(TAG, "I/O map: %s %s %u-%u truncated after %u elements",
+                         output ? "output" : "input", s_io_source_names[entry->source],
+                         entry->first, entry->first + entry->count - 1, (unsigned)n);
+                break;
+            }
+            MotomanIoSpan *span = assembly->span_count > 0 ? &assembly->spans[assembly->span_count - 1] : NULL;
+            if (span != NULL && span->data + span->length == element &&
+                span->assembly_offset + span->length == assembly->length) {
+                span->length += element_size;
+                span->count++;
+            } else if (assembly->span_count < MOTOMAN_MAX_IO_SPANS) {
+                span = &assembly->spans[assembly->span_count++];
+                span->data = element;
+                span->assembly_offset = assembly->length;
+                span->length = element_size;
+                span->source = entry->source;
+                span->first = (size_t)entry->first + n;
+                span->count = 1;
+            } else {
+                break;
+            }
+            assembly->length += element_size;
+        }
+    }
+}
+
+static void PackMotomanIoAssembly(MotomanIoAssembly *const assembly) {
+    for (size_t i = 0; i < assembly->span_count; i++) {
+        const MotomanIoSpan *span = &assembly->spans[i];
+        memcpy(&assembly->data[span->assembly_offset], span->data, span->length);
+    }
+}
+
+// Copies only the elements written since the last packing, the spans of a
+// source hold elements of one size
+static void PackDirtyMotomanIoAssembly(MotomanIoAssembly *const assembly,
+                                       const MotomanDirtyRange *const dirty_ranges) {
+    for (size_t i = 0; i < assembly->span_count; i++) {
+        const MotomanIoSpan *span = &assembly->spans[i];
+        const MotomanDirtyRange *range = &dirty_ranges[span->source];
+        const size_t first = range->first > span->first ? range->first : span->first;
+        const size_t end = range->end < span->first + span->count ? range->end : span->first + span->count;
+        if (first < end) {
+            const size_t element_size = span->length / span->count;
+            const size_t offset = (first - span->first) * element_size;
+            memcpy(&assembly->data[span->assembly_offset + offset], span->data + offset,
+                   (end - first) * element_size);
+        }
+    }
+}
+
+// Only spans whose data actually changes are marked, the scanner repeats the
+// same output data every RPI
+static void UnpackMotomanIoAssembly(const MotomanIoAssembly *const assembly) {
+    for (size_t i = 0; i < assembly->span_count; i++) {
+        const MotomanIoSpan *span = &assembly->spans[i];
+        if (0 != memcmp(span->data, &assembly->data[span->assembly_offset], span->length)) {
+            memcpy(span->data, &assembly->data[span->assembly_offset], span->length);
+            MarkMotomanIoDirty(span->source, span->first, span->count);
+        }
+    }
+}
+
+// Change of state and application triggered connections producing the input
+// assembly, cyclic ones are left alone by TriggerConnections()
+static void TriggerMotomanIoConnections(void) {
+    TriggerConnections(MOTOMAN_OUTPUT_ASSEMBLY, MOTOMAN_INPUT_ASSEMBLY);
+    TriggerConnections(MOTOMAN_HEARTBEAT_INPUT_ONLY_ASSEMBLY, MOTOMAN_INPUT_ASSEMBLY);
+    TriggerConnections(MOTOMAN_HEARTBEAT_LISTEN_ONLY_ASSEMBLY, MOTOMAN_INPUT_ASSEMBLY);
+}
+
+// Widens the dirty range of source by the written elements if the input
+// assembly carries any of them with a value other than the one packed last.
+// Only the first change after a packing triggers the connections, the
+// production inhibit time spaces their productions.
+static void MarkMotomanIoDirty(uint8_t source, size_t first, size_t count) {
+    const size_t end = first + count;
+    bool changed = false;
+
+    if (source >= SYSTEM_MOTOMAN_IO_SOURCE_COUNT || 0 == count) {
+        return;
+    }
+    for (size_t i = 0; i < s_input_assembly.span_count && !changed; i++) {
+        const MotomanIoSpan *span = &s_input_assembly.spans[i];
+        const size_t span_first = first > span->first ? first : span->first;
+        const size_t span_end = end < span->first + span->count ? end : span->first + span->count;
+        if (span->source == source && span_first < span_end) {
+            const size_t element_size = span->length / span->count;
+            const size_t offset = (span_first - span->first) * element_size;
+            changed = 0 != memcmp(&s_input_assembly.data[span->assembly_offset + offset], span->data + offset,
+                                  (span_end - span_first) * element_size);
+        }
+    }
+    if (!changed) {
+        return;
+    }
+
+    MotomanDirtyRange *range = &s_input_dirty_ranges[source];
+    if (range->first == range->end) {
+        range->first = first;
+        range->end = end;
+    } else {
+        range->first = first < range->first ? first : range->first;
+        range->end = end > range->end ? end : range->end;
+    }
+    if (!s_input_assembly_dirty) {
+        s_input_assembly_dirty = true;
+        TriggerMotomanIoConnections();
+    }
+}
+
+static void CreateMotomanIoAssemblies(void) {
+    system_motoman_io_map_t map;
+    system_motoman_io_map_load(&map);
+
+    BuildMotomanIoAssembly(&s_input_assembly, map.input, map.input_entry_count, false);
+    BuildMotomanIoAssembly(&s_output_assembly, map.output, map.output_entry_count, true);
+    PackMotomanIoAssembly(&s_input_assembly);
+    PackMotomanIoAssembly(&s_output_assembly);
+
+    s_input_assembly.instance = CreateAssemblyObject(MOTOMAN_INPUT_ASSEMBLY, s_input_assembly.data,
+                                                     (EipUint16)s_input_assembly.length);
+    s_output_assembly.instance = CreateAssemblyObject(MOTOMAN_OUTPUT_ASSEMBLY, s_output_assembly.data,
+                                                      (EipUint16)s_output_assembly.length);
+    CreateAssemblyObject(MOTOMAN_CONFIG_ASSEMBLY, NULL, 0);
+    CreateAssemblyObject(MOTOMAN_HEARTBEAT_INPUT_ONLY_ASSEMBLY, NULL, 0);
+    CreateAssemblyObject(MOTOMAN_HEARTBEAT_LISTEN_ONLY_ASSEMBLY, NULL, 0);
+
+    ConfigureExclusiveOwnerConnectionPoint(0, MOTOMAN_OUTPUT_ASSEMBLY, MOTOMAN_INPUT_ASSEMBLY,
+                                           MOTOMAN_CONFIG_ASSEMBLY);
+    ConfigureInputOnlyConnectionPoint(0, MOTOMAN_HEARTBEAT_INPUT_ONLY_ASSEMBLY, MOTOMAN_INPUT_ASSEMBLY,
+                                      MOTOMAN_CONFIG_ASSEMBLY);
+    ConfigureListenOnlyConnectionPoint(0, MOTOMAN_HEARTBEAT_LISTEN_ONLY_ASSEMBLY, MOTOMAN_INPUT_ASSEMBLY,
+                                       MOTOMAN_CONFIG_ASSEMBLY);
+
+    ESP_LOGI(TAG, "I/O assemblies: input %d (%zu bytes), output %d (%zu bytes)",
+             MOTOMAN_INPUT_ASSEMBLY, s_input_assembly.length,
+             MOTOMAN_OUTPUT_ASSEMBLY, s_output_assembly.length);
+}
+
+// Executes the job up to its next move; moves to where the robot is already
+// take no time and the job goes on within the same step
+static void RunMotomanJob(void) {
+    unsigned int budget = MOTOMAN_JOB_INSTRUCTIONS_PER_STEP;
+    MotomanJobMove move;
+
+    while (MotomanJobRun(&s_job, &s_job_variables, MOTOMAN_MOTION_PERIOD_US, &budget, &move)) {
+        if (MotomanMotionMoveTo(&s_motion, move.target, move.speed_ratio * s_speed_override / MOTOMAN_MOTION_FULL_SPEED)) {
+            break;
+        }
+    }
+    if (s_job.line != s_job_line || s_job.step != s_step_number) {
+        s_job_line = s_job.line;
+        s_step_number = s_job.step;
+        InvalidateCipResponseCache(s_job_info_class);
+    }
+}
+
+// Called at every step the robot does not move: the job played back decides
+// on the next move, without one the demo moves the robot between its initial
+// position and a second pose
+static void StartNextMotomanMove(void) {
+    if (0 != s_job.instruction_count) {
+        RunMotomanJob();
+        return;
+    }
+#if defined(CONFIG_MOTOMAN_MOTION_DEMO)
+    if (s_demo_dwell_steps > 0) {
+        s_demo_dwell_steps--;
+        return;
+    }
+    EipInt32 target[MOTOMAN_MAX_AXES];
+    s_demo_away = !s_demo_away;
+    for (int axis = 0; axis < MOTOMAN_MAX_AXES; axis++) {
+        target[axis] = s_demo_home[axis] + (s_demo_away ? s_demo_offset[axis] : 0);
+    }
+    MotomanMotionMoveTo(&s_motion, target, MOTOMAN_MOTION_DEMO_SPEED * s_speed_override / MOTOMAN_MOTION_FULL_SPEED);
+    s_demo_dwell_steps = MOTOMAN_MOTION_DEMO_DWELL_US / MOTOMAN_MOTION_PERIOD_US;
+#endif
+}
+
+static void InitializeMotomanMotion(void) {
+    s_motion.step_period = MOTOMAN_MOTION_PERIOD_US;
+    s_motion.acceleration_steps = MOTOMAN_MOTION_ACCELERATION_TIME_US / MOTOMAN_MOTION_PERIOD_US;
+    s_motion.position_gain = MOTOMAN_MOTION_POSITION_GAIN;
+    s_motion.axis_count = s_axis_count;
+    memcpy(s_motion.axes, s_axis_models, sizeof(s_motion.axes));
+    MotomanMotionInit(&s_motion, s_position);
+#if defined(CONFIG_MOTOMAN_MOTION_DEMO)
+    memcpy(s_demo_home, s_position, sizeof(s_demo_home));
+#endif
+    s_motion_next_step = GetMicroSeconds() + MOTOMAN_MOTION_PERIOD_US;
+    ESP_LOGI(TAG, "Motion engine: %u axes, %u us steps", s_motion.axis_count, MOTOMAN_MOTION_PERIOD_US);
+}
+
+// Copies the result of the last step into the robot data; instance 1 of the
+// position class is the robot pulse position, instance 101 follows it
+static void PublishMotomanMotion(void) {
+    for (EipUint8 axis = 0; axis < s_motion.axis_count; axis++) {
+        s_position[axis] = s_motion.position[axis];
+        s_position_data[0][1 + axis] = s_motion.position[axis];
+        s_position_deviation[axis] = MotomanMotionGetDeviation(&s_motion, axis);
+        s_torque[axis] = MotomanMotionGetTorque(&s_motion, axis);
+    }
+    if (MotomanMotionIsMoving(&s_motion) || 0 != s_job.instruction_count) {
+        s_status_data1 |= MOTOMAN_STATUS1_RUNNING;
+    } else {
+        s_status_data1 &= ~MOTOMAN_STATUS1_RUNNING;
+    }
+    s_base_position_dirty |= 1U;
+    MarkMotomanIoDirty(SYSTEM_MOTOMAN_IO_SOURCE_POSITION, 0, s_motion.axis_count);
+    MarkMotomanIoDirty(SYSTEM_MOTOMAN_IO_SOURCE_TORQUE, 0, s_motion.axis_count);
+    MarkMotomanIoDirty(SYSTEM_MOTOMAN_IO_SOURCE_STATUS, 0, 1);
+}
+
+// Compiles the job file for playback, the robot data keeps its initial job
+// information if there is none
+static void LoadMotomanJob(void) {
+    if ('\0' == MOTOMAN_JOB_FILE[0]) {
+        return;
+    }
+    FILE *file = fopen(MOTOMAN_JOB_FILE, "rb");
+    if (NULL == file) {
+        ESP_LOGI(TAG, "No job file %s, job playback off", MOTOMAN_JOB_FILE);
+        return;
+    }
+    long size = -1;
+    if (0 == fseek(file, 0, SEEK_END)) {
+        size = ftell(file);
+        rewind(file);
+    }
+    if (size <= 0 || size > MOTOMAN_JOB_MAX_FILE_SIZE) {
+        ESP_LOGW(TAG, "Job file %s: size %ld not supported", MOTOMAN_JOB_FILE, size);
+        fclose(file);
+        return;
+    }
+    char *text = (char *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!text) {
+        text = (char *)malloc(size);
+    }
+    const bool is_read = NULL != text && (size_t)size == fread(text, 1, size, file);
+    fclose(file);
+
+    s_job_variables.b = s_variable_b;
+    s_job_variables.i = s_variable_i;
+    s_job_variables.d = s_variable_d;
+    s_job_variables.r = s_variable_r;
+    s_job_variables.count = MOTOMAN_MAX_VARIABLES;
+    const bool compiled = is_read && MotomanJobCompile(&s_job, text, size, MOTOMAN_MAX_VARIABLES);
+    free(text);
+    if (!compiled) {
+        ESP_LOGW(TAG, "Job file %s not played back", MOTOMAN_JOB_FILE);
+        return;
+    }
+
+    snprintf((char *)s_job_name, sizeof(s_job_name), "%.27s.JBI", s_job.name);
+    s_job_line = 0;
+    s_step_number = 0;
+    InvalidateCipResponseCache(s_job_info_class);
+    s_status_data1 |= MOTOMAN_STATUS1_RUNNING;
+    MarkMotomanIoDirty(SYSTEM_MOTOMAN_IO_SOURCE_STATUS, 0, 1);
+    ESP_LOGI(TAG, "Playing job %s: %u lines, %u positions", s_job_name, s_job.instruction_count, s_job.position_count);
+}
+
 EipStatus ApplicationInitialization(void) {
     // Load RS022 configuration (defaults to true/RS022=1)
     system_motoman_rs022_load(&s_rs022_enabled);
@@ -1057,11 +1750,43 @@ EipStatus ApplicationInitialization(void) {
     CreateMotomanVariablePClass();
     CreateMotomanVariableBPClass();
     CreateMotomanVariableEXClass();
+    CreateMotomanIoAssemblies();
+    InitializeMotomanMotion();
+    LoadMotomanJob();
     
     return kEipStatusOk;
 }
 
+// The motion advances in fixed steps on the monotonic clock, the CIP traffic
+// only decides how many steps a call has to catch up with
 void HandleApplication(void) {
+    const MicroSeconds now = GetMicroSeconds();
+    unsigned int steps = 0;
+
+    while (s_motion_next_step <= now && steps < MOTOMAN_MOTION_MAX_STEPS_PER_CALL) {
+        if (!MotomanMotionIsMoving(&s_motion)) {
+            StartNextMotomanMove();
+        }
+        MotomanMotionStep(&s_motion);
+        s_motion_next_step += MOTOMAN_MOTION_PERIOD_US;
+        steps++;
+    }
+    if (s_motion_next_step <= now) {
+        const MicroSeconds delay = now - s_motion_next_step;
+        s_motion_delays++;
+        s_motion_longest_delay = delay > s_motion_longest_delay ? delay : s_motion_longest_delay;
+        s_motion_next_step = now + MOTOMAN_MOTION_PERIOD_US;
+    }
+    if (0 != s_motion_delays && now - s_motion_delay_logged >= MOTOMAN_MOTION_DELAY_LOG_INTERVAL_US) {
+        ESP_LOGW(TAG, "Motion delayed %u times, by up to %llu us", (unsigned)s_motion_delays,
+                 (unsigned long long)s_motion_longest_delay);
+        s_motion_delays = 0;
+        s_motion_longest_delay = 0;
+        s_motion_delay_logged = now;
+    }
+    if (steps > 0 && (!MotomanMotionIsAtRest(&s_motion) || (s_status_data1 & MOTOMAN_STATUS1_RUNNING))) {
+        PublishMotomanMotion();
+    }
 }
 
 void CheckIoConnectionEvent(unsigned int output_assembly_id,
@@ -1073,12 +1798,20 @@ void CheckIoConnectionEvent(unsigned int output_assembly_id,
 }
 
 EipStatus AfterAssemblyDataReceived(CipInstance *instance) {
-    (void) instance;
+    if (instance == s_output_assembly.instance) {
+        UnpackMotomanIoAssembly(&s_output_assembly);
+    }
     return kEipStatusOk;
 }
 
 EipBool8 BeforeAssemblyDataSend(CipInstance *instance) {
-    (void) instance;
+    // The assembly is shared by all connections producing it, a heartbeat or
+    // the next connection finds nothing dirty and sends the data packed before
+    if (instance == s_input_assembly.instance && s_input_assembly_dirty) {
+        PackDirtyMotomanIoAssembly(&s_input_assembly, s_input_dirty_ranges);
+        memset(s_input_dirty_ranges, 0, sizeof(s_input_dirty_ranges));
+        s_input_assembly_dirty = false;
+    }
     return true;
 }
 
@@ -0,0 +1,520 @@
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "motoman_job.h"
+
+static const char *TAG = "motoman_job";
+
+#define MOTOMAN_JOB_MAX_LINE_LENGTH 256
+#define MOTOMAN_JOB_MAX_TOKENS 8
+#define MOTOMAN_JOB_LABEL_LENGTH 8
+
+typedef enum {
+    kJobSectionHeader,
+    kJobSectionPulse,
+    kJobSectionInstructions
+} JobSection;
+
+// Text of the job split into lines, the line is copied so that it can be
+// split into tokens in place
+typedef struct {
+    const char *text;
+    const char *end;
+    unsigned int file_line;
+    bool line_too_long;
+    char line[MOTOMAN_JOB_MAX_LINE_LENGTH];
+} JobReader;
+
+// Labels and jump targets by instruction index until the jumps are resolved
+typedef char JobLabel[MOTOMAN_JOB_LABEL_LENGTH + 1];
+
+static bool ReadJobLine(JobReader *reader) {
+    while (reader->text < reader->end) {
+        const char *start = reader->text;
+        const char *stop = memchr(start, '\n', reader->end - start);
+        if (NULL == stop) {
+            stop = reader->end;
+        }
+        reader->text = stop < reader->end ? stop + 1 : stop;
+        reader->file_line++;
+
+        while (start < stop && isspace((unsigned char)*start)) {
+            start++;
+        }
+        while (stop > start && isspace((unsigned char)stop[-1])) {
+            stop--;
+        }
+        if (start == stop) {
+            continue;
+        }
+        // a cut line could still parse, to something else than written
+        if (stop - start >= MOTOMAN_JOB_MAX_LINE_LENGTH) {
+            reader->line_too_long = true;
+            return false;
+        }
+        const size_t length = (size_t)(stop - start);
+        memcpy(reader->line, start, length);
+        reader->line[length] = '\0';
+        return true;
+    }
+    return false;
+}
+
+static int SplitJobLine(char *line, char **tokens) {
+    int count = 0;
+    char *save = NULL;
+    for (char *token = strtok_r(line, " \t", &save); NULL != token && count < MOTOMAN_JOB_MAX_TOKENS;
+         token = strtok_r(NULL, " \t", &save)) {
+        tokens[count++] = token;
+    }
+    return count;
+}
+
+static bool StartsWith(const char *text, const char *prefix) {
+    return 0 == strncmp(text, prefix, strlen(prefix));
+}
+
+// Unsigned decimal number of digits only, the whole text has to be used
+static bool ParseIndex(const char *text, unsigned long limit, EipUint16 *index) {
+    char *end;
+    if (!isdigit((unsigned char)*text)) {
+        return false;
+    }
+    const unsigned long value = strtoul(text, &end, 10);
+    if ('\0' != *end || value >= limit) {
+        return false;
+    }
+    *index = (EipUint16)value;
+    return true;
+}
+
+// Decimal with up to two decimals like "50.00" or "0.5", in hundredths
+static bool ParseHundredths(const char *text, EipInt32 min, EipInt32 max, EipInt32 *hundredths) {
+    EipInt32 value = 0;
+    int decimals = -1;
+
+    if ('\0' == *text) {
+        return false;
+    }
+    for (; '\0' != *text; text++) {
+        if ('.' == *text && decimals < 0) {
+            decimals = 0;
+        } else if (isdigit((unsigned char)*text) && decimals < 2 && value < 100000000) {
+            value = value * 10 + (*text - '0');
+            if (decimals >= 0) {
+                decimals++;
+            }
+        } else {
+            return false;
+        }
+    }
+    for (decimals = decimals < 0 ? 0 : decimals; decimals < 2; decimals++) {
+        value *= 10;
+    }
+    if (value < min || value > max) {
+        return false;
+    }
+    *hundredths = value;
+    return true;
+}
+
+static bool ParseVariable(const char *text, EipUint16 variable_count, EipUint8 *type, EipUint16 *index) {
+    switch (text[0]) {
+        case 'B': *type = kMotomanJobVariableB; break;
+        case 'I': *type = kMotomanJobVariableI; break;
+        case 'D': *type = kMotomanJobVariableD; break;
+        case 'R': *type = kMotomanJobVariableR; break;
+        default: return false;
+    }
+    return ParseIndex(text + 1, variable_count, index);
+}
+
+// Constant of the destination type, or a variable of any type
+static bool ParseSource(const char *text, EipUint16 variable_count, MotomanJobInstruction *instruction) {
+    char *end;
+
+    if (ParseVariable(text, variable_count, &instruction->source, &instruction->argument)) {
+        return true;
+    }
+    instruction->source = kMotomanJobConstant;
+    if (kMotomanJobVariableR == instruction->destination) {
+        instruction->value.real = strtof(text, &end);
+        return end != text && '\0' == *end;
+    }
+    const long long value = strtoll(text, &end, 10);
+    if (end == text || '\0' != *end) {
+        return false;
+    }
+    const long long min = kMotomanJobVariableB == instruction->destination ? 0 :
+                          kMotomanJobVariableI == instruction->destination ? INT16_MIN : INT32_MIN;
+    const long long max = kMotomanJobVariableB == instruction->destination ? UINT8_MAX :
+                          kMotomanJobVariableI == instruction->destination ? INT16_MAX : INT32_MAX;
+    if (value < min || value > max) {
+        return false;
+    }
+    instruction->value.integer = (EipInt32)value;
+    return true;
+}
+
+static bool ParseLabel(const char *text, JobLabel label) {
+    if ('*' != text[0] || '\0' == text[1] || strlen(text + 1) > MOTOMAN_JOB_LABEL_LENGTH) {
+        return false;
+    }
+    strcpy(label, text + 1);
+    return true;
+}
+
+// C00001=100,-200,... with up to MOTOMAN_MOTION_MAX_AXES pulse values
+static bool ParsePosition(MotomanJob *job, char *line, bool *defined_positions) {
+    char *values = strchr(line, '=');
+    EipUint16 index;
+
+    if (NULL == values || 'C' != line[0]) {
+        return false;
+    }
+    *values++ = '\0';
+    if (!ParseIndex(line + 1, job->position_count, &index)) {
+        return false;
+    }
+    for (int axis = 0; axis < MOTOMAN_MOTION_MAX_AXES && '\0' != *values; axis++) {
+        char *end;
+        const long long value = strtoll(values, &end, 10);
+        if (end == values || value < INT32_MIN || value > INT32_MAX || (',' != *end && '\0' != *end)) {
+            return false;
+        }
+        job->positions[index][axis] = (EipInt32)value;
+        values = ',' == *end ? end + 1 : end;
+    }
+    defined_positions[index] = true;
+    return '\0' == *values;
+}
+
+static bool CompileInstruction(MotomanJob *job, char *line, EipUint16 variable_count, JobLabel *labels,
+                               EipUint16 *step) {
+    MotomanJobInstruction *instruction = &job->instructions[job->instruction_count];
+    char *tokens[MOTOMAN_JOB_MAX_TOKENS];
+    const int count = SplitJobLine(line, tokens);
+
+    memset(instruction, 0, sizeof(*instruction));
+    instruction->opcode = kMotomanJobOpNop;
+    instruction->line = job->instruction_count;
+
+    if (0 == count) {
+        return false;
+    }
+    const char *op = tokens[0];
+    if ('*' == op[0]) {
+        return 1 == count && ParseLabel(op, labels[job->instruction_count]);
+    }
+    if ('\'' == op[0] || 0 == strcmp(op, "NOP")) {
+        return true;
+    }
+    if (0 == strcmp(op, "END")) {
+        instruction->opcode = kMotomanJobOpEnd;
+        return 1 == count;
+    }
+    if (0 == strcmp(op, "JUMP")) {
+        if (2 != count) {
+            ESP_LOGW(TAG, "Job line %u: conditional JUMP not supported, kept as NOP", instruction->line);
+            return true;
+        }
+        instruction->opcode = kMotomanJobOpJump;
+        return ParseLabel(tokens[1], labels[job->instruction_count]);
+    }
+    if (0 == strcmp(op, "MOVJ")) {
+        instruction->opcode = kMotomanJobOpMoveJoint;
+        instruction->argument = ++*step;
+        if (count < 3 || 'C' != tokens[1][0] || !ParseIndex(tokens[1] + 1, job->position_count, &instruction->index) ||
+            !StartsWith(tokens[2], "VJ=")) {
+            return false;
+        }
+        return ParseHundredths(tokens[2] + 3, 1, 10000, &instruction->value.integer);
+    }
+    if (0 == strcmp(op, "TIMER")) {
+        instruction->opcode = kMotomanJobOpTimer;
+        return 2 == count && StartsWith(tokens[1], "T=") &&
+               ParseHundredths(tokens[1] + 2, 1, 65535, &instruction->value.integer);
+    }
+    if (0 == strcmp(op, "SET") || 0 == strcmp(op, "ADD") || 0 == strcmp(op, "SUB")) {
+        instruction->opcode = 'S' == op[0] && 'E' == op[1] ? kMotomanJobOpSet :
+                              'A' == op[0] ? kMotomanJobOpAdd : kMotomanJobOpSub;
+        return 3 == count && ParseVariable(tokens[1], variable_count, &instruction->destination, &instruction->index) &&
+               ParseSource(tokens[2], variable_count, instruction);
+    }
+    if (0 == strcmp(op, "INC") || 0 == strcmp(op, "DEC")) {
+        instruction->opcode = 'I' == op[0] ? kMotomanJobOpAdd : kMotomanJobOpSub;
+        instruction->source = kMotomanJobConstant;
+        if (2 != count || !ParseVariable(tokens[1], variable_count, &instruction->destination, &instruction->index)) {
+            return false;
+        }
+        if (kMotomanJobVariableR == instruction->destination) {
+            instruction->value.real = 1.0f;
+        } else {
+            instruction->value.integer = 1;
+        }
+        return true;
+    }
+    if (StartsWith(op, "MOV")) {
+        // without a move the step numbers of the following moves would be wrong
+        ++*step;
+    }
+    ESP_LOGW(TAG, "Job line %u: %s not supported, kept as NOP", instruction->line, op);
+    return true;
+}
+
+static bool ResolveJumps(MotomanJob *job, JobLabel *labels) {
+    // a JUMP goes to the first of two equal labels, the second would be dead
+    for (EipUint16 label = 0; label < job->instruction_count; label++) {
+        if (kMotomanJobOpNop != job->instructions[label].opcode || '\0' == labels[label][0]) {
+            continue;
+        }
+        for (EipUint16 other = 0; other < label; other++) {
+            if (kMotomanJobOpNop == job->instructions[other].opcode && 0 == strcmp(labels[other], labels[label])) {
+                ESP_LOGE(TAG, "Job line %u: label *%s defined twice", job->instructions[label].line, labels[label]);
+                return false;
+            }
+        }
+    }
+    for (EipUint16 jump = 0; jump < job->instruction_count; jump++) {
+        MotomanJobInstruction *instruction = &job->instructions[jump];
+        if (kMotomanJobOpJump != instruction->opcode) {
+            continue;
+        }
+        EipUint16 target = 0;
+        while (target < job->instruction_count &&
+               (kMotomanJobOpNop != job->instructions[target].opcode || 0 != strcmp(labels[target], labels[jump]))) {
+            target++;
+        }
+        if (target == job->instruction_count) {
+            ESP_LOGE(TAG, "Job line %u: label *%s not found", instruction->line, labels[jump]);
+            return false;
+        }
+        instruction->index = target;
+    }
+    return true;
+}
+
+// A move to a position number the job does not define would go to all zero pulses
+static bool CheckPositions(const MotomanJob *job, const bool *defined_positions) {
+    for (EipUint16 move = 0; move < job->instruction_count; move++) {
+        const MotomanJobInstruction *instruction = &job->instructions[move];
+        if (kMotomanJobOpMoveJoint == instruction->opcode && !defined_positions[instruction->index]) {
+            ESP_LOGE(TAG, "Job line %u: position C%05u not defined", instruction->line, instruction->index);
+            return false;
+        }
+    }
+    return true;
+}
+
+// First pass: number of instruction lines and of positions, to allocate once
+static bool CountJob(const char *text, size_t length, EipUint16 *instruction_count, EipUint16 *position_count) {
+    JobReader reader = {.text = text, .end = text + length};
+    bool instructions = false;
+    unsigned long lines = 0;
+    unsigned long positions = 0;
+
+    while (ReadJobLine(&reader)) {
+        if (0 == strcmp(reader.line, "//INST")) {
+            instructions = true;
+        } else if (instructions && !StartsWith(reader.line, "///")) {
+            lines++;
+        } else if (!instructions && 'C' == reader.line[0] && isdigit((unsigned char)reader.line[1])) {
+            const unsigned long index = strtoul(reader.line + 1, NULL, 10);
+            positions = index + 1 > positions ? index + 1 : positions;
+        }
+    }
+    if (reader.line_too_long) {
+        ESP_LOGE(TAG, "Line %u of the job file: more than %u characters", reader.file_line,
+                 MOTOMAN_JOB_MAX_LINE_LENGTH - 1);
+        return false;
+    }
+    if (!instructions || lines > MOTOMAN_JOB_MAX_LINES || positions > MOTOMAN_JOB_MAX_POSITIONS) {
+        ESP_LOGE(TAG, "No //INST section or more than %u lines or %u positions", MOTOMAN_JOB_MAX_LINES,
+                 MOTOMAN_JOB_MAX_POSITIONS);
+        return false;
+    }
+    // room for an END after the last line
+    *instruction_count = (EipUint16)lines + 1;
+    *position_count = (EipUint16)positions;
+    return true;
+}
+
+bool MotomanJobCompile(MotomanJob *job, const char *text, size_t length, EipUint16 variable_count) {
+    EipUint16 instruction_capacity;
+    EipUint16 position_count;
+    EipUint16 step = 0;
+    JobSection section = kJobSectionHeader;
+    JobReader reader = {.text = text, .end = text + length};
+    bool ok = true;
+
+    memset(job, 0, sizeof(*job));
+    if (!CountJob(text, length, &instruction_capacity, &position_count)) {
+        return false;
+    }
+    job->instructions = calloc(instruction_capacity, sizeof(job->instructions[0]));
+    job->positions = calloc(position_count > 0 ? position_count : 1, sizeof(job->positions[0]));
+    JobLabel *labels = calloc(instruction_capacity, sizeof(labels[0]));
+    bool *defined_positions = calloc(position_count > 0 ? position_count : 1, sizeof(defined_positions[0]));
+    if (NULL == job->instructions || NULL == job->positions || NULL == labels || NULL == defined_positions) {
+        ESP_LOGE(TAG, "Out of memory for %u lines", instruction_capacity);
+        free(labels);
+        free(defined_positions);
+        MotomanJobFree(job);
+        return false;
+    }
+    job->position_count = position_count;
+
+    while (ok && ReadJobLine(&reader)) {
+        char *line = reader.line;
+        if (kJobSectionInstructions == section) {
+            if (!StartsWith(line, "///")) {
+                char tokens[MOTOMAN_JOB_MAX_LINE_LENGTH];
+                strcpy(tokens, line);
+                ok = CompileInstruction(job, tokens, variable_count, labels, &step);
+                job->instruction_count++;
+            }
+        } else if (0 == strcmp(line, "//INST")) {
+            section = kJobSectionInstructions;
+        } else if (StartsWith(line, "//NAME ")) {
+            memcpy(job->name, line + 7, strnlen(line + 7, sizeof(job->name) - 1));
+        } else if (StartsWith(line, "///POSTYPE ")) {
+            ok = 0 == strcmp(line + 11, "PULSE");
+        } else if (0 == strcmp(line, "///PULSE")) {
+            section = kJobSectionPulse;
+        } else if (StartsWith(line, "///")) {
+            // tool, user frame and other position attributes
+        } else if (kJobSectionPulse == section && 'C' == line[0]) {
+            ok = ParsePosition(job, line, defined_positions);
+        } else if (!StartsWith(line, "/") && 'C' != line[0]) {
+            ok = false;
+        }
+    }
+    if (!ok) {
+        ESP_LOGE(TAG, "Line %u of the job file: \"%s\" not supported", reader.file_line, reader.line);
+    }
+
+    if (ok && (0 == job->instruction_count ||
+               kMotomanJobOpEnd != job->instructions[job->instruction_count - 1].opcode)) {
+        MotomanJobInstruction *end = &job->instructions[job->instruction_count];
+        memset(end, 0, sizeof(*end));
+        end->opcode = kMotomanJobOpEnd;
+        end->line = job->instruction_count++;
+    }
+    ok = ok && ResolveJumps(job, labels) && CheckPositions(job, defined_positions);
+    free(labels);
+    free(defined_positions);
+    if (!ok) {
+        MotomanJobFree(job);
+    }
+    return ok;
+}
+
+void MotomanJobFree(MotomanJob *job) {
+    free(job->instructions);
+    free(job->positions);
+    memset(job, 0, sizeof(*job));
+}
+
+static EipInt32 ReadJobInteger(const MotomanJobVariables *variables, const MotomanJobInstruction *instruction) {
+    switch (instruction->source) {
+        case kMotomanJobVariableB: return variables->b[instruction->argument];
+        case kMotomanJobVariableI: return variables->i[instruction->argument];
+        case kMotomanJobVariableD: return variables->d[instruction->argument];
+        case kMotomanJobVariableR: {
+            const float real = variables->r[instruction->argument];
+            if (!(real > (float)INT32_MIN)) {
+                return INT32_MIN;
+            }
+            if (real >= (float)INT32_MAX) {
+                return INT32_MAX;
+            }
+            return (EipInt32)(real + (real < 0.0f ? -0.5f : 0.5f));
+        }
+        default: return instruction->value.integer;
+    }
+}
+
+static float ReadJobReal(const MotomanJobVariables *variables, const MotomanJobInstruction *instruction) {
+    switch (instruction->source) {
+        case kMotomanJobVariableB: return variables->b[instruction->argument];
+        case kMotomanJobVariableI: return variables->i[instruction->argument];
+        case kMotomanJobVariableD: return (float)variables->d[instruction->argument];
+        case kMotomanJobVariableR: return variables->r[instruction->argument];
+        default: return instruction->value.real;
+    }
+}
+
+// Integer results wrap around at the size of the destination variable
+static EipUint32 ApplyJobArithmetic(EipUint8 opcode, EipUint32 current, EipUint32 operand) {
+    return kMotomanJobOpAdd == opcode ? current + operand :
+           kMotomanJobOpSub == opcode ? current - operand : operand;
+}
+
+static void ExecuteJobArithmetic(const MotomanJobVariables *variables, const MotomanJobInstruction *instruction) {
+    const EipUint16 index = instruction->index;
+
+    if (kMotomanJobVariableR == instruction->destination) {
+        const float operand = ReadJobReal(variables, instruction);
+        float *r = &variables->r[index];
+        *r = kMotomanJobOpAdd == instruction->opcode ? *r + operand :
+             kMotomanJobOpSub == instruction->opcode ? *r - operand : operand;
+        return;
+    }
+    const EipUint32 operand = (EipUint32)ReadJobInteger(variables, instruction);
+    switch (instruction->destination) {
+        case kMotomanJobVariableB:
+            variables->b[index] = (EipUint8)ApplyJobArithmetic(instruction->opcode, variables->b[index], operand);
+            break;
+        case kMotomanJobVariableI:
+            variables->i[index] = (EipInt16)ApplyJobArithmetic(instruction->opcode,
+                                                               (EipUint32)variables->i[index], operand);
+            break;
+        default:
+            variables->d[index] = (EipInt32)ApplyJobArithmetic(instruction->opcode,
+                                                               (EipUint32)variables->d[index], operand);
+            break;
+    }
+}
+
+bool MotomanJobRun(MotomanJob *job, const MotomanJobVariables *variables, MicroSeconds step_period,
+                   unsigned int *budget, MotomanJobMove *move) {
+    if (job->wait_steps > 0) {
+        job->wait_steps--;
+        return false;
+    }
+    while (*budget > 0) {
+        const MotomanJobInstruction *instruction = &job->instructions[job->next];
+        (*budget)--;
+        job->line = instruction->line;
+        job->next++;
+        switch (instruction->opcode) {
+            case kMotomanJobOpEnd:
+                job->next = 0;
+                break;
+            case kMotomanJobOpJump:
+                job->next = instruction->index;
+                break;
+            case kMotomanJobOpMoveJoint:
+                job->step = instruction->argument;
+                move->target = job->positions[instruction->index];
+                move->speed_ratio = (EipUint32)instruction->value.integer;
+                return true;
+            case kMotomanJobOpTimer: {
+                // this call is the first step of the wait
+                const EipUint64 steps = (EipUint64)instruction->value.integer * 10000 / step_period;
+                job->wait_steps = steps > 0 ? (EipUint32)(steps - 1) : 0;
+                return false;
+            }
+            case kMotomanJobOpSet:
+            case kMotomanJobOpAdd:
+            case kMotomanJobOpSub:
+                ExecuteJobArithmetic(variables, instruction);
+                break;
+            default:
+                break;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,101 @@
+#ifndef MOTOMAN_JOB_H_
+#define MOTOMAN_JOB_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "typedefs.h"
+#include "motoman_motion.h"
+
+// Playback of INFORM jobs.
+//
+// A job is compiled once from the text of a .JBI file into an array of fixed
+// size instructions: operands are parsed, labels resolved to instruction
+// indexes and step numbers assigned, so running the job needs no text
+// handling and every instruction is one switch case.
+//
+// Supported is a subset of INFORM with pulse positions:
+//   MOVJ C00000 VJ=50.00    joint move, further tags are ignored
+//   TIMER T=1.00            wait
+//   SET/ADD/SUB B000 <src>  src is a constant or a B, I, D or R variable,
+//   INC/DEC B000            the destination any of the four types
+//   *LABEL, JUMP *LABEL, NOP, END and 'comments
+// Other instructions are kept as NOP so that the line numbers stay right.
+
+#define MOTOMAN_JOB_MAX_LINES 9999
+#define MOTOMAN_JOB_MAX_POSITIONS 1000
+#define MOTOMAN_JOB_NAME_LENGTH 32
+
+typedef enum {
+    kMotomanJobOpNop,
+    kMotomanJobOpEnd,
+    kMotomanJobOpJump,
+    kMotomanJobOpMoveJoint,
+    kMotomanJobOpTimer,
+    kMotomanJobOpSet,
+    kMotomanJobOpAdd,
+    kMotomanJobOpSub
+} MotomanJobOpcode;
+
+typedef enum {
+    kMotomanJobConstant,
+    kMotomanJobVariableB,
+    kMotomanJobVariableI,
+    kMotomanJobVariableD,
+    kMotomanJobVariableR
+} MotomanJobOperand;
+
+typedef struct {
+    EipUint8 opcode;        // MotomanJobOpcode
+    EipUint8 destination;   // MotomanJobOperand of SET/ADD/SUB
+    EipUint8 source;        // MotomanJobOperand of SET/ADD/SUB
+    EipUint16 line;
+    EipUint16 index;        // destination variable, position or jump target
+    EipUint16 argument;     // source variable, or step number of a move
+    union {
+        EipInt32 integer;   // integer constant, speed in 0.01%, time in 10 ms
+        float real;         // constant of an R destination
+    } value;
+} MotomanJobInstruction;
+
+typedef struct {
+    EipUint8 *b;
+    EipInt16 *i;
+    EipInt32 *d;
+    float *r;
+    EipUint16 count;        // of each type
+} MotomanJobVariables;
+
+typedef struct {
+    char name[MOTOMAN_JOB_NAME_LENGTH];
+    MotomanJobInstruction *instructions;
+    EipUint16 instruction_count;
+    EipInt32 (*positions)[MOTOMAN_MOTION_MAX_AXES];
+    EipUint16 position_count;
+
+    // playback state
+    EipUint16 next;         // instruction executed next
+    EipUint16 line;         // line of the instruction running
+    EipUint16 step;         // step number of the last move
+    EipUint32 wait_steps;   // motion steps left of a TIMER
+} MotomanJob;
+
+typedef struct {
+    const EipInt32 *target;
+    EipUint32 speed_ratio;  // 0.01% of the max speed, before the override
+} MotomanJobMove;
+
+// Compiles the text of a .JBI file. Returns false and logs the line of the
+// first error if the job cannot be played; the job is empty then.
+bool MotomanJobCompile(MotomanJob *job, const char *text, size_t length, EipUint16 variable_count);
+
+void MotomanJobFree(MotomanJob *job);
+
+// Executes instructions until a move is reached, a TIMER waits or budget
+// instructions ran. Called once per motion step while the robot does not
+// move; after END the job starts again at the top. Returns true and fills
+// move when a move instruction was executed.
+bool MotomanJobRun(MotomanJob *job, const MotomanJobVariables *variables, MicroSeconds step_period,
+                   unsigned int *budget, MotomanJobMove *move);
+
+#endif
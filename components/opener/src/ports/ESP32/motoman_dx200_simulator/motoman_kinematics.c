@@ -0,0 +1,155 @@
+#include <math.h>
+#include <string.h>
+
+#include "motoman_kinematics.h"
+
+// Link dimensions in mm from the catalogue drawings, not calibrated data of a
+// robot. The pulse resolutions are nominal values of the right magnitude; the
+// exact ones are in the pulse parameters of each controller.
+typedef struct {
+    const char *name;
+    float base_height;      // L axis above the base mounting face
+    float l_offset;         // L axis in front of the S axis
+    float lower_arm;        // L axis to U axis
+    float u_offset;         // forearm axis above the U axis
+    float upper_arm;        // U axis to the wrist centre along the forearm
+    float flange;           // wrist centre to the flange face
+    float pulses_per_degree[MOTOMAN_KINEMATICS_AXES];
+} MotomanRobotDimensions;
+
+static const MotomanRobotDimensions s_robot_dimensions[kMotomanRobotModelCount] = {
+    [kMotomanRobotModelGp7] = {"GP7", 330.0f, 40.0f, 445.0f, 40.0f, 440.0f, 80.0f,
+                               {1435.0f, 1435.0f, 1435.0f, 730.0f, 730.0f, 435.0f}},
+    [kMotomanRobotModelGp8] = {"GP8", 330.0f, 40.0f, 345.0f, 40.0f, 340.0f, 80.0f,
+                               {1435.0f, 1435.0f, 1435.0f, 730.0f, 730.0f, 435.0f}},
+    [kMotomanRobotModelGp12] = {"GP12", 450.0f, 155.0f, 614.0f, 200.0f, 640.0f, 100.0f,
+                                {1150.0f, 1150.0f, 1150.0f, 620.0f, 620.0f, 360.0f}},
+    [kMotomanRobotModelGp25] = {"GP25", 505.0f, 150.0f, 760.0f, 200.0f, 795.0f, 100.0f,
+                                {1000.0f, 1000.0f, 1000.0f, 560.0f, 560.0f, 330.0f}},
+};
+
+// The joint frames are the same for all models. At zero pulses the lower arm
+// is vertical and the forearm and the flange point along X. Positive pulses
+// turn S counterclockwise seen from above, tilt L forward and raise U and B.
+static const float s_alpha_degrees[MOTOMAN_KINEMATICS_AXES] = {-90.0f, 0.0f, -90.0f, 90.0f, -90.0f, 0.0f};
+static const float s_theta_offset_degrees[MOTOMAN_KINEMATICS_AXES] = {0.0f, -90.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+static const float s_direction[MOTOMAN_KINEMATICS_AXES] = {1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f};
+
+#define KINEMATICS_RADIANS_PER_DEGREE 0.017453292519943295f
+// 0.0001 degree per radian
+#define KINEMATICS_ANGLE_UNITS_PER_RADIAN 572957.79513082321f
+#define KINEMATICS_TWO_OVER_PI 0.63661977236758134f
+// pi / 2 split in two parts so that the reduction is exact for large angles
+#define KINEMATICS_PI_OVER_TWO_HIGH 1.5707963705062866f
+#define KINEMATICS_PI_OVER_TWO_LOW -4.3711388286737929e-8f
+// Below this the flange axis is parallel to Z and Rx and Rz are not independent
+#define KINEMATICS_GIMBAL_LOCK_COSINE 1.0e-5f
+
+const char *MotomanKinematicsGetModelName(MotomanRobotModel model) {
+    return (unsigned int)model < kMotomanRobotModelCount ? s_robot_dimensions[model].name : NULL;
+}
+
+bool MotomanKinematicsInit(MotomanKinematics *kinematics, MotomanRobotModel model) {
+    if ((unsigned int)model >= kMotomanRobotModelCount) {
+        return false;
+    }
+    const MotomanRobotDimensions *dimensions = &s_robot_dimensions[model];
+    const float a[MOTOMAN_KINEMATICS_AXES] = {dimensions->l_offset, dimensions->lower_arm, dimensions->u_offset, 0.0f, 0.0f, 0.0f};
+    const float d[MOTOMAN_KINEMATICS_AXES] = {dimensions->base_height, 0.0f, 0.0f, dimensions->upper_arm, 0.0f, dimensions->flange};
+
+    // the padding lanes stay zero and compute an identity transform
+    memset(kinematics, 0, sizeof(*kinematics));
+    for (int axis = 0; axis < MOTOMAN_KINEMATICS_AXES; axis++) {
+        const float alpha = s_alpha_degrees[axis] * KINEMATICS_RADIANS_PER_DEGREE;
+        kinematics->radians_per_pulse[axis] = s_direction[axis] * KINEMATICS_RADIANS_PER_DEGREE /
+                                              dimensions->pulses_per_degree[axis];
+        kinematics->theta_offset[axis] = s_theta_offset_degrees[axis] * KINEMATICS_RADIANS_PER_DEGREE;
+        kinematics->a[axis] = a[axis];
+        kinematics->d[axis] = d[axis];
+        kinematics->sin_alpha[axis] = roundf(sinf(alpha));
+        kinematics->cos_alpha[axis] = roundf(cosf(alpha));
+    }
+    return true;
+}
+
+// Sine and cosine of all lanes without branches or library calls: the angle
+// is reduced to [-pi/4, pi/4] by quadrant and both are polynomials there,
+// within 1 ulp of the float result.
+static void SinCosLanes(const float *angle, float *sine, float *cosine) {
+    for (int lane = 0; lane < MOTOMAN_KINEMATICS_LANES; lane++) {
+        const float scaled = angle[lane] * KINEMATICS_TWO_OVER_PI;
+        const EipInt32 quadrant = (EipInt32)(scaled + (scaled < 0.0f ? -0.5f : 0.5f));
+        const float r = (angle[lane] - (float)quadrant * KINEMATICS_PI_OVER_TWO_HIGH) -
+                        (float)quadrant * KINEMATICS_PI_OVER_TWO_LOW;
+        const float r2 = r * r;
+        const float s = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+        const float c = 1.0f - 0.5f * r2 +
+                        r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+        const float sin_value = (quadrant & 1) ? c : s;
+        const float cos_value = (quadrant & 1) ? s : c;
+        sine[lane] = (quadrant & 2) ? -sin_value : sin_value;
+        cosine[lane] = ((quadrant + 1) & 2) ? -cos_value : cos_value;
+    }
+}
+
+static EipInt32 RoundToInt32(float value) {
+    return (EipInt32)(value + (value < 0.0f ? -0.5f : 0.5f));
+}
+
+void MotomanKinematicsForward(const MotomanKinematics *kinematics, const EipInt32 *pulses,
+                              EipInt32 *cartesian) {
+    float theta[MOTOMAN_KINEMATICS_LANES] = {0};
+    float sine[MOTOMAN_KINEMATICS_LANES];
+    float cosine[MOTOMAN_KINEMATICS_LANES];
+
+    for (int axis = 0; axis < MOTOMAN_KINEMATICS_AXES; axis++) {
+        theta[axis] = (float)pulses[axis];
+    }
+    for (int lane = 0; lane < MOTOMAN_KINEMATICS_LANES; lane++) {
+        theta[lane] = theta[lane] * kinematics->radians_per_pulse[lane] + kinematics->theta_offset[lane];
+    }
+    SinCosLanes(theta, sine, cosine);
+
+    // Columns of the base to flange transform, chained one link at a time:
+    // T = T * Rz(theta) * Tz(d) * Tx(a) * Rx(alpha)
+    float x[3] = {1.0f, 0.0f, 0.0f};
+    float y[3] = {0.0f, 1.0f, 0.0f};
+    float z[3] = {0.0f, 0.0f, 1.0f};
+    float p[3] = {0.0f, 0.0f, 0.0f};
+    for (int axis = 0; axis < MOTOMAN_KINEMATICS_AXES; axis++) {
+        const float c = cosine[axis];
+        const float s = sine[axis];
+        const float a = kinematics->a[axis];
+        const float d = kinematics->d[axis];
+        const float sin_alpha = kinematics->sin_alpha[axis];
+        const float cos_alpha = kinematics->cos_alpha[axis];
+        for (int row = 0; row < 3; row++) {
+            const float u = x[row] * c + y[row] * s;
+            const float v = y[row] * c - x[row] * s;
+            p[row] += a * u + d * z[row];
+            x[row] = u;
+            y[row] = v * cos_alpha + z[row] * sin_alpha;
+            z[row] = z[row] * cos_alpha - v * sin_alpha;
+        }
+    }
+
+    float rx;
+    float ry;
+    float rz;
+    const float cos_ry = sqrtf(x[0] * x[0] + x[1] * x[1]);
+    ry = atan2f(-x[2], cos_ry);
+    if (cos_ry > KINEMATICS_GIMBAL_LOCK_COSINE) {
+        rx = atan2f(y[2], z[2]);
+        rz = atan2f(x[1], x[0]);
+    } else {
+        rx = 0.0f;
+        rz = atan2f(-y[0], y[1]);
+    }
+
+    cartesian[0] = RoundToInt32(p[0] * 1000.0f);
+    cartesian[1] = RoundToInt32(p[1] * 1000.0f);
+    cartesian[2] = RoundToInt32(p[2] * 1000.0f);
+    cartesian[3] = RoundToInt32(rx * KINEMATICS_ANGLE_UNITS_PER_RADIAN);
+    cartesian[4] = RoundToInt32(ry * KINEMATICS_ANGLE_UNITS_PER_RADIAN);
+    cartesian[5] = RoundToInt32(rz * KINEMATICS_ANGLE_UNITS_PER_RADIAN);
+}
@@ -0,0 +1,51 @@
+#ifndef MOTOMAN_KINEMATICS_H_
+#define MOTOMAN_KINEMATICS_H_
+
+#include <stdbool.h>
+
+#include "typedefs.h"
+
+// Forward kinematics of a 6 axis Motoman arm with spherical wrist.
+//
+// The arm is described by standard Denavit-Hartenberg parameters built from
+// the link dimensions of the model. The joint values of all axes are
+// converted and transformed side by side in arrays of equal length, so the
+// per joint part is one loop the compiler can vectorize; only the chaining
+// of the link transforms is sequential. The maths is single precision to
+// stay on the FPU of the ESP32, good to about a micrometre at full reach.
+
+#define MOTOMAN_KINEMATICS_AXES 6
+// Joint arrays are padded to a power of two for the vectorized loops
+#define MOTOMAN_KINEMATICS_LANES 8
+
+typedef enum {
+    kMotomanRobotModelGp7,
+    kMotomanRobotModelGp8,
+    kMotomanRobotModelGp12,
+    kMotomanRobotModelGp25,
+    kMotomanRobotModelCount
+} MotomanRobotModel;
+
+typedef struct {
+    // per joint, theta = pulses * radians_per_pulse + theta_offset
+    float radians_per_pulse[MOTOMAN_KINEMATICS_LANES];
+    float theta_offset[MOTOMAN_KINEMATICS_LANES];
+    float a[MOTOMAN_KINEMATICS_LANES];      // mm
+    float d[MOTOMAN_KINEMATICS_LANES];      // mm
+    float sin_alpha[MOTOMAN_KINEMATICS_LANES];
+    float cos_alpha[MOTOMAN_KINEMATICS_LANES];
+} MotomanKinematics;
+
+// Returns the name of the model, NULL if model is not valid
+const char *MotomanKinematicsGetModelName(MotomanRobotModel model);
+
+// Sets up the parameters of model, returns false if model is not valid
+bool MotomanKinematicsInit(MotomanKinematics *kinematics, MotomanRobotModel model);
+
+// Computes the flange position in robot base coordinates from the pulses of
+// the 6 axes: X, Y and Z in micrometres, then Rx, Ry and Rz in 0.0001 degree
+// as fixed angles about the base axes, rotation = Rz * Ry * Rx.
+void MotomanKinematicsForward(const MotomanKinematics *kinematics, const EipInt32 *pulses,
+                              EipInt32 *cartesian);
+
+#endif
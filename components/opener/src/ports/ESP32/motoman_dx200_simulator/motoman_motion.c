@@ -0,0 +1,193 @@
+#include <string.h>
+
+#include "motoman_motion.h"
+
+// Torques are limited to 300% of the nominal torque like the servo amplifiers
+#define MOTOMAN_MOTION_MAX_TORQUE 300000
+
+static EipUint32 SquareRootRoundedUp(EipUint64 value) {
+    EipUint64 root = 0;
+    EipUint64 bit = 1ULL << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (EipUint32)root + (value != 0 ? 1 : 0);
+}
+
+// Speed of an axis in pulses per step, 16 fractional bits. 2^16 / 10^6 is
+// 1024 / 15625, which keeps the product within 64 bits.
+static EipUint64 GetStepSpeed(const MotomanMotion *motion, EipUint8 axis, EipUint32 speed_ratio) {
+    const EipUint64 speed = (EipUint64)(motion->axes[axis].max_speed > 0 ? motion->axes[axis].max_speed : 1) *
+                            speed_ratio / MOTOMAN_MOTION_FULL_SPEED;
+    const EipUint64 step_speed = speed * motion->step_period * 1024 / 15625;
+    return step_speed > 0 ? step_speed : 1;
+}
+
+// Share of the move done after step k of n in 2^-24. The velocity ramps up
+// over the first a steps, stays constant and ramps down over the last a steps.
+static EipUint32 GetProfileShare(EipUint32 n, EipUint32 a, EipUint32 k) {
+    EipUint64 numerator;
+    EipUint64 denominator;
+
+    if (0 == a) {
+        numerator = k;
+        denominator = n;
+    } else {
+        denominator = 2ULL * a * (n - a);
+        if (k <= a) {
+            numerator = (EipUint64)k * k;
+        } else if (k <= n - a) {
+            numerator = (EipUint64)a * (2ULL * k - a);
+        } else {
+            numerator = denominator - (EipUint64)(n - k) * (n - k);
+        }
+    }
+    return (EipUint32)((numerator << 24) / denominator);
+}
+
+void MotomanMotionInit(MotomanMotion *motion, const EipInt32 *position) {
+    if (motion->axis_count > MOTOMAN_MOTION_MAX_AXES) {
+        motion->axis_count = MOTOMAN_MOTION_MAX_AXES;
+    }
+    if (motion->acceleration_steps > MOTOMAN_MOTION_MAX_ACCELERATION_STEPS) {
+        motion->acceleration_steps = MOTOMAN_MOTION_MAX_ACCELERATION_STEPS;
+    }
+    memset(motion->start, 0, sizeof(motion->start));
+    memset(motion->delta, 0, sizeof(motion->delta));
+    memset(motion->position, 0, sizeof(motion->position));
+    memset(motion->velocity, 0, sizeof(motion->velocity));
+    memset(motion->acceleration, 0, sizeof(motion->acceleration));
+    memcpy(motion->position, position, motion->axis_count * sizeof(position[0]));
+    motion->move_steps = 0;
+    motion->move_acceleration_steps = 0;
+    motion->move_step = 0;
+}
+
+bool MotomanMotionMoveTo(MotomanMotion *motion, const EipInt32 *target, EipUint32 speed_ratio) {
+    EipUint64 cruise_steps = 0;
+
+    if (0 == speed_ratio) {
+        speed_ratio = 1;
+    } else if (speed_ratio > MOTOMAN_MOTION_FULL_SPEED) {
+        speed_ratio = MOTOMAN_MOTION_FULL_SPEED;
+    }
+
+    // the slowest axis at its speed sets the duration for all
+    for (EipUint8 axis = 0; axis < motion->axis_count; axis++) {
+        // the pulses of a step are computed from a 32 bit delta, a move over
+        // more than half the pulse range stops that far short of its target
+        EipInt64 delta = (EipInt64)target[axis] - motion->position[axis];
+        if (delta > INT32_MAX) {
+            delta = INT32_MAX;
+        } else if (delta < INT32_MIN) {
+            delta = INT32_MIN;
+        }
+        const EipUint64 distance = (EipUint64)(delta < 0 ? -delta : delta);
+        const EipUint64 step_speed = GetStepSpeed(motion, axis, speed_ratio);
+        const EipUint64 steps = ((distance << 16) + step_speed - 1) / step_speed;
+        if (steps > cruise_steps) {
+            cruise_steps = steps;
+        }
+        motion->start[axis] = motion->position[axis];
+        motion->delta[axis] = (EipInt32)delta;
+    }
+
+    motion->move_step = 0;
+    if (0 == cruise_steps) {
+        motion->move_steps = 0;
+        return false;
+    }
+
+    // A move too short to reach the speed ramps up and down with the same
+    // acceleration: a * a = cruise_steps * acceleration_steps
+    EipUint64 acceleration_steps = motion->acceleration_steps;
+    EipUint64 steps = cruise_steps + acceleration_steps;
+    if (cruise_steps < acceleration_steps) {
+        acceleration_steps = SquareRootRoundedUp(cruise_steps * acceleration_steps);
+        steps = 2 * acceleration_steps;
+    }
+    if (steps > MOTOMAN_MOTION_MAX_MOVE_STEPS) {
+        steps = MOTOMAN_MOTION_MAX_MOVE_STEPS;
+    }
+    motion->move_steps = (EipUint32)steps;
+    motion->move_acceleration_steps = (EipUint32)acceleration_steps;
+    return true;
+}
+
+void MotomanMotionStep(MotomanMotion *motion) {
+    if (motion->move_step >= motion->move_steps) {
+        for (EipUint8 axis = 0; axis < motion->axis_count; axis++) {
+            motion->acceleration[axis] = -motion->velocity[axis];
+            motion->velocity[axis] = 0;
+        }
+        return;
+    }
+
+    motion->move_step++;
+    const EipInt64 share = GetProfileShare(motion->move_steps, motion->move_acceleration_steps,
+                                           motion->move_step);
+    for (EipUint8 axis = 0; axis < motion->axis_count; axis++) {
+        const EipInt32 position = motion->start[axis] +
+                                  (EipInt32)(((EipInt64)motion->delta[axis] * share + (1 << 23)) >> 24);
+        const EipInt32 velocity = position - motion->position[axis];
+        motion->acceleration[axis] = velocity - motion->velocity[axis];
+        motion->velocity[axis] = velocity;
+        motion->position[axis] = position;
+    }
+}
+
+bool MotomanMotionIsMoving(const MotomanMotion *motion) {
+    return motion->move_step < motion->move_steps;
+}
+
+bool MotomanMotionIsAtRest(const MotomanMotion *motion) {
+    if (MotomanMotionIsMoving(motion)) {
+        return false;
+    }
+    for (EipUint8 axis = 0; axis < motion->axis_count; axis++) {
+        if (0 != motion->velocity[axis] || 0 != motion->acceleration[axis]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The position loop lags behind by the speed over the loop gain
+EipInt32 MotomanMotionGetDeviation(const MotomanMotion *motion, EipUint8 axis) {
+    if (axis >= motion->axis_count || 0 == motion->position_gain) {
+        return 0;
+    }
+    return (EipInt32)((EipInt64)motion->velocity[axis] * 1000000 /
+                      ((EipInt64)motion->step_period * motion->position_gain));
+}
+
+// Holding torque plus a part proportional to the speed and one proportional
+// to the acceleration, both relative to the axis maximum
+EipInt32 MotomanMotionGetTorque(const MotomanMotion *motion, EipUint8 axis) {
+    if (axis >= motion->axis_count) {
+        return 0;
+    }
+    const MotomanAxisModel *model = &motion->axes[axis];
+    const EipInt64 max_step_speed = (EipInt64)(model->max_speed > 0 ? model->max_speed : 1) *
+                                    motion->step_period;
+    EipInt64 torque = model->hold_torque;
+    torque += (EipInt64)model->speed_torque * motion->velocity[axis] * 1000000 / max_step_speed;
+    torque += (EipInt64)model->acceleration_torque * motion->acceleration[axis] *
+              motion->acceleration_steps * 1000000 / max_step_speed;
+    if (torque > MOTOMAN_MOTION_MAX_TORQUE) {
+        torque = MOTOMAN_MOTION_MAX_TORQUE;
+    } else if (torque < -MOTOMAN_MOTION_MAX_TORQUE) {
+        torque = -MOTOMAN_MOTION_MAX_TORQUE;
+    }
+    return (EipInt32)torque;
+}
@@ -0,0 +1,77 @@
+#ifndef MOTOMAN_MOTION_H_
+#define MOTOMAN_MOTION_H_
+
+#include <stdbool.h>
+
+#include "typedefs.h"
+
+// Fixed step joint motion of the simulated robot.
+//
+// A move interpolates all axes from their current pulses to a target with one
+// common trapezoidal profile, so that all axes start and arrive together like
+// a MOVJ. The pulses of step k are computed directly from k with integer
+// maths, each step costs the same and the result only depends on the number
+// of steps, not on when they are executed.
+
+#define MOTOMAN_MOTION_MAX_AXES 8
+
+// Speed ratios are given in 0.01% like the speed override, 10000 = 100%
+#define MOTOMAN_MOTION_FULL_SPEED 10000
+
+// Limits keeping the profile maths within 64 bits; longer moves are sped up
+#define MOTOMAN_MOTION_MAX_ACCELERATION_STEPS 4096
+#define MOTOMAN_MOTION_MAX_MOVE_STEPS (1UL << 22)
+
+typedef struct {
+    EipInt32 max_speed;             // pulses/s at 100% speed
+    EipInt32 hold_torque;           // torque at standstill, 0.001% of nominal
+    EipInt32 speed_torque;          // torque added at max_speed
+    EipInt32 acceleration_torque;   // torque added at the max acceleration
+} MotomanAxisModel;
+
+typedef struct {
+    // configuration
+    MicroSeconds step_period;
+    EipUint32 acceleration_steps;   // steps to reach max_speed from standstill
+    EipUint32 position_gain;        // servo position loop gain in 1/s
+    EipUint8 axis_count;
+    MotomanAxisModel axes[MOTOMAN_MOTION_MAX_AXES];
+
+    // current move, step 1 to move_steps
+    EipInt32 start[MOTOMAN_MOTION_MAX_AXES];
+    EipInt32 delta[MOTOMAN_MOTION_MAX_AXES];
+    EipUint32 move_steps;
+    EipUint32 move_acceleration_steps;
+    EipUint32 move_step;
+
+    // result of the last step in pulses, pulses/step and pulses/step^2
+    EipInt32 position[MOTOMAN_MOTION_MAX_AXES];
+    EipInt32 velocity[MOTOMAN_MOTION_MAX_AXES];
+    EipInt32 acceleration[MOTOMAN_MOTION_MAX_AXES];
+} MotomanMotion;
+
+// Sets the robot to rest at position, the configuration has to be set before.
+// acceleration_steps is limited to MOTOMAN_MOTION_MAX_ACCELERATION_STEPS.
+void MotomanMotionInit(MotomanMotion *motion, const EipInt32 *position);
+
+// Starts a joint move from the current position to target at speed_ratio of
+// the axis max speeds, replacing a move in progress. An axis moves by at most
+// INT32_MAX pulses per move. Returns false if the robot is at target already.
+bool MotomanMotionMoveTo(MotomanMotion *motion, const EipInt32 *target, EipUint32 speed_ratio);
+
+// Executes one step of the current move, at rest only velocity and
+// acceleration drop to zero
+void MotomanMotionStep(MotomanMotion *motion);
+
+bool MotomanMotionIsMoving(const MotomanMotion *motion);
+
+// Not moving and settled, velocity and acceleration are zero on all axes
+bool MotomanMotionIsAtRest(const MotomanMotion *motion);
+
+// Following error of the servo, in pulses
+EipInt32 MotomanMotionGetDeviation(const MotomanMotion *motion, EipUint8 axis);
+
+// Torque from the axis model, in 0.001% of the nominal torque
+EipInt32 MotomanMotionGetTorque(const MotomanMotion *motion, EipUint8 axis);
+
+#endif
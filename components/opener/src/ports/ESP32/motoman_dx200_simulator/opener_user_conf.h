@@ -86,8 +86,25 @@
 
 #define PC_OPENER_ETHERNET_BUFFER_SIZE 512
 
+/** @brief Run the implicit I/O messaging in a task of its own
+ *
+ * The I/O task sends the produced and receives the consumed data at a higher
+ * priority than the OpENer task handling explicit messages, see
+ * generic_iohandler.h.
+ */
+#ifndef OPENER_IO_TASK
+  #define OPENER_IO_TASK 1
+#endif
+
 static const MilliSeconds kOpenerTimerTickInMilliSeconds = 10;
 
+/** @brief Resolution of the connection production and watchdog timers
+ *
+ * Requested packet intervals are produced at multiples of this value, they are
+ * not bound to kOpenerTimerTickInMilliSeconds.
+ */
+static const MicroSeconds kOpenerTimerResolutionInMicroSeconds = 100;
+
 #define OPENER_WITH_TRACES
 #define OPENER_TRACE_LEVEL (OPENER_TRACE_LEVEL_ERROR | OPENER_TRACE_LEVEL_WARNING)
 
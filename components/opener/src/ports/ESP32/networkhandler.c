@@ -12,9 +12,14 @@
 #include "opener_user_conf.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
+
+MicroSeconds GetMicroSeconds(void) {
+  return (MicroSeconds) esp_timer_get_time();
+}
 
 MilliSeconds GetMilliSeconds(void) {
-  return (MilliSeconds)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+  return (MilliSeconds) (GetMicroSeconds() / 1000ULL);
 }
 
 EipStatus NetworkHandlerInitializePlatform(void) {
@@ -4,6 +4,7 @@
  *
  ******************************************************************************/
 #include "generic_networkhandler.h"
+#include "generic_iohandler.h"
 #include "opener_api.h"
 #include "cipcommon.h"
 #include "cipethernetlink.h"
@@ -24,6 +25,20 @@
 #define OPENER_THREAD_PRIO			5
 #define OPENER_STACK_SIZE			  8192  // Increased from 2000 to prevent stack overflow
 
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+// Implicit I/O runs above the explicit messaging, preempting it whenever a
+// production is due or I/O data arrives
+#define OPENER_IO_THREAD_PRIO		7
+#define OPENER_IO_STACK_SIZE		4096
+// Core 1 keeps the I/O task away from the LWIP TCP/IP task and the OpENer
+// task on core 0, tskNO_AFFINITY leaves the choice to the scheduler
+#define OPENER_IO_THREAD_CORE		1
+
+static void opener_io_thread(void *argument);
+static SemaphoreHandle_t opener_io_thread_stopped = NULL;
+TaskHandle_t opener_io_task_handle = NULL;
+#endif
+
 static void opener_thread(void *argument);
 static SemaphoreHandle_t opener_init_mutex = NULL;
 static SemaphoreHandle_t opener_init_mutex_creation_mutex = NULL;
@@ -147,6 +162,26 @@ void opener_init(struct netif *netif) {
     OPENER_TRACE_WARN("Network link is down, OpENer not started\n");
     g_end_stack = 1;
   }
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  if ((g_end_stack == 0) && (eip_status == kEipStatusOk)) {
+    if (opener_io_thread_stopped == NULL) {
+      opener_io_thread_stopped = xSemaphoreCreateBinary();
+    }
+    // Started first, the OpENer task hands its productions over to it
+    if (opener_io_thread_stopped == NULL ||
+        xTaskCreatePinnedToCore(opener_io_thread,
+                                "OpENerIO",
+                                OPENER_IO_STACK_SIZE,
+                                NULL,
+                                OPENER_IO_THREAD_PRIO,
+                                &opener_io_task_handle,
+                                OPENER_IO_THREAD_CORE) != pdPASS) {
+      OPENER_TRACE_ERR("Failed to create OpENer I/O task\n");
+      NetworkHandlerFinish();
+      eip_status = kEipStatusError;
+    }
+  }
+#endif
   if ((g_end_stack == 0) && (eip_status == kEipStatusOk)) {
     // Pin OpENer task to Core 0 (same as LWIP TCP/IP task)
     BaseType_t result = xTaskCreatePinnedToCore(opener_thread,
@@ -162,6 +197,12 @@ void opener_init(struct netif *netif) {
              xPortGetFreeHeapSize());
     } else {
       OPENER_TRACE_ERR("Failed to create OpENer task\n");
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+      g_end_stack = 1;
+      IoHandlerWakeUp();
+      xSemaphoreTake(opener_io_thread_stopped, portMAX_DELAY);
+      NetworkHandlerFinish();
+#endif
     }
   } else {
     OPENER_TRACE_ERR("NetworkHandlerInitialize error %d\n", eip_status);
@@ -182,6 +223,11 @@ static void opener_thread(void *argument) {
       g_end_stack = 1;
     }
   }
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  // The I/O task uses the sockets closed by NetworkHandlerFinish()
+  IoHandlerWakeUp();
+  xSemaphoreTake(opener_io_thread_stopped, portMAX_DELAY);
+#endif
   NetworkHandlerFinish();
   ShutdownCipStack();
   
@@ -199,3 +245,14 @@ static void opener_thread(void *argument) {
   vTaskDelete(NULL);
 }
 
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+static void opener_io_thread(void *argument) {
+  (void) argument;
+  while (!g_end_stack) {
+    IoHandlerProcessCyclic();
+  }
+  opener_io_task_handle = NULL;
+  xSemaphoreGive(opener_io_thread_stopped);
+  vTaskDelete(NULL);
+}
+#endif
@@ -0,0 +1,581 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "generic_iohandler.h"
+
+#include "opener_user_conf.h"
+#include "opener_error.h"
+#include "trace.h"
+#include "cpf.h"
+#include "spscqueue.h"
+
+/* the OpENer task writes the wake up socket the I/O task reads */
+#if defined(LWIP_NETCONN_FULLDUPLEX) && 0 == LWIP_NETCONN_FULLDUPLEX
+#error "The I/O task requires LWIP_NETCONN_FULLDUPLEX"
+#endif
+
+#if defined(_WIN32)
+#define NWBUF_CAST  (void *)
+#else
+#define NWBUF_CAST
+#endif
+
+/** @brief Producers the I/O task keeps sending for, every producing I/O
+ *  connection of the device at most once */
+#define IO_HANDLER_NUMBER_OF_PRODUCERS                                      \
+  (OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS + OPENER_CIP_NUM_INPUT_ONLY_CONNS *  \
+   OPENER_CIP_NUM_INPUT_ONLY_CONNS_PER_CON_PATH +                           \
+   OPENER_CIP_NUM_LISTEN_ONLY_CONNS *                                       \
+   OPENER_CIP_NUM_LISTEN_ONLY_CONNS_PER_CON_PATH)
+
+/** @brief Longest time the I/O task waits without anything to produce */
+static const MicroSeconds kIoHandlerIdleTimeout = 1000000;
+
+/** @brief Time a cyclic production is sent after it is due
+ *
+ * The network handler task hands the data over when the production is due,
+ * waiting this long lets it go out with the data of the same production
+ * instead of the previous one.
+ */
+static const MicroSeconds kIoHandlerCyclicProductionDelay =
+  kOpenerTimerResolutionInMicroSeconds;
+
+/** @brief Offset of the sequence number of a sequenced address item */
+#define IO_HANDLER_SEQUENCE_NUMBER_OFFSET 10
+
+typedef enum {
+  kIoProductionRequestProduce,
+  kIoProductionRequestStop
+} IoProductionRequestType;
+
+/** @brief Element of the queue from the network handler to the I/O task */
+typedef struct {
+  IoProductionRequestType type;
+  const void *producer;
+  struct sockaddr_in address;
+  MicroSeconds production_time;
+  MicroSeconds production_interval;
+  bool is_cyclic;
+  size_t length;
+  CipOctet data[PC_OPENER_ETHERNET_BUFFER_SIZE];
+} IoProductionRequest;
+
+/** @brief Production state kept by the I/O task */
+typedef struct {
+  const void *producer; /**< NULL if the entry is unused */
+  struct sockaddr_in address;
+  MicroSeconds production_interval;
+  MicroSeconds next_production; /**< time the next production is due */
+  MicroSeconds send_time; /**< time the next production is sent */
+  EipUint32 sequence_number; /**< last sent sequenced address item number */
+  size_t length;
+  CipOctet data[PC_OPENER_ETHERNET_BUFFER_SIZE];
+} IoProducer;
+
+static IoProductionRequest
+  g_production_requests[OPENER_IO_TASK_PRODUCTION_QUEUE_LENGTH];
+static SpscQueue g_production_queue;
+
+static IoConsumedDatagram
+  g_consumed_datagrams[OPENER_IO_TASK_CONSUMPTION_QUEUE_LENGTH];
+static SpscQueue g_consumption_queue;
+
+/** @brief only used by the I/O task */
+static IoProducer g_producers[IO_HANDLER_NUMBER_OF_PRODUCERS];
+
+/** @brief receive buffer for datagrams not fitting into the full queue */
+static CipOctet g_discard_buffer[PC_OPENER_ETHERNET_BUFFER_SIZE];
+
+static atomic_uint g_io_handler_counters[kIoHandlerNumberOfCounters];
+
+/** @brief A producer the I/O task must not send for any more
+ *
+ * IoHandlerStopProducing() counts the stop request up at once, the I/O task
+ * counts it down when it takes the request from the production queue. Until
+ * then the entry of the producer is kept but not sent, so a stop takes effect
+ * even if the queue is full, and a new production of the same producer queued
+ * behind the stop request is sent as soon as the request is taken.
+ */
+typedef struct {
+  const void *producer; /**< set by the network handler task while unused */
+  atomic_uint pending_stops; /**< 0 if the entry is unused */
+} IoStoppedProducer;
+
+static IoStoppedProducer g_stopped_producers[IO_HANDLER_NUMBER_OF_PRODUCERS];
+
+/** @brief Stop requests not queued yet as the production queue was full,
+ *  oldest first, only used by the network handler task */
+static const void *g_unqueued_stops[IO_HANDLER_NUMBER_OF_PRODUCERS];
+static size_t g_number_of_unqueued_stops;
+
+/** @brief loopback socket the I/O task waits on besides the implicit
+ *  messaging socket, a datagram sent to it wakes the I/O task up */
+static int g_wake_up_socket = kEipInvalidSocket;
+static struct sockaddr_in g_wake_up_address;
+
+/** @brief time up to which the I/O task waits, published before it waits */
+static atomic_ullong g_io_task_wake_up_time;
+
+static void IoHandlerCount(const IoHandlerCounter counter,
+                           const CipUdint increment) {
+  atomic_fetch_add_explicit(&g_io_handler_counters[counter], increment,
+                            memory_order_relaxed);
+}
+
+CipUdint IoHandlerTakeCounter(const IoHandlerCounter counter) {
+  return atomic_exchange_explicit(&g_io_handler_counters[counter], 0,
+                                  memory_order_relaxed);
+}
+
+static int CreateWakeUpSocket(void) {
+  int wake_up_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if(kEipInvalidSocket == wake_up_socket) {
+    return kEipInvalidSocket;
+  }
+  struct sockaddr_in address = {
+    .sin_family = AF_INET,
+    .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    .sin_port = 0
+  };
+  socklen_t address_length = sizeof(address);
+  if(0 > bind(wake_up_socket, (struct sockaddr *) &address,
+              sizeof(address) ) ||
+     0 > getsockname(wake_up_socket, (struct sockaddr *) &g_wake_up_address,
+                     &address_length) ||
+     0 > SetSocketToNonBlocking(wake_up_socket) ) {
+    CloseSocketPlatform(wake_up_socket);
+    return kEipInvalidSocket;
+  }
+  return wake_up_socket;
+}
+
+EipStatus IoHandlerInitialize(void) {
+  SpscQueueInitialize(&g_production_queue, g_production_requests,
+                      sizeof(g_production_requests[0]),
+                      OPENER_IO_TASK_PRODUCTION_QUEUE_LENGTH);
+  SpscQueueInitialize(&g_consumption_queue, g_consumed_datagrams,
+                      sizeof(g_consumed_datagrams[0]),
+                      OPENER_IO_TASK_CONSUMPTION_QUEUE_LENGTH);
+  memset(g_producers, 0, sizeof(g_producers) );
+  for(size_t i = 0; i < kIoHandlerNumberOfCounters; i++) {
+    atomic_init(&g_io_handler_counters[i], 0);
+  }
+  for(size_t i = 0; i < IO_HANDLER_NUMBER_OF_PRODUCERS; i++) {
+    g_stopped_producers[i].producer = NULL;
+    atomic_init(&g_stopped_producers[i].pending_stops, 0);
+  }
+  g_number_of_unqueued_stops = 0;
+  atomic_init(&g_io_task_wake_up_time, 0);
+
+  /* all I/O connections share the socket, it stays open while the I/O task
+   * runs */
+  if(kEipInvalidSocket == CreateUdpSocket() ) {
+    return kEipStatusError;
+  }
+
+  g_wake_up_socket = CreateWakeUpSocket();
+  if(kEipInvalidSocket == g_wake_up_socket) {
+    int error_code = GetSocketErrorNumber();
+    char *error_message = GetErrorMessage(error_code);
+    OPENER_TRACE_ERR(
+      "iohandler: cannot create wake up socket: %d - %s\n",
+      error_code,
+      error_message);
+    FreeErrorMessage(error_message);
+    CloseSocketPlatform(g_network_status.udp_io_messaging);
+    g_network_status.udp_io_messaging = kEipInvalidSocket;
+    return kEipStatusError;
+  }
+  return kEipStatusOk;
+}
+
+void IoHandlerFinish(void) {
+  if(kEipInvalidSocket != g_wake_up_socket) {
+    CloseSocketPlatform(g_wake_up_socket);
+    g_wake_up_socket = kEipInvalidSocket;
+  }
+  if(kEipInvalidSocket != g_network_status.udp_io_messaging) {
+    CloseSocketPlatform(g_network_status.udp_io_messaging);
+    g_network_status.udp_io_messaging = kEipInvalidSocket;
+  }
+}
+
+void IoHandlerWakeUp(void) {
+  const CipOctet wake_up = 0;
+  sendto(g_wake_up_socket, NWBUF_CAST & wake_up, sizeof(wake_up), 0,
+         (struct sockaddr *) &g_wake_up_address, sizeof(g_wake_up_address) );
+}
+
+/** @brief Queue the stop requests the full production queue did not take
+ *
+ *  @return true if all stop requests are queued
+ */
+static bool QueueStopRequests(void) {
+  size_t queued = 0;
+  while(queued < g_number_of_unqueued_stops) {
+    IoProductionRequest *const request = SpscQueueGetWriteSlot(
+      &g_production_queue);
+    if(NULL == request) {
+      break;
+    }
+    request->type = kIoProductionRequestStop;
+    request->producer = g_unqueued_stops[queued++];
+    SpscQueueCommitWrite(&g_production_queue);
+  }
+  g_number_of_unqueued_stops -= queued;
+  memmove(g_unqueued_stops, &g_unqueued_stops[queued],
+          g_number_of_unqueued_stops * sizeof(g_unqueued_stops[0]) );
+  return 0 == g_number_of_unqueued_stops;
+}
+
+EipStatus IoHandlerProduce(const void *const producer,
+                           const struct sockaddr_in *const address,
+                           const MicroSeconds production_time,
+                           const MicroSeconds production_interval,
+                           const bool is_cyclic,
+                           const ENIPMessage *const message) {
+  /* the stop requests go first, a production of a stopped producer must
+   * come behind its stop request */
+  IoProductionRequest *const request = QueueStopRequests() ?
+                                       SpscQueueGetWriteSlot(
+    &g_production_queue) : NULL;
+  if(NULL == request) {
+    OPENER_TRACE_WARN("iohandler: production queue full\n");
+    IoHandlerCount(kIoHandlerCounterOutDiscards, 1);
+    return kEipStatusError;
+  }
+  request->type = kIoProductionRequestProduce;
+  request->producer = producer;
+  request->address = *address;
+  request->production_time = production_time;
+  request->production_interval = production_interval;
+  request->is_cyclic = is_cyclic;
+  request->length = message->used_message_length;
+  memcpy(request->data, message->message_buffer, message->used_message_length);
+  SpscQueueCommitWrite(&g_production_queue);
+
+  /* the I/O task takes the request when it wakes up for the next due
+   * production anyway, it only needs a wake up if that is too late: for a
+   * cyclic production if no other one is due within its interval, e.g. for
+   * the first production of a connection */
+  const MicroSeconds latest_take_time = is_cyclic ?
+                                        production_time +
+                                        kIoHandlerCyclicProductionDelay +
+                                        production_interval : production_time;
+  /* pairs with the fence in IoHandlerProcessCyclic(), either the I/O task
+   * sees the request or this sees the time it waits for */
+  atomic_thread_fence(memory_order_seq_cst);
+  if(latest_take_time <
+     atomic_load_explicit(&g_io_task_wake_up_time, memory_order_relaxed) ) {
+    IoHandlerWakeUp();
+  }
+  return kEipStatusOk;
+}
+
+void IoHandlerStopProducing(const void *const producer) {
+  for(size_t i = 0; i < g_number_of_unqueued_stops; i++) {
+    if(producer == g_unqueued_stops[i]) {
+      return; /* still stopped, nothing has been produced since */
+    }
+  }
+
+  /* one entry per producer at most: an entry is used for the producer it
+   * was set for or not at all */
+  IoStoppedProducer *stopped_producer = NULL;
+  for(size_t i = 0; i < IO_HANDLER_NUMBER_OF_PRODUCERS; i++) {
+    IoStoppedProducer *const entry = &g_stopped_producers[i];
+    const bool is_unused = 0 == atomic_load_explicit(&entry->pending_stops,
+                                                     memory_order_acquire);
+    if(!is_unused && producer == entry->producer) {
+      stopped_producer = entry;
+      break;
+    }
+    if(is_unused && NULL == stopped_producer) {
+      stopped_producer = entry;
+    }
+  }
+  if(NULL == stopped_producer) {
+    /* more producers than I/O connections, the stop goes by the queue only */
+    OPENER_TRACE_ERR("iohandler: no entry to stop producer\n");
+  } else {
+    if(0 == atomic_load_explicit(&stopped_producer->pending_stops,
+                                 memory_order_relaxed) ) {
+      stopped_producer->producer = producer;
+    }
+    /* the I/O task does not send for the producer from now on */
+    atomic_fetch_add_explicit(&stopped_producer->pending_stops, 1,
+                              memory_order_release);
+  }
+
+  /* no wake up, the stop takes effect without the I/O task taking it */
+  if(IO_HANDLER_NUMBER_OF_PRODUCERS <= g_number_of_unqueued_stops) {
+    OPENER_TRACE_ERR("iohandler: too many stop requests\n");
+    return;
+  }
+  g_unqueued_stops[g_number_of_unqueued_stops++] = producer;
+  if( !QueueStopRequests() ) {
+    OPENER_TRACE_WARN(
+      "iohandler: production queue full, stop request queued later\n");
+  }
+}
+
+const IoConsumedDatagram *IoHandlerGetConsumedDatagram(void) {
+  return SpscQueueGetReadSlot(&g_consumption_queue);
+}
+
+void IoHandlerReleaseConsumedDatagram(void) {
+  SpscQueueReleaseRead(&g_consumption_queue);
+}
+
+/** @brief Check if the production starts with a sequenced address item */
+static bool IsSequencedIoProduction(const CipOctet *const data) {
+  const EipUint8 *item_type = data + 2; /* behind the item count */
+  return kCipItemIdSequencedAddressItem == GetUintFromMessage(&item_type);
+}
+
+/** @brief Find the entry of a stopped producer whose stop request has not
+ *  been taken yet
+ *
+ *  @return the entry, NULL if the producer is not stopped
+ */
+static IoStoppedProducer *FindStoppedIoProducer(const void *const producer) {
+  for(size_t i = 0; i < IO_HANDLER_NUMBER_OF_PRODUCERS; i++) {
+    IoStoppedProducer *const entry = &g_stopped_producers[i];
+    if(0 != atomic_load_explicit(&entry->pending_stops,
+                                 memory_order_acquire) &&
+       producer == entry->producer) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static IoProducer *FindIoProducer(const void *const producer) {
+  for(size_t i = 0; i < IO_HANDLER_NUMBER_OF_PRODUCERS; i++) {
+    if(producer == g_producers[i].producer) {
+      return &g_producers[i];
+    }
+  }
+  return NULL;
+}
+
+/** @brief Take over the productions handed over by the network handler */
+static void TakeProductionRequests(void) {
+  const IoProductionRequest *request = NULL;
+  while( NULL != ( request = SpscQueueGetReadSlot(&g_production_queue) ) ) {
+    IoProducer *io_producer = FindIoProducer(request->producer);
+    if(kIoProductionRequestStop == request->type) {
+      if(NULL != io_producer) {
+        io_producer->producer = NULL;
+      }
+      IoStoppedProducer *const stopped_producer = FindStoppedIoProducer(
+        request->producer);
+      if(NULL != stopped_producer) {
+        /* a production queued behind the request may be sent */
+        atomic_fetch_sub_explicit(&stopped_producer->pending_stops, 1,
+                                  memory_order_release);
+      }
+    } else {
+      if(NULL == io_producer) {
+        io_producer = FindIoProducer(NULL);
+        if(NULL == io_producer) {
+          OPENER_TRACE_ERR("iohandler: no free producer entry\n");
+          IoHandlerCount(kIoHandlerCounterOutDiscards, 1);
+          SpscQueueReleaseRead(&g_production_queue);
+          continue;
+        }
+        io_producer->producer = request->producer;
+        io_producer->next_production = request->production_time;
+        if( IsSequencedIoProduction(request->data) ) {
+          /* continue the sequence the connection has started */
+          const EipUint8 *sequence_number = request->data +
+                                            IO_HANDLER_SEQUENCE_NUMBER_OFFSET;
+          io_producer->sequence_number =
+            GetDintFromMessage(&sequence_number) - 1;
+        }
+      }
+      io_producer->address = request->address;
+      io_producer->production_interval = request->production_interval;
+      io_producer->length = request->length;
+      memcpy(io_producer->data, request->data, request->length);
+
+      if(request->is_cyclic) {
+        /* data of a production already sent goes out with the next one,
+         * a production off the schedule, e.g. after the network handler has
+         * restarted its production phase, moves the schedule to it */
+        if(request->production_time > io_producer->next_production ||
+           0 != (io_producer->next_production - request->production_time) %
+           request->production_interval) {
+          io_producer->next_production = request->production_time;
+        }
+        io_producer->send_time = io_producer->next_production +
+                                 kIoHandlerCyclicProductionDelay;
+      } else {
+        io_producer->next_production = request->production_time;
+        io_producer->send_time = request->production_time;
+      }
+    }
+    SpscQueueReleaseRead(&g_production_queue);
+  }
+}
+
+static void SendIoProduction(IoProducer *const io_producer) {
+  if( IsSequencedIoProduction(io_producer->data) ) {
+    /* every datagram sent gets a new number, repeated data included */
+    EipUint8 *const sequence_number = io_producer->data +
+                                      IO_HANDLER_SEQUENCE_NUMBER_OFFSET;
+    io_producer->sequence_number++;
+    for(size_t i = 0; i < sizeof(io_producer->sequence_number); i++) {
+      sequence_number[i] = (EipUint8) (io_producer->sequence_number >> (8 * i) );
+    }
+  }
+
+  int sent_length = sendto(g_network_status.udp_io_messaging,
+                           NWBUF_CAST io_producer->data,
+                           io_producer->length, 0,
+                           (struct sockaddr *) &io_producer->address,
+                           sizeof(io_producer->address) );
+  if(sent_length < 0) {
+    IoHandlerCount(kIoHandlerCounterOutErrors, 1);
+  } else if( (size_t) sent_length != io_producer->length ) {
+    IoHandlerCount(kIoHandlerCounterOutDiscards, 1);
+  } else {
+    IoHandlerCount(kIoHandlerCounterOutOctets, (CipUdint) sent_length);
+    IoHandlerCount(kIoHandlerCounterOutPackets, 1);
+  }
+}
+
+/** @brief Send the due productions
+ *
+ *  @param current_time current time
+ *  @return time the next production is to be sent
+ */
+static MicroSeconds SendDueProductions(const MicroSeconds current_time) {
+  MicroSeconds next_send_time = current_time + kIoHandlerIdleTimeout;
+  for(size_t i = 0; i < IO_HANDLER_NUMBER_OF_PRODUCERS; i++) {
+    IoProducer *const io_producer = &g_producers[i];
+    if(NULL == io_producer->producer) {
+      continue;
+    }
+    if( NULL != FindStoppedIoProducer(io_producer->producer) ) {
+      continue; /* removed when the stop request is taken */
+    }
+    if(io_producer->send_time <= current_time) {
+      SendIoProduction(io_producer);
+      io_producer->next_production += io_producer->production_interval;
+      if(io_producer->next_production + kIoHandlerCyclicProductionDelay <=
+         current_time) {
+        /* held up for more than an interval, skip the missed productions
+         * keeping the phase the network handler produces in */
+        io_producer->next_production +=
+          ( (current_time - kIoHandlerCyclicProductionDelay -
+             io_producer->next_production) /
+            io_producer->production_interval + 1 ) *
+          io_producer->production_interval;
+      }
+      io_producer->send_time = io_producer->next_production +
+                               kIoHandlerCyclicProductionDelay;
+    }
+    if(io_producer->send_time < next_send_time) {
+      next_send_time = io_producer->send_time;
+    }
+  }
+  return next_send_time;
+}
+
+/** @brief Queue the datagrams waiting on the implicit messaging socket */
+static void ReceiveConsumedDatagrams(void) {
+  for(size_t i = 0; i < OPENER_IO_TASK_CONSUMPTION_QUEUE_LENGTH; i++) {
+    IoConsumedDatagram *const datagram = SpscQueueGetWriteSlot(
+      &g_consumption_queue);
+    CipOctet *const buffer =
+      (NULL != datagram) ? datagram->data : g_discard_buffer;
+    struct sockaddr_in from_address = { 0 };
+    socklen_t from_address_length = sizeof(from_address);
+
+    int received_size = recvfrom(g_network_status.udp_io_messaging,
+                                 NWBUF_CAST buffer,
+                                 PC_OPENER_ETHERNET_BUFFER_SIZE,
+                                 0,
+                                 (struct sockaddr *) &from_address,
+                                 &from_address_length);
+    if(0 > received_size) {
+      if(OPENER_SOCKET_WOULD_BLOCK != GetSocketErrorNumber() ) {
+        IoHandlerCount(kIoHandlerCounterInErrors, 1);
+      }
+      return;
+    }
+    if(NULL == datagram || 0 == received_size) {
+      IoHandlerCount(kIoHandlerCounterInDiscards, 1);
+      continue;
+    }
+    datagram->reception_time = GetMicroSeconds();
+    datagram->from_address = from_address;
+    datagram->length = (size_t) received_size;
+    SpscQueueCommitWrite(&g_consumption_queue);
+  }
+}
+
+void IoHandlerProcessCyclic(void) {
+  TakeProductionRequests();
+  const MicroSeconds current_time = GetMicroSeconds();
+  const MicroSeconds next_send_time = SendDueProductions(current_time);
+
+  atomic_store_explicit(&g_io_task_wake_up_time, next_send_time,
+                        memory_order_relaxed);
+  /* pairs with the fence in IoHandlerProduce(), a request which has come in
+   * meanwhile is taken before waiting */
+  atomic_thread_fence(memory_order_seq_cst);
+  if(NULL != SpscQueueGetReadSlot(&g_production_queue) ) {
+    return;
+  }
+
+  fd_set read_set;
+  FD_ZERO(&read_set);
+  FD_SET(g_network_status.udp_io_messaging, &read_set);
+  FD_SET(g_wake_up_socket, &read_set);
+  const MicroSeconds timeout =
+    next_send_time > current_time ? next_send_time - current_time : 0;
+  struct timeval time_value = {
+    .tv_sec = (time_t) (timeout / 1000000ULL),
+    .tv_usec = (suseconds_t) (timeout % 1000000ULL)
+  };
+  int ready_sockets = select( (g_network_status.udp_io_messaging >
+                               g_wake_up_socket ? g_network_status.
+                               udp_io_messaging : g_wake_up_socket) + 1,
+                              &read_set, NULL, NULL, &time_value);
+  if(0 >= ready_sockets) {
+    return;
+  }
+
+  if( FD_ISSET(g_network_status.udp_io_messaging, &read_set) ) {
+    ReceiveConsumedDatagrams();
+  }
+  if( FD_ISSET(g_wake_up_socket, &read_set) ) {
+    while(0 <= recv(g_wake_up_socket, NWBUF_CAST g_discard_buffer,
+                    sizeof(g_discard_buffer), 0) ) {
+    }
+  }
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/** @file generic_iohandler.h
+ *  @brief Implicit I/O messaging in a task of its own
+ *
+ *  With OPENER_IO_TASK enabled the port calls IoHandlerProcessCyclic() from a
+ *  task of higher priority than the one calling NetworkHandlerProcessCyclic().
+ *  The I/O task owns the UDP socket of the implicit messaging: it sends the
+ *  produced data and receives the consumed data, so explicit messages being
+ *  processed by the network handler task no longer delay the production.
+ *
+ *  The tasks only exchange data through single producer, single consumer
+ *  queues:
+ *  - the network handler task hands every production over with
+ *    IoHandlerProduce(). The I/O task sends the data of cyclic connections at
+ *    its own RPI schedule and repeats the last data if no newer one has
+ *    arrived in time. Change of state and application triggered productions
+ *    are sent at once.
+ *  - the I/O task time stamps the received datagrams and queues them. The
+ *    network handler task takes them with IoHandlerGetConsumedDatagram() and
+ *    handles them at the time of their reception, so a busy network handler
+ *    task does not let the connections time out.
+ *
+ *  The OpENer task wakes the I/O task up with a datagram on a loopback socket
+ *  the I/O task waits on. On LWIP this needs LWIP_NETCONN_FULLDUPLEX, as one
+ *  task writes the socket while the other one reads it.
+ *
+ *  @attention This file should only be used by the port specific network
+ *  handlers.
+ */
+
+#ifndef GENERIC_IOHANDLER_H_
+#define GENERIC_IOHANDLER_H_
+
+#include "generic_networkhandler.h"
+
+/** @brief Number of productions the network handler task may hand over
+ *  before the I/O task takes them, has to be a power of two */
+#ifndef OPENER_IO_TASK_PRODUCTION_QUEUE_LENGTH
+  #define OPENER_IO_TASK_PRODUCTION_QUEUE_LENGTH 8
+#endif
+
+/** @brief Number of consumed datagrams the I/O task may queue before the
+ *  network handler task takes them, has to be a power of two */
+#ifndef OPENER_IO_TASK_CONSUMPTION_QUEUE_LENGTH
+  #define OPENER_IO_TASK_CONSUMPTION_QUEUE_LENGTH 16
+#endif
+
+/** @brief A datagram received by the I/O task */
+typedef struct {
+  MicroSeconds reception_time;
+  struct sockaddr_in from_address;
+  size_t length;
+  CipOctet data[PC_OPENER_ETHERNET_BUFFER_SIZE];
+} IoConsumedDatagram;
+
+/** @brief Interface counters of the traffic handled by the I/O task */
+typedef enum {
+  kIoHandlerCounterInDiscards,
+  kIoHandlerCounterInErrors,
+  kIoHandlerCounterOutOctets,
+  kIoHandlerCounterOutPackets,
+  kIoHandlerCounterOutDiscards,
+  kIoHandlerCounterOutErrors,
+  kIoHandlerNumberOfCounters
+} IoHandlerCounter;
+
+/** @brief Set up the queues and open the implicit messaging socket
+ *
+ *  Has to be called by the network handler task before the I/O task is
+ *  started.
+ *
+ *  @return kEipStatusOk on success
+ */
+EipStatus IoHandlerInitialize(void);
+
+/** @brief Close the sockets of the I/O handler
+ *
+ *  Has to be called after the I/O task has stopped.
+ */
+void IoHandlerFinish(void);
+
+/** @brief One cycle of the I/O task
+ *
+ *  Waits until the next production is due, a datagram is received or the
+ *  I/O task is woken up, then handles whatever is pending.
+ */
+void IoHandlerProcessCyclic(void);
+
+/** @brief Let a waiting IoHandlerProcessCyclic() return, e.g. to stop the
+ *  I/O task */
+void IoHandlerWakeUp(void);
+
+/** @brief Hand a production over to the I/O task
+ *
+ *  @param producer identifies the producing connection
+ *  @param address destination of the data
+ *  @param production_time time the production was due
+ *  @param production_interval interval until the next production is due
+ *  @param is_cyclic true if the I/O task times the productions, false to
+ *                   send the data at once
+ *  @param message data to send, starting with the common packet format
+ *  @return kEipStatusError if the queue is full
+ */
+EipStatus IoHandlerProduce(const void *const producer,
+                           const struct sockaddr_in *const address,
+                           const MicroSeconds production_time,
+                           const MicroSeconds production_interval,
+                           const bool is_cyclic,
+                           const ENIPMessage *const message);
+
+/** @brief Let the I/O task stop sending for the given producer
+ *
+ *  Takes effect at once, also if the production queue is full: the I/O task
+ *  does not send for the producer any more. A later IoHandlerProduce() for the
+ *  same producer starts a new production.
+ *
+ *  @param producer identifies the producing connection
+ */
+void IoHandlerStopProducing(const void *const producer);
+
+/** @brief Get the oldest datagram received by the I/O task
+ *
+ *  @return the datagram, NULL if none is waiting
+ */
+const IoConsumedDatagram *IoHandlerGetConsumedDatagram(void);
+
+/** @brief Hand the datagram from IoHandlerGetConsumedDatagram() back */
+void IoHandlerReleaseConsumedDatagram(void);
+
+/** @brief Get an interface counter of the I/O task and reset it
+ *
+ *  @param counter counter to take
+ *  @return increment of the counter since it has been taken last
+ */
+CipUdint IoHandlerTakeCounter(const IoHandlerCounter counter);
+
+#endif /* GENERIC_IOHANDLER_H_ */
@@ -23,9 +23,19 @@
 #include "ciptcpipinterface.h"
 #include "opener_user_conf.h"
 #include "cipqos.h"
+#include "cipconnectionobject.h"
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+#include "generic_iohandler.h"
+#endif
 
 #define MAX_NO_OF_TCP_SOCKETS 10
 
+/** @brief Most datagrams taken from the implicit messaging socket in one
+ *  network handler cycle */
+#ifndef OPENER_CONSUMING_UDP_RECEIVE_BUDGET
+  #define OPENER_CONSUMING_UDP_RECEIVE_BUDGET 16
+#endif
+
 /** @brief Ethernet/IP standard port */
 
 /* ----- Windows size_t PRI macros ------------- */
@@ -108,12 +118,43 @@ void CheckAndHandleConsumingUdpSocket(void);
  */
 EipStatus HandleDataOnTcpSocket(int socket);
 
-void CheckEncapsulationInactivity(int socket_handle);
-
 void RemoveSocketTimerFromList(const int socket_handle);
 
+/** @brief sockets of the established TCP connections, in no particular order
+ *
+ *  Only these are visited per cycle, independent of the range of socket
+ *  numbers handed to select().
+ */
+static int g_active_tcp_sockets[OPENER_NUMBER_OF_SUPPORTED_SESSIONS];
+
+/** @brief number of entries in g_active_tcp_sockets */
+static size_t g_number_of_active_tcp_sockets;
+
+static void AddActiveTcpSocket(const int socket_handle);
+
+static void RemoveActiveTcpSocket(const int socket_handle);
+
+/** @brief receive buffer shared by the UDP sockets, which are served one after
+ *  the other */
+static CipOctet g_udp_receive_buffer[PC_OPENER_ETHERNET_BUFFER_SIZE];
+
+/** @brief reply buffer shared by the UDP sockets */
+static ENIPMessage g_udp_outgoing_message;
+
 static NetworkInterfaceCounters g_network_interface_counters;
 
+/** @brief true while the implicit messaging socket is open, it is shared by
+ *  all I/O connections instead of being opened and closed with them */
+static bool g_udp_io_socket_is_shared = false;
+
+static void HandleConsumedUdpDatagram(const CipOctet *const data,
+                                      const size_t length,
+                                      struct sockaddr_in *const from_address);
+
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+static void HandleIoTaskConsumedData(const MicroSeconds current_time);
+#endif
+
 static void NetworkCountersRecordRx(size_t bytes, EipBool8 is_multicast) {
   g_network_interface_counters.in_octets += (CipUdint)bytes;
   if (is_multicast) {
@@ -148,11 +189,35 @@ static void NetworkCountersRecordTxDiscard(void) {
   g_network_interface_counters.out_discards++;
 }
 
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+/** @brief Add the traffic counted by the I/O task */
+static void NetworkCountersCollectIoTask(void) {
+  g_network_interface_counters.in_discards +=
+    IoHandlerTakeCounter(kIoHandlerCounterInDiscards);
+  g_network_interface_counters.in_errors +=
+    IoHandlerTakeCounter(kIoHandlerCounterInErrors);
+  g_network_interface_counters.out_octets +=
+    IoHandlerTakeCounter(kIoHandlerCounterOutOctets);
+  g_network_interface_counters.out_ucast_packets +=
+    IoHandlerTakeCounter(kIoHandlerCounterOutPackets);
+  g_network_interface_counters.out_discards +=
+    IoHandlerTakeCounter(kIoHandlerCounterOutDiscards);
+  g_network_interface_counters.out_errors +=
+    IoHandlerTakeCounter(kIoHandlerCounterOutErrors);
+}
+#endif
+
 const NetworkInterfaceCounters *NetworkGetInterfaceCounters(void) {
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  NetworkCountersCollectIoTask();
+#endif
   return &g_network_interface_counters;
 }
 
 void NetworkResetInterfaceCounters(void) {
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  NetworkCountersCollectIoTask();
+#endif
   memset(&g_network_interface_counters, 0, sizeof(g_network_interface_counters));
 }
 
@@ -181,6 +246,7 @@ EipStatus NetworkHandlerInitialize(void) {
   /* clear the master and temp sets */
   FD_ZERO(&master_socket);
   FD_ZERO(&read_socket);
+  g_number_of_active_tcp_sockets = 0;
 
   /* create a new TCP socket */
   if( ( g_network_status.tcp_listener =
@@ -414,10 +480,22 @@ EipStatus NetworkHandlerInitialize(void) {
   g_network_status.elapsed_time = 0;
   NetworkResetInterfaceCounters();
 
+  g_network_status.udp_io_messaging = kEipInvalidSocket;
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  if( kEipStatusOk != IoHandlerInitialize() ) {
+    OPENER_TRACE_ERR("networkhandler: cannot set up the I/O task\n");
+    return kEipStatusError;
+  }
+#endif
+
   return kEipStatusOk;
 }
 
 void CloseUdpSocket(int socket_handle) {
+  if(g_udp_io_socket_is_shared &&
+     socket_handle == g_network_status.udp_io_messaging) {
+    return; /* closed by NetworkHandlerFinish() */
+  }
   OPENER_TRACE_STATE("Closing UDP socket %d\n", socket_handle);
   CloseSocket(socket_handle);
 }
@@ -427,6 +505,52 @@ void CloseTcpSocket(int socket_handle) {
   ShutdownSocketPlatform(socket_handle);
   RemoveSocketTimerFromList(socket_handle);
   CloseSocket(socket_handle);
+  RemoveActiveTcpSocket(socket_handle);
+}
+
+/** @brief Add an accepted TCP connection to the sockets visited per cycle
+ *
+ *  @param socket_handle socket of the connection
+ */
+static void AddActiveTcpSocket(const int socket_handle) {
+  OPENER_ASSERT(g_number_of_active_tcp_sockets <
+                OPENER_NUMBER_OF_SUPPORTED_SESSIONS);
+  g_active_tcp_sockets[g_number_of_active_tcp_sockets++] = socket_handle;
+  if(socket_handle > highest_socket_handle) {
+    OPENER_TRACE_INFO("New highest socket: %d\n", socket_handle);
+    highest_socket_handle = socket_handle;
+  }
+}
+
+/** @brief Remove a closed TCP connection from the sockets visited per cycle
+ *
+ *  The last entry takes the place of the removed one. If the connection had
+ *  the highest socket number, the range handed to select() shrinks.
+ *
+ *  @param socket_handle socket of the connection
+ */
+static void RemoveActiveTcpSocket(const int socket_handle) {
+  for(size_t i = 0; i < g_number_of_active_tcp_sockets; i++) {
+    if(socket_handle == g_active_tcp_sockets[i]) {
+      g_active_tcp_sockets[i] =
+        g_active_tcp_sockets[--g_number_of_active_tcp_sockets];
+      break;
+    }
+  }
+  if(socket_handle != highest_socket_handle) {
+    return;
+  }
+  highest_socket_handle = GetMaxSocket(g_network_status.tcp_listener,
+                                       g_network_status.udp_global_broadcast_listener,
+                                       FD_ISSET(g_network_status.udp_io_messaging,
+                                                &master_socket) ?
+                                       g_network_status.udp_io_messaging : 0,
+                                       g_network_status.udp_unicast_listener);
+  for(size_t i = 0; i < g_number_of_active_tcp_sockets; i++) {
+    if(g_active_tcp_sockets[i] > highest_socket_handle) {
+      highest_socket_handle = g_active_tcp_sockets[i];
+    }
+  }
 }
 
 void RemoveSocketTimerFromList(const int socket_handle) {
@@ -459,7 +583,11 @@ void CheckAndHandleTcpListenerSocket(void) {
   if( true == CheckSocketSet(g_network_status.tcp_listener) ) {
     OPENER_TRACE_INFO("networkhandler: new TCP connection\n");
 
-    new_socket = accept(g_network_status.tcp_listener, NULL, NULL);
+    struct sockaddr peer_address;
+    socklen_t peer_address_length = sizeof(peer_address);
+    new_socket = accept(g_network_status.tcp_listener,
+                        &peer_address,
+                        &peer_address_length);
     if(new_socket == kEipInvalidSocket) {
       int error_code = GetSocketErrorNumber();
       char *error_message = GetErrorMessage(error_code);
@@ -496,7 +624,8 @@ void CheckAndHandleTcpListenerSocket(void) {
 //                        g_timestamps[i].last_update);
 //    }
 
-    if(socket_timer == NULL) {
+    if(socket_timer == NULL ||
+       NULL == CreateEncapsulationSession(new_socket, &peer_address) ) {
       OPENER_TRACE_WARN("networkhandler: no available session slot, closing new connection on socket %d\n", new_socket);
       ShutdownSocketPlatform(new_socket);
       CloseSocketPlatform(new_socket);
@@ -505,10 +634,7 @@ void CheckAndHandleTcpListenerSocket(void) {
 
     FD_SET(new_socket, &master_socket);
     /* add newfd to master set */
-    if(new_socket > highest_socket_handle) {
-      OPENER_TRACE_INFO("New highest socket: %d\n", new_socket);
-      highest_socket_handle = new_socket;
-    }
+    AddActiveTcpSocket(new_socket);
 
     OPENER_TRACE_STATE("networkhandler: opened new TCP connection on fd %d\n",
                        new_socket);
@@ -519,12 +645,17 @@ EipStatus NetworkHandlerProcessCyclic(void) {
 
   read_socket = master_socket;
 
-  g_time_value.tv_sec = 0;
-  g_time_value.tv_usec =
+  /* wait until the next tick, or the next connection timer if it is earlier */
+  const MicroSeconds current_time = GetMicroSeconds();
+  const MicroSeconds wakeup_time = GetNextConnectionTimerDeadline(
+    current_time +
     (g_network_status.elapsed_time <
      kOpenerTimerTickInMilliSeconds ? kOpenerTimerTickInMilliSeconds -
-     g_network_status.elapsed_time : 0)
-    * 1000; /* 10 ms */
+     g_network_status.elapsed_time : 0) * 1000ULL);
+  const MicroSeconds timeout =
+    wakeup_time > current_time ? wakeup_time - current_time : 0;
+  g_time_value.tv_sec = (time_t) (timeout / 1000000ULL);
+  g_time_value.tv_usec = (suseconds_t) (timeout % 1000000ULL);
 
   int ready_socket = select(highest_socket_handle + 1,
                             &read_socket,
@@ -547,16 +678,31 @@ EipStatus NetworkHandlerProcessCyclic(void) {
     }
   }
 
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  HandleIoTaskConsumedData(GetMicroSeconds() );
+#else
+  /* expired connection timers are handled before the received data, whose
+   * watchdog resets are relative to the time of the timers */
+  ManageConnectionTimers(GetMicroSeconds() );
+#endif
+
   if(ready_socket > 0) {
 
     CheckAndHandleTcpListenerSocket();
     CheckAndHandleUdpUnicastSocket();
     CheckAndHandleUdpGlobalBroadcastSocket();
+#if !defined(OPENER_IO_TASK) || 0 == OPENER_IO_TASK
     CheckAndHandleConsumingUdpSocket();
+#endif
 
-    for(int socket = 0; socket <= highest_socket_handle; socket++) {
+    /* walk the TCP connections from the end, closing one moves the last
+     * entry into its place */
+    for(size_t i = g_number_of_active_tcp_sockets; i > 0; i--) {
+      if(i > g_number_of_active_tcp_sockets) { /* closed while handling another one */
+        continue;
+      }
+      const int socket = g_active_tcp_sockets[i - 1];
       if( true == CheckSocketSet(socket) ) {
-        /* if it is still checked it is a TCP receive */
         if( kEipStatusError == HandleDataOnTcpSocket(socket) ) /* if error */
         {
           CloseTcpSocket(socket);
@@ -566,10 +712,6 @@ EipStatus NetworkHandlerProcessCyclic(void) {
     }
   }
 
-  for(int socket = 0; socket <= highest_socket_handle; socket++) {
-    CheckEncapsulationInactivity(socket);
-  }
-
   /* Check if all connections from one originator times out */
   //CheckForTimedOutConnectionsAndCloseTCPConnections();
   //OPENER_TRACE_INFO("Socket Loop done\n");
@@ -601,6 +743,13 @@ EipStatus NetworkHandlerFinish(void) {
   CloseTcpSocket(g_network_status.tcp_listener);
   CloseUdpSocket(g_network_status.udp_unicast_listener);
   CloseUdpSocket(g_network_status.udp_global_broadcast_listener);
+  g_udp_io_socket_is_shared = false;
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  IoHandlerFinish();
+#else
+  CloseUdpSocket(g_network_status.udp_io_messaging);
+  g_network_status.udp_io_messaging = kEipInvalidSocket;
+#endif
   return kEipStatusOk;
 }
 
@@ -614,10 +763,10 @@ void CheckAndHandleUdpGlobalBroadcastSocket(void) {
       "networkhandler: unsolicited UDP message on EIP global broadcast socket\n");
 
     /* Handle UDP broadcast messages */
-    CipOctet incoming_message[PC_OPENER_ETHERNET_BUFFER_SIZE] = { 0 };
+    CipOctet *const incoming_message = g_udp_receive_buffer;
     int received_size = recvfrom(g_network_status.udp_global_broadcast_listener,
                                  NWBUF_CAST incoming_message,
-                                 sizeof(incoming_message),
+                                 sizeof(g_udp_receive_buffer),
                                  0,
                                  (struct sockaddr *) &from_address,
                                  &from_address_length);
@@ -634,17 +783,17 @@ void CheckAndHandleUdpGlobalBroadcastSocket(void) {
     }
 
     // Check if packet was truncated
-    if (received_size >= (int)sizeof(incoming_message)) {
+    if (received_size >= (int)sizeof(g_udp_receive_buffer)) {
       OPENER_TRACE_WARN("UDP packet may have been truncated (received: %d, buffer: %zu)\n",
-                        received_size, sizeof(incoming_message));
+                        received_size, sizeof(g_udp_receive_buffer));
     }
 
     OPENER_TRACE_INFO("Data received on global broadcast UDP:\n");
 
     const EipUint8 *receive_buffer = &incoming_message[0];
     int remaining_bytes = 0;
-    ENIPMessage outgoing_message;
-    InitializeENIPMessage(&outgoing_message);
+    ENIPMessage *const outgoing_message = &g_udp_outgoing_message;
+    ReuseENIPMessage(outgoing_message);
     EipStatus need_to_send = HandleReceivedExplictUdpData(
       g_network_status.udp_unicast_listener,
       /* sending from unicast port, due to strange behavior of the broadcast port */
@@ -653,7 +802,7 @@ void CheckAndHandleUdpGlobalBroadcastSocket(void) {
       received_size,
       &remaining_bytes,
       false,
-      &outgoing_message);
+      outgoing_message);
 
     receive_buffer += received_size - remaining_bytes;
     received_size = remaining_bytes;
@@ -662,11 +811,13 @@ void CheckAndHandleUdpGlobalBroadcastSocket(void) {
       OPENER_TRACE_INFO("UDP broadcast reply sent:\n");
 
       /* if the active socket matches a registered UDP callback, handle a UDP packet */
-      if(sendto( g_network_status.udp_unicast_listener,  /* sending from unicast port, due to strange behavior of the broadcast port */
-                 (char *) outgoing_message.message_buffer,
-                 outgoing_message.used_message_length, 0,
-                 (struct sockaddr *) &from_address, sizeof(from_address) )
-         != outgoing_message.used_message_length) {
+      long sent_length = sendto(g_network_status.udp_unicast_listener,  /* sending from unicast port, due to strange behavior of the broadcast port */
+                                (char *) outgoing_message->message_buffer,
+                                outgoing_message->used_message_length, 0,
+                                (struct sockaddr *) &from_address,
+                                sizeof(from_address) );
+      if(sent_length < 0 ||
+         (size_t)sent_length != outgoing_message->used_message_length) {
         OPENER_TRACE_INFO(
           "networkhandler: UDP response was not fully sent\n");
       }
@@ -689,10 +840,10 @@ void CheckAndHandleUdpUnicastSocket(void) {
       "networkhandler: unsolicited UDP message on EIP unicast socket\n");
 
     /* Handle UDP broadcast messages */
-    CipOctet incoming_message[PC_OPENER_ETHERNET_BUFFER_SIZE] = { 0 };
+    CipOctet *const incoming_message = g_udp_receive_buffer;
     int received_size = recvfrom(g_network_status.udp_unicast_listener,
                                  NWBUF_CAST incoming_message,
-                                 sizeof(incoming_message),
+                                 sizeof(g_udp_receive_buffer),
                                  0,
                                  (struct sockaddr *) &from_address,
                                  &from_address_length);
@@ -710,9 +861,9 @@ void CheckAndHandleUdpUnicastSocket(void) {
     }
 
     // Check if packet was truncated
-    if (received_size >= (int)sizeof(incoming_message)) {
+    if (received_size >= (int)sizeof(g_udp_receive_buffer)) {
       OPENER_TRACE_WARN("UDP unicast packet may have been truncated (received: %d, buffer: %zu)\n",
-                        received_size, sizeof(incoming_message));
+                        received_size, sizeof(g_udp_receive_buffer));
       NetworkCountersRecordRxDiscard();
     }
 
@@ -723,8 +874,8 @@ void CheckAndHandleUdpUnicastSocket(void) {
 
     EipUint8 *receive_buffer = &incoming_message[0];
     int remaining_bytes = 0;
-    ENIPMessage outgoing_message;
-    InitializeENIPMessage(&outgoing_message);
+    ENIPMessage *const outgoing_message = &g_udp_outgoing_message;
+    ReuseENIPMessage(outgoing_message);
     EipStatus need_to_send = HandleReceivedExplictUdpData(
       g_network_status.udp_unicast_listener,
       &from_address,
@@ -732,7 +883,7 @@ void CheckAndHandleUdpUnicastSocket(void) {
       received_size,
       &remaining_bytes,
       true,
-      &outgoing_message);
+      outgoing_message);
 
     receive_buffer += received_size - remaining_bytes;
     received_size = remaining_bytes;
@@ -741,18 +892,19 @@ void CheckAndHandleUdpUnicastSocket(void) {
       OPENER_TRACE_INFO("UDP unicast reply sent:\n");
 
       /* if the active socket matches a registered UDP callback, handle a UDP packet */
-      if(sendto( g_network_status.udp_unicast_listener,
-                 (char *) outgoing_message.message_buffer,
-                 outgoing_message.used_message_length, 0,
-                 (struct sockaddr *) &from_address,
-                 sizeof(from_address) ) !=
-         outgoing_message.used_message_length) {
+      long sent_length = sendto(g_network_status.udp_unicast_listener,
+                                (char *) outgoing_message->message_buffer,
+                                outgoing_message->used_message_length, 0,
+                                (struct sockaddr *) &from_address,
+                                sizeof(from_address) );
+      if(sent_length < 0 ||
+         (size_t)sent_length != outgoing_message->used_message_length) {
         OPENER_TRACE_INFO(
           "networkhandler: UDP unicast response was not fully sent\n");
         NetworkCountersRecordTxError();
       }
       else {
-        NetworkCountersRecordTx(outgoing_message.used_message_length, false);
+        NetworkCountersRecordTx(outgoing_message->used_message_length, false);
       }
     }
     if (remaining_bytes > 0) {
@@ -791,9 +943,9 @@ EipStatus SendUdpData(const struct sockaddr_in *const address,
     return kEipStatusError;
   }
 
-  if(sent_length != outgoing_message->used_message_length) {
+  if( (size_t)sent_length != outgoing_message->used_message_length ) {
     OPENER_TRACE_WARN(
-      "data length sent_length mismatch; probably not all data was sent in SendUdpData, sent %d of %d\n",
+      "data length sent_length mismatch; probably not all data was sent in SendUdpData, sent %d of %" PRIuSZT "\n",
       sent_length,
       outgoing_message->used_message_length);
     NetworkCountersRecordTxDiscard();
@@ -804,211 +956,254 @@ EipStatus SendUdpData(const struct sockaddr_in *const address,
   return kEipStatusOk;
 }
 
-EipStatus HandleDataOnTcpSocket(int socket) {
-  OPENER_TRACE_INFO("Entering HandleDataOnTcpSocket for socket: %d\n", socket);
+EipStatus ProduceUdpData(const CipConnectionObject *const connection_object,
+                         const ENIPMessage *const outgoing_message) {
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  return IoHandlerProduce(connection_object,
+                          &connection_object->remote_address,
+                          connection_object->transmission_trigger_deadline,
+                          ConnectionObjectGetRequestedPacketInterval(
+                            connection_object),
+                          kConnectionObjectTransportClassTriggerProductionTriggerCyclic
+                          ==
+                          ConnectionObjectGetTransportClassTriggerProductionTrigger(
+                            connection_object),
+                          outgoing_message);
+#else
+  return SendUdpData(&connection_object->remote_address, outgoing_message);
+#endif
+}
+
+void StopProducingUdpData(const CipConnectionObject *const connection_object) {
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+  IoHandlerStopProducing(connection_object);
+#else
+  (void) connection_object; /* sent at once, nothing to stop */
+#endif
+}
+
+/** @brief Check if a TCP connection was closed while its data was handled
+ *
+ *  Closing the connection releases its record to the pool, which marks it
+ *  unused or hands it to another connection.
+ *
+ *  @param session record the connection had when handling started
+ *  @param socket socket of the connection
+ *  @return true if the record does not belong to the connection any more
+ */
+static EipBool8 IsTcpConnectionClosed(const EncapsulationSession *const session,
+                                      const int socket) {
+  return socket != session->socket;
+}
+
+/** @brief Handle one complete encapsulation packet received on a TCP connection
+ *
+ *  @param session record of the connection, the reply is built in its
+ *                 outgoing message
+ *  @param packet start of the packet
+ *  @param packet_length length of the packet including the encapsulation header
+ *  @return true if the connection is still open, false if handling the packet
+ *          closed it, e.g. UnregisterSession; the record must not be used then
+ */
+static EipBool8 HandleTcpEncapsulationPacket(EncapsulationSession *const session,
+                                             EipUint8 *const packet,
+                                             const size_t packet_length) {
+  const int socket = session->socket;
+  ENIPMessage *const outgoing_message = &session->outgoing_message;
   int remaining_bytes = 0;
-  long data_sent = PC_OPENER_ETHERNET_BUFFER_SIZE;
 
-  /* We will handle just one EIP packet here the rest is done by the select
-   * method which will inform us if more data is available in the socket
-     because of the current implementation of the main loop this may not be
-     the fastest way and a loop here with a non blocking socket would better
-     fit*/
+  OPENER_TRACE_INFO("Data received on TCP: %" PRIuSZT "\n", packet_length);
+  NetworkCountersRecordRx(packet_length, false);
 
-  /*Check how many data is here -- read the first four bytes from the connection */
-  CipOctet incoming_message[PC_OPENER_ETHERNET_BUFFER_SIZE] = { 0 };
+  g_current_active_tcp_socket = socket;
 
-  long number_of_read_bytes = recv(socket, NWBUF_CAST incoming_message, 4, 0); /*TODO we may have to set the socket to a non blocking socket */
+  ReuseENIPMessage(outgoing_message);
+  EipStatus need_to_send = HandleReceivedExplictTcpData(socket,
+                                                        packet,
+                                                        packet_length,
+                                                        &remaining_bytes,
+                                                        &session->peer_address,
+                                                        outgoing_message);
+  g_current_active_tcp_socket = kEipInvalidSocket;
 
-  SocketTimer *const socket_timer = SocketTimerArrayGetSocketTimer(g_timestamps,
-                                                                   OPENER_NUMBER_OF_SUPPORTED_SESSIONS,
-                                                                   socket);
-  if(number_of_read_bytes == 0) {
-    OPENER_TRACE_ERR(
-      "networkhandler: socket: %d - connection closed by client.\n",
-      socket);
-    RemoveSocketTimerFromList(socket);
-    RemoveSession(socket);
-    return kEipStatusError;
+  if( IsTcpConnectionClosed(session, socket) ) {
+    OPENER_TRACE_STATE("networkhandler: socket %d closed by its request\n",
+                       socket);
+    return false;
   }
-  if(number_of_read_bytes < 0) {
-    int error_code = GetSocketErrorNumber();
-    if(OPENER_SOCKET_WOULD_BLOCK == error_code) {
-      return kEipStatusOk;
-    }
-    char *error_message = GetErrorMessage(error_code);
-    OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n",
-                     error_code,
-                     error_message);
-    FreeErrorMessage(error_message);
-    return kEipStatusError;
+
+  /* a RegisterSession request has just set the socket timer */
+  SocketTimer *const socket_timer = session->socket_timer;
+  if(NULL != socket_timer) {
+    SocketTimerSetLastUpdate(socket_timer, g_actual_time);
   }
 
-  const EipUint8 *read_buffer = &incoming_message[2]; /* at this place EIP stores the data length */
-  EipUint16 reported_length = GetUintFromMessage(&read_buffer);
-  
-  // Prevent integer overflow: check if reported_length would cause overflow
-  if (reported_length > (PC_OPENER_ETHERNET_BUFFER_SIZE + 4)) {
-    OPENER_TRACE_ERR("Invalid packet length reported: %u (max: %u)\n",
-                     reported_length, PC_OPENER_ETHERNET_BUFFER_SIZE);
-    return kEipStatusError;
+  if(remaining_bytes != 0) {
+    OPENER_TRACE_WARN(
+      "Warning: received packet was to long: %d Bytes left!\n",
+      remaining_bytes);
   }
-  
-  size_t data_size = reported_length + ENCAPSULATION_HEADER_LENGTH - 4; /* -4 is for the 4 bytes we have already read*/
-  /* (NOTE this advances the buffer pointer) */
-  if( (PC_OPENER_ETHERNET_BUFFER_SIZE - 4) < data_size ) { /*TODO can this be handled in a better way?*/
-    OPENER_TRACE_ERR(
-      "too large packet received will be ignored, will drop the data\n");
-    /* Currently we will drop the whole packet */
 
-    do {
-      OPENER_TRACE_INFO(
-        "Entering consumption loop, remaining data to receive: %ld\n",
-        data_sent);
-      number_of_read_bytes = recv(socket,
-                                  NWBUF_CAST & incoming_message[0],
-                                  data_sent,
-                                  0);
-
-      if(number_of_read_bytes == 0) /* got error or connection closed by client */
-      {
-        int error_code = GetSocketErrorNumber();
-        char *error_message = GetErrorMessage(error_code);
-        OPENER_TRACE_ERR(
-          "networkhandler: socket: %d - connection closed by client: %d - %s\n",
-          socket,
-          error_code,
-          error_message);
-        FreeErrorMessage(error_message);
-        RemoveSocketTimerFromList(socket);
-        return kEipStatusError;
-      }
-      if(number_of_read_bytes < 0) {
-        int error_code = GetSocketErrorNumber();
-        char *error_message = GetErrorMessage(error_code);
-        if(OPENER_SOCKET_WOULD_BLOCK == error_code) {
-          return kEipStatusOk;
-        } OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n",
-                           error_code,
-                           error_message);
-        FreeErrorMessage(error_message);
-        return kEipStatusError;
-      }
-      data_size -= number_of_read_bytes;
-      if( (data_size < PC_OPENER_ETHERNET_BUFFER_SIZE) && (data_size != 0) ) {
-        data_sent = data_size;
-      }
-    } while(0 < data_size);
+  if(need_to_send > 0) {
+    OPENER_TRACE_INFO("TCP reply: send %" PRIuSZT " bytes on %d\n",
+                      outgoing_message->used_message_length,
+                      socket);
+
+    long data_sent = send(socket,
+                          (char *) outgoing_message->message_buffer,
+                          outgoing_message->used_message_length,
+                          MSG_NOSIGNAL);
     SocketTimerSetLastUpdate(socket_timer, g_actual_time);
-    return kEipStatusOk;
+    if(data_sent < 0 ||
+       (size_t)data_sent != outgoing_message->used_message_length) {
+      OPENER_TRACE_WARN(
+        "TCP response was not fully sent: exp %" PRIuSZT ", sent %ld\n",
+        outgoing_message->used_message_length,
+        data_sent);
+      NetworkCountersRecordTxDiscard();
+    }
+    if (data_sent > 0) {
+      NetworkCountersRecordTx((size_t)data_sent, false);
+    } else {
+      NetworkCountersRecordTxError();
+    }
   }
+  return true;
+}
 
-  number_of_read_bytes = recv(socket,
-                              NWBUF_CAST & incoming_message[4],
-                              data_size,
-                              0);
+/** @brief Handle all complete encapsulation packets in the receive buffer of a TCP connection
+ *
+ *  The packets are handled in the order they were received. An incomplete
+ *  packet at the end is moved to the start of the buffer and completed by the
+ *  next receive. Packets too large for the buffer are dropped. Handling stops
+ *  when a packet closes the connection, e.g. UnregisterSession; the released
+ *  record is not touched any more then, see IsTcpConnectionClosed().
+ *
+ *  @param session record of the TCP connection
+ *  @return kEipStatusError if the stream can not be parsed any more
+ */
+static EipStatus HandleTcpSessionBuffer(EncapsulationSession *const session) {
+  size_t position = 0;
+  EipStatus status = kEipStatusOk;
+
+  while(position < session->used_length) {
+    const size_t available = session->used_length - position;
+
+    if(0 != session->bytes_to_discard) {
+      const size_t discarded = available < session->bytes_to_discard ?
+                               available : session->bytes_to_discard;
+      session->bytes_to_discard -= discarded;
+      position += discarded;
+      SocketTimerSetLastUpdate(session->socket_timer, g_actual_time);
+      continue;
+    }
 
-  if(0 == number_of_read_bytes) /* got error or connection closed by client */
-  {
-    int error_code = GetSocketErrorNumber();
-    char *error_message = GetErrorMessage(error_code);
-    OPENER_TRACE_ERR(
-      "networkhandler: socket: %d - connection closed by client: %d - %s\n",
-      socket,
-      error_code,
-      error_message);
-    FreeErrorMessage(error_message);
-    RemoveSocketTimerFromList(socket);
-    RemoveSession(socket);
-    return kEipStatusError;
+    if(4 > available) { /* the data length is not complete yet */
+      break;
+    }
+    const EipUint8 *read_buffer = &session->receive_buffer[position + 2]; /* at this place EIP stores the data length */
+    const EipUint16 reported_length = GetUintFromMessage(&read_buffer);
+
+    // Prevent integer overflow: check if reported_length would cause overflow
+    if (reported_length > (PC_OPENER_ETHERNET_BUFFER_SIZE + 4)) {
+      OPENER_TRACE_ERR("Invalid packet length reported: %u (max: %u)\n",
+                       reported_length, PC_OPENER_ETHERNET_BUFFER_SIZE);
+      status = kEipStatusError;
+      break;
+    }
+
+    const size_t packet_length = reported_length + ENCAPSULATION_HEADER_LENGTH;
+    if(ENCAPSULATION_TCP_RECEIVE_BUFFER_SIZE < packet_length) {
+      OPENER_TRACE_ERR(
+        "too large packet received will be ignored, will drop the data\n");
+      session->bytes_to_discard = packet_length;
+      continue;
+    }
+    if(packet_length > available) { /* wait for the rest of the packet */
+      break;
+    }
+
+    if( !HandleTcpEncapsulationPacket(session,
+                                      &session->receive_buffer[position],
+                                      packet_length) ) {
+      return kEipStatusOk; /* no memmove, the record has been released */
+    }
+    position += packet_length;
   }
-  if(number_of_read_bytes < 0) {
-    int error_code = GetSocketErrorNumber();
-    char *error_message = GetErrorMessage(error_code);
-    if(OPENER_SOCKET_WOULD_BLOCK == error_code) {
-      return kEipStatusOk;
-    } OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n",
-                       error_code,
-                       error_message);
-    FreeErrorMessage(error_message);
-    return kEipStatusError;
+
+  session->used_length -= position;
+  if(0 != session->used_length && 0 != position) {
+    memmove(session->receive_buffer,
+            &session->receive_buffer[position],
+            session->used_length);
   }
+  return status;
+}
 
-  if( (unsigned) number_of_read_bytes == data_size ) {
-    /*we got the right amount of data */
-    data_size += 4;
-    /*TODO handle partial packets*/
-    OPENER_TRACE_INFO("Data received on TCP: %" PRIuSZT "\n", data_size);
-    NetworkCountersRecordRx(data_size, false);
+EipStatus HandleDataOnTcpSocket(int socket) {
+  OPENER_TRACE_INFO("Entering HandleDataOnTcpSocket for socket: %d\n", socket);
 
-    g_current_active_tcp_socket = socket;
+  /* Read everything the socket holds and handle every complete encapsulation
+   * packet in order, so pipelined requests do not wait for the next select
+   * cycle. The first receive can not block as select reported data, the
+   * following ones must not. */
+  EncapsulationSession *session = GetEncapsulationSession(socket);
+  if(NULL == session) {
+    session = CreateEncapsulationSession(socket, NULL);
+  }
+  if(NULL == session) {
+    OPENER_TRACE_ERR("networkhandler: no session record for socket: %d\n",
+                     socket);
+    return kEipStatusError;
+  }
 
-    struct sockaddr sender_address;
-    memset( &sender_address, 0, sizeof(sender_address) );
-    socklen_t fromlen = sizeof(sender_address);
-    if(getpeername(socket, (struct sockaddr *) &sender_address, &fromlen) < 0) {
+  int receive_flags = 0;
+  while(true) {
+    const size_t free_space = ENCAPSULATION_TCP_RECEIVE_BUFFER_SIZE -
+                              session->used_length;
+    long number_of_read_bytes = recv(socket,
+                                     NWBUF_CAST & session->receive_buffer[
+                                       session->used_length],
+                                     free_space,
+                                     receive_flags);
+
+    if(number_of_read_bytes == 0) {
+      OPENER_TRACE_ERR(
+        "networkhandler: socket: %d - connection closed by client.\n",
+        socket);
+      RemoveSocketTimerFromList(socket);
+      RemoveSession(socket);
+      return kEipStatusError;
+    }
+    if(number_of_read_bytes < 0) {
       int error_code = GetSocketErrorNumber();
+      if(OPENER_SOCKET_WOULD_BLOCK == error_code) {
+        return kEipStatusOk;
+      }
       char *error_message = GetErrorMessage(error_code);
-      OPENER_TRACE_ERR("networkhandler: could not get peername: %d - %s\n",
+      OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n",
                        error_code,
                        error_message);
       FreeErrorMessage(error_message);
+      return kEipStatusError;
     }
 
-    ENIPMessage outgoing_message;
-    InitializeENIPMessage(&outgoing_message);
-    EipStatus need_to_send = HandleReceivedExplictTcpData(socket,
-                                                          incoming_message,
-                                                          data_size,
-                                                          &remaining_bytes,
-                                                          &sender_address,
-                                                          &outgoing_message);
-    if(NULL != socket_timer) {
-      SocketTimerSetLastUpdate(socket_timer, g_actual_time);
+    session->used_length += number_of_read_bytes;
+    if( kEipStatusError == HandleTcpSessionBuffer(session) ) {
+      return kEipStatusError;
     }
-
-    g_current_active_tcp_socket = kEipInvalidSocket;
-
-    if(remaining_bytes != 0) {
-      OPENER_TRACE_WARN(
-        "Warning: received packet was to long: %d Bytes left!\n",
-        remaining_bytes);
+    if( IsTcpConnectionClosed(session, socket) ) {
+      return kEipStatusOk; /* no further recv on the closed socket */
     }
-
-    if(need_to_send > 0) {
-      OPENER_TRACE_INFO("TCP reply: send %" PRIuSZT " bytes on %d\n",
-                        outgoing_message.used_message_length,
-                        socket);
-
-      data_sent = send(socket,
-                       (char *) outgoing_message.message_buffer,
-                       outgoing_message.used_message_length,
-                       MSG_NOSIGNAL);
-      SocketTimerSetLastUpdate(socket_timer, g_actual_time);
-      if(data_sent != outgoing_message.used_message_length) {
-        OPENER_TRACE_WARN(
-          "TCP response was not fully sent: exp %" PRIuSZT ", sent %ld\n",
-          outgoing_message.used_message_length,
-          data_sent);
-        NetworkCountersRecordTxDiscard();
-      }
-      if (data_sent > 0) {
-        NetworkCountersRecordTx((size_t)data_sent, false);
-      } else {
-        NetworkCountersRecordTxError();
-      }
+    if( (size_t) number_of_read_bytes < free_space ) {
+      return kEipStatusOk; /* the socket has been drained */
     }
-
-    return kEipStatusOk;
-  } else {
-    /* we got a fragmented packet currently we cannot handle this will
-     * for this we would need a network buffer per TCP socket
-     *
-     * However with typical packet sizes of EIP this shouldn't be a big issue.
-     */
-    /*TODO handle fragmented packets */
+#if defined(MSG_DONTWAIT)
+    receive_flags = MSG_DONTWAIT;
+#else
+    return kEipStatusOk; /* select will report the rest */
+#endif
   }
-  return kEipStatusError;
 }
 
 /** @brief Create the UDP socket for the implicit IO messaging, one socket handles all connections
@@ -1016,6 +1211,11 @@ EipStatus HandleDataOnTcpSocket(int socket) {
  * @return the socket handle if successful, else kEipInvalidSocket */
 int CreateUdpSocket(void) {
 
+  /* all connections share the socket bound to the I/O port */
+  if(g_udp_io_socket_is_shared) {
+    return g_network_status.udp_io_messaging;
+  }
+
   /* create a new UDP socket */
   g_network_status.udp_io_messaging = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
 
@@ -1068,6 +1268,7 @@ int CreateUdpSocket(void) {
     return kEipInvalidSocket;
   }
 
+#if !defined(OPENER_IO_TASK) || 0 == OPENER_IO_TASK
   /* add new socket to the master list */
   FD_SET(g_network_status.udp_io_messaging, &master_socket);
 
@@ -1076,6 +1277,8 @@ int CreateUdpSocket(void) {
                       g_network_status.udp_io_messaging);
     highest_socket_handle = g_network_status.udp_io_messaging;
   }
+#endif /* the I/O task waits on the socket instead */
+  g_udp_io_socket_is_shared = true;
   return g_network_status.udp_io_messaging;
 }
 
@@ -1135,88 +1338,98 @@ int SetSocketOptionsMulticastProduce(void) {
  *
  * @return peer address if successful, else any address (0) */
 EipUint32 GetPeerAddress(void) {
-  struct sockaddr_in peer_address;
-  socklen_t peer_address_length = sizeof(peer_address);
+  const EncapsulationSession *const session = GetEncapsulationSession(
+    g_current_active_tcp_socket);
 
-  if (getpeername(g_current_active_tcp_socket, (struct sockaddr *)&peer_address,
-                  &peer_address_length) < 0) {
-    int error_code = GetSocketErrorNumber();
-    char *error_message = GetErrorMessage(error_code);
-    OPENER_TRACE_ERR("networkhandler: could not get peername: %d - %s\n",
-                     error_code, error_message);
-    FreeErrorMessage(error_message);
+  if (NULL == session) {
+    OPENER_TRACE_ERR("networkhandler: no peer address of socket %d\n",
+                     g_current_active_tcp_socket);
     return htonl(INADDR_ANY);
   }
-  return peer_address.sin_addr.s_addr;
+  return ( (const struct sockaddr_in *) &session->peer_address )->sin_addr.s_addr;
 }
 
-void CheckAndHandleConsumingUdpSocket(void) {
-  DoublyLinkedListNode *iterator = connection_list.first;
-
-  CipConnectionObject *current_connection_object = NULL;
-
-  /* see a message of the registered UDP socket has been received     */
-  while(NULL != iterator) {
-    current_connection_object = (CipConnectionObject *) iterator->data;
-    iterator = iterator->next; /* do this at the beginning as the close function may can make the entry invalid */
-
-    if( (kEipInvalidSocket !=
-         current_connection_object->socket[kUdpCommuncationDirectionConsuming])
-        && ( true ==
-             CheckSocketSet(current_connection_object->socket[
-                              kUdpCommuncationDirectionConsuming
-                            ]) ) ) {
-      #if NETWORK_VERBOSE_LOGGING
-      OPENER_TRACE_INFO("Processing UDP consuming message\n");
-      #endif
-      struct sockaddr_in from_address = { 0 };
-      socklen_t from_address_length = sizeof(from_address);
-      CipOctet incoming_message[PC_OPENER_ETHERNET_BUFFER_SIZE] = { 0 };
-
-      int received_size = recvfrom(g_network_status.udp_io_messaging,
-                                   NWBUF_CAST incoming_message,
-                                   sizeof(incoming_message),
-                                   0,
-                                   (struct sockaddr *) &from_address,
-                                   &from_address_length);
-      if(0 == received_size) {
-        NetworkCountersRecordRxDiscard();
-        NetworkCountersRecordRxError();
-        int error_code = GetSocketErrorNumber();
-        char *error_message = GetErrorMessage(error_code);
-        OPENER_TRACE_ERR(
-          "networkhandler: socket: %d - connection closed by client: %d - %s\n",
-          current_connection_object->socket[
-            kUdpCommuncationDirectionConsuming],
-          error_code,
-          error_message);
-        FreeErrorMessage(error_message);
-        current_connection_object->connection_close_function(
-          current_connection_object);
-        continue;
-      }
+#if defined(OPENER_IO_TASK) && 0 != OPENER_IO_TASK
+/** @brief Hand the datagrams received by the I/O task over and bring the
+ *  connection timers up to date
+ *
+ *  Each datagram is handled at the time of its reception, so the connection
+ *  timers expire as if it had been handled right away, no matter how long the
+ *  explicit messages have held this task up.
+ *
+ *  @param current_time time the connection timers are advanced to
+ */
+static void HandleIoTaskConsumedData(const MicroSeconds current_time) {
+  const IoConsumedDatagram *datagram = NULL;
+  while( NULL != ( datagram = IoHandlerGetConsumedDatagram() ) &&
+         datagram->reception_time <= current_time ) {
+    ManageConnectionTimers(datagram->reception_time);
+    struct sockaddr_in from_address = datagram->from_address;
+    HandleConsumedUdpDatagram(datagram->data, datagram->length,
+                              &from_address);
+    IoHandlerReleaseConsumedDatagram();
+  }
+  ManageConnectionTimers(current_time);
+  NetworkCountersCollectIoTask();
+}
+#endif
 
-      if(0 > received_size) {
-        int error_code = GetSocketErrorNumber();
-        if(OPENER_SOCKET_WOULD_BLOCK == error_code) {
-          return; // No fatal error, resume execution
-        } 
-        NetworkCountersRecordRxError();
-        char *error_message = GetErrorMessage(error_code);
-        OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n",
-                           error_code,
-                           error_message);
-        FreeErrorMessage(error_message);
-        current_connection_object->connection_close_function(
-          current_connection_object);
-        continue;
-      }
+/** @brief Hand a datagram of the implicit messaging socket to the connection
+ *  its connection ID belongs to */
+static void HandleConsumedUdpDatagram(const CipOctet *const data,
+                                      const size_t length,
+                                      struct sockaddr_in *const from_address) {
+  NetworkCountersRecordRx(length, false);
+  if( kEipStatusError ==
+      HandleReceivedConnectedData(data, (int) length, from_address) ) {
+    NetworkCountersRecordRxDiscard();
+  }
+}
 
-      NetworkCountersRecordRx((size_t)received_size, false);
-      HandleReceivedConnectedData(incoming_message, received_size,
-                                  &from_address);
+/** @brief Count and trace a failed receive on the implicit messaging socket,
+ *  unless the socket has just run empty */
+static void HandleConsumingUdpReceiveError(void) {
+  int error_code = GetSocketErrorNumber();
+  if(OPENER_SOCKET_WOULD_BLOCK == error_code) {
+    return; // No fatal error, resume execution
+  }
+  NetworkCountersRecordRxError();
+  char *error_message = GetErrorMessage(error_code);
+  OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n",
+                   error_code,
+                   error_message);
+  FreeErrorMessage(error_message);
+}
+
+void CheckAndHandleConsumingUdpSocket(void) {
+  /* all consuming connections share the implicit messaging socket, the
+   * received data is handed to its connection by the connection ID */
+  if( !g_udp_io_socket_is_shared ||
+      true != CheckSocketSet(g_network_status.udp_io_messaging) ) {
+    return;
+  }
+
+  #if NETWORK_VERBOSE_LOGGING
+  OPENER_TRACE_INFO("Processing UDP consuming message\n");
+  #endif
+  /* take everything that has piled up while the other sockets were handled,
+   * the budget bounds how long they wait in turn */
+  for(size_t i = 0; i < OPENER_CONSUMING_UDP_RECEIVE_BUDGET; i++) {
+    struct sockaddr_in from_address = { 0 };
+    socklen_t from_address_length = sizeof(from_address);
 
+    int received_size = recvfrom(g_network_status.udp_io_messaging,
+                                 NWBUF_CAST g_udp_receive_buffer,
+                                 sizeof(g_udp_receive_buffer),
+                                 0,
+                                 (struct sockaddr *) &from_address,
+                                 &from_address_length);
+    if(0 > received_size) {
+      HandleConsumingUdpReceiveError();
+      return;
     }
+    HandleConsumedUdpDatagram(g_udp_receive_buffer, (size_t) received_size,
+                              &from_address);
   }
 }
 
@@ -1249,34 +1462,6 @@ int GetMaxSocket(int socket1,
   return socket4;
 }
 
-void CheckEncapsulationInactivity(int socket_handle) {
-  if(0 < g_tcpip.encapsulation_inactivity_timeout) { //*< Encapsulation inactivity timeout is enabled
-    SocketTimer *socket_timer = SocketTimerArrayGetSocketTimer(g_timestamps,
-                                                               OPENER_NUMBER_OF_SUPPORTED_SESSIONS,
-                                                               socket_handle);
-
-//    OPENER_TRACE_INFO("Check socket %d - socket timer: %p\n",
-//                      socket_handle,
-//                      socket_timer);
-    if(NULL != socket_timer) {
-      MilliSeconds diff_milliseconds = g_actual_time - SocketTimerGetLastUpdate(
-        socket_timer);
-
-      if( diff_milliseconds >=
-          (MilliSeconds) (1000UL * g_tcpip.encapsulation_inactivity_timeout) ) {
-
-        CipSessionHandle encapsulation_session_handle =
-          GetSessionFromSocket(socket_handle);
-
-        CloseClass3ConnectionBasedOnSession(encapsulation_session_handle);
-
-        CloseTcpSocket(socket_handle);
-        RemoveSession(socket_handle);
-      }
-    }
-  }
-}
-
 void RegisterTimeoutChecker(TimeoutCheckerFunction timeout_checker_function) {
   for (size_t i = 0; i < OPENER_TIMEOUT_CHECKER_ARRAY_SIZE; i++) {
     if (NULL == timeout_checker_array[i]) { // find empty array element
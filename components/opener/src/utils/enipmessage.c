@@ -11,3 +11,19 @@ void InitializeENIPMessage(ENIPMessage *const message) {
   memset(message, 0, sizeof(ENIPMessage) );
   message->current_message_position = message->message_buffer;
 }
+
+void ReuseENIPMessage(ENIPMessage *const message) {
+  size_t written_length = message->used_message_length;
+  if(NULL != message->current_message_position &&
+     (size_t) (message->current_message_position - message->message_buffer) >
+     written_length) {
+    written_length = message->current_message_position -
+                     message->message_buffer;
+  }
+  if(written_length > sizeof(message->message_buffer) ) {
+    written_length = sizeof(message->message_buffer);
+  }
+  memset(message->message_buffer, 0, written_length);
+  message->current_message_position = message->message_buffer;
+  message->used_message_length = 0;
+}
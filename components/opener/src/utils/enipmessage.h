@@ -16,4 +16,13 @@ typedef struct enip_message {
 
 void InitializeENIPMessage(ENIPMessage *const message);
 
+/** @brief Prepare an already initialized message buffer for the next message
+ *
+ * Only the part written by the previous message is cleared, afterwards the
+ * message is in the same state as after InitializeENIPMessage().
+ *
+ * @param message message that has been initialized before
+ */
+void ReuseENIPMessage(ENIPMessage *const message);
+
 #endif /* SRC_CIP_ENIPMESSAGE_H_ */
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "spscqueue.h"
+
+#include <stdio.h>  // Needed to define NULL
+
+#include "opener_user_conf.h"
+
+void SpscQueueInitialize(SpscQueue *const queue,
+                         void *const storage,
+                         const size_t element_size,
+                         const size_t number_of_elements) {
+  OPENER_ASSERT(0 != number_of_elements &&
+                0 == (number_of_elements & (number_of_elements - 1) ) );
+  atomic_init(&queue->head, 0);
+  atomic_init(&queue->tail, 0);
+  queue->storage = storage;
+  queue->element_size = element_size;
+  queue->mask = number_of_elements - 1;
+}
+
+void *SpscQueueGetWriteSlot(SpscQueue *const queue) {
+  const size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  /* acquire: the consumer is done with the slot before it is written again */
+  const size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+  if(head - tail > queue->mask) {
+    return NULL;
+  }
+  return queue->storage + (head & queue->mask) * queue->element_size;
+}
+
+void SpscQueueCommitWrite(SpscQueue *const queue) {
+  const size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  /* release: the element content is visible before the new head */
+  atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+}
+
+void *SpscQueueGetReadSlot(SpscQueue *const queue) {
+  const size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  const size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+  if(head == tail) {
+    return NULL;
+  }
+  return queue->storage + (tail & queue->mask) * queue->element_size;
+}
+
+void SpscQueueReleaseRead(SpscQueue *const queue) {
+  const size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+}
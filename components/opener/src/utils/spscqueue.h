@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SRC_UTILS_SPSCQUEUE_H_
+#define SRC_UTILS_SPSCQUEUE_H_
+
+/**
+ * @file spscqueue.h
+ *
+ * Lock-free queue for exactly one producing and one consuming task
+ *
+ * The queue holds a fixed number of equally sized elements in storage
+ * provided by the user. Elements are written and read in place: the producer
+ * fills the slot returned by SpscQueueGetWriteSlot() and publishes it with
+ * SpscQueueCommitWrite(), the consumer works on the slot returned by
+ * SpscQueueGetReadSlot() and hands it back with SpscQueueReleaseRead().
+ * Neither side ever blocks or takes a lock, so a high priority task is not
+ * held up by a lower priority one it exchanges data with.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "typedefs.h"
+
+typedef struct {
+  atomic_size_t head; /**< number of elements written, only changed by the producer */
+  atomic_size_t tail; /**< number of elements read, only changed by the consumer */
+  CipOctet *storage;
+  size_t element_size;
+  size_t mask; /**< number of elements minus one */
+} SpscQueue;
+
+/** @brief Set up an empty queue
+ *
+ *  @param queue queue to set up
+ *  @param storage memory for number_of_elements * element_size bytes
+ *  @param element_size size of one element in bytes
+ *  @param number_of_elements capacity of the queue, has to be a power of two
+ */
+void SpscQueueInitialize(SpscQueue *const queue,
+                         void *const storage,
+                         const size_t element_size,
+                         const size_t number_of_elements);
+
+/** @brief Get the next free element, producer side
+ *
+ *  @return element to be filled, NULL if the queue is full
+ */
+void *SpscQueueGetWriteSlot(SpscQueue *const queue);
+
+/** @brief Make the element from SpscQueueGetWriteSlot() visible to the
+ *  consumer */
+void SpscQueueCommitWrite(SpscQueue *const queue);
+
+/** @brief Get the oldest element, consumer side
+ *
+ *  @return oldest element, NULL if the queue is empty
+ */
+void *SpscQueueGetReadSlot(SpscQueue *const queue);
+
+/** @brief Return the element from SpscQueueGetReadSlot() to the producer */
+void SpscQueueReleaseRead(SpscQueue *const queue);
+
+#endif /* SRC_UTILS_SPSCQUEUE_H_ */
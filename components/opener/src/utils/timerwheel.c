@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "timerwheel.h"
+
+#include <stdio.h>  // Needed to define NULL
+#include <string.h>
+
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_NUMBER_OF_SLOTS - 1)
+
+static void LinkTimerWheelEntry(TimerWheelEntry **const link,
+                                TimerWheelEntry *const entry) {
+  entry->next = *link;
+  if(NULL != entry->next) {
+    entry->next->previous_next = &entry->next;
+  }
+  entry->previous_next = link;
+  *link = entry;
+}
+
+void TimerWheelInitialize(TimerWheel *const wheel) {
+  memset(wheel, 0, sizeof(*wheel) );
+}
+
+MicroSeconds TimerWheelGetTime(const TimerWheel *const wheel) {
+  return wheel->current_time;
+}
+
+void TimerWheelSchedule(TimerWheel *const wheel,
+                        TimerWheelEntry *const entry,
+                        const MicroSeconds deadline) {
+  TimerWheelCancel(entry);
+  entry->deadline = deadline;
+  /* the current time has already been handled */
+  const MicroSeconds slot_time =
+    (deadline > wheel->current_time) ? deadline : wheel->current_time + 1;
+  LinkTimerWheelEntry(&wheel->slots[(slot_time >> TIMER_WHEEL_SLOT_WIDTH_SHIFT)
+                                    & TIMER_WHEEL_SLOT_MASK], entry);
+}
+
+void TimerWheelCancel(TimerWheelEntry *const entry) {
+  if(NULL == entry->previous_next) {
+    return;
+  }
+  *entry->previous_next = entry->next;
+  if(NULL != entry->next) {
+    entry->next->previous_next = entry->previous_next;
+  }
+  entry->next = NULL;
+  entry->previous_next = NULL;
+}
+
+bool TimerWheelIsScheduled(const TimerWheelEntry *const entry) {
+  return NULL != entry->previous_next;
+}
+
+void TimerWheelAdvance(TimerWheel *const wheel,
+                       const MicroSeconds current_time) {
+  if(current_time < wheel->current_time) {
+    return;
+  }
+  /* the slot of the previous time may still hold entries due later in it */
+  MicroSeconds slot_number = wheel->current_time >> TIMER_WHEEL_SLOT_WIDTH_SHIFT;
+  const MicroSeconds last_slot_number =
+    current_time >> TIMER_WHEEL_SLOT_WIDTH_SHIFT;
+  if(last_slot_number - slot_number >= TIMER_WHEEL_NUMBER_OF_SLOTS) {
+    /* one revolution visits every slot */
+    slot_number = last_slot_number - TIMER_WHEEL_NUMBER_OF_SLOTS + 1;
+  }
+  wheel->current_time = current_time;
+
+  for(; slot_number <= last_slot_number; ++slot_number) {
+    TimerWheelEntry **const slot =
+      &wheel->slots[slot_number & TIMER_WHEEL_SLOT_MASK];
+
+    /* detach the slot, so expiry functions may schedule into it again */
+    TimerWheelEntry *pending = NULL;
+    if(NULL != *slot) {
+      pending = *slot;
+      pending->previous_next = &pending;
+      *slot = NULL;
+    }
+
+    while(NULL != pending) {
+      TimerWheelEntry *const entry = pending;
+      TimerWheelCancel(entry);
+      if(entry->deadline <= current_time) {
+        entry->expiry_function(entry);
+      } else {
+        /* due later in this slot or in a later revolution */
+        LinkTimerWheelEntry(slot, entry);
+      }
+    }
+  }
+}
+
+MicroSeconds TimerWheelGetNextDeadline(const TimerWheel *const wheel,
+                                       const MicroSeconds latest_time) {
+  if(latest_time < wheel->current_time) {
+    return latest_time;
+  }
+  MicroSeconds next_deadline = latest_time;
+  MicroSeconds slot_number = wheel->current_time >> TIMER_WHEEL_SLOT_WIDTH_SHIFT;
+  MicroSeconds last_slot_number = latest_time >> TIMER_WHEEL_SLOT_WIDTH_SHIFT;
+  if(last_slot_number - slot_number >= TIMER_WHEEL_NUMBER_OF_SLOTS) {
+    last_slot_number = slot_number + TIMER_WHEEL_NUMBER_OF_SLOTS - 1;
+  }
+
+  for(; slot_number <= last_slot_number; ++slot_number) {
+    for(const TimerWheelEntry *entry =
+          wheel->slots[slot_number & TIMER_WHEEL_SLOT_MASK];
+        NULL != entry; entry = entry->next) {
+      if(entry->deadline < next_deadline) {
+        next_deadline = entry->deadline;
+      }
+    }
+  }
+  return next_deadline;
+}
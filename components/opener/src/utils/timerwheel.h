@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2025, Adam G. Sweeney <agsweeney@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SRC_UTILS_TIMERWHEEL_H_
+#define SRC_UTILS_TIMERWHEEL_H_
+
+/**
+ * @file timerwheel.h
+ *
+ * Hashed timer wheel on a microsecond time base
+ *
+ * Deadlines are absolute times in microseconds, the wheel is moved forward to
+ * the current time with TimerWheelAdvance(). Each slot covers
+ * 2^TIMER_WHEEL_SLOT_WIDTH_SHIFT microseconds, a deadline further away than
+ * one revolution is kept in its slot and skipped until its revolution has
+ * come. The slot width only bounds the work per advance, entries expire at
+ * the first advance reaching their exact deadline. Advancing the wheel
+ * therefore only touches the entries which are due or share a slot with a
+ * due one, instead of all timers of the system.
+ *
+ * Entries are embedded into the objects owning them. A zero initialized
+ * entry is not scheduled.
+ */
+
+#include "typedefs.h"
+
+/** @brief Number of slots of the wheel, has to be a power of two */
+#define TIMER_WHEEL_NUMBER_OF_SLOTS 256
+
+/** @brief Each slot covers 2^TIMER_WHEEL_SLOT_WIDTH_SHIFT microseconds */
+#define TIMER_WHEEL_SLOT_WIDTH_SHIFT 10
+
+typedef struct timer_wheel_entry TimerWheelEntry;
+
+/** @brief Function called when the deadline of an entry has been reached
+ *
+ *  The entry is no longer scheduled when the function is called, so it may
+ *  schedule the entry again or release the object owning it.
+ */
+typedef void (*TimerWheelExpiryFunction)(TimerWheelEntry *const entry);
+
+typedef struct timer_wheel_entry {
+  TimerWheelEntry *next;
+  TimerWheelEntry **previous_next; /**< link pointing to this entry, NULL if not scheduled */
+  MicroSeconds deadline; /**< absolute deadline in the time base of the wheel */
+  TimerWheelExpiryFunction expiry_function;
+  void *data; /**< object owning the entry */
+} TimerWheelEntry;
+
+typedef struct {
+  TimerWheelEntry *slots[TIMER_WHEEL_NUMBER_OF_SLOTS];
+  MicroSeconds current_time; /**< time the wheel has been advanced to */
+} TimerWheel;
+
+/** @brief Reset the wheel to time zero without any scheduled entries
+ *
+ *  Entries still linked into the wheel are dropped without being touched.
+ */
+void TimerWheelInitialize(TimerWheel *const wheel);
+
+/** @brief Get the time the wheel has been advanced to */
+MicroSeconds TimerWheelGetTime(const TimerWheel *const wheel);
+
+/** @brief Schedule an entry, or move it if it is already scheduled
+ *
+ *  Deadlines which are not in the future expire with the next advance.
+ *
+ *  @param wheel wheel to schedule the entry in
+ *  @param entry entry to be scheduled, expiry_function has to be set
+ *  @param deadline absolute deadline in the time base of the wheel
+ */
+void TimerWheelSchedule(TimerWheel *const wheel,
+                        TimerWheelEntry *const entry,
+                        const MicroSeconds deadline);
+
+/** @brief Remove an entry from its wheel, does nothing if not scheduled */
+void TimerWheelCancel(TimerWheelEntry *const entry);
+
+/** @brief Check if an entry is currently scheduled */
+bool TimerWheelIsScheduled(const TimerWheelEntry *const entry);
+
+/** @brief Advance the wheel to the given time and call the expiry functions
+ *  of all entries whose deadline has been reached
+ *
+ *  The expiry functions see the new time as the current time of the wheel.
+ *
+ *  @param wheel wheel to advance
+ *  @param current_time new time of the wheel, earlier times are ignored
+ */
+void TimerWheelAdvance(TimerWheel *const wheel,
+                       const MicroSeconds current_time);
+
+/** @brief Get the earliest deadline of the scheduled entries, looking no
+ *  further than the given time
+ *
+ *  @param wheel wheel to look at
+ *  @param latest_time time returned if no entry expires before
+ *  @return earliest deadline, at most @p latest_time
+ */
+MicroSeconds TimerWheelGetNextDeadline(const TimerWheel *const wheel,
+                                       const MicroSeconds latest_time);
+
+#endif /* SRC_UTILS_TIMERWHEEL_H_ */
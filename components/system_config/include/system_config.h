@@ -76,6 +76,62 @@ bool system_motoman_rs022_load(bool *instance_direct);
  */
 bool system_motoman_rs022_save(bool instance_direct);
 
+#define SYSTEM_MOTOMAN_IO_MAP_MAX_ENTRIES 16
+
+/**
+ * @brief Robot data a Motoman I/O assembly entry is mapped to
+ */
+typedef enum {
+    SYSTEM_MOTOMAN_IO_SOURCE_STATUS = 0,    // Status data 1 and 2 (UDINT)
+    SYSTEM_MOTOMAN_IO_SOURCE_POSITION,      // Current position per axis (DINT)
+    SYSTEM_MOTOMAN_IO_SOURCE_TORQUE,        // Torque per axis (DINT)
+    SYSTEM_MOTOMAN_IO_SOURCE_IO,            // I/O signals (USINT)
+    SYSTEM_MOTOMAN_IO_SOURCE_REGISTER,      // Registers (UINT)
+    SYSTEM_MOTOMAN_IO_SOURCE_COUNT
+} system_motoman_io_source_t;
+
+/**
+ * @brief count consecutive elements of a source, starting at element first
+ */
+typedef struct {
+    uint8_t source;             // system_motoman_io_source_t
+    uint8_t reserved;
+    uint16_t first;
+    uint16_t count;
+} system_motoman_io_map_entry_t;
+
+/**
+ * @brief Layout of the Motoman I/O assemblies
+ *
+ * The input assembly (T->O) packs the input entries in order, the output
+ * assembly (O->T) is unpacked into the output entries in order.
+ */
+typedef struct {
+    uint8_t input_entry_count;
+    uint8_t output_entry_count;
+    system_motoman_io_map_entry_t input[SYSTEM_MOTOMAN_IO_MAP_MAX_ENTRIES];
+    system_motoman_io_map_entry_t output[SYSTEM_MOTOMAN_IO_MAP_MAX_ENTRIES];
+} system_motoman_io_map_t;
+
+/**
+ * @brief Get default Motoman I/O assembly layout
+ */
+void system_motoman_io_map_get_defaults(system_motoman_io_map_t *map);
+
+/**
+ * @brief Load Motoman I/O assembly layout from NVS
+ * @param map Pointer to map structure to fill
+ * @return true if loaded successfully, false if using defaults
+ */
+bool system_motoman_io_map_load(system_motoman_io_map_t *map);
+
+/**
+ * @brief Save Motoman I/O assembly layout to NVS
+ * @param map Pointer to map structure to save
+ * @return true on success, false on error
+ */
+bool system_motoman_io_map_save(const system_motoman_io_map_t *map);
+
 #ifdef __cplusplus
 }
 #endif
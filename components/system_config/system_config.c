@@ -31,6 +31,7 @@ static const char *TAG = "system_config";
 static const char *NVS_NAMESPACE = "system";
 static const char *NVS_KEY_IPCONFIG = "ipconfig";
 static const char *NVS_KEY_RS022 = "rs022";
+static const char *NVS_KEY_IO_MAP = "io_map";
 
 void system_ip_config_get_defaults(system_ip_config_t *config)
 {
@@ -186,3 +187,109 @@ bool system_motoman_rs022_save(bool instance_direct)
     return true;
 }
 
+
+void system_motoman_io_map_get_defaults(system_motoman_io_map_t *map)
+{
+    if (map == NULL) {
+        return;
+    }
+    
+    static const system_motoman_io_map_entry_t default_input[] = {
+        {SYSTEM_MOTOMAN_IO_SOURCE_STATUS, 0, 0, 2},     // Status data 1 and 2
+        {SYSTEM_MOTOMAN_IO_SOURCE_POSITION, 0, 0, 8},   // Axes 1-8
+        {SYSTEM_MOTOMAN_IO_SOURCE_TORQUE, 0, 0, 8},     // Axes 1-8
+        {SYSTEM_MOTOMAN_IO_SOURCE_IO, 0, 0, 16},        // General inputs
+        {SYSTEM_MOTOMAN_IO_SOURCE_IO, 0, 100, 16},      // General outputs
+        {SYSTEM_MOTOMAN_IO_SOURCE_REGISTER, 0, 0, 8},   // M000-M007
+    };
+    static const system_motoman_io_map_entry_t default_output[] = {
+        {SYSTEM_MOTOMAN_IO_SOURCE_IO, 0, 200, 16},      // External inputs
+        {SYSTEM_MOTOMAN_IO_SOURCE_REGISTER, 0, 8, 8},   // M008-M015
+    };
+    
+    memset(map, 0, sizeof(system_motoman_io_map_t));
+    map->input_entry_count = sizeof(default_input) / sizeof(default_input[0]);
+    memcpy(map->input, default_input, sizeof(default_input));
+    map->output_entry_count = sizeof(default_output) / sizeof(default_output[0]);
+    memcpy(map->output, default_output, sizeof(default_output));
+}
+
+bool system_motoman_io_map_load(system_motoman_io_map_t *map)
+{
+    if (map == NULL) {
+        return false;
+    }
+    
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        system_motoman_io_map_get_defaults(map);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            return false;
+        }
+        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
+        return false;
+    }
+    
+    size_t required_size = sizeof(system_motoman_io_map_t);
+    err = nvs_get_blob(handle, NVS_KEY_IO_MAP, map, &required_size);
+    nvs_close(handle);
+    
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        system_motoman_io_map_get_defaults(map);
+        return false;
+    }
+    
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to load I/O assembly map: %s", esp_err_to_name(err));
+        system_motoman_io_map_get_defaults(map);
+        return false;
+    }
+    
+    if (required_size != sizeof(system_motoman_io_map_t) ||
+        map->input_entry_count > SYSTEM_MOTOMAN_IO_MAP_MAX_ENTRIES ||
+        map->output_entry_count > SYSTEM_MOTOMAN_IO_MAP_MAX_ENTRIES) {
+        ESP_LOGW(TAG, "Invalid I/O assembly map in NVS, using defaults");
+        system_motoman_io_map_get_defaults(map);
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "I/O assembly map loaded (%u input, %u output entries)",
+             map->input_entry_count, map->output_entry_count);
+    return true;
+}
+
+bool system_motoman_io_map_save(const system_motoman_io_map_t *map)
+{
+    if (map == NULL ||
+        map->input_entry_count > SYSTEM_MOTOMAN_IO_MAP_MAX_ENTRIES ||
+        map->output_entry_count > SYSTEM_MOTOMAN_IO_MAP_MAX_ENTRIES) {
+        return false;
+    }
+    
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
+        return false;
+    }
+    
+    err = nvs_set_blob(handle, NVS_KEY_IO_MAP, map, sizeof(system_motoman_io_map_t));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save I/O assembly map: %s", esp_err_to_name(err));
+        nvs_close(handle);
+        return false;
+    }
+    
+    err = nvs_commit(handle);
+    nvs_close(handle);
+    
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to commit I/O assembly map: %s", esp_err_to_name(err));
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "I/O assembly map saved (%u input, %u output entries)",
+             map->input_entry_count, map->output_entry_count);
+    return true;
+}
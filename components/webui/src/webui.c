@@ -135,7 +135,7 @@ bool webui_init(void)
 
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 80;
-    config.max_uri_handlers = 8; // Root, favicon, GET/POST /api/ipconfig, GET/POST /api/rs022, plus room for future
+    config.max_uri_handlers = 8; // Root, favicon, GET/POST /api/ipconfig, /api/rs022 and /api/io_map
     config.max_open_sockets = 3;
     config.stack_size = 8192; // Reduced for minimal web UI
     config.task_priority = 5;
@@ -398,6 +398,126 @@ static esp_err_t api_post_rs022_handler(httpd_req_t *req)
     return send_json_response(req, response, ESP_OK);
 }
 
+static const char *const s_io_source_names[SYSTEM_MOTOMAN_IO_SOURCE_COUNT] = {
+    [SYSTEM_MOTOMAN_IO_SOURCE_STATUS] = "status",
+    [SYSTEM_MOTOMAN_IO_SOURCE_POSITION] = "position",
+    [SYSTEM_MOTOMAN_IO_SOURCE_TORQUE] = "torque",
+    [SYSTEM_MOTOMAN_IO_SOURCE_IO] = "io",
+    [SYSTEM_MOTOMAN_IO_SOURCE_REGISTER] = "register",
+};
+
+static cJSON *io_map_entries_to_json(const system_motoman_io_map_entry_t *entries, uint8_t count)
+{
+    cJSON *array = cJSON_CreateArray();
+    for (uint8_t i = 0; i < count; i++) {
+        if (entries[i].source >= SYSTEM_MOTOMAN_IO_SOURCE_COUNT) {
+            continue;
+        }
+        cJSON *entry = cJSON_CreateObject();
+        cJSON_AddStringToObject(entry, "source", s_io_source_names[entries[i].source]);
+        cJSON_AddNumberToObject(entry, "first", entries[i].first);
+        cJSON_AddNumberToObject(entry, "count", entries[i].count);
+        cJSON_AddItemToArray(array, entry);
+    }
+    return array;
+}
+
+// Returns the number of entries parsed, -1 if the array is malformed
+static int io_map_entries_from_json(const cJSON *array, system_motoman_io_map_entry_t *entries)
+{
+    if (!cJSON_IsArray(array) || cJSON_GetArraySize(array) > SYSTEM_MOTOMAN_IO_MAP_MAX_ENTRIES) {
+        return -1;
+    }
+    int count = 0;
+    const cJSON *entry = NULL;
+    cJSON_ArrayForEach(entry, array) {
+        const cJSON *source = cJSON_GetObjectItem(entry, "source");
+        const cJSON *first = cJSON_GetObjectItem(entry, "first");
+        const cJSON *number = cJSON_GetObjectItem(entry, "count");
+        if (!cJSON_IsString(source) || !cJSON_IsNumber(first) || !cJSON_IsNumber(number) ||
+            first->valuedouble < 0 || first->valuedouble > UINT16_MAX ||
+            number->valuedouble < 1 || number->valuedouble > UINT16_MAX) {
+            return -1;
+        }
+        int source_index = -1;
+        for (int i = 0; i < SYSTEM_MOTOMAN_IO_SOURCE_COUNT; i++) {
+            if (strcmp(source->valuestring, s_io_source_names[i]) == 0) {
+                source_index = i;
+                break;
+            }
+        }
+        if (source_index < 0) {
+            return -1;
+        }
+        entries[count].source = (uint8_t)source_index;
+        entries[count].reserved = 0;
+        entries[count].first = (uint16_t)first->valueint;
+        entries[count].count = (uint16_t)number->valueint;
+        count++;
+    }
+    return count;
+}
+
+// GET /api/io_map - Get I/O assembly layout
+static esp_err_t api_get_io_map_handler(httpd_req_t *req)
+{
+    system_motoman_io_map_t map;
+    system_motoman_io_map_load(&map);
+    
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddItemToObject(json, "input", io_map_entries_to_json(map.input, map.input_entry_count));
+    cJSON_AddItemToObject(json, "output", io_map_entries_to_json(map.output, map.output_entry_count));
+    
+    return send_json_response(req, json, ESP_OK);
+}
+
+// POST /api/io_map - Set I/O assembly layout
+static esp_err_t api_post_io_map_handler(httpd_req_t *req)
+{
+    char content[2048];
+    if (req->content_len >= sizeof(content)) {
+        return send_json_error(req, "I/O map too large", 400);
+    }
+    size_t received = 0;
+    while (received < req->content_len) {
+        int ret = httpd_req_recv(req, content + received, req->content_len - received);
+        if (ret <= 0) {
+            httpd_resp_send_500(req);
+            return ESP_FAIL;
+        }
+        received += ret;
+    }
+    content[received] = '\0';
+    
+    cJSON *json = cJSON_Parse(content);
+    if (json == NULL) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+    
+    system_motoman_io_map_t map;
+    memset(&map, 0, sizeof(map));
+    int input_count = io_map_entries_from_json(cJSON_GetObjectItem(json, "input"), map.input);
+    int output_count = io_map_entries_from_json(cJSON_GetObjectItem(json, "output"), map.output);
+    cJSON_Delete(json);
+    
+    if (input_count < 0 || output_count < 0) {
+        return send_json_error(req, "Invalid I/O map: expected input and output arrays of {source, first, count}", 400);
+    }
+    map.input_entry_count = (uint8_t)input_count;
+    map.output_entry_count = (uint8_t)output_count;
+    
+    if (!system_motoman_io_map_save(&map)) {
+        return send_json_error(req, "Failed to save I/O map", 500);
+    }
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", "ok");
+    cJSON_AddStringToObject(response, "message", "I/O map saved successfully. Reboot required to apply changes.");
+    
+    return send_json_response(req, response, ESP_OK);
+}
+
 void webui_register_api_handlers(httpd_handle_t server)
 {
     if (server == NULL) {
@@ -463,5 +583,33 @@ void webui_register_api_handlers(httpd_handle_t server)
         ESP_LOGI(TAG, "Registered POST /api/rs022 handler");
     }
     
+    // GET /api/io_map
+    httpd_uri_t get_io_map_uri = {
+        .uri       = "/api/io_map",
+        .method    = HTTP_GET,
+        .handler   = api_get_io_map_handler,
+        .user_ctx  = NULL
+    };
+    ret = httpd_register_uri_handler(server, &get_io_map_uri);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register GET /api/io_map: %s", esp_err_to_name(ret));
+    } else {
+        ESP_LOGI(TAG, "Registered GET /api/io_map handler");
+    }
+    
+    // POST /api/io_map
+    httpd_uri_t post_io_map_uri = {
+        .uri       = "/api/io_map",
+        .method    = HTTP_POST,
+        .handler   = api_post_io_map_handler,
+        .user_ctx  = NULL
+    };
+    ret = httpd_register_uri_handler(server, &post_io_map_uri);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register POST /api/io_map: %s", esp_err_to_name(ret));
+    } else {
+        ESP_LOGI(TAG, "Registered POST /api/io_map handler");
+    }
+    
     ESP_LOGI(TAG, "API handler registration complete");
 }
@@ -35,6 +35,7 @@
 #include "esp_eth_mac_esp.h"
 #include "driver/gpio.h"
 #include "nvs_flash.h"
+#include "esp_spiffs.h"
 #include "lwip/netif.h"
 #include "lwip/ip4_addr.h"
 #include "opener.h"
@@ -206,6 +207,18 @@ void app_main(void)
     }
     ESP_ERROR_CHECK(nvs_ret);
 
+    // Job files of the simulator, the image is built from spiffs_image/
+    esp_vfs_spiffs_conf_t spiffs_conf = {
+        .base_path = "/spiffs",
+        .partition_label = "spiffs",
+        .max_files = 2,
+        .format_if_mount_failed = false,
+    };
+    esp_err_t spiffs_ret = esp_vfs_spiffs_register(&spiffs_conf);
+    if (spiffs_ret != ESP_OK) {
+        ESP_LOGW(TAG, "SPIFFS not mounted: %s", esp_err_to_name(spiffs_ret));
+    }
+
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
 